@@ -201,7 +201,6 @@ get_install_cmd() {
                 pkg-config) echo "sudo pacman -S pkgconf" ;;
                 qt6-base-dev) echo "sudo pacman -S qt6-base" ;;
                 qt6-multimedia-dev) echo "sudo pacman -S qt6-multimedia" ;;
-                lsof) echo "sudo pacman -S lsof" ;;
                 *) echo "sudo pacman -S $package" ;;
             esac
             ;;
@@ -237,9 +236,6 @@ get_install_cmd() {
                 qt6-multimedia-dev)
                     echo "Arch: sudo pacman -S qt6-multimedia | Debian/Ubuntu: sudo apt install qt6-multimedia-dev | Fedora: sudo dnf install qt6-qtmultimedia-devel"
                     ;;
-                lsof)
-                    echo "Arch: sudo pacman -S lsof | Debian/Ubuntu: sudo apt install lsof | Fedora: sudo dnf install lsof"
-                    ;;
                 *)
                     echo "Package: $package"
                     ;;
@@ -339,17 +335,6 @@ check_dependencies() {
         all_ok=false
     fi
 
-    # Check for optional but recommended tools
-    echo ""
-    print_msg "$BLUE" "Optional dependencies:"
-
-    if command -v lsof &> /dev/null; then
-        print_msg "$GREEN" "  ✓ lsof (for camera usage detection)"
-    else
-        print_msg "$YELLOW" "  ⚠ lsof - NOT FOUND (optional, but recommended)"
-        print_msg "$BLUE" "    Install: $(get_install_cmd lsof)"
-    fi
-
     echo ""
     if [ "$all_ok" = true ]; then
         print_msg "$GREEN" "✓ All required dependencies are installed!"
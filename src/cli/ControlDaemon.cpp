@@ -0,0 +1,626 @@
+#include "ControlDaemon.h"
+#include "DeviceCommands.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <dev/devs.hpp>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+// Status subscriptions poll cameraStatus(), which the SDK keeps cached
+constexpr auto kStatusPollInterval = chrono::milliseconds(250);
+// A client that sends a line longer than this is not speaking our protocol
+constexpr size_t kMaxLineLength = 4096;
+
+volatile sig_atomic_t s_stopRequested = 0;
+int s_signalWakeFd = -1;
+
+void onStopSignal(int)
+{
+    s_stopRequested = 1;
+    if (s_signalWakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(s_signalWakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+bool fillAddress(const string &path, sockaddr_un &addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+int connectTo(const string &path)
+{
+    sockaddr_un addr;
+    if (!fillAddress(path, addr)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Split a leading "#<id>" request tag off a command line
+string takeRequestId(string &line)
+{
+    size_t start = line.find_first_not_of(" \t");
+    if (start == string::npos || line[start] != '#') {
+        return string();
+    }
+    size_t end = line.find_first_of(" \t", start);
+    string id = line.substr(start + 1, end == string::npos ? string::npos : end - start - 1);
+    line = end == string::npos ? string() : line.substr(end);
+    return id;
+}
+
+bool sendAll(int fd, const string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+ControlDaemon::ControlDaemon(const Config &config)
+    : m_config(config)
+    , m_listenFd(-1)
+    , m_wakeFd(-1)
+    , m_nextClientId(0)
+    , m_stopping(false)
+    , m_deviceChanged(true)
+    , m_subscribers(0)
+{
+}
+
+ControlDaemon::~ControlDaemon()
+{
+    if (m_worker.joinable()) {
+        // run() set the hotplug callback just before starting the worker, and
+        // Devices outlives us; a late plug event must not reach this object
+        Devices::get().setDevChangedCallback(nullptr, nullptr);
+    }
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobReady.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    for (auto &entry : m_clients) {
+        close(entry.second.fd);
+    }
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        unlink(socketPath().c_str());
+    }
+    if (m_wakeFd >= 0) {
+        s_signalWakeFd = -1;
+        close(m_wakeFd);
+    }
+}
+
+string ControlDaemon::socketPath()
+{
+    const char *runtimeDir = getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && *runtimeDir) {
+        return string(runtimeDir) + "/obsbot.sock";
+    }
+    return "/tmp/obsbot-" + to_string(getuid()) + ".sock";
+}
+
+bool ControlDaemon::openSocket(const string &path)
+{
+    sockaddr_un addr;
+    if (!fillAddress(path, addr)) {
+        cerr << "[Daemon] Socket path too long: " << path << endl;
+        return false;
+    }
+
+    // A socket file nobody answers on is left over from a crash
+    int existing = connectTo(path);
+    if (existing >= 0) {
+        close(existing);
+        cerr << "[Daemon] Another daemon is already listening on " << path << endl;
+        return false;
+    }
+    unlink(path.c_str());
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (m_listenFd < 0) {
+        cerr << "[Daemon] socket() failed: " << strerror(errno) << endl;
+        return false;
+    }
+
+    // Owner-only: anyone who can connect can move the camera
+    mode_t oldMask = umask(0077);
+    int bound = bind(m_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    umask(oldMask);
+    if (bound != 0 || listen(m_listenFd, 16) != 0) {
+        cerr << "[Daemon] Cannot listen on " << path << ": " << strerror(errno) << endl;
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    return true;
+}
+
+int ControlDaemon::run()
+{
+    const string path = socketPath();
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeFd < 0 || !openSocket(path)) {
+        return 1;
+    }
+
+    s_signalWakeFd = m_wakeFd;
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Hotplug only flags the worker; it re-reads the device list itself
+    Devices::get().setDevChangedCallback([this](std::string dev_sn, bool connected, void *) {
+        cout << "[Daemon] Device " << dev_sn << (connected ? " connected" : " disconnected") << endl;
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_deviceChanged = true;
+        }
+        m_jobReady.notify_one();
+    }, nullptr);
+    Devices::get().setEnableMdnsScan(false);  // USB only
+
+    m_worker = thread(&ControlDaemon::workerLoop, this);
+    cout << "[Daemon] Listening on " << path << endl;
+
+    while (!s_stopRequested) {
+        vector<pollfd> fds;
+        vector<int> ids;
+        fds.push_back({m_listenFd, POLLIN, 0});
+        fds.push_back({m_wakeFd, POLLIN, 0});
+        for (const auto &entry : m_clients) {
+            if (entry.second.hungUp) {
+                continue;  // POLLHUP is reported regardless of events and would spin the loop
+            }
+            short events = entry.second.readClosed ? 0 : POLLIN;
+            if (!entry.second.output.empty()) {
+                events |= POLLOUT;
+            }
+            fds.push_back({entry.second.fd, events, 0});
+            ids.push_back(entry.first);
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            cerr << "[Daemon] poll() failed: " << strerror(errno) << endl;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            while (read(m_wakeFd, &count, sizeof(count)) > 0) {}
+            deliverReplies();
+        }
+
+        for (size_t i = 2; i < fds.size(); ++i) {
+            auto it = m_clients.find(ids[i - 2]);
+            if (it == m_clients.end()) continue;
+            bool alive = true;
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                alive = readClient(it->first, it->second);
+            }
+            if (alive && (fds[i].revents & (POLLHUP | POLLERR))) {
+                // Commands it sent before leaving still run; their replies have nowhere to go
+                it->second.hungUp = true;
+                it->second.readClosed = true;
+                it->second.output.clear();
+            }
+            if (alive && (fds[i].revents & POLLOUT)) {
+                alive = writeClient(it->second);
+            }
+            if (alive && it->second.readClosed && it->second.pending == 0 && it->second.output.empty()) {
+                alive = false;
+            }
+            if (!alive) {
+                closeClient(ids[i - 2]);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            acceptClient();
+        }
+    }
+
+    cout << "[Daemon] Shutting down" << endl;
+    return 0;
+}
+
+void ControlDaemon::acceptClient()
+{
+    while (true) {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        Client client;
+        client.fd = fd;
+        m_clients[m_nextClientId++] = std::move(client);
+    }
+}
+
+bool ControlDaemon::readClient(int clientId, Client &client)
+{
+    char buffer[4096];
+    while (true) {
+        ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n == 0) {
+            // Half-closed ("echo get zoom | socat ..."): still answer what was sent
+            client.readClosed = true;
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        client.input.append(buffer, static_cast<size_t>(n));
+    }
+
+    // Queue every complete line at once; the worker drains them back to back
+    vector<Job> jobs;
+    size_t newline;
+    while ((newline = client.input.find('\n')) != string::npos) {
+        string line = client.input.substr(0, newline);
+        client.input.erase(0, newline + 1);
+        if (line.find_first_not_of(" \t\r") == string::npos) {
+            continue;
+        }
+        string id = takeRequestId(line);
+        jobs.push_back({clientId, std::move(id), std::move(line)});
+    }
+    if (client.input.size() > kMaxLineLength) {
+        return false;
+    }
+
+    if (!jobs.empty()) {
+        client.pending += static_cast<int>(jobs.size());
+        {
+            lock_guard<mutex> lock(m_mutex);
+            for (auto &job : jobs) {
+                m_jobs.push_back(std::move(job));
+            }
+        }
+        m_jobReady.notify_one();
+    }
+    return true;
+}
+
+bool ControlDaemon::writeClient(Client &client)
+{
+    while (!client.output.empty()) {
+        ssize_t n = send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.output.erase(0, static_cast<size_t>(n));
+    }
+    return true;
+}
+
+void ControlDaemon::closeClient(int clientId)
+{
+    auto it = m_clients.find(clientId);
+    if (it == m_clients.end()) return;
+    if (it->second.subscribed) {
+        --m_subscribers;
+    }
+    close(it->second.fd);
+    m_clients.erase(it);
+}
+
+void ControlDaemon::deliverReplies()
+{
+    vector<Reply> replies;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        replies.swap(m_replies);
+    }
+
+    vector<int> touched;
+    for (auto &reply : replies) {
+        if (reply.clientId < 0) {
+            for (auto &entry : m_clients) {
+                if (entry.second.subscribed && !entry.second.hungUp) {
+                    entry.second.output += reply.line + "\n";
+                    touched.push_back(entry.first);
+                }
+            }
+            continue;
+        }
+
+        auto it = m_clients.find(reply.clientId);
+        if (it == m_clients.end()) {
+            continue;  // Client left before its answer arrived
+        }
+        Client &client = it->second;
+        --client.pending;
+        if (reply.subscribe > 0 && !client.subscribed) {
+            client.subscribed = true;
+            ++m_subscribers;
+            m_jobReady.notify_one();  // Start status polling
+        } else if (reply.subscribe < 0 && client.subscribed) {
+            client.subscribed = false;
+            --m_subscribers;
+        }
+        if (!client.hungUp) {
+            client.output += reply.line + "\n";
+        }
+        touched.push_back(reply.clientId);
+    }
+
+    // Try to flush right away; poll() picks up whatever does not fit
+    sort(touched.begin(), touched.end());
+    touched.erase(unique(touched.begin(), touched.end()), touched.end());
+    for (int id : touched) {
+        auto it = m_clients.find(id);
+        if (it == m_clients.end()) continue;
+        Client &client = it->second;
+        bool alive = writeClient(client);
+        if (!alive || (client.readClosed && client.pending == 0 && client.output.empty())) {
+            closeClient(id);
+        }
+    }
+}
+
+void ControlDaemon::post(Reply reply)
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_replies.push_back(std::move(reply));
+    }
+    wake();
+}
+
+void ControlDaemon::wake()
+{
+    uint64_t one = 1;
+    ssize_t ignored = write(m_wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void ControlDaemon::workerLoop()
+{
+    DeviceCommands commands(m_config);
+    map<string, double> lastStatus;
+    bool statusKnown = false;
+    auto nextPoll = chrono::steady_clock::now();
+
+    while (true) {
+        deque<Job> jobs;
+        bool deviceChanged = false;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            auto ready = [this]() { return m_stopping || m_deviceChanged || !m_jobs.empty(); };
+            if (m_subscribers > 0) {
+                m_jobReady.wait_until(lock, nextPoll, ready);
+            } else {
+                m_jobReady.wait(lock, [this, &ready]() { return ready() || m_subscribers > 0; });
+            }
+            if (m_stopping) {
+                return;
+            }
+            jobs.swap(m_jobs);
+            deviceChanged = m_deviceChanged;
+            m_deviceChanged = false;
+        }
+
+        if (deviceChanged) {
+            auto devices = Devices::get().getDevList();
+            auto dev = devices.empty() ? nullptr : devices.front();
+            bool wasConnected = commands.hasDevice();
+            commands.setDevice(dev);
+            if (dev || wasConnected) {
+                JsonLine event;
+                event.add("event", "device").add("connected", dev != nullptr);
+                if (dev) {
+                    event.add("sn", dev->devSn()).add("name", dev->devName());
+                    cout << "[Daemon] Using " << dev->devName() << " (" << dev->devSn() << ")" << endl;
+                }
+                post({-1, event.str()});
+            }
+            statusKnown = false;
+        }
+
+        for (auto &job : jobs) {
+            auto args = DeviceCommands::tokenize(job.line);
+            Reply reply{job.clientId, std::string()};
+            if (!args.empty() && (args[0] == "subscribe" || args[0] == "unsubscribe")) {
+                DeviceCommands::Result result;
+                reply.subscribe = args[0] == "subscribe" ? 1 : -1;
+                result.fields.add("subscribed", reply.subscribe > 0);
+                reply.line = result.toJson(job.id);
+                statusKnown = false;  // New subscribers get the current status right away
+            } else {
+                // A waiting command answers from the sequencer thread; the worker moves on
+                auto result = commands.execute(args, [this, clientId = job.clientId, id = job.id](
+                                                         const DeviceCommands::Result &finished) {
+                    post({clientId, finished.toJson(id)});
+                });
+                if (result.deferred) {
+                    continue;
+                }
+                reply.line = result.toJson(job.id);
+            }
+            post(std::move(reply));
+        }
+
+        auto now = chrono::steady_clock::now();
+        if (m_subscribers > 0 && (now >= nextPoll || !statusKnown)) {
+            auto status = commands.snapshot();
+            if (!statusKnown || status != lastStatus) {
+                JsonLine event;
+                event.add("event", "status").add("connected", commands.hasDevice());
+                for (const auto &entry : status) {
+                    event.add(entry.first, entry.second);
+                }
+                post({-1, event.str()});
+                lastStatus = status;
+                statusKnown = true;
+            }
+            nextPoll = now + kStatusPollInterval;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+int runDaemonClient(const vector<string> &command, bool timing)
+{
+    const string path = ControlDaemon::socketPath();
+    int fd = connectTo(path);
+    if (fd < 0) {
+        cerr << "No daemon listening on " << path << " (start one with --daemon)" << endl;
+        return 1;
+    }
+
+    bool readStdin = command.empty();
+    bool subscribed = false;
+    bool anyFailed = false;
+    string input;
+    string stdinBuffer;
+    deque<chrono::steady_clock::time_point> inFlight;
+    vector<double> roundTrips;
+
+    auto sendLine = [&](string line) {
+        string probe = line;
+        takeRequestId(probe);
+        auto args = DeviceCommands::tokenize(probe);
+        if (args.empty()) {
+            return true;
+        }
+        if (args[0] == "subscribe") {
+            subscribed = true;
+        }
+        inFlight.push_back(chrono::steady_clock::now());
+        return sendAll(fd, line + "\n");
+    };
+
+    if (!readStdin) {
+        string line;
+        for (const auto &word : command) {
+            if (!line.empty()) line += " ";
+            line += word.find_first_of(" \t") == string::npos ? word : "\"" + word + "\"";
+        }
+        if (!sendLine(line)) {
+            cerr << "Lost connection to daemon" << endl;
+            close(fd);
+            return 1;
+        }
+    }
+
+    while (readStdin || !inFlight.empty() || subscribed) {
+        pollfd fds[2] = {{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+        if (poll(fds, readStdin ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (readStdin && (fds[1].revents & (POLLIN | POLLHUP))) {
+            char buffer[4096];
+            ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (n <= 0) {
+                readStdin = false;
+                if (!stdinBuffer.empty()) {
+                    sendLine(stdinBuffer);
+                    stdinBuffer.clear();
+                }
+            } else {
+                stdinBuffer.append(buffer, static_cast<size_t>(n));
+                size_t newline;
+                // Pipelined: lines go out as soon as they are read
+                while ((newline = stdinBuffer.find('\n')) != string::npos) {
+                    if (!sendLine(stdinBuffer.substr(0, newline))) {
+                        cerr << "Lost connection to daemon" << endl;
+                        close(fd);
+                        return 1;
+                    }
+                    stdinBuffer.erase(0, newline + 1);
+                }
+            }
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            char buffer[4096];
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                if (!inFlight.empty()) {
+                    cerr << "Daemon closed the connection" << endl;
+                    anyFailed = true;
+                }
+                break;
+            }
+            input.append(buffer, static_cast<size_t>(n));
+            size_t newline;
+            while ((newline = input.find('\n')) != string::npos) {
+                string reply = input.substr(0, newline);
+                input.erase(0, newline + 1);
+                cout << reply << endl;
+                if (reply.rfind("{\"event\"", 0) == 0 || inFlight.empty()) {
+                    continue;
+                }
+                roundTrips.push_back(chrono::duration<double, milli>(
+                    chrono::steady_clock::now() - inFlight.front()).count());
+                inFlight.pop_front();
+                if (reply.find("\"ok\":false") != string::npos) {
+                    anyFailed = true;
+                }
+            }
+        }
+    }
+    close(fd);
+
+    if (timing && !roundTrips.empty()) {
+        auto sorted = roundTrips;
+        sort(sorted.begin(), sorted.end());
+        double mean = accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        cerr << "[Client] " << sorted.size() << " command(s), round trip ms: min " << sorted.front()
+             << ", median " << sorted[sorted.size() / 2] << ", mean " << mean
+             << ", max " << sorted.back() << endl;
+    }
+    return anyFailed ? 1 : 0;
+}
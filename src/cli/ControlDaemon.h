@@ -0,0 +1,99 @@
+#ifndef CONTROLDAEMON_H
+#define CONTROLDAEMON_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Config.h"
+
+/**
+ * @brief Long-running owner of the camera, serving commands on a Unix socket
+ *
+ * Discovery and SDK start-up happen once; clients then send one command per
+ * line (see DeviceCommands::usage()) and get one JSON object per line back,
+ * in order. A request may start with "#<id>" which is echoed as "id" in its
+ * reply, so clients can pipeline without waiting for each answer.
+ *
+ * "subscribe" switches a connection to also receive {"event":"status",...}
+ * lines whenever the camera status changes, and {"event":"device",...} on
+ * hotplug. Device commands run on one worker thread in arrival order; the
+ * socket loop never blocks on USB. "sequence play <name> wait" is the one
+ * reply that can come after later ones: it is sent when the sequence ends,
+ * while the worker goes on serving commands, "sequence stop" included.
+ */
+class ControlDaemon
+{
+public:
+    explicit ControlDaemon(const Config &config);
+    ~ControlDaemon();
+
+    // Serve until SIGINT/SIGTERM. Returns the process exit code.
+    int run();
+
+    // $XDG_RUNTIME_DIR/obsbot.sock, or /tmp/obsbot-<uid>.sock without a runtime dir
+    static std::string socketPath();
+
+private:
+    struct Client {
+        int fd = -1;
+        std::string input;
+        std::string output;
+        bool subscribed = false;
+        int pending = 0;          // Commands queued but not answered yet
+        bool readClosed = false;  // Peer shut down its side; close once answered
+        bool hungUp = false;      // Peer gone; no longer polled, replies dropped, close once answered
+    };
+
+    struct Job {
+        int clientId;
+        std::string id;
+        std::string line;
+    };
+
+    struct Reply {
+        int clientId;  // -1 broadcasts to subscribers
+        std::string line;
+        int subscribe = 0;  // +1 subscribe, -1 unsubscribe
+    };
+
+    const Config &m_config;
+    int m_listenFd;
+    int m_wakeFd;  // eventfd: worker replies and signals wake the socket loop
+    std::map<int, Client> m_clients;  // By connection id; fds get reused, ids do not
+    int m_nextClientId;
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::deque<Job> m_jobs;
+    std::vector<Reply> m_replies;
+    bool m_stopping;
+    bool m_deviceChanged;
+    std::atomic<int> m_subscribers;
+
+    bool openSocket(const std::string &path);
+    void workerLoop();
+    void post(Reply reply);
+    void wake();
+
+    void acceptClient();
+    bool readClient(int clientId, Client &client);
+    bool writeClient(Client &client);
+    void deliverReplies();
+    void closeClient(int clientId);
+};
+
+/**
+ * @brief Thin client for a running daemon
+ * @param command Command words; empty reads commands from stdin, one per line
+ * @param timing Report per-command round trip statistics on stderr
+ * @return 0 when every command succeeded
+ */
+int runDaemonClient(const std::vector<std::string> &command, bool timing);
+
+#endif // CONTROLDAEMON_H
@@ -0,0 +1,1096 @@
+#include "DeviceCommands.h"
+#include "GimbalPresets.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+bool parseBool(const string &text, bool &value)
+{
+    if (text == "on" || text == "true" || text == "1") {
+        value = true;
+        return true;
+    }
+    if (text == "off" || text == "false" || text == "0") {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool parseDouble(const string &text, double &value)
+{
+    char *end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return end && end != text.c_str() && *end == '\0' && std::isfinite(value);
+}
+
+bool parseInt(const string &text, int &value)
+{
+    char *end = nullptr;
+    long parsed = strtol(text.c_str(), &end, 10);
+    if (!end || end == text.c_str() || *end != '\0') {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+DeviceCommands::Result failure(const string &message)
+{
+    DeviceCommands::Result result;
+    result.ok = false;
+    result.error = message;
+    return result;
+}
+
+Device::FovType toFovType(int fov)
+{
+    return fov == 0 ? Device::FovType86 : (fov == 1 ? Device::FovType78 : Device::FovType65);
+}
+
+void addSequenceStatus(DeviceCommands::Result &result, const PtzSequencer::Status &status)
+{
+    result.fields.add("running", status.running)
+                 .add("name", status.name)
+                 .add("elapsed_ms", std::round(status.elapsedMs))
+                 .add("duration_ms", status.durationMs)
+                 .add("peak_speed_deg_s", std::round(status.peakSpeedDeg))
+                 .add("max_error_deg", std::round(status.maxErrorDeg * 100.0) / 100.0)
+                 .add("max_zoom_error", std::round(status.maxZoomError * 1000.0) / 1000.0)
+                 .add("overruns", status.overruns);
+    if (!status.running) {
+        result.fields.add("completed", status.completed);
+    }
+    if (!status.error.empty()) {
+        result.fields.add("reason", status.error);
+    }
+}
+
+// A white_balance name or its SDK value, as settings.conf accepts them
+bool parseWhiteBalance(const string &text, int &mode)
+{
+    for (const auto &named : Config::whiteBalanceModes()) {
+        if (text == named.first || text == to_string(named.second)) {
+            mode = named.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+string whiteBalanceName(int mode)
+{
+    for (const auto &named : Config::whiteBalanceModes()) {
+        if (named.second == mode) {
+            return named.first;
+        }
+    }
+    return to_string(mode);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// JsonLine
+
+string JsonLine::quote(const string &text)
+{
+    string out = "\"";
+    for (char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += "\"";
+    return out;
+}
+
+void JsonLine::addRaw(const string &key, const string &rawValue)
+{
+    if (!m_body.empty()) {
+        m_body += ",";
+    }
+    m_body += quote(key) + ":" + rawValue;
+}
+
+JsonLine &JsonLine::add(const string &key, const string &value)
+{
+    addRaw(key, quote(value));
+    return *this;
+}
+
+JsonLine &JsonLine::add(const string &key, const char *value)
+{
+    return add(key, string(value));
+}
+
+JsonLine &JsonLine::add(const string &key, double value)
+{
+    if (!std::isfinite(value)) {
+        addRaw(key, "null");
+        return *this;
+    }
+    char text[32];
+    snprintf(text, sizeof(text), "%.6g", value);
+    addRaw(key, text);
+    return *this;
+}
+
+JsonLine &JsonLine::add(const string &key, int value)
+{
+    addRaw(key, to_string(value));
+    return *this;
+}
+
+JsonLine &JsonLine::add(const string &key, bool value)
+{
+    addRaw(key, value ? "true" : "false");
+    return *this;
+}
+
+JsonLine &JsonLine::append(const JsonLine &other)
+{
+    if (!other.m_body.empty()) {
+        if (!m_body.empty()) {
+            m_body += ",";
+        }
+        m_body += other.m_body;
+    }
+    return *this;
+}
+
+// ---------------------------------------------------------------------------
+// DeviceCommands
+
+string DeviceCommands::Result::toJson(const string &id) const
+{
+    JsonLine prefix;
+    if (!id.empty()) {
+        prefix.add("id", id);
+    }
+    return toJson(prefix);
+}
+
+string DeviceCommands::Result::toJson(const JsonLine &prefix) const
+{
+    JsonLine line = prefix;
+    line.add("ok", ok);
+    if (!ok) {
+        line.add("error", error);
+    }
+    line.append(fields);
+    line.add("ms", std::round(elapsedMs * 1000.0) / 1000.0);
+    return line.str();
+}
+
+DeviceCommands::DeviceCommands(const Config &config)
+    : m_config(config)
+    , m_pan(0.0)
+    , m_tilt(0.0)
+    , m_applied(config.getSettings())
+    , m_ptzKnown(false)
+{
+    m_sequencer.setCommandLogger([this](const string &name, int32_t result) {
+        m_telemetry.logCommand(name, result);
+    });
+    m_sequencer.setFinishedCallback([this](const PtzSequencer::Status &status) {
+        Result result;
+        addSequenceStatus(result, status);
+        result.elapsedMs = status.elapsedMs;
+        if (!status.completed) {
+            result.ok = false;
+            result.error = status.error.empty() ? "sequence stopped" : status.error;
+        }
+
+        vector<Completion> waiters;
+        {
+            lock_guard<mutex> lock(m_waitMutex);
+            waiters.swap(m_sequenceWaiters);
+        }
+        for (const auto &waiter : waiters) {
+            waiter(result);
+        }
+    });
+    m_targetSelector.setCommandLogger([this](const string &name, int32_t result) {
+        m_telemetry.logCommand(name, result);
+    });
+    m_commandSequence.setCommandLogger([this](const string &name, int32_t result) {
+        m_telemetry.logCommand(name, result);
+    });
+}
+
+void DeviceCommands::setDevice(shared_ptr<Device> dev)
+{
+    if (dev != m_device) {
+        m_pan = 0.0;
+        m_tilt = 0.0;
+        m_applied = m_config.getSettings();  // Assume the app left it there
+        m_ptzKnown = false;
+        m_sequencer.stop();
+        m_telemetry.stop();
+    }
+    m_device = std::move(dev);
+}
+
+vector<string> DeviceCommands::tokenize(const string &line)
+{
+    vector<string> tokens;
+    string current;
+    bool quoted = false;
+    bool inToken = false;
+
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            inToken = true;
+        } else if (!quoted && (c == ' ' || c == '\t' || c == '\r' || c == '\n')) {
+            if (inToken) {
+                tokens.push_back(current);
+                current.clear();
+                inToken = false;
+            }
+        } else {
+            current += c;
+            inToken = true;
+        }
+    }
+    if (inToken) {
+        tokens.push_back(current);
+    }
+    return tokens;
+}
+
+const char *DeviceCommands::usage()
+{
+    return "Commands:\n"
+           "  info                         Device name, serial and version\n"
+           "  get <field>|status           Read one field or all of them\n"
+           "  set <field> <value>          pan, tilt, zoom, tracking, hdr, fov, face_ae,\n"
+           "                               face_focus, brightness, contrast, saturation,\n"
+           "                               white_balance (auto ... shade, manual <kelvin>)\n"
+           "  ptz <pan> <tilt> [zoom]      Move and zoom in one command\n"
+           "  center                       Pan/tilt to 0, 0\n"
+           "  preset <n>                   Recall preset n (1-based) from settings.conf\n"
+           "  apply-config                 Apply settings.conf to the camera\n"
+           "  profile list                 Saved setting profiles\n"
+           "  profile use <name>           Send only the settings that differ from the profile\n"
+           "  profile save|delete <name>   Save the current settings.conf as a profile, or delete one\n"
+           "  record <file> [hz]|stop      Log gimbal attitude and commands to a file\n"
+           "  sequence list|status|stop    Keyframed PTZ moves from settings.conf\n"
+           "  sequence play <name> [wait]  Start a sequence; 'wait' returns when it ends\n"
+           "  target at <x> <y>            Track the subject at a frame point (0-1)\n"
+           "  target box <x0> <y0> <x1> <y1>  Frame a box given in frame coordinates\n"
+           "  target center|biggest        Track the central or the largest subject\n"
+           "  ping                         No-op, for measuring round trips\n";
+}
+
+DeviceCommands::Result DeviceCommands::execute(const string &line)
+{
+    return execute(tokenize(line));
+}
+
+DeviceCommands::Result DeviceCommands::execute(const vector<string> &args, Completion completion)
+{
+    m_completion = std::move(completion);
+    Result result = execute(args);
+    m_completion = nullptr;
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::execute(const vector<string> &args)
+{
+    auto start = chrono::steady_clock::now();
+    Result result;
+
+    if (args.empty()) {
+        result = failure("empty command");
+    } else if (args[0] == "ping") {
+        result.fields.add("pong", true);
+    } else if (args[0] == "profile" && !(args.size() == 3 && args[1] == "use")) {
+        result = runProfile(args);  // Listing and saving work without a camera
+    } else if (!m_device) {
+        result = failure("no device");
+    } else if (args[0] == "sequence") {
+        result = runSequence(args);
+    } else if (args[0] == "get") {
+        result = runGet(args);
+    } else if (m_sequencer.isRunning() && (args[0] == "ptz" || args[0] == "center" || args[0] == "preset" ||
+               args[0] == "target" ||
+               (args[0] == "set" && args.size() >= 2 &&
+                (args[1] == "pan" || args[1] == "tilt" || args[1] == "zoom" || args[1] == "ptz")))) {
+        // A manual move takes over from a running sequence
+        m_sequencer.stop();
+        result = execute(args);
+    } else if (args[0] == "set") {
+        result = runSet(args);
+    } else if (args[0] == "ptz") {
+        vector<string> setArgs = {"set", "ptz"};
+        setArgs.insert(setArgs.end(), args.begin() + 1, args.end());
+        result = runSet(setArgs);
+    } else if (args[0] == "center") {
+        result = runSet({"set", "ptz", "0", "0"});
+    } else if (args[0] == "preset") {
+        result = runPreset(args);
+    } else if (args[0] == "info") {
+        result = runInfo();
+    } else if (args[0] == "record") {
+        result = runRecord(args);
+    } else if (args[0] == "target") {
+        result = runTarget(args);
+    } else if (args[0] == "profile") {
+        result = runProfile(args);
+    } else if (args[0] == "apply-config") {
+        applyConfigToCamera(m_device, m_config.getSettings());
+        m_applied = m_config.getSettings();
+        m_pan = m_applied.pan;
+        m_tilt = m_applied.tilt;
+        m_ptzKnown = true;
+    } else {
+        result = failure("unknown command '" + args[0] + "'");
+    }
+
+    result.elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    if (m_telemetry.isRecording() && !args.empty()) {
+        string name;
+        for (const auto &arg : args) {
+            name += (name.empty() ? "" : " ") + arg;
+        }
+        m_telemetry.logCommand(name, result.ok ? RM_RET_OK : RM_RET_ERR);
+    }
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::checkDevice(const char *what, int32_t ret)
+{
+    if (ret != 0) {
+        return failure(string(what) + " failed (code: " + to_string(ret) + ")");
+    }
+    return Result();
+}
+
+bool DeviceCommands::readValue(const string &field, double &value)
+{
+    if (!m_device) {
+        return false;
+    }
+
+    if (field == "pan") {
+        value = m_pan;
+    } else if (field == "tilt") {
+        value = m_tilt;
+    } else if (field == "zoom") {
+        float zoom = 1.0f;
+        if (m_device->cameraGetZoomAbsoluteR(zoom) != 0) return false;
+        value = zoom;
+    } else if (field == "brightness" || field == "contrast" || field == "saturation") {
+        int32_t raw = 0;
+        int32_t ret;
+        if (field == "brightness") {
+            ret = m_device->cameraGetImageBrightnessR(raw);
+        } else if (field == "contrast") {
+            ret = m_device->cameraGetImageContrastR(raw);
+        } else {
+            ret = m_device->cameraGetImageSaturationR(raw);
+        }
+        if (ret != 0) return false;
+        value = raw;
+    } else if (field == "white_balance" || field == "white_balance_kelvin") {
+        Device::DevWhiteBalanceType type;
+        int32_t param = 0;
+        if (m_device->cameraGetWhiteBalanceR(type, param) != 0) return false;
+        value = field == "white_balance" ? static_cast<int>(type) : param;
+    } else {
+        // Everything else comes from the status block the SDK keeps up to date
+        auto values = snapshot();
+        auto it = values.find(field);
+        if (it == values.end()) return false;
+        value = it->second;
+    }
+    return true;
+}
+
+bool DeviceCommands::readField(const string &field, JsonLine &out)
+{
+    double value = 0.0;
+    if (!readValue(field, value)) {
+        return false;
+    }
+
+    if (field == "pan" || field == "tilt" || field == "zoom") {
+        out.add(field, value);
+    } else {
+        out.add(field, static_cast<int>(value));
+    }
+    if (field == "white_balance" && static_cast<int>(value) == Device::DevWhiteBalanceManual) {
+        double kelvin = 0.0;
+        if (readValue("white_balance_kelvin", kelvin)) {
+            out.add("white_balance_kelvin", static_cast<int>(kelvin));
+        }
+    }
+    return true;
+}
+
+map<string, double> DeviceCommands::snapshot()
+{
+    map<string, double> values;
+    values["pan"] = m_pan;
+    values["tilt"] = m_tilt;
+    if (!m_device) {
+        return values;
+    }
+
+    auto status = m_device->cameraStatus();
+    values["ai_mode"] = status.tiny.ai_mode;
+    values["zoom_ratio"] = status.tiny.zoom_ratio;
+    values["hdr"] = status.tiny.hdr;
+    values["face_ae"] = status.tiny.face_ae;
+    values["face_focus"] = status.tiny.face_auto_focus;
+    values["auto_focus"] = status.tiny.auto_focus;
+    values["fov"] = status.tiny.fov;
+    values["dev_status"] = status.tiny.dev_status;
+    return values;
+}
+
+DeviceCommands::Result DeviceCommands::runGet(const vector<string> &args)
+{
+    if (args.size() != 2) {
+        return failure("usage: get <field>|status");
+    }
+
+    Result result;
+    if (args[1] == "status") {
+        for (const char *field : {"zoom", "brightness", "contrast", "saturation", "white_balance"}) {
+            if (!readField(field, result.fields)) {
+                return failure(string("reading ") + field + " failed");
+            }
+        }
+        for (const auto &entry : snapshot()) {
+            if (entry.first == "pan" || entry.first == "tilt") {
+                result.fields.add(entry.first, entry.second);
+            } else {
+                result.fields.add(entry.first, static_cast<int>(entry.second));
+            }
+        }
+        return result;
+    }
+
+    if (!readField(args[1], result.fields)) {
+        return failure("cannot read '" + args[1] + "'");
+    }
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::runSet(const vector<string> &args)
+{
+    if (args.size() < 3) {
+        return failure("usage: set <field> <value>");
+    }
+
+    const string &field = args[1];
+    const string &value = args[2];
+    double number = 0.0;
+    int integer = 0;
+    bool flag = false;
+
+    if (field == "ptz") {
+        double pan = 0.0, tilt = 0.0, zoom = 0.0;
+        if (args.size() < 4 || !parseDouble(args[2], pan) || !parseDouble(args[3], tilt) ||
+            (args.size() > 4 && !parseDouble(args[4], zoom))) {
+            return failure("usage: ptz <pan> <tilt> [zoom]");
+        }
+        pan = std::clamp(pan, -1.0, 1.0);
+        tilt = std::clamp(tilt, -1.0, 1.0);
+        Result result = checkDevice("cameraSetPanTiltAbsolute", m_device->cameraSetPanTiltAbsolute(pan, tilt));
+        if (!result.ok) return result;
+        m_pan = pan;
+        m_tilt = tilt;
+        m_applied.pan = pan;
+        m_applied.tilt = tilt;
+        result.fields.add("pan", pan).add("tilt", tilt);
+        if (args.size() > 4) {
+            zoom = std::clamp(zoom, 1.0, 2.0);
+            Result zoomed = checkDevice("cameraSetZoomAbsoluteR", m_device->cameraSetZoomAbsoluteR(static_cast<float>(zoom)));
+            if (!zoomed.ok) return zoomed;
+            m_applied.zoom = zoom;
+            result.fields.add("zoom", zoom);
+        }
+        return result;
+    }
+
+    if (field == "pan" || field == "tilt") {
+        if (!parseDouble(value, number)) return failure(field + " expects a number in -1..1");
+        number = std::clamp(number, -1.0, 1.0);
+        double pan = field == "pan" ? number : m_pan;
+        double tilt = field == "tilt" ? number : m_tilt;
+        Result result = checkDevice("cameraSetPanTiltAbsolute", m_device->cameraSetPanTiltAbsolute(pan, tilt));
+        if (result.ok) {
+            m_pan = pan;
+            m_tilt = tilt;
+            m_applied.pan = pan;
+            m_applied.tilt = tilt;
+            result.fields.add(field, number);
+        }
+        return result;
+    }
+
+    if (field == "zoom") {
+        if (!parseDouble(value, number)) return failure("zoom expects a number in 1.0..2.0");
+        number = std::clamp(number, 1.0, 2.0);
+        Result result = checkDevice("cameraSetZoomAbsoluteR", m_device->cameraSetZoomAbsoluteR(static_cast<float>(number)));
+        if (result.ok) {
+            m_applied.zoom = number;
+            result.fields.add("zoom", number);
+        }
+        return result;
+    }
+
+    if (field == "tracking") {
+        if (!parseBool(value, flag)) return failure("tracking expects on|off");
+        // Each step waits for the camera to confirm the previous one
+        auto sequence = m_commandSequence.run(m_device, CommandSequence::autoFraming(m_device->productType(), flag));
+        Result result;
+        if (sequence.outcome == CommandSequence::Failed) {
+            result = checkDevice(sequence.step.c_str(), sequence.result);
+        } else if (sequence.outcome != CommandSequence::Completed) {
+            result = failure(sequence.step + " " + CommandSequence::outcomeName(sequence.outcome));
+        }
+        if (result.ok) {
+            m_applied.faceTracking = flag;
+            result.fields.add("tracking", flag).add("confirm_ms", sequence.elapsedMs);
+        }
+        return result;
+    }
+
+    if (field == "hdr" || field == "face_ae" || field == "face_focus") {
+        if (!parseBool(value, flag)) return failure(field + " expects on|off");
+        int32_t ret;
+        if (field == "hdr") {
+            ret = m_device->cameraSetWdrR(flag ? Device::DevWdrModeDol2TO1 : Device::DevWdrModeNone);
+        } else if (field == "face_ae") {
+            ret = m_device->cameraSetFaceAER(flag);
+        } else {
+            ret = m_device->cameraSetFaceFocusR(flag);
+        }
+        Result result = checkDevice(field.c_str(), ret);
+        if (result.ok) {
+            (field == "hdr" ? m_applied.hdr : (field == "face_ae" ? m_applied.faceAE : m_applied.faceFocus)) = flag;
+            result.fields.add(field, flag);
+        }
+        return result;
+    }
+
+    if (field == "fov") {
+        if (!parseInt(value, integer) || integer < 0 || integer > 2) {
+            return failure("fov expects 0 (wide), 1 (medium) or 2 (narrow)");
+        }
+        Result result = checkDevice("cameraSetFovU", m_device->cameraSetFovU(toFovType(integer)));
+        if (result.ok) {
+            m_applied.fov = integer;
+            result.fields.add("fov", integer);
+        }
+        return result;
+    }
+
+    if (field == "brightness" || field == "contrast" || field == "saturation") {
+        if (!parseInt(value, integer)) return failure(field + " expects an integer");
+        int32_t ret;
+        if (field == "brightness") {
+            ret = m_device->cameraSetImageBrightnessR(integer);
+        } else if (field == "contrast") {
+            ret = m_device->cameraSetImageContrastR(integer);
+        } else {
+            ret = m_device->cameraSetImageSaturationR(integer);
+        }
+        Result result = checkDevice(field.c_str(), ret);
+        if (result.ok) {
+            (field == "brightness" ? m_applied.brightness
+                                   : (field == "contrast" ? m_applied.contrast : m_applied.saturation)) = integer;
+            result.fields.add(field, integer);
+        }
+        return result;
+    }
+
+    if (field == "white_balance") {
+        if (!parseWhiteBalance(value, integer)) {
+            return failure("white_balance expects auto, daylight, fluorescent, tungsten, flash, fine, cloudy, "
+                           "shade or manual <kelvin>");
+        }
+        const bool manual = integer == static_cast<int>(Device::DevWhiteBalanceManual);
+        int kelvin = 0;
+        if (manual && (args.size() < 4 || !parseInt(args[3], kelvin) || kelvin < 2000 || kelvin > 10000)) {
+            return failure("white_balance manual expects a temperature from 2000 to 10000 kelvin");
+        }
+        Result result = checkDevice("cameraSetWhiteBalanceR",
+            m_device->cameraSetWhiteBalanceR(static_cast<Device::DevWhiteBalanceType>(integer), kelvin));
+        if (result.ok) {
+            m_applied.whiteBalance = integer;  // The SDK value, as profile diffs compare it
+            result.fields.add("white_balance", integer);
+            if (manual) {
+                m_applied.whiteBalanceKelvin = kelvin;
+                result.fields.add("white_balance_kelvin", kelvin);
+            }
+        }
+        return result;
+    }
+
+    return failure("cannot set '" + field + "'");
+}
+
+DeviceCommands::Result DeviceCommands::runPreset(const vector<string> &args)
+{
+    int number = 0;
+    if (args.size() != 2 || !parseInt(args[1], number)) {
+        return failure("usage: preset <n>");
+    }
+
+    auto settings = m_config.getSettings();
+    if (number < 1 || number > static_cast<int>(settings.presets.size()) ||
+        !settings.presets[static_cast<size_t>(number - 1)].defined) {
+        return failure("preset " + args[1] + " is not defined");
+    }
+
+    const auto &slot = settings.presets[static_cast<size_t>(number - 1)];
+    if (!GimbalPresets::supported(m_device->productType())) {
+        // No preset table on the device: replay the stored position
+        Result result = runSet({"set", "ptz", to_string(slot.pan), to_string(slot.tilt), to_string(slot.zoom)});
+        if (result.ok) {
+            result.fields = JsonLine().add("preset", number).append(result.fields);
+        }
+        return result;
+    }
+
+    // A single trigger moves and zooms in one motion, as the GUI recalls presets
+    Result result = checkDevice("aiTrgGimbalPresetR", GimbalPresets::recall(*m_device, number - 1, slot));
+    if (result.ok) {
+        m_pan = slot.pan;
+        m_tilt = slot.tilt;
+        m_ptzKnown = false;
+        result.fields.add("preset", number).add("pan", slot.pan).add("tilt", slot.tilt).add("zoom", slot.zoom);
+    }
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::runRecord(const vector<string> &args)
+{
+    if (args.size() == 2 && args[1] == "stop") {
+        Result result;
+        result.fields.add("recording", false).add("file", m_telemetry.path());
+        m_telemetry.stop();
+        return result;
+    }
+
+    int rateHz = GimbalTelemetry::kDefaultRateHz;
+    if (args.size() < 2 || args.size() > 3 || (args.size() == 3 && !parseInt(args[2], rateHz))) {
+        return failure("usage: record <file> [hz] | record stop");
+    }
+    if (!m_telemetry.start(m_device, args[1], rateHz)) {
+        return failure("cannot record to " + args[1]);
+    }
+
+    Result result;
+    result.fields.add("recording", true).add("file", args[1]).add("hz", std::clamp(rateHz, 1, GimbalTelemetry::kMaxRateHz));
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::runSequence(const vector<string> &args)
+{
+    const auto settings = m_config.getSettings();
+    if (args.size() == 2 && args[1] == "list") {
+        string names;
+        for (const auto &sequence : settings.sequences) {
+            names += (names.empty() ? "" : ",") + sequence.name;
+        }
+        Result result;
+        result.fields.add("count", static_cast<int>(settings.sequences.size())).add("sequences", names);
+        return result;
+    }
+    if (args.size() == 2 && (args[1] == "status" || args[1] == "stop")) {
+        if (args[1] == "stop") {
+            m_sequencer.stop();
+        }
+        Result result;
+        addSequenceStatus(result, m_sequencer.status());
+        return result;
+    }
+    if (args.size() < 3 || args.size() > 4 || args[1] != "play" || (args.size() == 4 && args[3] != "wait")) {
+        return failure("usage: sequence list|status|stop, sequence play <name> [wait]");
+    }
+
+    auto it = std::find_if(settings.sequences.begin(), settings.sequences.end(),
+                           [&args](const Config::CameraSettings::Sequence &sequence) { return sequence.name == args[2]; });
+    if (it == settings.sequences.end()) {
+        return failure("no sequence '" + args[2] + "' in settings.conf");
+    }
+
+    // Stop the running sequence first, so its finished callback answers the
+    // waiters it already had and not the one added below
+    const bool wait = args.size() == 4;
+    m_sequencer.stop();
+
+    // Without a completion the wait blocks below; a sequence that ends
+    // before it gets there has already filled this in
+    auto finished = make_shared<Result>();
+    auto done = make_shared<bool>(false);
+    if (wait) {
+        Completion completion = m_completion;
+        if (!completion) {
+            completion = [this, finished, done](const Result &result) {
+                {
+                    lock_guard<mutex> lock(m_waitMutex);
+                    *finished = result;
+                    *done = true;
+                }
+                m_waitDone.notify_all();
+            };
+        }
+        lock_guard<mutex> lock(m_waitMutex);
+        m_sequenceWaiters.push_back(std::move(completion));
+    }
+
+    string error;
+    if (!m_sequencer.start(m_device, *it, error)) {
+        if (wait) {
+            lock_guard<mutex> lock(m_waitMutex);
+            m_sequenceWaiters.pop_back();
+        }
+        return failure(error);
+    }
+    m_pan = it->keyframes.back().pan;
+    m_tilt = it->keyframes.back().tilt;
+    m_ptzKnown = false;
+
+    Result result;
+    if (wait && m_completion) {
+        result.deferred = true;
+        return result;
+    }
+    if (wait) {
+        unique_lock<mutex> lock(m_waitMutex);
+        m_waitDone.wait(lock, [&done]() { return *done; });
+        return *finished;
+    }
+    addSequenceStatus(result, m_sequencer.status());
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::runTarget(const vector<string> &args)
+{
+    TargetSelector::Request request;
+    double values[4] = {0.0, 0.0, 0.0, 0.0};
+    auto parseCoordinates = [&args, &values](size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!parseDouble(args[i + 2], values[i]) || values[i] < 0.0 || values[i] > 1.0) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (args.size() == 2 && (args[1] == "center" || args[1] == "biggest")) {
+        request.action = args[1] == "center" ? TargetSelector::TrackCentral : TargetSelector::TrackBiggest;
+    } else if (args.size() == 4 && args[1] == "at" && parseCoordinates(2)) {
+        request.action = TargetSelector::TrackAt;
+        request.x0 = static_cast<float>(values[0]);
+        request.y0 = static_cast<float>(values[1]);
+    } else if (args.size() == 6 && args[1] == "box" && parseCoordinates(4) &&
+               values[0] < values[2] && values[1] < values[3]) {
+        request.action = TargetSelector::FrameBox;
+        request.x0 = static_cast<float>(values[0]);
+        request.y0 = static_cast<float>(values[1]);
+        request.x1 = static_cast<float>(values[2]);
+        request.y1 = static_cast<float>(values[3]);
+    } else {
+        return failure("usage: target at <x> <y> | target box <x0> <y0> <x1> <y1> | target center|biggest "
+                       "(coordinates 0-1, origin top-left)");
+    }
+
+    auto outcome = m_targetSelector.run(m_device, request);
+    m_ptzKnown = false;  // The camera picks the framing
+    Result result = checkDevice(outcome.command.c_str(), outcome.result);
+    if (result.ok) {
+        result.fields.add("action", TargetSelector::actionName(outcome.action))
+                     .add("command", outcome.command)
+                     .add("ack_ms", std::round(outcome.ackMs * 10.0) / 10.0)
+                     .add("motion_ms", outcome.motionMs < 0.0 ? -1.0 : std::round(outcome.motionMs * 10.0) / 10.0);
+    }
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::runProfile(const vector<string> &args)
+{
+    if (args.size() == 2 && args[1] == "list") {
+        string names;
+        const auto profiles = m_config.profileNames();
+        for (const auto &name : profiles) {
+            names += (names.empty() ? "" : ",") + name;
+        }
+        Result result;
+        result.fields.add("count", static_cast<int>(profiles.size()))
+                     .add("profiles", names)
+                     .add("active", m_applied.activeProfile);
+        return result;
+    }
+    if (args.size() != 3 || (args[1] != "use" && args[1] != "save" && args[1] != "delete")) {
+        return failure("usage: profile list | profile use|save|delete <name>");
+    }
+
+    const string &name = args[2];
+    if (!Config::isValidProfileName(name)) {
+        return failure("profile names are letters, digits, spaces, '-' and '_'");
+    }
+    if (args[1] == "save") {
+        if (!m_config.saveProfile(name)) {
+            return failure("cannot save profile '" + name + "'");
+        }
+        Result result;
+        result.fields.add("saved", name);
+        return result;
+    }
+    if (args[1] == "delete") {
+        if (!m_config.removeProfile(name)) {
+            return failure("no profile '" + name + "'");
+        }
+        Result result;
+        result.fields.add("deleted", name);
+        return result;
+    }
+
+    // Fields the profile leaves out keep what is on the camera, not what settings.conf says
+    Config::CameraSettings settings = m_applied;
+    vector<Config::ValidationError> errors;
+    if (!m_config.loadProfile(name, settings, errors)) {
+        return failure(errors.empty() ? "cannot load profile '" + name + "'" : errors.front().message);
+    }
+
+    Result result = applyChanges(settings);
+    result.fields = JsonLine().add("profile", name).append(result.fields);
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::applyChanges(const Config::CameraSettings &settings)
+{
+    Config::CameraSettings before = m_applied;
+    before.pan = m_pan;
+    before.tilt = m_tilt;
+    auto keys = Config::changedKeys(before, settings);
+    if (!m_ptzKnown) {
+        // Where the gimbal ended up is unknown; send the profile's framing regardless
+        for (const char *key : {"pan", "tilt", "zoom"}) {
+            if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+                keys.push_back(key);
+            }
+        }
+    }
+    auto changed = [&keys](const char *key) { return std::find(keys.begin(), keys.end(), key) != keys.end(); };
+
+    string failed;
+    auto send = [&](const string &name, int32_t ret) {
+        m_telemetry.logCommand(name, ret);
+        if (ret != RM_RET_OK && failed.empty()) {
+            failed = name + " failed (code: " + to_string(ret) + ")";
+        }
+        return ret == RM_RET_OK;
+    };
+
+    // One burst, in the order the camera needs: framing mode first, then image, then position
+    if (changed("face_tracking")) {
+        auto tracking = m_commandSequence.run(m_device,
+                                              CommandSequence::autoFraming(m_device->productType(), settings.faceTracking));
+        if (send("auto-framing", tracking.outcome == CommandSequence::Completed ? RM_RET_OK : RM_RET_ERR)) {
+            m_applied.faceTracking = settings.faceTracking;
+        }
+    }
+    if (changed("hdr") && send("cameraSetWdrR", m_device->cameraSetWdrR(settings.hdr ? Device::DevWdrModeDol2TO1
+                                                                                  : Device::DevWdrModeNone))) {
+        m_applied.hdr = settings.hdr;
+    }
+    if (changed("fov") && send("cameraSetFovU", m_device->cameraSetFovU(toFovType(settings.fov)))) {
+        m_applied.fov = settings.fov;
+    }
+    if (changed("face_ae") && send("cameraSetFaceAER", m_device->cameraSetFaceAER(settings.faceAE))) {
+        m_applied.faceAE = settings.faceAE;
+    }
+    if (changed("face_focus") && send("cameraSetFaceFocusR", m_device->cameraSetFaceFocusR(settings.faceFocus))) {
+        m_applied.faceFocus = settings.faceFocus;
+    }
+
+    // Manual values are only sent while their auto mode is off
+    if ((changed("brightness") || changed("brightness_auto")) && !settings.brightnessAuto &&
+        send("cameraSetImageBrightnessR", m_device->cameraSetImageBrightnessR(settings.brightness))) {
+        m_applied.brightness = settings.brightness;
+    }
+    if ((changed("contrast") || changed("contrast_auto")) && !settings.contrastAuto &&
+        send("cameraSetImageContrastR", m_device->cameraSetImageContrastR(settings.contrast))) {
+        m_applied.contrast = settings.contrast;
+    }
+    if ((changed("saturation") || changed("saturation_auto")) && !settings.saturationAuto &&
+        send("cameraSetImageSaturationR", m_device->cameraSetImageSaturationR(settings.saturation))) {
+        m_applied.saturation = settings.saturation;
+    }
+    m_applied.brightnessAuto = settings.brightnessAuto;
+    m_applied.contrastAuto = settings.contrastAuto;
+    m_applied.saturationAuto = settings.saturationAuto;
+
+    const bool manualWhiteBalance = settings.whiteBalance == static_cast<int>(Device::DevWhiteBalanceManual);
+    if ((changed("white_balance") || (manualWhiteBalance && changed("white_balance_kelvin"))) &&
+        send("cameraSetWhiteBalanceR",
+             m_device->cameraSetWhiteBalanceR(static_cast<Device::DevWhiteBalanceType>(settings.whiteBalance),
+                                              manualWhiteBalance ? settings.whiteBalanceKelvin : 0))) {
+        m_applied.whiteBalance = settings.whiteBalance;
+        m_applied.whiteBalanceKelvin = settings.whiteBalanceKelvin;
+    }
+
+    if (changed("zoom") &&
+        send("cameraSetZoomAbsoluteR", m_device->cameraSetZoomAbsoluteR(static_cast<float>(settings.zoom)))) {
+        m_applied.zoom = settings.zoom;
+    }
+    if ((changed("pan") || changed("tilt")) &&
+        send("cameraSetPanTiltAbsolute", m_device->cameraSetPanTiltAbsolute(settings.pan, settings.tilt))) {
+        m_pan = m_applied.pan = settings.pan;
+        m_tilt = m_applied.tilt = settings.tilt;
+        m_ptzKnown = true;
+    }
+
+    // Video and virtual camera settings belong to the GUI; keep them so the next diff is right
+    m_applied.virtualCameraEnabled = settings.virtualCameraEnabled;
+    m_applied.virtualCameraDevice = settings.virtualCameraDevice;
+    m_applied.virtualCameraResolution = settings.virtualCameraResolution;
+    m_applied.effects = settings.effects;
+    m_applied.activeProfile = settings.activeProfile;
+
+    string names;
+    for (const auto &key : keys) {
+        names += (names.empty() ? "" : ",") + key;
+    }
+    Result result;
+    if (!failed.empty()) {
+        result = failure(failed);
+    }
+    result.fields.add("changed", static_cast<int>(keys.size())).add("keys", names);
+    return result;
+}
+
+DeviceCommands::Result DeviceCommands::runInfo()
+{
+    Result result;
+    result.fields.add("name", m_device->devName())
+                 .add("sn", m_device->devSn())
+                 .add("version", m_device->devVersion())
+                 .add("product", static_cast<int>(m_device->productType()));
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+
+void applyConfigToCamera(shared_ptr<Device> dev, const Config::CameraSettings &settings)
+{
+    int32_t ret;
+
+    // Apply face tracking
+    if (settings.faceTracking) {
+        cout << "  Enabling face tracking..." << endl;
+    } else {
+        cout << "  Disabling face tracking..." << endl;
+    }
+    CommandSequence sequence;
+    auto tracking = sequence.run(dev, CommandSequence::autoFraming(dev->productType(), settings.faceTracking));
+    if (tracking.outcome != CommandSequence::Completed) {
+        cout << "    Failed at " << tracking.step << " (" << CommandSequence::outcomeName(tracking.outcome)
+             << ", code: " << tracking.result << ")" << endl;
+    }
+
+    // Apply HDR
+    cout << "  Setting HDR: " << (settings.hdr ? "On" : "Off") << endl;
+    ret = dev->cameraSetWdrR(settings.hdr ? Device::DevWdrModeDol2TO1 : Device::DevWdrModeNone);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    // Apply FOV
+    const char* fovNames[] = {"Wide (86°)", "Medium (78°)", "Narrow (65°)"};
+    cout << "  Setting FOV: " << fovNames[settings.fov] << endl;
+    ret = dev->cameraSetFovU(toFovType(settings.fov));
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    // Apply Face AE
+    cout << "  Setting Face AE: " << (settings.faceAE ? "On" : "Off") << endl;
+    ret = dev->cameraSetFaceAER(settings.faceAE);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    // Apply Face Focus
+    cout << "  Setting Face Focus: " << (settings.faceFocus ? "On" : "Off") << endl;
+    ret = dev->cameraSetFaceFocusR(settings.faceFocus);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    // Apply Zoom
+    cout << "  Setting Zoom: " << settings.zoom << "x" << endl;
+    ret = dev->cameraSetZoomAbsoluteR(settings.zoom);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    // Apply Pan/Tilt
+    cout << "  Setting Pan/Tilt: " << settings.pan << ", " << settings.tilt << endl;
+    ret = dev->cameraSetPanTiltAbsolute(settings.pan, settings.tilt);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    // Apply Image Controls
+    cout << "  Setting Brightness: " << settings.brightness << endl;
+    ret = dev->cameraSetImageBrightnessR(settings.brightness);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    cout << "  Setting Contrast: " << settings.contrast << endl;
+    ret = dev->cameraSetImageContrastR(settings.contrast);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    cout << "  Setting Saturation: " << settings.saturation << endl;
+    ret = dev->cameraSetImageSaturationR(settings.saturation);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+
+    const bool manualWhiteBalance = settings.whiteBalance == static_cast<int>(Device::DevWhiteBalanceManual);
+    cout << "  Setting White Balance: " << whiteBalanceName(settings.whiteBalance);
+    if (manualWhiteBalance) {
+        cout << " " << settings.whiteBalanceKelvin << "K";
+    }
+    cout << endl;
+    Device::DevWhiteBalanceType wbType = static_cast<Device::DevWhiteBalanceType>(settings.whiteBalance);
+    ret = dev->cameraSetWhiteBalanceR(wbType, manualWhiteBalance ? settings.whiteBalanceKelvin : 0);
+    if (ret != 0) {
+        cout << "    Failed (code: " << ret << ")" << endl;
+    }
+}
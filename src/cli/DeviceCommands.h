@@ -0,0 +1,149 @@
+#ifndef DEVICECOMMANDS_H
+#define DEVICECOMMANDS_H
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <dev/devs.hpp>
+#include "CommandSequence.h"
+#include "Config.h"
+#include "GimbalTelemetry.h"
+#include "PtzSequencer.h"
+#include "TargetSelector.h"
+
+/**
+ * @brief Builds one JSON object on a single line
+ *
+ * Only what the command layer needs: flat objects with string, number and
+ * bool members. Keys are emitted in insertion order.
+ */
+class JsonLine
+{
+public:
+    JsonLine &add(const std::string &key, const std::string &value);
+    JsonLine &add(const std::string &key, const char *value);
+    JsonLine &add(const std::string &key, double value);
+    JsonLine &add(const std::string &key, int value);
+    JsonLine &add(const std::string &key, bool value);
+    JsonLine &append(const JsonLine &other);  // Merge another object's members
+
+    bool empty() const { return m_body.empty(); }
+    std::string str() const { return "{" + m_body + "}"; }
+
+    static std::string quote(const std::string &text);
+
+private:
+    void addRaw(const std::string &key, const std::string &rawValue);
+
+    std::string m_body;
+};
+
+/**
+ * @brief Text commands shared by the CLI's daemon and script modes
+ *
+ * Parses one command line such as "set zoom 1.5", "get status" or
+ * "preset 2" and runs it against the current device. Not thread-safe:
+ * callers run all commands for a device on one thread, the same way the
+ * SDK serialises them on the USB pipe.
+ */
+class DeviceCommands
+{
+public:
+    struct Result {
+        bool ok = true;
+        std::string error;
+        JsonLine fields;
+        double elapsedMs = 0.0;  // Time spent talking to the device
+        bool deferred = false;   // No reply yet; the completion passed to execute() gets it
+
+        // {"id":..,"ok":..,<fields>,"ms":..}; id is omitted when empty
+        std::string toJson(const std::string &id = std::string()) const;
+        // Same, with the prefix's members first
+        std::string toJson(const JsonLine &prefix) const;
+    };
+
+    explicit DeviceCommands(const Config &config);
+
+    void setDevice(std::shared_ptr<Device> dev);
+    bool hasDevice() const { return m_device != nullptr; }
+
+    // Split on whitespace; "quoted words" stay together
+    static std::vector<std::string> tokenize(const std::string &line);
+
+    // Called with the final result of a deferred command, on another thread
+    using Completion = std::function<void(const Result &result)>;
+
+    Result execute(const std::string &line);
+    Result execute(const std::vector<std::string> &args);
+
+    /**
+     * @brief Run a command without blocking on the ones that wait
+     *
+     * "sequence play <name> wait" returns at once with deferred set, and
+     * completion gets its result from the sequencer thread when the
+     * sequence ends, however it ends. Other commands behave as execute()
+     * and never call completion. Without a completion, waiting blocks.
+     */
+    Result execute(const std::vector<std::string> &args, Completion completion);
+
+    /**
+     * @brief Cheap view of the camera state
+     *
+     * Built from cameraStatus() and the last commanded pan/tilt only, so it
+     * can be polled without extra USB round trips. Keys match "get" fields.
+     */
+    std::map<std::string, double> snapshot();
+
+    // Read one "get" field as a number; false if unknown or the device refused
+    bool readValue(const std::string &field, double &value);
+
+    static const char *usage();
+
+private:
+    const Config &m_config;
+    std::shared_ptr<Device> m_device;
+
+    // The SDK cannot read back pan/tilt on every model; track what we commanded
+    double m_pan;
+    double m_tilt;
+
+    // What settings.conf, profiles and "set" last put on the camera; profile switches send only the difference
+    Config::CameraSettings m_applied;
+    bool m_ptzKnown;  // False once a preset, sequence or target has moved the gimbal
+
+    Completion m_completion;  // Set while execute(args, completion) runs
+
+    // Replies owed to "sequence play <name> wait", sent when the sequence ends
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitDone;
+    std::vector<Completion> m_sequenceWaiters;
+
+    GimbalTelemetry m_telemetry;
+    PtzSequencer m_sequencer;  // After m_telemetry and the waiters: calls into them until stopped
+    TargetSelector m_targetSelector;
+    CommandSequence m_commandSequence;
+
+    Result runGet(const std::vector<std::string> &args);
+    Result runSet(const std::vector<std::string> &args);
+    Result runPreset(const std::vector<std::string> &args);
+    Result runInfo();
+    Result runRecord(const std::vector<std::string> &args);
+    Result runSequence(const std::vector<std::string> &args);
+    Result runTarget(const std::vector<std::string> &args);
+    Result runProfile(const std::vector<std::string> &args);
+
+    // Send the fields of settings that differ from m_applied
+    Result applyChanges(const Config::CameraSettings &settings);
+
+    bool readField(const std::string &field, JsonLine &out);
+    Result checkDevice(const char *what, int32_t ret);
+};
+
+// Apply settings.conf to the camera, logging each step to stdout
+void applyConfigToCamera(std::shared_ptr<Device> dev, const Config::CameraSettings &settings);
+
+#endif // DEVICECOMMANDS_H
@@ -0,0 +1,346 @@
+#include "ScriptRunner.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+// wait-until polls the device at this rate
+constexpr auto kWaitUntilPollInterval = chrono::milliseconds(20);
+constexpr int kDefaultWaitUntilTimeoutMs = 5000;
+
+bool parseNumber(const string &text, double &value)
+{
+    char *end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return end && end != text.c_str() && *end == '\0';
+}
+
+bool isPtzStep(const vector<string> &args)
+{
+    if (args[0] == "ptz" || args[0] == "center") {
+        return true;
+    }
+    return args[0] == "set" && args.size() >= 2 &&
+           (args[1] == "pan" || args[1] == "tilt" || args[1] == "zoom" || args[1] == "ptz");
+}
+
+bool compare(double lhs, const string &op, double rhs, bool &valid)
+{
+    valid = true;
+    if (op == "==") return lhs == rhs;
+    if (op == "!=") return lhs != rhs;
+    if (op == "<") return lhs < rhs;
+    if (op == "<=") return lhs <= rhs;
+    if (op == ">") return lhs > rhs;
+    if (op == ">=") return lhs >= rhs;
+    valid = false;
+    return false;
+}
+
+// Lines shared between the stdin reader thread and the runner
+struct LineQueue {
+    mutex lock;
+    condition_variable ready;
+    deque<pair<int, string>> lines;
+    bool done = false;
+};
+
+} // namespace
+
+ScriptRunner::ScriptRunner(const Config &config, shared_ptr<Device> dev, ostream &out)
+    : m_commands(config)
+    , m_out(out)
+{
+    m_commands.setDevice(std::move(dev));
+}
+
+bool ScriptRunner::isMergeable(const vector<string> &args)
+{
+    return args[0] == "ptz" || args[0] == "center" || (args[0] == "set" && args.size() >= 3);
+}
+
+bool ScriptRunner::isTiming(const vector<string> &args)
+{
+    return args[0] == "wait" || args[0] == "at" || args[0] == "wait-until" || args[0] == "sync";
+}
+
+bool ScriptRunner::run(istream &in, bool live)
+{
+    m_start = chrono::steady_clock::now();
+
+    // A live source (stdin) is read on its own thread so commands already
+    // typed or piped in can be flushed while we wait for the next line.
+    // The thread is detached: it may still be blocked in getline() when a
+    // step fails and we stop early.
+    auto queue = make_shared<LineQueue>();
+    auto readLines = [queue, &in]() {
+        string text;
+        int number = 0;
+        while (getline(in, text)) {
+            lock_guard<mutex> lock(queue->lock);
+            queue->lines.emplace_back(++number, text);
+            queue->ready.notify_one();
+        }
+        lock_guard<mutex> lock(queue->lock);
+        queue->done = true;
+        queue->ready.notify_one();
+    };
+    if (live) {
+        thread(readLines).detach();
+    } else {
+        readLines();
+    }
+
+    bool ok = true;
+    while (ok) {
+        unique_lock<mutex> lock(queue->lock);
+        if (queue->lines.empty() && !queue->done && !m_pending.empty()) {
+            // Nothing else to merge with right now; don't hold commands back
+            lock.unlock();
+            ok = flush();
+            continue;
+        }
+        queue->ready.wait(lock, [&queue]() { return !queue->lines.empty() || queue->done; });
+        if (queue->lines.empty()) {
+            break;
+        }
+        auto next = std::move(queue->lines.front());
+        queue->lines.pop_front();
+        lock.unlock();
+
+        Step step{next.first, next.second, DeviceCommands::tokenize(next.second)};
+        if (step.args.empty() || step.args[0][0] == '#') {
+            continue;
+        }
+        ok = runStep(step);
+    }
+
+    return flush() && ok;
+}
+
+bool ScriptRunner::runStep(const Step &step)
+{
+    if (isMergeable(step.args)) {
+        m_pending.push_back(step);
+        return true;
+    }
+
+    if (!flush()) {
+        return false;
+    }
+
+    if (isTiming(step.args)) {
+        return runTiming(step);
+    }
+
+    auto result = m_commands.execute(step.args);
+    emit(step, result);
+    return result.ok;
+}
+
+bool ScriptRunner::flush()
+{
+    if (m_pending.empty()) {
+        return true;
+    }
+
+    vector<Step> steps;
+    steps.swap(m_pending);
+
+    // Fold every pan/tilt/zoom change into one move, and keep only the last
+    // value of other fields. Values are checked first so a typo late in the
+    // block does not leave the camera half way through it.
+    double pan = 0.0, tilt = 0.0, zoom = 0.0;
+    bool havePanTilt = false, haveZoom = false;
+    int lastPtz = -1;
+    map<string, int> lastSet;
+
+    for (int i = 0; i < static_cast<int>(steps.size()); ++i) {
+        const auto &args = steps[i].args;
+        if (!isPtzStep(args)) {
+            lastSet[args[1]] = i;
+            continue;
+        }
+
+        // ptz/center/"set ptz" take positional pan tilt [zoom]
+        bool positional = args[0] != "set" || args[1] == "ptz";
+        vector<string> values;
+        if (args[0] == "center") {
+            values = {"0", "0"};
+        } else if (args[0] == "ptz") {
+            values.assign(args.begin() + 1, args.end());
+        } else if (args[1] == "ptz") {
+            values.assign(args.begin() + 2, args.end());
+        }
+
+        bool valid = true;
+        double number = 0.0;
+        if (positional) {
+            double p = 0.0, t = 0.0;
+            valid = values.size() >= 2 && values.size() <= 3 && parseNumber(values[0], p) && parseNumber(values[1], t) &&
+                    (values.size() < 3 || parseNumber(values[2], number));
+            if (valid) {
+                pan = p;
+                tilt = t;
+                havePanTilt = true;
+                if (values.size() == 3) {
+                    zoom = number;
+                    haveZoom = true;
+                }
+            }
+        } else {
+            valid = args.size() == 3 && parseNumber(args[2], number);
+            if (valid && args[1] == "zoom") {
+                zoom = number;
+                haveZoom = true;
+            } else if (valid) {
+                if (!havePanTilt) {
+                    m_commands.readValue("pan", pan);
+                    m_commands.readValue("tilt", tilt);
+                    havePanTilt = true;
+                }
+                (args[1] == "pan" ? pan : tilt) = number;
+            }
+        }
+
+        if (!valid) {
+            DeviceCommands::Result result;
+            result.ok = false;
+            result.error = "usage: ptz <pan> <tilt> [zoom], set pan|tilt|zoom <value>";
+            emit(steps[i], result);
+            return false;
+        }
+        lastPtz = i;
+    }
+
+    DeviceCommands::Result ptzResult;
+    bool ok = true;
+    vector<pair<DeviceCommands::Result, bool>> results(steps.size());
+
+    for (int i = 0; i < static_cast<int>(steps.size()); ++i) {
+        const auto &args = steps[i].args;
+        if (isPtzStep(args)) {
+            if (i != lastPtz) {
+                continue;  // Filled in from the combined move below
+            }
+            vector<string> move;
+            if (havePanTilt) {
+                move = {"ptz", to_string(pan), to_string(tilt)};
+                if (haveZoom) move.push_back(to_string(zoom));
+            } else {
+                move = {"set", "zoom", to_string(zoom)};
+            }
+            ptzResult = m_commands.execute(move);
+            results[i] = {ptzResult, false};
+        } else if (lastSet[args[1]] == i) {
+            results[i] = {m_commands.execute(args), false};
+        } else {
+            DeviceCommands::Result superseded;
+            superseded.fields.add("superseded", true);
+            results[i] = {superseded, true};
+        }
+        ok = ok && results[i].first.ok;
+    }
+
+    for (int i = 0; i < static_cast<int>(steps.size()); ++i) {
+        if (isPtzStep(steps[i].args) && i != lastPtz) {
+            results[i] = {ptzResult, true};
+        }
+        emit(steps[i], results[i].first, results[i].second);
+    }
+    return ok;
+}
+
+bool ScriptRunner::runTiming(const Step &step)
+{
+    const auto &args = step.args;
+    DeviceCommands::Result result;
+    auto started = chrono::steady_clock::now();
+    double ms = 0.0;
+
+    if (args[0] == "sync") {
+        // Everything before this line has already been flushed
+    } else if (args[0] == "wait" || args[0] == "at") {
+        if (args.size() != 2 || !parseNumber(args[1], ms) || ms < 0) {
+            result.ok = false;
+            result.error = "usage: " + args[0] + " <ms>";
+        } else if (args[0] == "wait") {
+            this_thread::sleep_for(chrono::duration<double, milli>(ms));
+        } else {
+            // Absolute time keeps a long sequence from drifting with command latency
+            auto target = m_start + chrono::duration_cast<chrono::steady_clock::duration>(
+                                        chrono::duration<double, milli>(ms));
+            if (started > target) {
+                result.fields.add("late_ms", chrono::duration<double, milli>(started - target).count());
+            }
+            this_thread::sleep_until(target);
+        }
+    } else {
+        waitUntil(step, result);
+    }
+
+    result.elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    emit(step, result);
+    return result.ok;
+}
+
+bool ScriptRunner::waitUntil(const Step &step, DeviceCommands::Result &result)
+{
+    const auto &args = step.args;
+    double target = 0.0;
+    double timeoutMs = kDefaultWaitUntilTimeoutMs;
+    bool validOp = false;
+    compare(0.0, args.size() > 2 ? args[2] : string(), 0.0, validOp);
+
+    if (args.size() < 4 || args.size() > 5 || !validOp || !parseNumber(args[3], target) ||
+        (args.size() == 5 && !parseNumber(args[4], timeoutMs))) {
+        result.ok = false;
+        result.error = "usage: wait-until <field> <op> <value> [timeout ms]";
+        return false;
+    }
+
+    auto deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+                                                      chrono::duration<double, milli>(timeoutMs));
+    double value = 0.0;
+    while (true) {
+        if (!m_commands.readValue(args[1], value)) {
+            result.ok = false;
+            result.error = "cannot read '" + args[1] + "'";
+            return false;
+        }
+        if (compare(value, args[2], target, validOp)) {
+            result.fields.add(args[1], value);
+            return true;
+        }
+        auto now = chrono::steady_clock::now();
+        if (now >= deadline) {
+            result.ok = false;
+            result.error = "timed out";
+            result.fields.add(args[1], value);
+            return false;
+        }
+        this_thread::sleep_until(min(now + kWaitUntilPollInterval, deadline));
+    }
+}
+
+void ScriptRunner::emit(const Step &step, const DeviceCommands::Result &result, bool merged)
+{
+    JsonLine prefix;
+    prefix.add("line", step.line).add("cmd", step.text);
+    prefix.add("t", chrono::duration<double, milli>(chrono::steady_clock::now() - m_start).count());
+    if (merged) {
+        prefix.add("merged", true);
+    }
+    // One flush per line so a consumer can react to each step as it happens
+    m_out << result.toJson(prefix) << endl;
+}
@@ -0,0 +1,65 @@
+#ifndef SCRIPTRUNNER_H
+#define SCRIPTRUNNER_H
+
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include <dev/devs.hpp>
+#include "Config.h"
+#include "DeviceCommands.h"
+
+/**
+ * @brief Runs a camera script for obsbot-cli --exec
+ *
+ * A script is one command per line: everything DeviceCommands accepts,
+ * plus timing steps:
+ *
+ *   wait <ms>                              Pause after earlier commands finish
+ *   at <ms>                                Pause until <ms> after script start
+ *   wait-until <field> <op> <value> [ms]   Poll a "get" field (op: == != < <= > >=)
+ *   sync                                   Finish earlier commands
+ *
+ * '#' starts a comment. Device commands that are already read are
+ * pipelined: they go out back to back without waiting on the reader, and
+ * "set"/"ptz" steps with no timing step between them are merged so the
+ * camera sees one pan/tilt/zoom move and only the last value of each
+ * field. Every line produces one JSON result on the output stream.
+ */
+class ScriptRunner
+{
+public:
+    ScriptRunner(const Config &config, std::shared_ptr<Device> dev, std::ostream &out);
+
+    /**
+     * @brief Execute a script until it ends or a step fails
+     * @param in Script source
+     * @param live Read on a separate thread as lines arrive (stdin)
+     * @return true when every step succeeded
+     */
+    bool run(std::istream &in, bool live);
+
+private:
+    struct Step {
+        int line;
+        std::string text;
+        std::vector<std::string> args;
+    };
+
+    DeviceCommands m_commands;
+    std::ostream &m_out;
+    std::chrono::steady_clock::time_point m_start;
+    std::vector<Step> m_pending;  // Mergeable device commands awaiting flush
+
+    bool runStep(const Step &step);
+    bool flush();
+    bool runTiming(const Step &step);
+    bool waitUntil(const Step &step, DeviceCommands::Result &result);
+    void emit(const Step &step, const DeviceCommands::Result &result, bool merged = false);
+
+    static bool isMergeable(const std::vector<std::string> &args);
+    static bool isTiming(const std::vector<std::string> &args);
+};
+
+#endif // SCRIPTRUNNER_H
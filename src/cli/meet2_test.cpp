@@ -3,45 +3,133 @@
 #include <chrono>
 #include <string>
 #include <cstring>
+#include <fstream>
+#include <cstdlib>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 #include <dev/devs.hpp>
+#include "CommandSequence.h"
 #include "Config.h"
+#include "ControlDaemon.h"
+#include "DeviceCommands.h"
+#include "ScriptRunner.h"
 
 using namespace std;
 
 // Forward declarations
 bool handleConfigErrors(Config &config);
-void applyConfigToCamera(shared_ptr<Device> dev, const Config::CameraSettings &settings);
 void runInteractiveMode(shared_ptr<Device> dev);
+shared_ptr<Device> waitForDevice(chrono::milliseconds timeout);
+
+// Default upper bound for device enumeration; we return as soon as a camera shows up
+constexpr int kDefaultDiscoveryTimeoutMs = 3000;
 
 int main(int argc, char **argv)
 {
     bool interactive = false;
+    bool daemon = false;
+    bool timing = false;
+    vector<string> clientCommand;
+    bool client = false;
+    const char *scriptPath = nullptr;
+    int discoveryTimeoutMs = kDefaultDiscoveryTimeoutMs;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--interactive") == 0) {
             interactive = true;
+        } else if (strcmp(argv[i], "--daemon") == 0) {
+            daemon = true;
+        } else if (strcmp(argv[i], "--timing") == 0) {
+            timing = true;
+        } else if (strcmp(argv[i], "--client") == 0) {
+            // Everything after --client (and its own --timing) is the command
+            client = true;
+            int first = i + 1;
+            if (first < argc && strcmp(argv[first], "--timing") == 0) {
+                timing = true;
+                ++first;
+            }
+            clientCommand.assign(argv + first, argv + argc);
+            break;
+        } else if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--exec") == 0) {
+            if (i + 1 >= argc) {
+                cerr << "Error: " << argv[i] << " requires a script file (or - for stdin)" << endl;
+                return 2;
+            }
+            scriptPath = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--timeout") == 0) {
+            char *end = nullptr;
+            long value = (i + 1 < argc) ? strtol(argv[i + 1], &end, 10) : -1;
+            if (!end || *end != '\0' || value < 0) {
+                cerr << "Error: " << argv[i] << " requires a timeout in milliseconds" << endl;
+                return 2;
+            }
+            discoveryTimeoutMs = static_cast<int>(value);
+            ++i;
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             cout << "OBSBOT Control - CLI Tool" << endl;
             cout << "\nUsage: " << argv[0] << " [options]" << endl;
             cout << "\nOptions:" << endl;
             cout << "  -i, --interactive    Run in interactive menu mode" << endl;
+            cout << "  -t, --timeout MS     Max time to wait for a camera (default: "
+                 << kDefaultDiscoveryTimeoutMs << ")" << endl;
+            cout << "  -e, --exec FILE      Run a command script (- reads stdin), JSON results on stdout" << endl;
+            cout << "  --daemon             Keep the camera open and serve commands on "
+                 << ControlDaemon::socketPath() << endl;
+            cout << "  --client [command]   Send a command to the daemon (reads stdin if none given)" << endl;
+            cout << "  --timing             With --client, report round trip times on stderr" << endl;
             cout << "  -h, --help           Show this help message" << endl;
             cout << "\nDefault behavior:" << endl;
             cout << "  Loads configuration from ~/.config/obsbot-control/settings.conf" << endl;
             cout << "  Applies settings to camera and exits" << endl;
+            cout << "\nDaemon protocol: one command per line, one JSON reply per line." << endl;
+            cout << "Prefix a command with #<id> to tag its reply; 'subscribe' streams status events." << endl;
+            cout << DeviceCommands::usage();
+            cout << "\nScript-only commands:" << endl;
+            cout << "  wait <ms>                    Pause after earlier commands finish" << endl;
+            cout << "  at <ms>                      Pause until <ms> after the script started" << endl;
+            cout << "  wait-until <field> <op> <value> [timeout ms]" << endl;
+            cout << "                               Poll a field until the comparison holds" << endl;
+            cout << "  sync                         Finish earlier commands before going on" << endl;
             return 0;
         }
     }
 
-    cout << "OBSBOT Control" << (interactive ? " - Interactive Mode" : "") << endl;
+    // The thin client never touches the SDK, so it skips config and discovery
+    if (client) {
+        return runDaemonClient(clientCommand, timing);
+    }
+
+    // Scripts own stdout for their JSON results; progress messages go to stderr
+    ifstream scriptFile;
+    ostream results(cout.rdbuf());
+    if (scriptPath) {
+        if (strcmp(scriptPath, "-") != 0) {
+            scriptFile.open(scriptPath);
+            if (!scriptFile) {
+                cerr << "Error: cannot open script " << scriptPath << endl;
+                return 2;
+            }
+        }
+        cout.rdbuf(cerr.rdbuf());
+    }
+
+    cout << "OBSBOT Control" << (interactive ? " - Interactive Mode" : (daemon ? " - Daemon" : "")) << endl;
 
     // Load configuration
     Config config;
     vector<Config::ValidationError> errors;
     if (!config.load(errors)) {
         // Config has validation errors
-        if (!handleConfigErrors(config)) {
+        if (daemon || scriptPath) {
+            // No one is at the terminal to answer the prompt
+            for (const auto &err : errors) {
+                cerr << "Config: " << err.message << endl;
+            }
+            config.disableSaving();
+        } else if (!handleConfigErrors(config)) {
             cout << "Continuing without saving settings." << endl;
         }
     } else {
@@ -52,33 +140,20 @@ int main(int argc, char **argv)
         }
     }
 
-    // Device detection callback
-    bool device_connected = false;
-    auto onDevChanged = [&device_connected](std::string dev_sn, bool connected, void *param) {
-        if (connected) {
-            cout << "Device " << dev_sn << " connected" << endl;
-            device_connected = true;
-        } else {
-            cout << "Device " << dev_sn << " disconnected" << endl;
-        }
-    };
-
-    // Register device detection
-    Devices::get().setDevChangedCallback(onDevChanged, nullptr);
-    Devices::get().setEnableMdnsScan(false);  // USB only
+    if (daemon) {
+        // The daemon tracks hotplug itself and keeps serving while unplugged
+        ControlDaemon server(config);
+        return server.run();
+    }
 
     // Wait for device detection
     cout << "Waiting for OBSBOT camera..." << endl;
-    this_thread::sleep_for(chrono::seconds(3));
-
-    auto dev_list = Devices::get().getDevList();
-    if (dev_list.empty()) {
+    auto dev = waitForDevice(chrono::milliseconds(discoveryTimeoutMs));
+    if (!dev) {
         cout << "No OBSBOT devices found!" << endl;
         return 1;
     }
 
-    // Get first device
-    auto dev = dev_list.front();
     cout << "\nFound device:" << endl;
     cout << "  Name: " << dev->devName() << endl;
     cout << "  SN: " << dev->devSn() << endl;
@@ -91,6 +166,14 @@ int main(int argc, char **argv)
         cout << "      Some features may not work as expected." << endl;
     }
 
+    if (scriptPath) {
+        ScriptRunner runner(config, dev, results);
+        bool fromStdin = !scriptFile.is_open();
+        bool ok = runner.run(fromStdin ? cin : scriptFile, fromStdin);
+        cout.rdbuf(results.rdbuf());
+        return ok ? 0 : 1;
+    }
+
     if (interactive) {
         // Interactive mode - run menu
         runInteractiveMode(dev);
@@ -106,6 +189,50 @@ int main(int argc, char **argv)
     return 0;
 }
 
+shared_ptr<Device> waitForDevice(chrono::milliseconds timeout)
+{
+    // State outlives this call: the SDK keeps the callback for the whole process
+    static mutex discoveryMutex;
+    static condition_variable discoveryCond;
+    static bool deviceArrived = false;
+
+    auto onDevChanged = [](std::string dev_sn, bool connected, void *param) {
+        if (connected) {
+            cout << "Device " << dev_sn << " connected" << endl;
+            {
+                lock_guard<mutex> lock(discoveryMutex);
+                deviceArrived = true;
+            }
+            discoveryCond.notify_all();
+        } else {
+            cout << "Device " << dev_sn << " disconnected" << endl;
+        }
+    };
+
+    // Register device detection
+    Devices::get().setDevChangedCallback(onDevChanged, nullptr);
+    Devices::get().setEnableMdnsScan(false);  // USB only
+
+    const auto deadline = chrono::steady_clock::now() + timeout;
+    unique_lock<mutex> lock(discoveryMutex);
+    while (true) {
+        // Check the list first: the camera may have been enumerated before the
+        // callback was registered, in which case no event will ever arrive.
+        // The flag is cleared before looking so an arrival in between still wakes us.
+        deviceArrived = false;
+        lock.unlock();
+        auto dev_list = Devices::get().getDevList();
+        lock.lock();
+        if (!dev_list.empty()) {
+            return dev_list.front();
+        }
+
+        if (!discoveryCond.wait_until(lock, deadline, [] { return deviceArrived; })) {
+            return nullptr;
+        }
+    }
+}
+
 bool handleConfigErrors(Config &config)
 {
     vector<Config::ValidationError> errors;
@@ -159,104 +286,6 @@ bool handleConfigErrors(Config &config)
     }
 }
 
-void applyConfigToCamera(shared_ptr<Device> dev, const Config::CameraSettings &settings)
-{
-    int32_t ret;
-
-    // Apply face tracking
-    if (settings.faceTracking) {
-        cout << "  Enabling face tracking..." << endl;
-        ret = dev->cameraSetMediaModeU(Device::MediaModeAutoFrame);
-        if (ret != 0) {
-            cout << "    Failed to set MediaMode (code: " << ret << ")" << endl;
-        } else {
-            this_thread::sleep_for(chrono::milliseconds(500));
-            ret = dev->cameraSetAutoFramingModeU(Device::AutoFrmSingle, Device::AutoFrmUpperBody);
-            if (ret != 0) {
-                cout << "    Failed to set AutoFraming mode (code: " << ret << ")" << endl;
-            }
-        }
-    } else {
-        cout << "  Disabling face tracking..." << endl;
-        ret = dev->cameraSetMediaModeU(Device::MediaModeNormal);
-        if (ret != 0) {
-            cout << "    Failed to set MediaMode (code: " << ret << ")" << endl;
-        }
-    }
-
-    // Apply HDR
-    cout << "  Setting HDR: " << (settings.hdr ? "On" : "Off") << endl;
-    ret = dev->cameraSetWdrR(settings.hdr ? Device::DevWdrModeDol2TO1 : Device::DevWdrModeNone);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    // Apply FOV
-    const char* fovNames[] = {"Wide (86°)", "Medium (78°)", "Narrow (65°)"};
-    cout << "  Setting FOV: " << fovNames[settings.fov] << endl;
-    Device::FovType fovType = settings.fov == 0 ? Device::FovType86 :
-                               (settings.fov == 1 ? Device::FovType78 : Device::FovType65);
-    ret = dev->cameraSetFovU(fovType);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    // Apply Face AE
-    cout << "  Setting Face AE: " << (settings.faceAE ? "On" : "Off") << endl;
-    ret = dev->cameraSetFaceAER(settings.faceAE);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    // Apply Face Focus
-    cout << "  Setting Face Focus: " << (settings.faceFocus ? "On" : "Off") << endl;
-    ret = dev->cameraSetFaceFocusR(settings.faceFocus);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    // Apply Zoom
-    cout << "  Setting Zoom: " << settings.zoom << "x" << endl;
-    ret = dev->cameraSetZoomAbsoluteR(settings.zoom);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    // Apply Pan/Tilt
-    cout << "  Setting Pan/Tilt: " << settings.pan << ", " << settings.tilt << endl;
-    ret = dev->cameraSetPanTiltAbsolute(settings.pan, settings.tilt);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    // Apply Image Controls
-    cout << "  Setting Brightness: " << settings.brightness << endl;
-    ret = dev->cameraSetImageBrightnessR(settings.brightness);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    cout << "  Setting Contrast: " << settings.contrast << endl;
-    ret = dev->cameraSetImageContrastR(settings.contrast);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    cout << "  Setting Saturation: " << settings.saturation << endl;
-    ret = dev->cameraSetImageSaturationR(settings.saturation);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-
-    const char* wbNames[] = {"Auto", "Daylight", "Fluorescent", "Tungsten", "Flash", "Fine", "Cloudy", "Shade"};
-    cout << "  Setting White Balance: " << wbNames[settings.whiteBalance] << endl;
-    Device::DevWhiteBalanceType wbType = static_cast<Device::DevWhiteBalanceType>(settings.whiteBalance);
-    ret = dev->cameraSetWhiteBalanceR(wbType, 0);
-    if (ret != 0) {
-        cout << "    Failed (code: " << ret << ")" << endl;
-    }
-}
-
 void runInteractiveMode(shared_ptr<Device> dev)
 {
     cout << "\n=== Interactive Camera Control Menu ===" << endl;
@@ -290,13 +319,10 @@ void runInteractiveMode(shared_ptr<Device> dev)
         switch (choice) {
             case 1:
                 cout << "Enabling face tracking..." << endl;
-                ret = dev->cameraSetMediaModeU(Device::MediaModeAutoFrame);
-                if (ret == 0) {
-                    this_thread::sleep_for(chrono::milliseconds(500));
-                    ret = dev->cameraSetAutoFramingModeU(Device::AutoFrmSingle, Device::AutoFrmUpperBody);
-                    cout << (ret == 0 ? "Success" : "Failed") << endl;
-                } else {
-                    cout << "Failed (code: " << ret << ")" << endl;
+                {
+                    CommandSequence sequence;
+                    auto tracking = sequence.run(dev, CommandSequence::autoFraming(dev->productType(), true));
+                    cout << (tracking.outcome == CommandSequence::Completed ? "Success" : "Failed") << endl;
                 }
                 break;
 
@@ -0,0 +1,178 @@
+#include "CameraUsageWatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+// Application names, sorted and without repeats, for spotting a change
+std::vector<std::string> namesOf(const std::vector<CameraUsageWatcher::Consumer> &consumers)
+{
+    std::vector<std::string> names;
+    for (const auto &consumer : consumers) {
+        names.push_back(consumer.name);
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+} // namespace
+
+CameraUsageWatcher::CameraUsageWatcher(std::chrono::milliseconds settle)
+    : m_settle(settle)
+    , m_lookup([this](const std::vector<std::string> &devices) { return m_scanner.scan(devices); })
+    , m_inotifyFd(-1)
+    , m_stopFd(-1)
+{
+}
+
+CameraUsageWatcher::~CameraUsageWatcher()
+{
+    stop();
+}
+
+bool CameraUsageWatcher::start(const std::vector<std::string> &devices, ChangeCallback callback)
+{
+    stop();
+
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_stopFd = eventfd(0, EFD_CLOEXEC);
+    if (m_inotifyFd < 0 || m_stopFd < 0) {
+        std::cerr << "[Usage] Cannot watch the camera: " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+
+    m_devices.clear();
+    for (const auto &device : devices) {
+        if (device.empty() || std::find(m_devices.begin(), m_devices.end(), device) != m_devices.end()) {
+            continue;
+        }
+        if (inotify_add_watch(m_inotifyFd, device.c_str(), IN_OPEN | IN_CLOSE) < 0) {
+            std::cerr << "[Usage] Cannot watch " << device << ": " << std::strerror(errno) << std::endl;
+            continue;
+        }
+        m_devices.push_back(device);
+    }
+    if (m_devices.empty()) {
+        stop();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_stats = Stats();
+    }
+    m_callback = std::move(callback);
+    m_thread = std::thread(&CameraUsageWatcher::watchLoop, this);
+    return true;
+}
+
+void CameraUsageWatcher::stop()
+{
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        if (write(m_stopFd, &one, sizeof(one)) != sizeof(one)) {
+            std::cerr << "[Usage] Cannot stop camera usage watcher: " << std::strerror(errno) << std::endl;
+        }
+        m_thread.join();
+    }
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+        m_stopFd = -1;
+    }
+}
+
+std::vector<CameraUsageWatcher::Consumer> CameraUsageWatcher::lookup()
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto consumers = m_lookup(m_devices);
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    ++m_stats.lookups;
+    m_stats.lastLookupMs = ms;
+    return consumers;
+}
+
+CameraUsageWatcher::Stats CameraUsageWatcher::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+void CameraUsageWatcher::watchLoop()
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Someone may have the camera already
+    auto consumers = lookup();
+    std::vector<std::string> names = namesOf(consumers);
+    if (m_callback) {
+        m_callback(consumers);
+    }
+
+    bool pending = false;
+    Clock::time_point lastEvent;
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true) {
+        int timeoutMs = -1;  // Idle: sleep until the next open or close
+        if (pending) {
+            const auto settledAt = lastEvent + m_settle;
+            timeoutMs = static_cast<int>(std::max<int64_t>(
+                0, std::chrono::duration_cast<std::chrono::milliseconds>(settledAt - Clock::now()).count() + 1));
+        }
+
+        pollfd fds[2] = {{m_inotifyFd, POLLIN, 0}, {m_stopFd, POLLIN, 0}};
+        if (poll(fds, 2, timeoutMs) < 0 && errno != EINTR) {
+            std::cerr << "[Usage] Camera usage watcher failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t length;
+            while ((length = read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+                unsigned events = 0;
+                for (char *p = buffer; p < buffer + length;) {
+                    auto *event = reinterpret_cast<struct inotify_event *>(p);
+                    ++events;
+                    p += sizeof(struct inotify_event) + event->len;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_statsMutex);
+                    m_stats.events += events;
+                }
+                pending = true;
+                lastEvent = Clock::now();
+            }
+        }
+
+        if (pending && Clock::now() >= lastEvent + m_settle) {
+            pending = false;
+            consumers = lookup();
+            auto current = namesOf(consumers);
+            if (current != names) {
+                names = std::move(current);
+                if (m_callback) {
+                    m_callback(consumers);
+                }
+            }
+        }
+    }
+}
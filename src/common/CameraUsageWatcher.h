@@ -0,0 +1,68 @@
+#ifndef CAMERAUSAGEWATCHER_H
+#define CAMERAUSAGEWATCHER_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DeviceHolderScanner.h"
+
+/**
+ * @brief Reports which applications have the camera device nodes open
+ *
+ * A background thread sleeps in poll() on an inotify watch for opens and
+ * closes of the given nodes, so it costs nothing while no one touches the
+ * camera. After a burst of events settles (browsers open every node briefly
+ * while enumerating) the thread looks up the processes holding the nodes and
+ * calls back if the set of applications changed. This process is left out.
+ */
+class CameraUsageWatcher
+{
+public:
+    using Consumer = DeviceHolderScanner::Holder;
+
+    // Processes other than this one holding any of the nodes open
+    using Lookup = std::function<std::vector<Consumer>(const std::vector<std::string> &devices)>;
+
+    // Called on the watcher thread, once at start and then on every change
+    using ChangeCallback = std::function<void(const std::vector<Consumer> &consumers)>;
+
+    struct Stats {
+        unsigned events = 0;   // inotify events read
+        unsigned lookups = 0;  // Process lookups after an event burst settled
+        double lastLookupMs = 0.0;
+    };
+
+    explicit CameraUsageWatcher(std::chrono::milliseconds settle = std::chrono::milliseconds(500));
+    ~CameraUsageWatcher();
+
+    // Replaces the /proc scan, e.g. with a fake for testing
+    void setLookup(Lookup lookup) { m_lookup = std::move(lookup); }
+
+    // Nodes that do not exist are skipped; false if none could be watched
+    bool start(const std::vector<std::string> &devices, ChangeCallback callback);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    Stats stats() const;  // Safe while the watcher runs
+
+private:
+    const std::chrono::milliseconds m_settle;
+    DeviceHolderScanner m_scanner;  // Default lookup, run on the watcher thread
+    Lookup m_lookup;
+    ChangeCallback m_callback;
+    std::vector<std::string> m_devices;
+
+    std::thread m_thread;
+    int m_inotifyFd;
+    int m_stopFd;  // eventfd that wakes the thread for stop()
+    mutable std::mutex m_statsMutex;
+    Stats m_stats;  // Guarded by m_statsMutex; written on the watcher thread
+
+    void watchLoop();
+    std::vector<Consumer> lookup();
+};
+
+#endif // CAMERAUSAGEWATCHER_H
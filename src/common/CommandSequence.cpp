@@ -0,0 +1,218 @@
+#include "CommandSequence.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+constexpr auto kConfirmPollInterval = std::chrono::milliseconds(10);
+
+double msSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+CommandSequence::CommandSequence()
+    : m_stopping(false)
+    , m_busy(false)
+    , m_cancelling(false)
+    , m_hasPending(false)
+{
+}
+
+CommandSequence::~CommandSequence()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+const char *CommandSequence::outcomeName(Outcome outcome)
+{
+    switch (outcome) {
+    case Completed:
+        return "completed";
+    case Failed:
+        return "failed";
+    case TimedOut:
+        return "timed out";
+    case Cancelled:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+void CommandSequence::start(std::shared_ptr<Device> dev, Operation operation)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingDevice = std::move(dev);
+        m_pending = std::move(operation);
+        m_hasPending = true;
+        if (!m_thread.joinable()) {
+            m_thread = std::thread(&CommandSequence::workerLoop, this);
+        }
+    }
+    m_wake.notify_all();
+}
+
+void CommandSequence::cancel()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_hasPending = false;
+    m_pendingDevice.reset();
+    m_cancelling = true;
+    m_wake.notify_all();
+    m_wake.wait(lock, [this]() { return !m_busy; });
+    m_cancelling = false;
+}
+
+void CommandSequence::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_stopping || m_hasPending; });
+        if (m_stopping) {
+            return;
+        }
+
+        std::shared_ptr<Device> dev = std::move(m_pendingDevice);
+        Operation operation = std::move(m_pending);
+        m_hasPending = false;
+        m_busy = true;
+        lock.unlock();
+
+        Result result = run(dev, operation);
+        if (m_resultCallback) {
+            m_resultCallback(result);
+        }
+
+        lock.lock();
+        m_busy = false;
+        m_wake.notify_all();
+    }
+}
+
+bool CommandSequence::interrupted()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return interruptedLocked();
+}
+
+CommandSequence::Result CommandSequence::run(const std::shared_ptr<Device> &dev, const Operation &operation)
+{
+    Result result;
+    result.name = operation.name;
+    if (!dev) {
+        return result;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    auto finish = [&](Outcome outcome, const Step *step) {
+        result.outcome = outcome;
+        result.step = step ? step->name : std::string();
+        result.elapsedMs = msSince(started);
+
+        std::cout << "[Sequence] " << operation.name << " " << outcomeName(outcome);
+        if (step) {
+            std::cout << " at " << step->name;
+            if (outcome == Failed) {
+                std::cout << " (" << result.result << ")";
+            }
+        }
+        std::cout << std::fixed << std::setprecision(1) << " after " << result.elapsedMs << " ms"
+                  << std::defaultfloat << std::endl;
+        return result;
+    };
+
+    for (const Step &step : operation.steps) {
+        if (interrupted()) {
+            return finish(Cancelled, &step);
+        }
+
+        const auto sent = std::chrono::steady_clock::now();
+        result.result = step.send(*dev);
+        if (m_logger) {
+            m_logger(step.name, result.result);
+        }
+        if (result.result != RM_RET_OK) {
+            return finish(Failed, &step);
+        }
+
+        // Poll the read-back until the camera reflects the step; the status
+        // is served from the SDK's pushed cache, so a poll costs no USB traffic
+        if (step.confirmed) {
+            const auto deadline = sent + step.timeout;
+            while (!step.confirmed(*dev)) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    return finish(TimedOut, &step);
+                }
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_wake.wait_for(lock, kConfirmPollInterval, [this]() { return interruptedLocked(); })) {
+                    return finish(Cancelled, &step);
+                }
+            }
+        }
+        ++result.completedSteps;
+    }
+    return finish(Completed, nullptr);
+}
+
+bool CommandSequence::usesMeetStatus(ObsbotProductType product)
+{
+    return product == ObsbotProdMeet || product == ObsbotProdMeet4k;
+}
+
+CommandSequence::Operation CommandSequence::autoFraming(ObsbotProductType product, bool enabled)
+{
+    Operation operation;
+    operation.name = enabled ? "auto-framing on" : "auto-framing off";
+
+    const bool meet = usesMeetStatus(product);
+    const bool tailAir = product == ObsbotProdTailAir;  // No media mode in its status
+
+    Step mediaMode;
+    mediaMode.name = "cameraSetMediaModeU";
+    mediaMode.send = [enabled](Device &dev) {
+        return dev.cameraSetMediaModeU(enabled ? Device::MediaModeAutoFrame : Device::MediaModeNormal);
+    };
+    if (!tailAir) {
+        mediaMode.confirmed = [enabled, meet](Device &dev) {
+            const Device::CameraStatus status = dev.cameraStatus();
+            if (meet) {
+                return status.meet.media_mode ==
+                       static_cast<uint8_t>(enabled ? Device::MediaModeAutoFrame : Device::MediaModeNormal);
+            }
+            return (status.tiny.ai_mode != Device::AiWorkModeNone) == enabled;
+        };
+    }
+    operation.steps.push_back(mediaMode);
+
+    if (enabled) {
+        Step framing;
+        framing.name = "cameraSetAutoFramingModeU";
+        framing.send = [](Device &dev) {
+            return dev.cameraSetAutoFramingModeU(Device::AutoFrmSingle, Device::AutoFrmUpperBody);
+        };
+        if (!tailAir) {
+            framing.confirmed = [meet](Device &dev) {
+                const Device::CameraStatus status = dev.cameraStatus();
+                if (meet) {
+                    return status.meet.group_single == Device::AutoFrmSingle &&
+                           status.meet.close_upper == Device::AutoFrmUpperBody;
+                }
+                return status.tiny.ai_mode == Device::AiWorkModeHuman &&
+                       status.tiny.ai_sub_mode == Device::AiSubModeUpperBody;
+            };
+        }
+        operation.steps.push_back(framing);
+    }
+    return operation;
+}
@@ -0,0 +1,112 @@
+#ifndef COMMANDSEQUENCE_H
+#define COMMANDSEQUENCE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dev/dev.hpp>
+
+/**
+ * @brief Runs multi-step device operations that must land in order
+ *
+ * Some settings take more than one command, and a later command is only
+ * accepted once the camera has acted on the earlier one (auto framing:
+ * media mode first, then the framing mode). Each step sends its command
+ * and then reads the camera status back until the step's confirmation
+ * holds, so the next step goes out as soon as the camera is ready rather
+ * than after a fixed delay. A step that is not confirmed within its
+ * timeout ends the operation.
+ *
+ * start() hands the operation to a worker thread and returns immediately.
+ * Starting another operation supersedes the current one: no further steps
+ * of it are sent, and the new one runs once the command in flight returns.
+ * Toggling a setting quickly therefore always ends in the last state asked
+ * for, never with a stale step landing afterwards.
+ */
+class CommandSequence
+{
+public:
+    struct Step {
+        std::string name;                         // SDK call, for logs and telemetry
+        std::function<int32_t(Device &)> send;
+        std::function<bool(Device &)> confirmed;  // Read back; empty if the acknowledge is enough
+        std::chrono::milliseconds timeout{2000};  // Acknowledge to confirmation
+    };
+
+    struct Operation {
+        std::string name;  // e.g. "auto-framing on"
+        std::vector<Step> steps;
+    };
+
+    enum Outcome {
+        Completed,
+        Failed,     // A command returned an error
+        TimedOut,   // A step was acknowledged but never confirmed
+        Cancelled,  // Superseded by a newer operation, or cancel()
+    };
+
+    struct Result {
+        std::string name;
+        Outcome outcome = Failed;
+        std::string step;        // Step that failed, timed out or was interrupted
+        int32_t result = RM_RET_OK;
+        size_t completedSteps = 0;
+        double elapsedMs = 0.0;
+    };
+
+    // Called on the worker thread when an operation started with start() ends
+    using ResultCallback = std::function<void(const Result &result)>;
+    // Called for every command sent, e.g. to feed GimbalTelemetry
+    using CommandLogger = std::function<void(const std::string &name, int32_t result)>;
+
+    CommandSequence();
+    ~CommandSequence();
+
+    void setResultCallback(ResultCallback callback) { m_resultCallback = std::move(callback); }
+    void setCommandLogger(CommandLogger logger) { m_logger = std::move(logger); }
+
+    // Queue an operation for the worker, superseding the one running or waiting
+    void start(std::shared_ptr<Device> dev, Operation operation);
+
+    // Run an operation on the calling thread
+    Result run(const std::shared_ptr<Device> &dev, const Operation &operation);
+
+    // Drop any queued operation and stop the running one after its current
+    // command. Must not be called from the result callback.
+    void cancel();
+
+    static const char *outcomeName(Outcome outcome);
+
+    // Meet and Meet 4K report the media mode directly in the meet status
+    // layout; the tiny layout, used by the Tiny series and Meet 2 / Meet SE,
+    // reports the resulting AI mode. Tail Air has a layout of its own
+    static bool usesMeetStatus(ObsbotProductType product);
+
+    // Tracking on (media mode, then single-person upper-body framing) or off
+    static Operation autoFraming(ObsbotProductType product, bool enabled);
+
+private:
+    CommandLogger m_logger;
+    ResultCallback m_resultCallback;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+    bool m_busy;
+    bool m_cancelling;
+    bool m_hasPending;
+    std::shared_ptr<Device> m_pendingDevice;
+    Operation m_pending;
+
+    void workerLoop();
+    bool interruptedLocked() const { return m_hasPending || m_cancelling || m_stopping; }
+    bool interrupted();
+};
+
+#endif // COMMANDSEQUENCE_H
@@ -1,572 +1,911 @@
 #include "Config.h"
+#include "Trace.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
 #include <cstdlib>
-#include <unordered_set>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <type_traits>
+#include <unordered_map>
 #include <algorithm>
+#include <cctype>
+#include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
-Config::Config()
-    : m_savingEnabled(true)
+namespace {
+
+// Split "preset<N>_<suffix>" into a zero-based index and suffix
+bool splitPresetKey(const std::string &key, int &index, std::string &suffix)
 {
-    setDefaults();
+    if (key.rfind("preset", 0) != 0) {
+        return false;
+    }
+
+    size_t underscore = key.find('_', 6);
+    if (underscore == std::string::npos || underscore == 6 || underscore > 8) {
+        return false;
+    }
+
+    int number = 0;
+    for (size_t i = 6; i < underscore; ++i) {
+        if (key[i] < '0' || key[i] > '9') {
+            return false;
+        }
+        number = number * 10 + (key[i] - '0');
+    }
+
+    if (number < 1 || number > Config::kMaxPresets) {
+        return false;
+    }
+
+    index = number - 1;
+    suffix = key.substr(underscore + 1);
+    return true;
 }
 
-Config::~Config()
+// Split "sequence_<name>" / "sequence_<name>_hotkey" into name and suffix
+bool splitSequenceKey(const std::string &key, std::string &name, std::string &suffix)
 {
+    static const std::string prefix = "sequence_";
+    static const std::string hotkeySuffix = "_hotkey";
+    if (key.rfind(prefix, 0) != 0) {
+        return false;
+    }
+
+    name = key.substr(prefix.size());
+    suffix.clear();
+    if (name.size() > hotkeySuffix.size() &&
+        name.compare(name.size() - hotkeySuffix.size(), hotkeySuffix.size(), hotkeySuffix) == 0) {
+        name.erase(name.size() - hotkeySuffix.size());
+        suffix = "hotkey";
+    }
+    return Config::isValidSequenceName(name);
 }
 
-void Config::setDefaults()
+const std::pair<const char *, Config::CameraSettings::Easing> kEasingNames[] = {
+    {"linear", Config::CameraSettings::EaseLinear},
+    {"ease-in", Config::CameraSettings::EaseIn},
+    {"ease-out", Config::CameraSettings::EaseOut},
+    {"ease-in-out", Config::CameraSettings::EaseInOut},
+    {"hold", Config::CameraSettings::EaseHold},
+};
+
+// mkdir -p for the directory holding path
+bool makeParentDirectories(const std::string &path)
 {
-    m_settings.faceTracking = false;  // Default to off for safety
-    m_settings.hdr = false;
-    m_settings.fov = 0;               // Wide
-    m_settings.faceAE = false;
-    m_settings.faceFocus = false;
-    m_settings.zoom = 1.0;            // No zoom
-   m_settings.pan = 0.0;             // Centered
-   m_settings.tilt = 0.0;            // Centered
-
-    // AI / Tracking defaults
-    m_settings.aiMode = 0;            // AiWorkModeNone
-    m_settings.aiSubMode = 0;         // AiSubModeNormal
-    m_settings.autoZoom = false;
-    m_settings.trackSpeed = 2;        // AiTrackSpeedStandard
-
-    // Image controls - use auto mode by default
-    m_settings.brightnessAuto = true;
-    m_settings.brightness = 128;
-    m_settings.contrastAuto = true;
-    m_settings.contrast = 128;
-    m_settings.saturationAuto = true;
-    m_settings.saturation = 128;
-    m_settings.whiteBalance = 0;      // Auto
-    m_settings.whiteBalanceKelvin = 5000;
-
-    // Audio defaults
-    m_settings.audioAutoGain = true;
-
-    // Video / preview
-    m_settings.previewFormat = "auto";
-
-    for (auto &preset : m_settings.presets) {
-        preset.defined = false;
-        preset.pan = 0.0;
-        preset.tilt = 0.0;
-        preset.zoom = 1.0;
-    }
-
-    // Application settings
-    m_settings.startMinimized = false;
-    m_settings.virtualCameraEnabled = false;
-    m_settings.virtualCameraDevice = "/dev/video42";
-    m_settings.virtualCameraResolution = "match";
+    for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        if (mkdir(path.substr(0, slash).c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    return true;
 }
 
-std::string Config::getXdgConfigHome() const
+// Write beside the target, flush it to disk, then rename it over the target:
+// a crash leaves either the old or the new file, never a truncated one
+bool writeFileAtomically(const std::string &path, const std::string &content, std::string &error)
 {
-    const char *xdg = std::getenv("XDG_CONFIG_HOME");
-    if (xdg && xdg[0] != '\0') {
-        return std::string(xdg);
+    const std::string tempPath = path + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "Cannot open " + tempPath + ": " + std::strerror(errno);
+        return false;
     }
 
-    const char *home = std::getenv("HOME");
-    if (home) {
-        return std::string(home) + "/.config";
+    auto fail = [&](const std::string &what) {
+        error = what + " " + tempPath + ": " + std::strerror(errno);
+        close(fd);
+        unlink(tempPath.c_str());
+        return false;
+    };
+
+    const char *data = content.data();
+    size_t remaining = content.size();
+    while (remaining > 0) {
+        ssize_t written = write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return fail("Cannot write");
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    if (fsync(fd) != 0) {
+        return fail("Cannot sync");
+    }
+    if (close(fd) != 0) {
+        error = "Cannot close " + tempPath + ": " + std::strerror(errno);
+        unlink(tempPath.c_str());
+        return false;
     }
 
-    return ".config";  // Fallback
-}
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        error = "Cannot replace " + path + ": " + std::strerror(errno);
+        unlink(tempPath.c_str());
+        return false;
+    }
 
-std::string Config::getConfigPath() const
-{
-    return getXdgConfigHome() + "/obsbot-control/settings.conf";
+    // Sync the directory too, so the rename itself survives a power cut
+    const std::string dir = path.substr(0, path.find_last_of('/'));
+    int dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
 }
 
-bool Config::configExists() const
-{
-    std::ifstream file(getConfigPath());
-    return file.good();
-}
+using Settings = Config::CameraSettings;
+using VideoEffects = Config::CameraSettings::VideoEffects;
 
-bool Config::load(std::vector<ValidationError> &errors)
+bool parseBool(const std::string &value, bool &out)
 {
-    errors.clear();
-    std::string configPath = getConfigPath();
-
-    std::ifstream file(configPath);
-    if (!file.is_open()) {
-        // No config file is not an error - we'll use defaults
+    if (value == "true" || value == "enabled" || value == "yes" || value == "1") {
+        out = true;
+        return true;
+    } else if (value == "false" || value == "disabled" || value == "no" || value == "0") {
+        out = false;
         return true;
     }
+    return false;
+}
 
-    // Temporary storage for parsed values
-    std::map<std::string, std::string> values;
-    std::vector<std::string> foundKeys;
+// Range bounds as written in messages: integers plainly, doubles with one decimal
+std::string formatBound(int value)
+{
+    return std::to_string(value);
+}
 
-    std::string line;
-    int lineNumber = 0;
+std::string formatBound(double value)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << value;
+    return out.str();
+}
 
-    while (std::getline(file, line)) {
-        lineNumber++;
+// std::stoi / std::stod by type, so numeric fields share one template
+template <typename T>
+T parseNumber(const std::string &value);
 
-        // Trim whitespace
-        size_t start = line.find_first_not_of(" \t\r\n");
-        if (start == std::string::npos) continue;  // Empty line
-        line = line.substr(start);
+template <>
+int parseNumber<int>(const std::string &value)
+{
+    return std::stoi(value);
+}
 
-        // Skip comments
-        if (line[0] == '#') continue;
+template <>
+double parseNumber<double>(const std::string &value)
+{
+    return std::stod(value);
+}
 
-        // Parse key=value
-        size_t equals = line.find('=');
-        if (equals == std::string::npos) {
-            ValidationError err;
-            err.type = MalformedLine;
-            err.message = "Expected format: key=value";
-            err.lineNumber = lineNumber;
-            errors.push_back(err);
-            continue;
+// Parse a number and check it against [min, max]; error names the key
+template <typename T>
+bool parseInRange(const std::string &key, const std::string &value, T min, T max, T &out, std::string &error)
+{
+    // Messages are only built on failure: this runs for most lines of the file
+    auto range = [min, max]() { return formatBound(min) + " and " + formatBound(max); };
+    try {
+        T number = parseNumber<T>(value);
+        if (number < min || number > max) {
+            error = key + " must be between " + range();
+            return false;
         }
+        out = number;
+        return true;
+    } catch (...) {
+        error = key + (std::is_integral<T>::value ? " must be an integer between " : " must be a number between ") + range();
+        return false;
+    }
+}
 
-        std::string key = line.substr(0, equals);
-        std::string value = line.substr(equals + 1);
-
-        // Trim key and value
-        key.erase(key.find_last_not_of(" \t\r\n") + 1);
-        value.erase(0, value.find_first_not_of(" \t\r\n"));
-        value.erase(value.find_last_not_of(" \t\r\n") + 1);
+// "match" or WIDTHxHEIGHT, rewritten to canonical form; an empty value means "match"
+bool normalizeResolution(std::string &value, std::string &error)
+{
+    if (value.empty()) {
+        value = "match";
+        return true;
+    }
 
-        // Remove inline comments from value
-        size_t comment = value.find('#');
-        if (comment != std::string::npos) {
-            value = value.substr(0, comment);
-            value.erase(value.find_last_not_of(" \t\r\n") + 1);
-        }
+    std::string normalized = value;
+    std::replace(normalized.begin(), normalized.end(), 'X', 'x');
+    if (normalized == "match") {
+        value = normalized;
+        return true;
+    }
 
-        values[key] = value;
-        foundKeys.push_back(key);
+    size_t sep = normalized.find('x');
+    if (sep == std::string::npos) {
+        error = "virtual_camera_resolution must be 'match' or WIDTHxHEIGHT (e.g. 1280x720)";
+        return false;
+    }
 
-        if (!parseLine(key + "=" + value, lineNumber, errors)) {
-            // Error already added to errors vector
+    try {
+        const int width = std::stoi(normalized.substr(0, sep));
+        const int height = std::stoi(normalized.substr(sep + 1));
+        if (width <= 0 || height <= 0) {
+            error = "virtual_camera_resolution width and height must be greater than zero";
+            return false;
         }
+        value = std::to_string(width) + "x" + std::to_string(height);
+    } catch (...) {
+        error = "virtual_camera_resolution must be 'match' or WIDTHxHEIGHT (e.g. 1280x720)";
+        return false;
     }
+    return true;
+}
 
-    file.close();
+/*
+ * One scalar setting: everything parse, validate, serialize, diff and
+ * setDefaults need to know about a key. Presets and sequences have keys
+ * built from an index or name and stay hand-written.
+ */
+struct Field {
+    const char *key;
+    const char *comment;   // Written above the key, '#' included; nullptr for none
+    bool required;         // Reported as missing when absent from the file
+    bool blankLineAfter;
+    bool inProfile;        // Saved in and applied from named profiles
+    std::function<void(Settings &)> reset;
+    std::function<bool(Settings &, const std::string &value, std::string &error)> parse;
+    std::function<std::string(const Settings &)> format;
+    std::function<bool(const Settings &, std::string &error)> check;  // For values set in code
+    std::function<bool(const Settings &, const Settings &)> same;
+};
+
+// A member of CameraSettings, or of the VideoEffects inside it
+template <typename T>
+struct Member {
+    Member(T Settings::*member) : direct(member), effect(nullptr) {}
+    Member(T Settings::VideoEffects::*member) : direct(nullptr), effect(member) {}
+
+    T &operator()(Settings &s) const { return direct ? s.*direct : s.effects.*effect; }
+    const T &operator()(const Settings &s) const { return direct ? s.*direct : s.effects.*effect; }
+
+    T Settings::*direct;
+    T Settings::VideoEffects::*effect;
+};
+
+// Keeps the member out of template deduction, so the range arguments decide T
+template <typename T>
+struct NonDeduced {
+    using type = T;
+};
+
+template <typename T>
+std::function<bool(const Settings &, const Settings &)> sameMember(Member<T> member)
+{
+    return [member](const Settings &a, const Settings &b) { return member(a) == member(b); };
+}
 
-    // Check for missing required properties
-    std::vector<std::string> requiredKeys = {
-        "face_tracking", "hdr", "fov", "face_ae",
-        "face_focus", "zoom", "pan", "tilt",
-        "brightness_auto", "brightness",
-        "contrast_auto", "contrast",
-        "saturation_auto", "saturation",
-        "white_balance", "start_minimized"
+Field boolField(const char *key, Member<bool> member, bool fallback, bool required, const char *comment,
+                bool blankLineAfter = true)
+{
+    const std::string name = key;
+    return {
+        key, comment, required, blankLineAfter, true,
+        [member, fallback](Settings &s) { member(s) = fallback; },
+        [member, name](Settings &s, const std::string &value, std::string &error) {
+            if (!parseBool(value, member(s))) {
+                error = name + " must be true/false or enabled/disabled";
+                return false;
+            }
+            return true;
+        },
+        [member](const Settings &s) { return std::string(member(s) ? "enabled" : "disabled"); },
+        [](const Settings &, std::string &) { return true; },
+        sameMember(member),
     };
+}
 
-    for (const auto &key : requiredKeys) {
-        if (values.find(key) == values.end()) {
-            ValidationError err;
-            err.type = MissingProperty;
-            err.message = "Required property '" + key + "' not found";
-            err.lineNumber = 0;
-            errors.push_back(err);
-        }
-    }
-
-    const std::unordered_set<std::string> optionalKeys = {
-        "ai_mode",
-        "ai_sub_mode",
-        "auto_zoom",
-        "track_speed",
-        "audio_auto_gain",
-        "preview_format",
-        "virtual_camera_enabled",
-        "virtual_camera_device",
-        "virtual_camera_resolution",
-        "white_balance_kelvin"
+template <typename T>
+Field numberField(const char *key, Member<typename NonDeduced<T>::type> member, T fallback, T min, T max, bool required,
+                  const char *comment, bool blankLineAfter = true)
+{
+    const std::string name = key;
+    return {
+        key, comment, required, blankLineAfter, true,
+        [member, fallback](Settings &s) { member(s) = fallback; },
+        [member, name, min, max](Settings &s, const std::string &value, std::string &error) {
+            return parseInRange(name, value, min, max, member(s), error);
+        },
+        [member](const Settings &s) {
+            std::ostringstream out;
+            out << member(s);
+            return out.str();
+        },
+        [member, name, min, max](const Settings &s, std::string &error) {
+            if (member(s) < min || member(s) > max) {
+                error = name + " out of range (must be " + formatBound(min) + " to " + formatBound(max) + ")";
+                return false;
+            }
+            return true;
+        },
+        sameMember(member),
     };
+}
 
-    auto isPresetKey = [](const std::string &key) -> bool {
-        if (key.rfind("preset", 0) != 0 || key.size() < 10) {
-            return false;
-        }
-
-        char presetIndex = key[6];
-        if (presetIndex < '1' || presetIndex > '3') {
+// An int stored by name (fov=wide); the number is accepted too
+Field enumField(const char *key, Member<int> member, int fallback,
+                std::vector<std::pair<std::string, int>> names, bool required, const char *comment,
+                bool blankLineAfter = true)
+{
+    const std::string name = key;
+    std::string accepted;
+    std::string numbers;
+    for (const auto &named : names) {
+        accepted += (accepted.empty() ? "" : "/") + named.first;
+        numbers += (numbers.empty() ? "" : "/") + std::to_string(named.second);
+    }
+    const std::string message = name + " must be " + accepted + " or " + numbers;
+
+    return {
+        key, comment, required, blankLineAfter, true,
+        [member, fallback](Settings &s) { member(s) = fallback; },
+        [member, names, message](Settings &s, const std::string &value, std::string &error) {
+            for (const auto &named : names) {
+                if (value == named.first || value == std::to_string(named.second)) {
+                    member(s) = named.second;
+                    return true;
+                }
+            }
+            error = message;
             return false;
-        }
-
-        if (key[7] != '_') {
+        },
+        [member, names, fallback](const Settings &s) {
+            std::string fallbackName;
+            for (const auto &named : names) {
+                if (named.second == member(s)) {
+                    return named.first;
+                }
+                if (named.second == fallback) {
+                    fallbackName = named.first;
+                }
+            }
+            return fallbackName;
+        },
+        [member, names, message](const Settings &s, std::string &error) {
+            for (const auto &named : names) {
+                if (named.second == member(s)) {
+                    return true;
+                }
+            }
+            error = message;
             return false;
-        }
+        },
+        sameMember(member),
+    };
+}
 
-        const std::string suffix = key.substr(8);
-        static const std::unordered_set<std::string> presetSuffixes = {
-            "defined",
-            "pan",
-            "tilt",
-            "zoom"
-        };
-        return presetSuffixes.count(suffix) > 0;
+// normalize rewrites the value in place, or fails with a message; nullptr accepts anything.
+// An empty value reads as the default.
+Field stringField(const char *key, Member<std::string> member, const char *fallback,
+                  bool (*normalize)(std::string &, std::string &), bool required, const char *comment,
+                  bool blankLineAfter = true)
+{
+    const std::string defaultValue = fallback;
+    return {
+        key, comment, required, blankLineAfter, true,
+        [member, defaultValue](Settings &s) { member(s) = defaultValue; },
+        [member, normalize, defaultValue](Settings &s, const std::string &value, std::string &error) {
+            std::string normalized = value;
+            if (normalize && !normalize(normalized, error)) {
+                return false;
+            }
+            member(s) = normalized.empty() ? defaultValue : normalized;
+            return true;
+        },
+        [member, defaultValue](const Settings &s) { return member(s).empty() ? defaultValue : member(s); },
+        [member, normalize](const Settings &s, std::string &error) {
+            std::string normalized = member(s);
+            return !normalize || normalize(normalized, error);
+        },
+        sameMember(member),
     };
+}
 
-    // Check for unknown properties
-    std::unordered_set<std::string> knownKeys(requiredKeys.begin(), requiredKeys.end());
-    knownKeys.insert(optionalKeys.begin(), optionalKeys.end());
+// Settings of the application rather than of the camera or the video
+Field appSetting(Field field)
+{
+    field.inProfile = false;
+    return field;
+}
 
-    for (const auto &key : foundKeys) {
-        if (knownKeys.count(key) > 0 || isPresetKey(key)) {
-            continue;
-        }
+// Rewrite rules in canonical form, so the file reads the same whoever wrote it
+bool normalizeProfileRules(std::string &value, std::string &error)
+{
+    std::vector<Config::ProfileRule> rules;
+    if (!Config::parseProfileRules(value, rules, error)) {
+        error = "auto_profile_rules: " + error;
+        return false;
+    }
+    value = Config::formatProfileRules(rules);
+    return true;
+}
 
-        ValidationError err;
-        err.type = UnknownProperty;
-        err.message = "Unknown property '" + key + "'";
-        err.lineNumber = 0;
-        errors.push_back(err);
+// Six hex digits, rrggbb; no '#', which would start a comment
+bool normalizeColor(std::string &value, std::string &error)
+{
+    if (value.empty()) {
+        return true;  // Reads as the default
     }
+    if (value.size() != 6 || !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isxdigit(c); })) {
+        error = "effect_duotone colors must be six hex digits rrggbb, e.g. 1e1e3c";
+        return false;
+    }
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+    return true;
+}
 
-    return errors.empty();
+bool requireDevice(std::string &value, std::string &error)
+{
+    if (value.empty()) {
+        error = "virtual_camera_device cannot be empty";
+        return false;
+    }
+    return true;
+}
+
+// Every scalar key, in the order save() writes them
+const std::vector<Field> &schema()
+{
+    static const std::vector<Field> fields = {
+        // Tracking defaults to off for safety
+        boolField("face_tracking", &Settings::faceTracking, false, true, "# Enable automatic face tracking"),
+        boolField("hdr", &Settings::hdr, false, true, "# High Dynamic Range"),
+        enumField("fov", &Settings::fov, 0, {{"wide", 0}, {"medium", 1}, {"narrow", 2}}, true,
+                  "# Field of View (wide/medium/narrow)"),
+        boolField("face_ae", &Settings::faceAE, false, true, "# Face-based Auto Exposure"),
+        boolField("face_focus", &Settings::faceFocus, false, true, "# Face-based Auto Focus"),
+        numberField("zoom", &Settings::zoom, 1.0, 1.0, 2.0, true, "# Zoom level (1.0 to 2.0)"),
+        numberField("pan", &Settings::pan, 0.0, -1.0, 1.0, true, "# Pan position (-1.0 to 1.0, 0 is center)"),
+        numberField("tilt", &Settings::tilt, 0.0, -1.0, 1.0, true, "# Tilt position (-1.0 to 1.0, 0 is center)"),
+
+        // AI / Tracking
+        numberField("ai_mode", &Settings::aiMode, 0, 0, 6, false,
+                    "# AI Tracking Mode (0=None,1=Group,2=Human,3=Hand,4=Whiteboard,5=Desk)"),
+        numberField("ai_sub_mode", &Settings::aiSubMode, 0, 0, 5, false,
+                    "# AI Human Sub-Mode (0=Normal,1=UpperBody,2=CloseUp,3=Headless,4=LowerBody)"),
+        boolField("auto_zoom", &Settings::autoZoom, false, false, "# Enable AI Auto Zoom"),
+        numberField("track_speed", &Settings::trackSpeed, 2, 0, 5, false,
+                    "# Tracking Speed (0=Lazy,1=Slow,2=Standard,3=Fast,4=Crazy,5=Auto)"),
+
+        // Image controls - auto mode by default
+        boolField("brightness_auto", &Settings::brightnessAuto, true, true,
+                  "# Brightness Auto Mode (when enabled, brightness slider is read-only)", false),
+        numberField("brightness", &Settings::brightness, 128, 0, 255, true, "# Brightness (0-255, default 128)"),
+        boolField("contrast_auto", &Settings::contrastAuto, true, true,
+                  "# Contrast Auto Mode (when enabled, contrast slider is read-only)", false),
+        numberField("contrast", &Settings::contrast, 128, 0, 255, true, "# Contrast (0-255, default 128)"),
+        boolField("saturation_auto", &Settings::saturationAuto, true, true,
+                  "# Saturation Auto Mode (when enabled, saturation slider is read-only)", false),
+        numberField("saturation", &Settings::saturation, 128, 0, 255, true, "# Saturation (0-255, default 128)"),
+        enumField("white_balance", &Settings::whiteBalance, 0, Config::whiteBalanceModes(), true, "# White Balance (auto/daylight/fluorescent/tungsten/flash/fine/cloudy/shade/manual)", false),
+        numberField("white_balance_kelvin", &Settings::whiteBalanceKelvin, 5000, 2000, 10000, false,
+                    "# Manual white balance temperature (Kelvin, only used when white_balance=manual)"),
+
+        boolField("audio_auto_gain", &Settings::audioAutoGain, true, false, "# Audio auto gain control"),
+        appSetting(stringField("preview_format", &Settings::previewFormat, "auto", nullptr, false,
+                               "# Preferred preview format (auto or WIDTHxHEIGHT@FPS)")),
+
+        // Software effects (Creative FX), applied to the preview and the virtual camera
+        numberField("effect_brightness", &VideoEffects::brightness, 0.0, -1.0, 1.0, false,
+                    "# Creative FX, applied in software to the preview and the virtual camera (0 is unchanged)", false),
+        numberField("effect_contrast", &VideoEffects::contrast, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_exposure", &VideoEffects::exposure, 0.0, -2.0, 2.0, false, nullptr, false),
+        numberField("effect_highlights", &VideoEffects::highlights, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_shadows", &VideoEffects::shadows, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_saturation", &VideoEffects::saturation, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_vibrance", &VideoEffects::vibrance, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_temperature", &VideoEffects::temperature, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_tint", &VideoEffects::tint, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_noise", &VideoEffects::noise, 0.0, 0.0, 1.0, false, nullptr, false),
+        numberField("effect_blur", &VideoEffects::blur, 0.0, 0.0, 1.0, false, nullptr, false),
+        numberField("effect_sharpen", &VideoEffects::sharpen, 0.0, 0.0, 1.0, false, nullptr, false),
+        numberField("effect_glow", &VideoEffects::glow, 0.0, 0.0, 1.0, false, nullptr, false),
+        numberField("effect_bloom", &VideoEffects::bloom, 0.0, 0.0, 1.0, false, nullptr, false),
+        numberField("effect_soft_focus", &VideoEffects::softFocus, 0.0, 0.0, 1.0, false, nullptr, false),
+        numberField("effect_duotone", &VideoEffects::duoToneIntensity, 0.0, 0.0, 1.0, false, nullptr, false),
+        numberField("effect_denoise", &VideoEffects::denoise, 0.0, 0.0, 1.0, false, nullptr, false),
+        numberField("effect_digital_zoom", &VideoEffects::digitalZoom, 1.0, 1.0, 4.0, false,
+                    "# Digital PTZ: crop-zoom on top of the camera's zoom (1.0 to 4.0), pan and tilt\n"
+                    "# within the cropped margin (-1.0 to 1.0)", false),
+        numberField("effect_digital_pan", &VideoEffects::digitalPan, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_digital_tilt", &VideoEffects::digitalTilt, 0.0, -1.0, 1.0, false, nullptr, false),
+        numberField("effect_stabilize", &VideoEffects::stabilize, 0.0, 0.0, 1.0, false,
+                    "# Stabilization strength (0.0 to 1.0) and frames held back to see ahead (0 to 8)", false),
+        numberField("effect_stabilize_lookahead", &VideoEffects::stabilizeLookahead, 2, 0, 8, false, nullptr, false),
+        stringField("effect_duotone_shadow", &VideoEffects::duoToneShadow, "1e1e3c", normalizeColor, false,
+                    "# Duo tone colors as rrggbb", false),
+        stringField("effect_duotone_highlight", &VideoEffects::duoToneHighlight, "dcb4a0", normalizeColor, false,
+                    nullptr, false),
+        boolField("effect_mirror", &VideoEffects::horizontalFlip, false, false, "# Mirror (horizontal flip)"),
+
+        // Application settings
+        appSetting(boolField("start_minimized", &Settings::startMinimized, false, true,
+                             "# Application Settings\n# Start application minimized to system tray")),
+        appSetting(stringField("active_profile", &Settings::activeProfile, "", nullptr, false,
+                               "# Profile applied last (profiles/<name>.conf); empty for none")),
+        appSetting(stringField("auto_profile_rules", &Settings::autoProfileRules, "", normalizeProfileRules, false,
+                               "# Switch profile by the application using the camera or virtual camera,\n"
+                               "# e.g. obs=Presentation; chrome=Video Call (first match wins)")),
+        boolField("virtual_camera_enabled", &Settings::virtualCameraEnabled, false, false,
+                  "# Virtual camera output", false),
+        stringField("virtual_camera_device", &Settings::virtualCameraDevice, "/dev/video42", requireDevice, false,
+                    nullptr, false),
+        stringField("virtual_camera_resolution", &Settings::virtualCameraResolution, "match", normalizeResolution,
+                    false, "# Set 'match' to follow the preview output, or WIDTHxHEIGHT (e.g. 1280x720)", false),
+    };
+    return fields;
 }
 
-bool Config::parseLine(const std::string &line, int lineNumber, std::vector<ValidationError> &errors)
+const Field *findField(const std::string &key)
 {
-    size_t equals = line.find('=');
-    if (equals == std::string::npos) return false;
+    static const std::unordered_map<std::string, const Field *> index = []() {
+        std::unordered_map<std::string, const Field *> byKey;
+        for (const auto &field : schema()) {
+            byKey.emplace(field.key, &field);
+        }
+        return byKey;
+    }();
 
-    std::string key = line.substr(0, equals);
-    std::string value = line.substr(equals + 1);
+    auto it = index.find(key);
+    return it == index.end() ? nullptr : it->second;
+}
 
-    auto addError = [&](ValidationResult type, const std::string &msg) {
-        ValidationError err;
-        err.type = type;
-        err.message = msg;
-        err.lineNumber = lineNumber;
-        errors.push_back(err);
+} // namespace
+
+const std::vector<std::pair<std::string, int>> &Config::whiteBalanceModes()
+{
+    static const std::vector<std::pair<std::string, int>> modes = {
+        {"auto", 0}, {"daylight", 1}, {"fluorescent", 2}, {"tungsten", 3}, {"flash", 4},
+        {"fine", 9}, {"cloudy", 10}, {"shade", 11}, {"manual", 255},
     };
+    return modes;
+}
 
-    // Parse boolean values
-    auto parseBool = [&](const std::string &val, bool &out) -> bool {
-        if (val == "true" || val == "enabled" || val == "yes" || val == "1") {
-            out = true;
-            return true;
-        } else if (val == "false" || val == "disabled" || val == "no" || val == "0") {
-            out = false;
-            return true;
-        }
+bool Config::isValidSequenceName(const std::string &name)
+{
+    if (name.empty() || name.size() > 32) {
         return false;
-    };
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-';
+    });
+}
 
-    for (int i = 0; i < 3; ++i) {
-        std::string base = "preset" + std::to_string(i + 1) + "_";
-        if (key.rfind(base, 0) == 0) {
-            auto &preset = m_settings.presets[static_cast<size_t>(i)];
-            std::string suffix = key.substr(base.size());
+bool Config::parseKeyframes(const std::string &text, std::vector<CameraSettings::Keyframe> &keyframes,
+                            std::string &error)
+{
+    keyframes.clear();
+    std::stringstream entries(text);
+    std::string entry;
 
-            if (suffix == "defined") {
-                if (!parseBool(value, preset.defined)) {
-                    addError(InvalidValue, base + "defined must be true/false or enabled/disabled");
-                    return false;
-                }
-                return true;
-            } else if (suffix == "pan") {
-                try {
-                    double pan = std::stod(value);
-                    if (pan < -1.0 || pan > 1.0) {
-                        addError(InvalidValue, base + "pan must be between -1.0 and 1.0");
-                        return false;
-                    }
-                    preset.pan = pan;
-                } catch (...) {
-                    addError(InvalidValue, base + "pan must be a number between -1.0 and 1.0");
-                    return false;
-                }
-                return true;
-            } else if (suffix == "tilt") {
-                try {
-                    double tilt = std::stod(value);
-                    if (tilt < -1.0 || tilt > 1.0) {
-                        addError(InvalidValue, base + "tilt must be between -1.0 and 1.0");
-                        return false;
-                    }
-                    preset.tilt = tilt;
-                } catch (...) {
-                    addError(InvalidValue, base + "tilt must be a number between -1.0 and 1.0");
-                    return false;
-                }
-                return true;
-            } else if (suffix == "zoom") {
-                try {
-                    double zoom = std::stod(value);
-                    if (zoom < 1.0 || zoom > 2.0) {
-                        addError(InvalidValue, base + "zoom must be between 1.0 and 2.0");
-                        return false;
-                    }
-                    preset.zoom = zoom;
-                } catch (...) {
-                    addError(InvalidValue, base + "zoom must be a number between 1.0 and 2.0");
-                    return false;
-                }
-                return true;
-            }
+    while (std::getline(entries, entry, ';')) {
+        if (entry.find_first_not_of(" \t") == std::string::npos) {
+            continue;  // Tolerate a trailing ';'
         }
-    }
 
-    if (key == "face_tracking") {
-        if (!parseBool(value, m_settings.faceTracking)) {
-            addError(InvalidValue, "face_tracking must be true/false or enabled/disabled");
-            return false;
-        }
-    } else if (key == "hdr") {
-        if (!parseBool(value, m_settings.hdr)) {
-            addError(InvalidValue, "hdr must be true/false or enabled/disabled");
-            return false;
-        }
-    } else if (key == "face_ae") {
-        if (!parseBool(value, m_settings.faceAE)) {
-            addError(InvalidValue, "face_ae must be true/false or enabled/disabled");
-            return false;
-        }
-    } else if (key == "face_focus") {
-        if (!parseBool(value, m_settings.faceFocus)) {
-            addError(InvalidValue, "face_focus must be true/false or enabled/disabled");
-            return false;
-        }
-    } else if (key == "fov") {
-        if (value == "wide" || value == "0") {
-            m_settings.fov = 0;
-        } else if (value == "medium" || value == "1") {
-            m_settings.fov = 1;
-        } else if (value == "narrow" || value == "2") {
-            m_settings.fov = 2;
-        } else {
-            addError(InvalidValue, "fov must be wide/medium/narrow or 0/1/2");
-            return false;
-        }
-    } else if (key == "zoom") {
-        try {
-            double zoom = std::stod(value);
-            if (zoom < 1.0 || zoom > 2.0) {
-                addError(InvalidValue, "zoom must be between 1.0 and 2.0");
-                return false;
-            }
-            m_settings.zoom = zoom;
-        } catch (...) {
-            addError(InvalidValue, "zoom must be a number between 1.0 and 2.0");
+        std::istringstream fields(entry);
+        CameraSettings::Keyframe keyframe{0, 0.0, 0.0, 1.0, CameraSettings::EaseInOut};
+        std::string easing;
+        if (!(fields >> keyframe.timeMs >> keyframe.pan >> keyframe.tilt >> keyframe.zoom)) {
+            error = "keyframe '" + entry + "' must be <ms> <pan> <tilt> <zoom> [easing]";
             return false;
         }
-    } else if (key == "pan") {
-        try {
-            double pan = std::stod(value);
-            if (pan < -1.0 || pan > 1.0) {
-                addError(InvalidValue, "pan must be between -1.0 and 1.0");
+        if (fields >> easing) {
+            auto it = std::find_if(std::begin(kEasingNames), std::end(kEasingNames),
+                                   [&easing](const auto &named) { return easing == named.first; });
+            if (it == std::end(kEasingNames)) {
+                error = "unknown easing '" + easing + "' (linear/ease-in/ease-out/ease-in-out/hold)";
                 return false;
             }
-            m_settings.pan = pan;
-        } catch (...) {
-            addError(InvalidValue, "pan must be a number between -1.0 and 1.0");
-            return false;
-        }
-    } else if (key == "tilt") {
-        try {
-            double tilt = std::stod(value);
-            if (tilt < -1.0 || tilt > 1.0) {
-                addError(InvalidValue, "tilt must be between -1.0 and 1.0");
-                return false;
-            }
-            m_settings.tilt = tilt;
-        } catch (...) {
-            addError(InvalidValue, "tilt must be a number between -1.0 and 1.0");
-            return false;
+            keyframe.easing = it->second;
         }
-    } else if (key == "ai_mode") {
-        try {
-            int mode = std::stoi(value);
-            if (mode < 0 || mode > 6) {
-                addError(InvalidValue, "ai_mode must be between 0 and 6");
-                return false;
-            }
-            m_settings.aiMode = mode;
-        } catch (...) {
-            addError(InvalidValue, "ai_mode must be an integer between 0 and 6");
+        std::string extra;
+        if (fields >> extra) {
+            error = "unexpected '" + extra + "' in keyframe '" + entry + "'";
             return false;
         }
-    } else if (key == "ai_sub_mode") {
-        try {
-            int subMode = std::stoi(value);
-            if (subMode < 0 || subMode > 5) {
-                addError(InvalidValue, "ai_sub_mode must be between 0 and 5");
-                return false;
-            }
-            m_settings.aiSubMode = subMode;
-        } catch (...) {
-            addError(InvalidValue, "ai_sub_mode must be an integer between 0 and 5");
+
+        keyframes.push_back(keyframe);
+    }
+
+    return checkKeyframes(keyframes, error);
+}
+
+bool Config::checkKeyframes(const std::vector<CameraSettings::Keyframe> &keyframes, std::string &error)
+{
+    if (keyframes.empty()) {
+        error = "sequence has no keyframes";
+        return false;
+    }
+    if (static_cast<int>(keyframes.size()) > kMaxKeyframes) {
+        error = "sequence has more than " + std::to_string(kMaxKeyframes) + " keyframes";
+        return false;
+    }
+
+    for (size_t i = 0; i < keyframes.size(); ++i) {
+        const auto &keyframe = keyframes[i];
+        if (keyframe.timeMs < 0 || (i > 0 && keyframe.timeMs <= keyframes[i - 1].timeMs)) {
+            error = "keyframe times must start at 0 or later and increase";
             return false;
         }
-    } else if (key == "auto_zoom") {
-        if (!parseBool(value, m_settings.autoZoom)) {
-            addError(InvalidValue, "auto_zoom must be true/false or enabled/disabled");
+        if (keyframe.pan < -1.0 || keyframe.pan > 1.0 || keyframe.tilt < -1.0 || keyframe.tilt > 1.0) {
+            error = "keyframe pan/tilt must be between -1.0 and 1.0";
             return false;
         }
-    } else if (key == "track_speed") {
-        try {
-            int trackSpeed = std::stoi(value);
-            if (trackSpeed < 0 || trackSpeed > 5) {
-                addError(InvalidValue, "track_speed must be between 0 and 5");
-                return false;
-            }
-            m_settings.trackSpeed = trackSpeed;
-        } catch (...) {
-            addError(InvalidValue, "track_speed must be an integer between 0 and 5");
+        if (keyframe.zoom < 1.0 || keyframe.zoom > 2.0) {
+            error = "keyframe zoom must be between 1.0 and 2.0";
             return false;
         }
-    } else if (key == "brightness_auto") {
-        if (!parseBool(value, m_settings.brightnessAuto)) {
-            addError(InvalidValue, "brightness_auto must be true/false or enabled/disabled");
-            return false;
+    }
+    return true;
+}
+
+std::string Config::formatKeyframes(const std::vector<CameraSettings::Keyframe> &keyframes)
+{
+    std::ostringstream out;
+    for (size_t i = 0; i < keyframes.size(); ++i) {
+        const auto &keyframe = keyframes[i];
+        if (i > 0) {
+            out << "; ";
         }
-    } else if (key == "brightness") {
-        try {
-            int brightness = std::stoi(value);
-            if (brightness < 0 || brightness > 255) {
-                addError(InvalidValue, "brightness must be between 0 and 255");
-                return false;
+        out << keyframe.timeMs << " " << keyframe.pan << " " << keyframe.tilt << " " << keyframe.zoom;
+        for (const auto &named : kEasingNames) {
+            if (named.second == keyframe.easing) {
+                out << " " << named.first;
             }
-            m_settings.brightness = brightness;
-        } catch (...) {
-            addError(InvalidValue, "brightness must be an integer between 0 and 255");
-            return false;
-        }
-    } else if (key == "contrast_auto") {
-        if (!parseBool(value, m_settings.contrastAuto)) {
-            addError(InvalidValue, "contrast_auto must be true/false or enabled/disabled");
-            return false;
         }
-    } else if (key == "contrast") {
-        try {
-            int contrast = std::stoi(value);
-            if (contrast < 0 || contrast > 255) {
-                addError(InvalidValue, "contrast must be between 0 and 255");
-                return false;
-            }
-            m_settings.contrast = contrast;
-        } catch (...) {
-            addError(InvalidValue, "contrast must be an integer between 0 and 255");
-            return false;
+    }
+    return out.str();
+}
+
+Config::Config()
+    : m_savingEnabled(true)
+    , m_savedHash(0)
+    , m_haveSavedHash(false)
+{
+    setDefaults();
+}
+
+Config::~Config()
+{
+}
+
+void Config::setDefaults()
+{
+    for (const auto &field : schema()) {
+        field.reset(m_settings);
+    }
+    m_settings.presets.assign(kDefaultPresetCount, {false, 0.0, 0.0, 1.0});
+    m_settings.sequences.clear();
+}
+
+std::string Config::getXdgConfigHome() const
+{
+    const char *xdg = std::getenv("XDG_CONFIG_HOME");
+    if (xdg && xdg[0] != '\0') {
+        return std::string(xdg);
+    }
+
+    const char *home = std::getenv("HOME");
+    if (home) {
+        return std::string(home) + "/.config";
+    }
+
+    return ".config";  // Fallback
+}
+
+std::string Config::getConfigPath() const
+{
+    return getXdgConfigHome() + "/obsbot-control/settings.conf";
+}
+
+bool Config::configExists() const
+{
+    std::ifstream file(getConfigPath());
+    return file.good();
+}
+
+bool Config::load(std::vector<ValidationError> &errors)
+{
+    errors.clear();
+    std::string configPath = getConfigPath();
+
+    std::ifstream input(configPath);
+    if (!input.is_open()) {
+        // No config file is not an error - we'll use defaults
+        return true;
+    }
+
+    // Read it whole: its hash lets an unchanged save skip the write
+    const std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_savedHash = std::hash<std::string>{}(content);
+        m_haveSavedHash = true;
+    }
+    return parse(content, errors);
+}
+
+bool Config::parse(const std::string &content, std::vector<ValidationError> &errors)
+{
+    return parseContent(content, false, errors);
+}
+
+bool Config::parseContent(const std::string &content, bool profile, std::vector<ValidationError> &errors)
+{
+    errors.clear();
+
+    auto addError = [&errors](ValidationResult type, const std::string &message, int lineNumber) {
+        ValidationError err;
+        err.type = type;
+        err.message = message;
+        err.lineNumber = lineNumber;
+        errors.push_back(err);
+    };
+
+    const auto &fields = schema();
+    std::vector<bool> found(fields.size(), false);
+
+    // Scan the content in place; only the key and value of each line are copied
+    static const char *const kSpace = " \t\r";
+    std::string key;
+    std::string value;
+    int lineNumber = 0;
+
+    // Sequences are matched by name and unbounded in number; keep a lookup
+    // so a file with many of them loads in linear time
+    std::unordered_map<std::string, size_t> sequenceIndex;
+    for (size_t i = 0; i < m_settings.sequences.size(); ++i) {
+        sequenceIndex.emplace(m_settings.sequences[i].name, i);
+    }
+
+    for (size_t lineStart = 0; lineStart < content.size();) {
+        size_t lineEnd = content.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = content.size();
         }
-    } else if (key == "saturation_auto") {
-        if (!parseBool(value, m_settings.saturationAuto)) {
-            addError(InvalidValue, "saturation_auto must be true/false or enabled/disabled");
-            return false;
+        const size_t next = lineEnd + 1;
+        lineNumber++;
+
+        // Trim leading whitespace; skip empty lines and comments
+        size_t start = content.find_first_not_of(kSpace, lineStart);
+        if (start >= lineEnd || content[start] == '#') {
+            lineStart = next;
+            continue;
         }
-    } else if (key == "saturation") {
-        try {
-            int saturation = std::stoi(value);
-            if (saturation < 0 || saturation > 255) {
-                addError(InvalidValue, "saturation must be between 0 and 255");
-                return false;
-            }
-            m_settings.saturation = saturation;
-        } catch (...) {
-            addError(InvalidValue, "saturation must be an integer between 0 and 255");
-            return false;
+
+        // Parse key=value; an inline comment ends the value
+        const auto lineBegin = content.begin();
+        const size_t equals = std::find(lineBegin + start, lineBegin + lineEnd, '=') - lineBegin;
+        if (equals == lineEnd) {
+            addError(MalformedLine, "Expected format: key=value", lineNumber);
+            lineStart = next;
+            continue;
         }
-    } else if (key == "white_balance") {
-        if (value == "auto" || value == "0") {
-            m_settings.whiteBalance = 0;
-        } else if (value == "daylight" || value == "1") {
-            m_settings.whiteBalance = 1;
-        } else if (value == "fluorescent" || value == "2") {
-            m_settings.whiteBalance = 2;
-        } else if (value == "tungsten" || value == "3") {
-            m_settings.whiteBalance = 3;
-        } else if (value == "flash" || value == "4") {
-            m_settings.whiteBalance = 4;
-        } else if (value == "fine" || value == "9") {
-            m_settings.whiteBalance = 9;
-        } else if (value == "cloudy" || value == "10") {
-            m_settings.whiteBalance = 10;
-        } else if (value == "shade" || value == "11") {
-            m_settings.whiteBalance = 11;
-        } else if (value == "manual" || value == "255") {
-            m_settings.whiteBalance = 255;
-        } else {
-            addError(InvalidValue, "white_balance must be auto/daylight/fluorescent/tungsten/flash/fine/cloudy/shade/manual or numeric");
-            return false;
+        const size_t valueEnd = std::find(lineBegin + equals + 1, lineBegin + lineEnd, '#') - lineBegin;
+
+        key.assign(content, start, equals - start);
+        key.erase(key.find_last_not_of(kSpace) + 1);
+        value.assign(content, equals + 1, valueEnd - equals - 1);
+        value.erase(0, value.find_first_not_of(kSpace));
+        value.erase(value.find_last_not_of(kSpace) + 1);
+        lineStart = next;
+
+        const Field *field = findField(key);
+        if (field && profile && !field->inProfile) {
+            addError(UnknownProperty, "'" + key + "' cannot be set by a profile", lineNumber);
+            continue;
         }
-    } else if (key == "white_balance_kelvin") {
-        try {
-            int kelvin = std::stoi(value);
-            if (kelvin < 2000 || kelvin > 10000) {
-                addError(InvalidValue, "white_balance_kelvin must be between 2000 and 10000");
-                return false;
+        if (field) {
+            found[static_cast<size_t>(field - fields.data())] = true;
+            std::string error;
+            if (!field->parse(m_settings, value, error)) {
+                addError(InvalidValue, error, lineNumber);
             }
-            m_settings.whiteBalanceKelvin = kelvin;
-        } catch (...) {
-            addError(InvalidValue, "white_balance_kelvin must be an integer between 2000 and 10000");
-            return false;
-        }
-    } else if (key == "audio_auto_gain") {
-        if (!parseBool(value, m_settings.audioAutoGain)) {
-            addError(InvalidValue, "audio_auto_gain must be true/false or enabled/disabled");
-            return false;
+            continue;
         }
-    } else if (key == "preview_format") {
-        m_settings.previewFormat = value;
-    } else if (key == "start_minimized") {
-        if (!parseBool(value, m_settings.startMinimized)) {
-            addError(InvalidValue, "start_minimized must be true/false or enabled/disabled");
-            return false;
+
+        std::string error;
+        if (profile) {
+            addError(UnknownProperty, "Unknown property '" + key + "'", lineNumber);
+            continue;
         }
-    } else if (key == "virtual_camera_enabled") {
-        if (!parseBool(value, m_settings.virtualCameraEnabled)) {
-            addError(InvalidValue, "virtual_camera_enabled must be true/false or enabled/disabled");
-            return false;
+        switch (parseIndexedKey(key, value, sequenceIndex, error)) {
+        case KeyParsed:
+            break;
+        case KeyInvalid:
+            addError(InvalidValue, error, lineNumber);
+            break;
+        case KeyUnknown:
+            addError(UnknownProperty, "Unknown property '" + key + "'", 0);
+            break;
         }
-    } else if (key == "virtual_camera_device") {
-        if (value.empty()) {
-            addError(InvalidValue, "virtual_camera_device cannot be empty");
-            return false;
+    }
+
+    // Check for missing required properties; a profile only sets what it lists
+    for (size_t i = 0; i < fields.size() && !profile; ++i) {
+        if (fields[i].required && !found[i]) {
+            addError(MissingProperty, "Required property '" + std::string(fields[i].key) + "' not found", 0);
         }
-        m_settings.virtualCameraDevice = value;
-    } else if (key == "virtual_camera_resolution") {
-        if (value.empty()) {
-            m_settings.virtualCameraResolution = "match";
-            return true;
+    }
+
+    return errors.empty();
+}
+
+Config::IndexedKeyResult Config::parseIndexedKey(const std::string &key, const std::string &value,
+                                                 std::unordered_map<std::string, size_t> &sequenceIndex,
+                                                 std::string &error)
+{
+    int presetIndex = 0;
+    std::string suffix;
+    if (splitPresetKey(key, presetIndex, suffix)) {
+        const std::string &name = key;
+        CameraSettings::PresetSlot slot = static_cast<size_t>(presetIndex) < m_settings.presets.size()
+            ? m_settings.presets[static_cast<size_t>(presetIndex)]
+            : CameraSettings::PresetSlot{false, 0.0, 0.0, 1.0};
+
+        bool ok;
+        if (suffix == "defined") {
+            ok = parseBool(value, slot.defined);
+            if (!ok) {
+                error = name + " must be true/false or enabled/disabled";
+            }
+        } else if (suffix == "pan") {
+            ok = parseInRange(name, value, -1.0, 1.0, slot.pan, error);
+        } else if (suffix == "tilt") {
+            ok = parseInRange(name, value, -1.0, 1.0, slot.tilt, error);
+        } else if (suffix == "zoom") {
+            ok = parseInRange(name, value, 1.0, 2.0, slot.zoom, error);
+        } else {
+            return KeyUnknown;
         }
 
-        std::string normalized = value;
-        std::replace(normalized.begin(), normalized.end(), 'X', 'x');
+        if (m_settings.presets.size() <= static_cast<size_t>(presetIndex)) {
+            m_settings.presets.resize(static_cast<size_t>(presetIndex) + 1, {false, 0.0, 0.0, 1.0});
+        }
+        m_settings.presets[static_cast<size_t>(presetIndex)] = slot;
+        return ok ? KeyParsed : KeyInvalid;
+    }
 
-        if (normalized == "match") {
-            m_settings.virtualCameraResolution = normalized;
-            return true;
+    std::string sequenceName;
+    if (splitSequenceKey(key, sequenceName, suffix)) {
+        std::vector<CameraSettings::Keyframe> keyframes;
+        if (suffix != "hotkey" && !parseKeyframes(value, keyframes, error)) {
+            error = key + ": " + error;
+            return KeyInvalid;
         }
 
-        size_t sep = normalized.find('x');
-        if (sep == std::string::npos) {
-            addError(InvalidValue, "virtual_camera_resolution must be 'match' or WIDTHxHEIGHT (e.g. 1280x720)");
-            return false;
+        auto &sequences = m_settings.sequences;
+        const auto [entry, added] = sequenceIndex.emplace(sequenceName, sequences.size());
+        if (added) {
+            sequences.push_back({sequenceName, std::string(), {}});
         }
 
-        try {
-            const int width = std::stoi(normalized.substr(0, sep));
-            const int height = std::stoi(normalized.substr(sep + 1));
-            if (width <= 0 || height <= 0) {
-                addError(InvalidValue, "virtual_camera_resolution width and height must be greater than zero");
-                return false;
-            }
-            m_settings.virtualCameraResolution = std::to_string(width) + "x" + std::to_string(height);
-        } catch (...) {
-            addError(InvalidValue, "virtual_camera_resolution must be 'match' or WIDTHxHEIGHT (e.g. 1280x720)");
-            return false;
+        auto &sequence = sequences[entry->second];
+        if (suffix == "hotkey") {
+            sequence.hotkey = value;
+        } else {
+            sequence.keyframes = std::move(keyframes);
         }
+        return KeyParsed;
     }
 
-    return true;
+    return KeyUnknown;
 }
 
 bool Config::validateSettings(std::vector<ValidationError> &errors)
@@ -581,37 +920,10 @@ bool Config::validateSettings(std::vector<ValidationError> &errors)
         errors.push_back(err);
     };
 
-    if (m_settings.fov < 0 || m_settings.fov > 2) {
-        addError("fov out of range (must be 0-2)");
-    }
-
-    if (m_settings.zoom < 1.0 || m_settings.zoom > 2.0) {
-        addError("zoom out of range (must be 1.0-2.0)");
-    }
-
-    if (m_settings.pan < -1.0 || m_settings.pan > 1.0) {
-        addError("pan out of range (must be -1.0 to 1.0)");
-    }
-
-    if (m_settings.tilt < -1.0 || m_settings.tilt > 1.0) {
-        addError("tilt out of range (must be -1.0 to 1.0)");
-    }
-
-    if (m_settings.aiMode < 0 || m_settings.aiMode > 6) {
-        addError("ai_mode out of range (must be 0-6)");
-    }
-
-    if (m_settings.aiSubMode < 0 || m_settings.aiSubMode > 5) {
-        addError("ai_sub_mode out of range (must be 0-5)");
-    }
-
-    if (m_settings.trackSpeed < 0 || m_settings.trackSpeed > 5) {
-        addError("track_speed out of range (must be 0-5)");
-    }
-
-    if (m_settings.whiteBalance == 255) {
-        if (m_settings.whiteBalanceKelvin < 2000 || m_settings.whiteBalanceKelvin > 10000) {
-            addError("white_balance_kelvin out of range (must be 2000-10000)");
+    for (const auto &field : schema()) {
+        std::string error;
+        if (!field.check(m_settings, error)) {
+            addError(error);
         }
     }
 
@@ -631,27 +943,12 @@ bool Config::validateSettings(std::vector<ValidationError> &errors)
         }
     }
 
-    if (m_settings.virtualCameraDevice.empty()) {
-        addError("virtual_camera_device cannot be empty");
-    }
-
-    if (m_settings.virtualCameraResolution.empty()) {
-        addError("virtual_camera_resolution cannot be empty");
-    } else if (m_settings.virtualCameraResolution != "match") {
-        const std::string &res = m_settings.virtualCameraResolution;
-        size_t sep = res.find('x');
-        if (sep == std::string::npos) {
-            addError("virtual_camera_resolution must be 'match' or WIDTHxHEIGHT (e.g. 1280x720)");
-        } else {
-            try {
-                const int width = std::stoi(res.substr(0, sep));
-                const int height = std::stoi(res.substr(sep + 1));
-                if (width <= 0 || height <= 0) {
-                    addError("virtual_camera_resolution width and height must be greater than zero");
-                }
-            } catch (...) {
-                addError("virtual_camera_resolution must be 'match' or WIDTHxHEIGHT (e.g. 1280x720)");
-            }
+    for (const auto &sequence : m_settings.sequences) {
+        std::string error;
+        if (!isValidSequenceName(sequence.name)) {
+            addError("sequence name '" + sequence.name + "' must be letters, digits and '-'");
+        } else if (!checkKeyframes(sequence.keyframes, error)) {
+            addError("sequence_" + sequence.name + ": " + error);
         }
     }
 
@@ -660,31 +957,16 @@ bool Config::validateSettings(std::vector<ValidationError> &errors)
 
 bool Config::save()
 {
-    std::cout << "[Config] save() called, savingEnabled=" << m_savingEnabled << ", startMinimized=" << m_settings.startMinimized << std::endl;
-
     if (!m_savingEnabled) {
         std::cout << "[Config] save() aborted - saving disabled" << std::endl;
         return false;
     }
+    return writeSerialized(serialize());
+}
 
-    std::string configPath = getConfigPath();
-    std::string configDir = configPath.substr(0, configPath.find_last_of('/'));
-
-    // Create config directory if it doesn't exist
-    struct stat st;
-    if (stat(configDir.c_str(), &st) != 0) {
-        // Directory doesn't exist, create it
-        if (mkdir(configDir.c_str(), 0755) != 0) {
-            std::cerr << "Failed to create config directory: " << configDir << std::endl;
-            return false;
-        }
-    }
-
-    std::ofstream file(configPath);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open config file for writing: " << configPath << std::endl;
-        return false;
-    }
+std::string Config::serialize() const
+{
+    std::ostringstream file;
 
     file << "# OBSBOT Control Configuration\n";
     file << "# Auto-generated settings file\n";
@@ -694,107 +976,326 @@ bool Config::save()
     file << "# Numeric ranges: zoom (1.0-2.0), pan/tilt (-1.0 to 1.0)\n";
     file << "\n";
 
-    file << "# Enable automatic face tracking\n";
-    file << "face_tracking=" << (m_settings.faceTracking ? "enabled" : "disabled") << "\n\n";
+    for (const auto &field : schema()) {
+        if (field.comment) {
+            file << field.comment << "\n";
+        }
+        file << field.key << "=" << field.format(m_settings) << "\n";
+        if (field.blankLineAfter) {
+            file << "\n";
+        }
+    }
 
-    file << "# High Dynamic Range\n";
-    file << "hdr=" << (m_settings.hdr ? "enabled" : "disabled") << "\n\n";
+    for (size_t i = 0; i < m_settings.presets.size(); ++i) {
+        const auto &preset = m_settings.presets[i];
+        file << "\n# PTZ Preset " << (i + 1) << "\n";
+        file << "preset" << (i + 1) << "_defined=" << (preset.defined ? "enabled" : "disabled") << "\n";
+        file << "preset" << (i + 1) << "_pan=" << preset.pan << "\n";
+        file << "preset" << (i + 1) << "_tilt=" << preset.tilt << "\n";
+        file << "preset" << (i + 1) << "_zoom=" << preset.zoom << "\n";
+    }
 
-    file << "# Field of View (wide/medium/narrow)\n";
-    std::string fovStr = m_settings.fov == 0 ? "wide" : (m_settings.fov == 1 ? "medium" : "narrow");
-    file << "fov=" << fovStr << "\n\n";
+    if (!m_settings.sequences.empty()) {
+        file << "\n# PTZ sequences: sequence_<name>=<ms> <pan> <tilt> <zoom> [easing]; ...\n";
+        file << "# Easing: linear/ease-in/ease-out/ease-in-out/hold. Optional sequence_<name>_hotkey=Ctrl+Alt+1\n";
+        for (const auto &sequence : m_settings.sequences) {
+            if (sequence.keyframes.empty()) {
+                continue;  // Nothing to play yet; an empty value would not load back
+            }
+            file << "sequence_" << sequence.name << "=" << formatKeyframes(sequence.keyframes) << "\n";
+            if (!sequence.hotkey.empty()) {
+                file << "sequence_" << sequence.name << "_hotkey=" << sequence.hotkey << "\n";
+            }
+        }
+    }
 
-    file << "# Face-based Auto Exposure\n";
-    file << "face_ae=" << (m_settings.faceAE ? "enabled" : "disabled") << "\n\n";
+    return file.str();
+}
 
-    file << "# Face-based Auto Focus\n";
-    file << "face_focus=" << (m_settings.faceFocus ? "enabled" : "disabled") << "\n\n";
+bool Config::writeSerialized(const std::string &content)
+{
+    Trace::Scope trace("config.write");
+    const size_t hash = std::hash<std::string>{}(content);
+    const std::string configPath = getConfigPath();
 
-    file << "# Zoom level (1.0 to 2.0)\n";
-    file << "zoom=" << m_settings.zoom << "\n\n";
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    if (m_haveSavedHash && hash == m_savedHash) {
+        ++m_saveStats.unchanged;
+        return true;
+    }
 
-    file << "# Pan position (-1.0 to 1.0, 0 is center)\n";
-    file << "pan=" << m_settings.pan << "\n\n";
+    const auto start = std::chrono::steady_clock::now();
+
+    // Create config directory (and ~/.config on a fresh account) if needed
+    if (!makeParentDirectories(configPath)) {
+        std::cerr << "[Config] Failed to create config directory: "
+                  << configPath.substr(0, configPath.find_last_of('/')) << std::endl;
+        ++m_saveStats.failures;
+        return false;
+    }
 
-    file << "# Tilt position (-1.0 to 1.0, 0 is center)\n";
-    file << "tilt=" << m_settings.tilt << "\n\n";
+    std::string error;
+    if (!writeFileAtomically(configPath, content, error)) {
+        std::cerr << "[Config] " << error << std::endl;
+        ++m_saveStats.failures;
+        return false;
+    }
 
-    file << "# AI Tracking Mode (0=None,1=Group,2=Human,3=Hand,4=Whiteboard,5=Desk)\n";
-    file << "ai_mode=" << m_settings.aiMode << "\n\n";
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ++m_saveStats.writes;
+    m_saveStats.totalWriteMs += ms;
+    m_saveStats.maxWriteMs = std::max(m_saveStats.maxWriteMs, ms);
+    m_savedHash = hash;
+    m_haveSavedHash = true;
 
-    file << "# AI Human Sub-Mode (0=Normal,1=UpperBody,2=CloseUp,3=Headless,4=LowerBody)\n";
-    file << "ai_sub_mode=" << m_settings.aiSubMode << "\n\n";
+    std::cout << "[Config] Configuration saved to " << configPath << " (" << ms << " ms)" << std::endl;
+    return true;
+}
+
+bool Config::isSavedContent(const std::string &content) const
+{
+    const size_t hash = std::hash<std::string>{}(content);
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    return m_haveSavedHash && hash == m_savedHash;
+}
+
+void Config::acceptExternalEdit(const CameraSettings &settings, const std::string &content)
+{
+    m_settings = settings;
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_savedHash = std::hash<std::string>{}(content);
+    m_haveSavedHash = true;
+}
 
-    file << "# Enable AI Auto Zoom\n";
-    file << "auto_zoom=" << (m_settings.autoZoom ? "enabled" : "disabled") << "\n\n";
+std::vector<std::string> Config::changedKeys(const CameraSettings &before, const CameraSettings &after)
+{
+    std::vector<std::string> keys;
+    auto check = [&keys](const char *key, bool changed) {
+        if (changed) {
+            keys.push_back(key);
+        }
+    };
 
-    file << "# Tracking Speed (0=Lazy,1=Slow,2=Standard,3=Fast,4=Crazy,5=Auto)\n";
-    file << "track_speed=" << m_settings.trackSpeed << "\n\n";
+    for (const auto &field : schema()) {
+        check(field.key, !field.same(before, after));
+    }
 
-    // Image controls
-    file << "# Brightness Auto Mode (when enabled, brightness slider is read-only)\n";
-    file << "brightness_auto=" << (m_settings.brightnessAuto ? "enabled" : "disabled") << "\n";
-    file << "# Brightness (0-255, default 128)\n";
-    file << "brightness=" << m_settings.brightness << "\n\n";
+    auto sameSlot = [](const CameraSettings::PresetSlot &a, const CameraSettings::PresetSlot &b) {
+        return a.defined == b.defined && (!a.defined || (a.pan == b.pan && a.tilt == b.tilt && a.zoom == b.zoom));
+    };
+    const CameraSettings::PresetSlot undefined{false, 0.0, 0.0, 1.0};
+    bool presetsChanged = false;
+    for (size_t i = 0; i < std::max(before.presets.size(), after.presets.size()); ++i) {
+        const auto &a = i < before.presets.size() ? before.presets[i] : undefined;
+        const auto &b = i < after.presets.size() ? after.presets[i] : undefined;
+        presetsChanged = presetsChanged || !sameSlot(a, b);
+    }
+    check("presets", presetsChanged);
 
-    file << "# Contrast Auto Mode (when enabled, contrast slider is read-only)\n";
-    file << "contrast_auto=" << (m_settings.contrastAuto ? "enabled" : "disabled") << "\n";
-    file << "# Contrast (0-255, default 128)\n";
-    file << "contrast=" << m_settings.contrast << "\n\n";
+    auto sameSequences = [](const std::vector<CameraSettings::Sequence> &a, const std::vector<CameraSettings::Sequence> &b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].name != b[i].name || a[i].hotkey != b[i].hotkey ||
+                formatKeyframes(a[i].keyframes) != formatKeyframes(b[i].keyframes)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    check("sequences", !sameSequences(before.sequences, after.sequences));
+    return keys;
+}
 
-    file << "# Saturation Auto Mode (when enabled, saturation slider is read-only)\n";
-    file << "saturation_auto=" << (m_settings.saturationAuto ? "enabled" : "disabled") << "\n";
-    file << "# Saturation (0-255, default 128)\n";
-    file << "saturation=" << m_settings.saturation << "\n\n";
+bool Config::isValidProfileName(const std::string &name)
+{
+    if (name.empty() || name.size() > 32 || name.front() == ' ' || name.back() == ' ') {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == ' ' || c == '-' || c == '_';
+    });
+}
 
-    file << "# White Balance (auto/daylight/fluorescent/tungsten/flash/fine/cloudy/shade)\n";
-    std::string wbStr;
-    switch (m_settings.whiteBalance) {
-        case 0: wbStr = "auto"; break;
-        case 1: wbStr = "daylight"; break;
-        case 2: wbStr = "fluorescent"; break;
-        case 3: wbStr = "tungsten"; break;
-        case 4: wbStr = "flash"; break;
-        case 9: wbStr = "fine"; break;
-        case 10: wbStr = "cloudy"; break;
-        case 11: wbStr = "shade"; break;
-        case 255: wbStr = "manual"; break;
-        default: wbStr = "auto";
+std::vector<std::string> Config::profileKeys()
+{
+    std::vector<std::string> keys;
+    for (const auto &field : schema()) {
+        if (field.inProfile) {
+            keys.push_back(field.key);
+        }
     }
-    file << "white_balance=" << wbStr << "\n";
-    file << "# Manual white balance temperature (Kelvin, only used when white_balance=manual)\n";
-    file << "white_balance_kelvin=" << m_settings.whiteBalanceKelvin << "\n\n";
+    return keys;
+}
 
-    for (size_t i = 0; i < m_settings.presets.size(); ++i) {
-        const auto &preset = m_settings.presets[i];
-        file << "# PTZ Preset " << (i + 1) << "\n";
-        file << "preset" << (i + 1) << "_defined=" << (preset.defined ? "enabled" : "disabled") << "\n";
-        file << "preset" << (i + 1) << "_pan=" << preset.pan << "\n";
-        file << "preset" << (i + 1) << "_tilt=" << preset.tilt << "\n";
-        file << "preset" << (i + 1) << "_zoom=" << preset.zoom << "\n\n";
+std::string Config::getProfileDir() const
+{
+    return getXdgConfigHome() + "/obsbot-control/profiles";
+}
+
+std::vector<std::string> Config::profileNames() const
+{
+    static const std::string extension = ".conf";
+    std::vector<std::string> names;
+
+    DIR *dir = opendir(getProfileDir().c_str());
+    if (!dir) {
+        return names;  // No profiles saved yet
+    }
+    while (const dirent *entry = readdir(dir)) {
+        const std::string fileName = entry->d_name;
+        if (fileName.size() <= extension.size() ||
+            fileName.compare(fileName.size() - extension.size(), extension.size(), extension) != 0) {
+            continue;
+        }
+        const std::string name = fileName.substr(0, fileName.size() - extension.size());
+        if (isValidProfileName(name)) {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+bool Config::saveProfile(const std::string &name) const
+{
+    if (!isValidProfileName(name)) {
+        std::cerr << "[Config] Invalid profile name '" << name << "'" << std::endl;
+        return false;
     }
 
-    file << "# Audio auto gain control\n";
-    file << "audio_auto_gain=" << (m_settings.audioAutoGain ? "enabled" : "disabled") << "\n\n";
+    std::ostringstream file;
+    file << "# OBSBOT Control profile: " << name << "\n";
+    file << "# Applied over settings.conf; delete a line to leave that setting as it is\n";
+    file << "\n";
+    for (const auto &field : schema()) {
+        if (field.inProfile) {
+            file << field.key << "=" << field.format(m_settings) << "\n";
+        }
+    }
 
-    file << "# Preferred preview format (auto or WIDTHxHEIGHT@FPS)\n";
-    file << "preview_format=" << (m_settings.previewFormat.empty() ? "auto" : m_settings.previewFormat) << "\n\n";
+    const std::string path = getProfileDir() + "/" + name + ".conf";
+    std::string error;
+    if (!makeParentDirectories(path) || !writeFileAtomically(path, file.str(), error)) {
+        std::cerr << "[Config] Failed to save profile " << path << (error.empty() ? "" : ": " + error) << std::endl;
+        return false;
+    }
+    std::cout << "[Config] Profile '" << name << "' saved to " << path << std::endl;
+    return true;
+}
+
+bool Config::loadProfile(const std::string &name, CameraSettings &settings,
+                         std::vector<ValidationError> &errors) const
+{
+    errors.clear();
+    auto addError = [&errors](ValidationResult type, const std::string &message) {
+        errors.push_back({type, message, 0});
+    };
+
+    if (!isValidProfileName(name)) {
+        addError(InvalidValue, "Invalid profile name '" + name + "'");
+        return false;
+    }
+    std::ifstream input(getProfileDir() + "/" + name + ".conf");
+    if (!input.is_open()) {
+        addError(MissingProperty, "No profile named '" + name + "'");
+        return false;
+    }
+    const std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    // Parse over a copy, so keys the profile leaves out keep their values
+    Config overlay;
+    overlay.m_settings = settings;
+    if (!overlay.parseContent(content, true, errors) || !overlay.validateSettings(errors)) {
+        return false;
+    }
+    settings = overlay.m_settings;
+    settings.activeProfile = name;
+    return true;
+}
 
-    file << "# Application Settings\n";
-    file << "# Start application minimized to system tray\n";
-    file << "start_minimized=" << (m_settings.startMinimized ? "enabled" : "disabled") << "\n";
+bool Config::removeProfile(const std::string &name) const
+{
+    if (!isValidProfileName(name) || unlink((getProfileDir() + "/" + name + ".conf").c_str()) != 0) {
+        return false;
+    }
+    std::cout << "[Config] Profile '" << name << "' removed" << std::endl;
+    return true;
+}
 
-    file << "\n# Virtual camera output\n";
-    file << "virtual_camera_enabled=" << (m_settings.virtualCameraEnabled ? "enabled" : "disabled") << "\n";
-    file << "virtual_camera_device=" << (m_settings.virtualCameraDevice.empty() ? "/dev/video42" : m_settings.virtualCameraDevice) << "\n";
-    file << "# Set 'match' to follow the preview output, or WIDTHxHEIGHT (e.g. 1280x720)\n";
-    file << "virtual_camera_resolution=" << (m_settings.virtualCameraResolution.empty() ? "match" : m_settings.virtualCameraResolution) << "\n";
+bool Config::parseProfileRules(const std::string &text, std::vector<ProfileRule> &rules, std::string &error)
+{
+    static const char *const kSpace = " \t";
+    rules.clear();
+    std::stringstream entries(text);
+    std::string entry;
+
+    while (std::getline(entries, entry, ';')) {
+        if (entry.find_first_not_of(kSpace) == std::string::npos) {
+            continue;  // Tolerate a trailing ';'
+        }
 
-    file.close();
-    std::cout << "[Config] Configuration saved successfully to " << configPath << std::endl;
+        const size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            error = "rule '" + entry + "' must be <process>=<profile>";
+            return false;
+        }
+        ProfileRule rule{entry.substr(0, equals), entry.substr(equals + 1)};
+        for (auto *part : {&rule.process, &rule.profile}) {
+            part->erase(0, part->find_first_not_of(kSpace));
+            part->erase(part->find_last_not_of(kSpace) + 1);
+        }
+        if (rule.process.empty() || rule.process.find_first_of(" =") != std::string::npos) {
+            error = "rule '" + entry + "' needs a process name without spaces";
+            return false;
+        }
+        if (!isValidProfileName(rule.profile)) {
+            error = "rule '" + entry + "' names an invalid profile";
+            return false;
+        }
+        rules.push_back(rule);
+    }
     return true;
 }
 
+std::string Config::formatProfileRules(const std::vector<ProfileRule> &rules)
+{
+    std::string text;
+    for (const auto &rule : rules) {
+        text += (text.empty() ? "" : "; ") + rule.process + "=" + rule.profile;
+    }
+    return text;
+}
+
+std::string Config::profileForProcesses(const std::vector<ProfileRule> &rules,
+                                        const std::vector<std::string> &processes)
+{
+    auto lower = [](std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+        return text;
+    };
+
+    for (const auto &rule : rules) {
+        const std::string prefix = lower(rule.process);
+        for (const auto &process : processes) {
+            if (lower(process).compare(0, prefix.size(), prefix) == 0) {
+                return rule.profile;
+            }
+        }
+    }
+    return std::string();
+}
+
+Config::SaveStats Config::saveStats() const
+{
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    return m_saveStats;
+}
+
 bool Config::resetToDefaults(bool saveToFile)
 {
     setDefaults();
@@ -3,8 +3,10 @@
 
 #include <string>
 #include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <array>
 
 /**
  * @brief Configuration manager for OBSBOT camera settings
@@ -38,6 +40,59 @@ public:
             double zoom;
         };
 
+        enum Easing {
+            EaseLinear,
+            EaseIn,
+            EaseOut,
+            EaseInOut,
+            EaseHold      // Jump at the keyframe time instead of moving
+        };
+
+        // One point of a PTZ sequence; easing shapes the move arriving here
+        struct Keyframe {
+            int timeMs;       // From the start of the sequence
+            double pan;
+            double tilt;
+            double zoom;
+            Easing easing;
+        };
+
+        struct Sequence {
+            std::string name;
+            std::string hotkey;   // QKeySequence text, e.g. "Ctrl+Alt+1"; empty for none
+            std::vector<Keyframe> keyframes;
+        };
+
+        // Software grade applied to the preview and the virtual camera
+        // (FilterPreviewWidget::VideoEffectsSettings); all zero is untouched
+        struct VideoEffects {
+            double brightness;    // -1.0 to 1.0
+            double contrast;      // -1.0 to 1.0
+            double exposure;      // -2.0 to 2.0
+            double highlights;    // -1.0 to 1.0
+            double shadows;       // -1.0 to 1.0
+            double saturation;    // -1.0 to 1.0
+            double vibrance;      // -1.0 to 1.0
+            double temperature;   // -1.0 to 1.0
+            double tint;          // -1.0 to 1.0
+            double noise;         // 0.0 to 1.0
+            double blur;          // 0.0 to 1.0
+            double sharpen;       // 0.0 to 1.0
+            double glow;          // 0.0 to 1.0
+            double bloom;         // 0.0 to 1.0
+            double softFocus;     // 0.0 to 1.0
+            double duoToneIntensity; // 0.0 to 1.0
+            double denoise;       // 0.0 to 1.0
+            double digitalZoom;   // 1.0 to 4.0, on top of the camera's zoom
+            double digitalPan;    // -1.0 to 1.0
+            double digitalTilt;   // -1.0 to 1.0
+            double stabilize;     // 0.0 to 1.0
+            int stabilizeLookahead; // Frames, 0 to 8
+            std::string duoToneShadow;    // "rrggbb"
+            std::string duoToneHighlight; // "rrggbb"
+            bool horizontalFlip;
+        };
+
         bool faceTracking;
         bool hdr;
         int fov;              // 0=Wide, 1=Medium, 2=Narrow
@@ -68,16 +123,46 @@ public:
 
         // Preview / video
         std::string previewFormat; // Encoded as "widthxheight@fps" or "auto"
+        VideoEffects effects;
+
+        // PTZ presets; index N is stored as presetN+1_* and as gimbal preset id N
+        std::vector<PresetSlot> presets;
 
-        std::array<PresetSlot, 3> presets;
+        // Keyframed PTZ moves, stored as sequence_<name>=... and played by PtzSequencer
+        std::vector<Sequence> sequences;
 
         // Application settings
         bool startMinimized;  // Start application minimized to tray
+        std::string activeProfile;  // Profile applied last; empty for none
+        std::string autoProfileRules;  // "process=Profile; ..." as parsed by parseProfileRules()
         bool virtualCameraEnabled;
         std::string virtualCameraDevice;
         std::string virtualCameraResolution;
     };
 
+    static constexpr int kDefaultPresetCount = 3;
+    static constexpr int kMaxPresets = 16;  // Device preset id list holds 16 entries
+    static constexpr int kMaxKeyframes = 64;
+
+    /**
+     * @brief Parse a sequence value: "<ms> <pan> <tilt> <zoom> [easing]; ..."
+     *
+     * Easing is linear, ease-in, ease-out, ease-in-out or hold (default
+     * ease-in-out). Times must start at 0 or later and strictly increase.
+     * @param error Set to a description when parsing fails
+     */
+    static bool parseKeyframes(const std::string &text, std::vector<CameraSettings::Keyframe> &keyframes,
+                               std::string &error);
+    static std::string formatKeyframes(const std::vector<CameraSettings::Keyframe> &keyframes);
+    // Range and ordering checks shared by parsing and validateSettings()
+    static bool checkKeyframes(const std::vector<CameraSettings::Keyframe> &keyframes, std::string &error);
+
+    // Sequence names are letters, digits and '-' so they fit in a key
+    static bool isValidSequenceName(const std::string &name);
+
+    // white_balance names and their SDK DevWhiteBalanceType values; manual is 255
+    static const std::vector<std::pair<std::string, int>> &whiteBalanceModes();
+
     Config();
     ~Config();
 
@@ -88,12 +173,113 @@ public:
      */
     bool load(std::vector<ValidationError> &errors);
 
+    struct SaveStats {
+        unsigned writes = 0;     // Files actually written
+        unsigned unchanged = 0;  // Saves skipped because the file already had the content
+        unsigned failures = 0;
+        double totalWriteMs = 0.0;
+        double maxWriteMs = 0.0;
+    };
+
+    /**
+     * @brief Parse settings.conf content over the current settings
+     * @param errors Output parameter for parse errors
+     * @return true if the content parsed without errors
+     */
+    bool parse(const std::string &content, std::vector<ValidationError> &errors);
+
+    /**
+     * @brief Check the current settings against value ranges
+     * @return true if every value is in range
+     */
+    bool validateSettings(std::vector<ValidationError> &errors);
+
     /**
      * @brief Save current settings to disk
-     * @return true if saved successfully
+     * @return true if saved successfully (or the file was already up to date)
      */
     bool save();
 
+    /**
+     * @brief Render current settings in settings.conf format
+     */
+    std::string serialize() const;
+
+    /**
+     * @brief Write serialized settings, skipping the write if the file already holds them
+     *
+     * The content goes to a temporary file that is fsync'ed and renamed over
+     * settings.conf, so a crash leaves either the old or the new file. Does
+     * not touch the settings, so it may run on another thread than the one
+     * editing them; concurrent writes are serialized.
+     */
+    bool writeSerialized(const std::string &content);
+
+    SaveStats saveStats() const;
+
+    /**
+     * @brief True if content is what was last loaded from or written to the file
+     *
+     * Lets a file watcher tell our own saves from edits by other tools.
+     * Thread-safe.
+     */
+    bool isSavedContent(const std::string &content) const;
+
+    /**
+     * @brief Take settings parsed from an edit made by another program
+     * @param content The file content they were parsed from
+     */
+    void acceptExternalEdit(const CameraSettings &settings, const std::string &content);
+
+    /**
+     * @brief Config keys whose values differ; presets and sequences are reported as "presets" and "sequences"
+     */
+    static std::vector<std::string> changedKeys(const CameraSettings &before, const CameraSettings &after);
+
+    /**
+     * @brief Names for profiles: letters, digits, spaces, '-' and '_', e.g. "Video Call"
+     *
+     * A profile holds the camera, video and virtual camera settings (see
+     * profileKeys()) in profiles/<name>.conf beside settings.conf. Loading one
+     * lays its values over the current settings, so a switch only needs to
+     * send the fields that differ.
+     */
+    static bool isValidProfileName(const std::string &name);
+    static std::vector<std::string> profileKeys();
+    std::string getProfileDir() const;
+    std::vector<std::string> profileNames() const;  // Sorted
+
+    /**
+     * @brief Save the profile keys of the current settings under a name, replacing any profile of that name
+     */
+    bool saveProfile(const std::string &name) const;
+
+    /**
+     * @brief Lay a profile's values over settings
+     * @param settings The settings in effect; updated only on success, with activeProfile set to name
+     * @return false if the profile is missing or has errors
+     */
+    bool loadProfile(const std::string &name, CameraSettings &settings, std::vector<ValidationError> &errors) const;
+
+    bool removeProfile(const std::string &name) const;
+
+    // Switch to profile when an application whose name starts with process opens the camera
+    struct ProfileRule {
+        std::string process;  // Compared case-insensitively
+        std::string profile;
+    };
+
+    /**
+     * @brief Parse "obs=Presentation; chrome=Video Call"; earlier rules take priority
+     * @param error Set to a description when parsing fails
+     */
+    static bool parseProfileRules(const std::string &text, std::vector<ProfileRule> &rules, std::string &error);
+    static std::string formatProfileRules(const std::vector<ProfileRule> &rules);
+
+    // Profile of the first rule matching one of the process names; empty if none does
+    static std::string profileForProcesses(const std::vector<ProfileRule> &rules,
+                                           const std::vector<std::string> &processes);
+
     /**
      * @brief Reset to default settings and optionally save
      * @param saveToFile If true, writes defaults to disk
@@ -135,9 +321,24 @@ private:
     CameraSettings m_settings;
     bool m_savingEnabled;
 
+    // Hash of the content last loaded from or written to the file
+    mutable std::mutex m_writeMutex;
+    size_t m_savedHash;
+    bool m_haveSavedHash;
+    SaveStats m_saveStats;
+
     void setDefaults();
-    bool parseLine(const std::string &line, int lineNumber, std::vector<ValidationError> &errors);
-    bool validateSettings(std::vector<ValidationError> &errors);
+    bool parseContent(const std::string &content, bool profile, std::vector<ValidationError> &errors);
+
+    // Keys built from an index or name: preset<N>_* and sequence_<name>[_hotkey]
+    enum IndexedKeyResult {
+        KeyParsed,
+        KeyInvalid,
+        KeyUnknown
+    };
+    // sequenceIndex maps each sequence name to its position in m_settings.sequences
+    IndexedKeyResult parseIndexedKey(const std::string &key, const std::string &value,
+                                     std::unordered_map<std::string, size_t> &sequenceIndex, std::string &error);
     std::string getXdgConfigHome() const;
 };
 
@@ -0,0 +1,123 @@
+#include "ConfigSaver.h"
+#include "Trace.h"
+
+#include <iomanip>
+#include <iostream>
+
+ConfigSaver::ConfigSaver(Config &config, std::chrono::milliseconds debounce)
+    : m_config(config)
+    , m_debounce(debounce)
+    , m_stopping(false)
+    , m_writing(false)
+    , m_hasPending(false)
+{
+}
+
+ConfigSaver::~ConfigSaver()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    const Stats stats = m_stats;
+    const Config::SaveStats saves = m_config.saveStats();
+    if (stats.requests == 0) {
+        return;
+    }
+    std::cout << "[Config] Session saves: " << stats.requests << " requested, " << stats.coalesced << " coalesced, "
+              << saves.unchanged << " unchanged, " << saves.writes << " written";
+    if (saves.writes > 0) {
+        std::cout << std::fixed << std::setprecision(2) << " (avg " << saves.totalWriteMs / saves.writes
+                  << " ms, max " << saves.maxWriteMs << " ms)" << std::defaultfloat;
+    }
+    if (saves.failures > 0) {
+        std::cout << ", " << saves.failures << " failed";
+    }
+    std::cout << std::endl;
+}
+
+void ConfigSaver::request(std::string content)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.requests;
+        if (m_hasPending) {
+            ++m_stats.coalesced;
+        }
+        m_pending = std::move(content);
+        m_hasPending = true;
+        m_lastRequest = std::chrono::steady_clock::now();
+        if (!m_thread.joinable()) {
+            m_thread = std::thread(&ConfigSaver::workerLoop, this);
+        }
+    }
+    m_wake.notify_all();
+}
+
+bool ConfigSaver::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait(lock, [this]() { return !m_writing; });
+    if (!m_hasPending) {
+        return true;
+    }
+    return writePendingLocked(lock);
+}
+
+void ConfigSaver::cancel()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait(lock, [this]() { return !m_writing; });
+    m_pending.clear();
+    m_hasPending = false;
+}
+
+ConfigSaver::Stats ConfigSaver::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool ConfigSaver::writePendingLocked(std::unique_lock<std::mutex> &lock)
+{
+    std::string content = std::move(m_pending);
+    m_hasPending = false;
+    m_writing = true;
+    lock.unlock();
+
+    bool ok = m_config.writeSerialized(content);
+
+    lock.lock();
+    m_writing = false;
+    m_wake.notify_all();
+    return ok;
+}
+
+void ConfigSaver::workerLoop()
+{
+    Trace::setThreadName("ConfigSaver");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_stopping || (m_hasPending && !m_writing); });
+        if (m_stopping) {
+            return;
+        }
+
+        // Quiet period: every new request pushes the write back
+        const auto due = m_lastRequest + m_debounce;
+        if (std::chrono::steady_clock::now() < due) {
+            m_wake.wait_until(lock, due, [this]() { return m_stopping; });
+            continue;
+        }
+
+        if (m_hasPending && !m_writing) {
+            writePendingLocked(lock);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef CONFIGSAVER_H
+#define CONFIGSAVER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Config.h"
+
+/**
+ * @brief Debounced background writer for Config
+ *
+ * request() takes settings already serialized on the caller's thread, which
+ * costs microseconds, and returns at once. A worker writes the newest content
+ * once no further request has arrived for the debounce interval, so a slider
+ * drag ends in a single write. Config::writeSerialized() then skips the write
+ * entirely if the file already holds that content.
+ *
+ * flush() writes anything pending before returning; the destructor flushes
+ * and logs the session's save statistics.
+ */
+class ConfigSaver
+{
+public:
+    struct Stats {
+        unsigned requests = 0;
+        unsigned coalesced = 0;  // Replaced by a newer request before being written
+    };
+
+    explicit ConfigSaver(Config &config, std::chrono::milliseconds debounce = std::chrono::milliseconds(500));
+    ~ConfigSaver();
+
+    void request(std::string content);
+
+    // Write the pending content now; true if nothing was pending or it was written
+    bool flush();
+
+    // Drop the pending content unwritten, once any write in progress has finished;
+    // for when the file was replaced by newer content from elsewhere
+    void cancel();
+
+    Stats stats() const;
+
+private:
+    Config &m_config;
+    const std::chrono::milliseconds m_debounce;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+    bool m_writing;     // A write is in progress; the next one waits so order is kept
+    bool m_hasPending;
+    std::string m_pending;
+    std::chrono::steady_clock::time_point m_lastRequest;
+    Stats m_stats;
+
+    void workerLoop();
+    bool writePendingLocked(std::unique_lock<std::mutex> &lock);
+};
+
+#endif // CONFIGSAVER_H
@@ -0,0 +1,149 @@
+#include "ConfigWatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ConfigWatcher::ConfigWatcher(const Config &config, std::chrono::milliseconds quietPeriod)
+    : m_config(config)
+    , m_quietPeriod(quietPeriod)
+    , m_inotifyFd(-1)
+    , m_stopFd(-1)
+{
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    stop();
+}
+
+bool ConfigWatcher::start(ChangeCallback callback)
+{
+    stop();
+
+    const std::string path = m_config.getConfigPath();
+    const size_t slash = path.find_last_of('/');
+    const std::string dir = path.substr(0, slash);
+    const std::string fileName = path.substr(slash + 1);
+
+    // Watch the directory, not the file: a rename replaces the file's inode
+    mkdir(dir.c_str(), 0755);
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0 ||
+        inotify_add_watch(m_inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "[Config] Cannot watch " << dir << ": " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    m_stopFd = eventfd(0, EFD_CLOEXEC);
+    if (m_stopFd < 0) {
+        stop();
+        return false;
+    }
+
+    m_callback = std::move(callback);
+    m_thread = std::thread(&ConfigWatcher::watchLoop, this, fileName);
+    std::cout << "[Config] Watching " << path << " for external edits" << std::endl;
+    return true;
+}
+
+void ConfigWatcher::stop()
+{
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        if (write(m_stopFd, &one, sizeof(one)) != sizeof(one)) {
+            std::cerr << "[Config] Cannot stop config watcher: " << std::strerror(errno) << std::endl;
+        }
+        m_thread.join();
+    }
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+        m_stopFd = -1;
+    }
+}
+
+void ConfigWatcher::watchLoop(const std::string &fileName)
+{
+    using Clock = std::chrono::steady_clock;
+    bool pending = false;
+    Clock::time_point lastEvent;
+
+    // Room for a batch of events with names, as inotify(7) recommends
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true) {
+        int timeoutMs = -1;
+        if (pending) {
+            const auto quietUntil = lastEvent + m_quietPeriod;
+            timeoutMs = static_cast<int>(std::max<int64_t>(
+                0, std::chrono::duration_cast<std::chrono::milliseconds>(quietUntil - Clock::now()).count() + 1));
+        }
+
+        pollfd fds[2] = {{m_inotifyFd, POLLIN, 0}, {m_stopFd, POLLIN, 0}};
+        if (poll(fds, 2, timeoutMs) < 0 && errno != EINTR) {
+            std::cerr << "[Config] Config watcher failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t length;
+            while ((length = read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (char *p = buffer; p < buffer + length;) {
+                    auto *event = reinterpret_cast<struct inotify_event *>(p);
+                    if (event->len > 0 && fileName == event->name) {
+                        pending = true;
+                        lastEvent = Clock::now();
+                    }
+                    p += sizeof(struct inotify_event) + event->len;
+                }
+            }
+        }
+
+        if (pending && Clock::now() >= lastEvent + m_quietPeriod) {
+            pending = false;
+            readChange();
+        }
+    }
+}
+
+void ConfigWatcher::readChange()
+{
+    std::ifstream input(m_config.getConfigPath());
+    if (!input.is_open()) {
+        return;  // Removed; keep the settings we have
+    }
+    const std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    // Our own saves, and edits that change nothing
+    if (m_config.isSavedContent(content)) {
+        return;
+    }
+
+    Change change;
+    change.content = content;
+    Config parsed;
+    if (parsed.parse(content, change.errors)) {
+        parsed.validateSettings(change.errors);
+    }
+    change.settings = parsed.getSettings();
+
+    if (m_callback) {
+        m_callback(change);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef CONFIGWATCHER_H
+#define CONFIGWATCHER_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Config.h"
+
+/**
+ * @brief Watches settings.conf for edits made by other programs
+ *
+ * An inotify watch on the config directory, read by a background thread,
+ * catches both in-place writes and the write-and-rename that editors (and
+ * Config itself) use. Events are coalesced until the file has been quiet
+ * for a moment, so a tool writing in several steps is read once. The file
+ * is then re-parsed and validated on the watcher thread; content the Config
+ * itself last loaded or wrote is ignored, which filters out our own saves.
+ */
+class ConfigWatcher
+{
+public:
+    struct Change {
+        Config::CameraSettings settings;
+        std::vector<Config::ValidationError> errors;  // Empty if the file parsed and validated
+        std::string content;
+    };
+
+    // Called on the watcher thread
+    using ChangeCallback = std::function<void(const Change &change)>;
+
+    explicit ConfigWatcher(const Config &config,
+                           std::chrono::milliseconds quietPeriod = std::chrono::milliseconds(250));
+    ~ConfigWatcher();
+
+    // False if the directory cannot be watched; edits then apply on restart
+    bool start(ChangeCallback callback);
+    void stop();
+
+private:
+    const Config &m_config;
+    const std::chrono::milliseconds m_quietPeriod;
+    ChangeCallback m_callback;
+
+    std::thread m_thread;
+    int m_inotifyFd;
+    int m_stopFd;  // eventfd that wakes the thread for stop()
+
+    void watchLoop(const std::string &fileName);
+    void readChange();
+};
+
+#endif // CONFIGWATCHER_H
@@ -0,0 +1,249 @@
+#include "ControlRangeCache.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace {
+
+const char *const kRangeKeys[] = {"brightness", "contrast", "saturation", "white_balance_kelvin"};
+
+ControlRanges::Range *rangeForKey(ControlRanges &ranges, const std::string &key)
+{
+    ControlRanges::Range *fields[] = {&ranges.brightness, &ranges.contrast, &ranges.saturation,
+                                      &ranges.whiteBalanceKelvin};
+    for (size_t i = 0; i < sizeof(kRangeKeys) / sizeof(kRangeKeys[0]); ++i) {
+        if (key == kRangeKeys[i]) {
+            return fields[i];
+        }
+    }
+    return nullptr;
+}
+
+bool parseRange(const std::string &value, ControlRanges::Range &range)
+{
+    range = {};
+    if (value == "none") {
+        return true;
+    }
+    std::istringstream in(value);
+    std::string rest;
+    if (!(in >> range.min >> range.max >> range.step >> range.defaultValue) || (in >> rest) ||
+        range.min > range.max || range.step < 1) {
+        return false;
+    }
+    range.valid = true;
+    return true;
+}
+
+std::string formatRange(const ControlRanges::Range &range)
+{
+    if (!range.valid) {
+        return "none";
+    }
+    return std::to_string(range.min) + " " + std::to_string(range.max) + " " + std::to_string(range.step) + " " +
+           std::to_string(range.defaultValue);
+}
+
+// mkdir -p for the directory part of path
+bool makeParentDirectories(const std::string &path)
+{
+    for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        std::string dir = path.substr(0, slash);
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ControlRanges ControlRanges::query(Device &dev)
+{
+    ControlRanges ranges;
+    auto fetchRange = [&dev](int32_t (Device::*getter)(Device::UvcParamRange &), Range &target) {
+        Device::UvcParamRange sdkRange{};
+        if ((dev.*getter)(sdkRange) == RM_RET_OK) {
+            target.min = sdkRange.min_;
+            target.max = sdkRange.max_;
+            target.step = sdkRange.step_ == 0 ? 1 : sdkRange.step_;
+            target.defaultValue = sdkRange.default_;
+            target.valid = true;
+        }
+    };
+
+    fetchRange(&Device::cameraGetRangeImageBrightnessR, ranges.brightness);
+    fetchRange(&Device::cameraGetRangeImageContrastR, ranges.contrast);
+    fetchRange(&Device::cameraGetRangeImageSaturationR, ranges.saturation);
+    fetchRange(&Device::cameraGetRangeWhiteBalanceR, ranges.whiteBalanceKelvin);
+
+    std::vector<int32_t> wbList;
+    int32_t wbMin = 0;
+    int32_t wbMax = 0;
+    if (dev.cameraGetWhiteBalanceListR(wbList, wbMin, wbMax) == RM_RET_OK) {
+        ranges.whiteBalanceTypes.assign(wbList.begin(), wbList.end());
+    }
+    return ranges;
+}
+
+ControlRangeCache::ControlRangeCache()
+    : ControlRangeCache(defaultPath())
+{
+}
+
+ControlRangeCache::ControlRangeCache(const std::string &path)
+    : m_path(path)
+    , m_loaded(false)
+{
+}
+
+std::string ControlRangeCache::defaultPath()
+{
+    const char *xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && xdg[0] != '\0') {
+        return std::string(xdg) + "/obsbot-control/ranges.cache";
+    }
+
+    const char *home = std::getenv("HOME");
+    if (home) {
+        return std::string(home) + "/.cache/obsbot-control/ranges.cache";
+    }
+
+    return ".cache/obsbot-control/ranges.cache";  // Fallback
+}
+
+bool ControlRangeCache::lookup(const std::string &serial, const std::string &version, ControlRanges &ranges)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    loadLocked();
+
+    auto it = m_entries.find(serial + " " + version);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    ranges = it->second;
+    return true;
+}
+
+bool ControlRangeCache::store(const std::string &serial, const std::string &version, const ControlRanges &ranges)
+{
+    if (serial.empty()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    loadLocked();
+    m_entries[serial + " " + version] = ranges;
+    return saveLocked();
+}
+
+void ControlRangeCache::loadLocked()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    std::ifstream file(m_path);
+    if (!file.is_open()) {
+        return;  // No cache yet
+    }
+
+    // A damaged section is dropped rather than trusted; the next query rewrites it
+    std::string key;
+    ControlRanges ranges;
+    bool sectionValid = false;
+    auto finishSection = [&]() {
+        if (!key.empty() && sectionValid) {
+            m_entries[key] = ranges;
+        }
+    };
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        if (line.front() == '[' && line.back() == ']') {
+            finishSection();
+            key = line.substr(1, line.size() - 2);
+            ranges = ControlRanges();
+            sectionValid = key.find(' ') != std::string::npos;
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos || key.empty()) {
+            sectionValid = false;
+            continue;
+        }
+        std::string name = line.substr(0, equals);
+        std::string value = line.substr(equals + 1);
+
+        if (ControlRanges::Range *range = rangeForKey(ranges, name)) {
+            sectionValid = sectionValid && parseRange(value, *range);
+        } else if (name == "white_balance_types") {
+            std::istringstream in(value);
+            int type;
+            while (in >> type) {
+                ranges.whiteBalanceTypes.push_back(type);
+            }
+            sectionValid = sectionValid && in.eof();
+        }
+        // Unknown keys come from newer versions; ignore them
+    }
+    finishSection();
+}
+
+bool ControlRangeCache::saveLocked()
+{
+    if (!makeParentDirectories(m_path)) {
+        std::cerr << "[RangeCache] Cannot create directory for " << m_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Written beside the old file and renamed over it, so readers never see half a file
+    const std::string tempPath = m_path + ".tmp";
+    {
+        std::ofstream file(tempPath);
+        if (!file.is_open()) {
+            std::cerr << "[RangeCache] Cannot write " << tempPath << std::endl;
+            return false;
+        }
+
+        file << "# OBSBOT control ranges per camera serial and firmware\n";
+        file << "# Generated automatically; safe to delete\n";
+        for (const auto &[key, ranges] : m_entries) {
+            file << "\n[" << key << "]\n";
+            file << "brightness=" << formatRange(ranges.brightness) << "\n";
+            file << "contrast=" << formatRange(ranges.contrast) << "\n";
+            file << "saturation=" << formatRange(ranges.saturation) << "\n";
+            file << "white_balance_kelvin=" << formatRange(ranges.whiteBalanceKelvin) << "\n";
+            file << "white_balance_types=";
+            for (size_t i = 0; i < ranges.whiteBalanceTypes.size(); ++i) {
+                file << (i ? " " : "") << ranges.whiteBalanceTypes[i];
+            }
+            file << "\n";
+        }
+        if (!file.good()) {
+            std::cerr << "[RangeCache] Failed writing " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    if (std::rename(tempPath.c_str(), m_path.c_str()) != 0) {
+        std::cerr << "[RangeCache] Cannot replace " << m_path << ": " << std::strerror(errno) << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
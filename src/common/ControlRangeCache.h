@@ -0,0 +1,81 @@
+#ifndef CONTROLRANGECACHE_H
+#define CONTROLRANGECACHE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <dev/dev.hpp>
+
+/**
+ * @brief Image control ranges a camera reports for its firmware
+ */
+struct ControlRanges
+{
+    struct Range {
+        int min = 0;
+        int max = 0;
+        int step = 1;
+        int defaultValue = 0;
+        bool valid = false;
+
+        bool operator==(const Range &other) const
+        {
+            return valid == other.valid && (!valid || (min == other.min && max == other.max &&
+                                                       step == other.step && defaultValue == other.defaultValue));
+        }
+        bool operator!=(const Range &other) const { return !(*this == other); }
+    };
+
+    Range brightness;
+    Range contrast;
+    Range saturation;
+    Range whiteBalanceKelvin;
+    std::vector<int> whiteBalanceTypes;
+
+    bool operator==(const ControlRanges &other) const
+    {
+        return brightness == other.brightness && contrast == other.contrast && saturation == other.saturation &&
+               whiteBalanceKelvin == other.whiteBalanceKelvin && whiteBalanceTypes == other.whiteBalanceTypes;
+    }
+    bool operator!=(const ControlRanges &other) const { return !(*this == other); }
+
+    // Read all ranges from the device: five blocking USB round trips
+    static ControlRanges query(Device &dev);
+};
+
+/**
+ * @brief On-disk cache of ControlRanges, keyed by serial number and firmware
+ *
+ * Ranges are fixed for a given firmware, so a reconnect can take them from
+ * here instead of querying the camera. A firmware update changes the key
+ * and forces a fresh query. The file is plain text and safe to delete.
+ *
+ * Location: $XDG_CACHE_HOME/obsbot-control/ranges.cache
+ * Thread-safe.
+ */
+class ControlRangeCache
+{
+public:
+    ControlRangeCache();
+    explicit ControlRangeCache(const std::string &path);
+
+    static std::string defaultPath();
+    const std::string &path() const { return m_path; }
+
+    bool lookup(const std::string &serial, const std::string &version, ControlRanges &ranges);
+
+    // Remember ranges and rewrite the file; false if it could not be written
+    bool store(const std::string &serial, const std::string &version, const ControlRanges &ranges);
+
+private:
+    std::string m_path;
+    std::mutex m_mutex;
+    bool m_loaded;
+    std::map<std::string, ControlRanges> m_entries;  // "<serial> <version>"
+
+    void loadLocked();
+    bool saveLocked();
+};
+
+#endif // CONTROLRANGECACHE_H
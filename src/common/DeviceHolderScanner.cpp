@@ -0,0 +1,273 @@
+#include "DeviceHolderScanner.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Targets seen across scans are bounded by what processes open under /dev;
+// the cap only guards against something churning through pty numbers
+constexpr size_t MaxCachedTargets = 4096;
+
+// pid of a /proc entry, or -1 for the non-numeric ones
+int parsePid(const char *name)
+{
+    int pid = 0;
+    for (const char *p = name; *p; ++p) {
+        if (*p < '0' || *p > '9') {
+            return -1;
+        }
+        pid = pid * 10 + (*p - '0');
+    }
+    return *name ? pid : -1;
+}
+
+std::string processName(int pid)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+    std::string name;
+    if (FILE *file = std::fopen(path, "re")) {
+        char buffer[64];
+        if (std::fgets(buffer, sizeof(buffer), file)) {
+            name = buffer;
+            name.erase(name.find_last_not_of('\n') + 1);
+        }
+        std::fclose(file);
+    }
+    return name;
+}
+
+// Kernel threads have no descriptors and no executable
+bool isKernelThread(int pid)
+{
+    char path[64];
+    char target[16];
+    std::snprintf(path, sizeof(path), "/proc/%d/exe", pid);
+    return readlink(path, target, sizeof(target)) < 0 && errno == ENOENT;
+}
+
+} // namespace
+
+DeviceHolderScanner::DeviceHolderScanner()
+    : m_stopping(false)
+    , m_hasPending(false)
+{
+}
+
+DeviceHolderScanner::~DeviceHolderScanner()
+{
+    stop();
+}
+
+bool DeviceHolderScanner::setDevices(const std::vector<std::string> &devices)
+{
+    std::vector<Node> nodes;
+    for (const auto &device : devices) {
+        struct stat info;
+        if (!device.empty() && stat(device.c_str(), &info) == 0 && S_ISCHR(info.st_mode)) {
+            nodes.push_back({info.st_rdev, device});
+        }
+    }
+
+    bool same = nodes.size() == m_nodes.size();
+    for (size_t i = 0; same && i < nodes.size(); ++i) {
+        same = nodes[i].rdev == m_nodes[i].rdev && nodes[i].path == m_nodes[i].path;
+    }
+    if (!same) {
+        m_nodes = std::move(nodes);
+        m_targets.clear();  // Classified against the old nodes
+    }
+    return !m_nodes.empty();
+}
+
+int DeviceHolderScanner::matchTarget(const char *target)
+{
+    // Sockets, pipes, anon inodes and ordinary files are settled by the text alone
+    if (std::strncmp(target, "/dev/", 5) != 0) {
+        for (size_t i = 0; i < m_nodes.size(); ++i) {
+            if (m_nodes[i].path == target) {
+                return static_cast<int>(i);  // A node made outside /dev
+            }
+        }
+        return -1;
+    }
+
+    auto cached = m_targets.find(target);
+    if (cached != m_targets.end()) {
+        return cached->second;
+    }
+
+    int index = -1;
+    struct stat info;
+    ++m_scanStats.stats;
+    if (stat(target, &info) == 0 && S_ISCHR(info.st_mode)) {
+        for (size_t i = 0; i < m_nodes.size(); ++i) {
+            if (m_nodes[i].rdev == info.st_rdev) {
+                index = static_cast<int>(i);
+                break;
+            }
+        }
+    }
+    if (m_targets.size() >= MaxCachedTargets) {
+        m_targets.clear();
+    }
+    m_targets.emplace(target, index);
+    return index;
+}
+
+std::vector<DeviceHolderScanner::Holder> DeviceHolderScanner::scan(const std::vector<std::string> &devices)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Holder> holders;
+    m_scanStats = Stats();
+    DIR *proc = setDevices(devices) ? opendir("/proc") : nullptr;
+    if (!proc) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats = m_scanStats;
+        return holders;
+    }
+
+    const int self = static_cast<int>(getpid());
+    std::unordered_map<int, ino_t> skipped;
+    std::vector<bool> held(m_nodes.size());
+    char path[64];
+    char target[512];
+
+    while (struct dirent *entry = readdir(proc)) {
+        const int pid = parsePid(entry->d_name);
+        if (pid <= 0 || pid == self) {
+            continue;
+        }
+        ++m_scanStats.processes;
+
+        // A new process under a reused pid gets a new /proc inode
+        auto known = m_skipped.find(pid);
+        if (known != m_skipped.end() && known->second == entry->d_ino) {
+            skipped.emplace(pid, entry->d_ino);
+            ++m_scanStats.skipped;
+            continue;
+        }
+
+        std::snprintf(path, sizeof(path), "/proc/%d/fd", pid);
+        const int fdDirFd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fdDirFd < 0) {
+            if (errno == EACCES || errno == EPERM) {
+                skipped.emplace(pid, entry->d_ino);  // Another user's process
+            }
+            continue;  // Otherwise it exited
+        }
+        DIR *fds = fdopendir(fdDirFd);
+        if (!fds) {
+            close(fdDirFd);
+            continue;
+        }
+
+        bool anyDescriptor = false;
+        std::fill(held.begin(), held.end(), false);
+        while (struct dirent *fd = readdir(fds)) {
+            if (fd->d_name[0] == '.') {
+                continue;
+            }
+            anyDescriptor = true;
+            ++m_scanStats.descriptors;
+            const ssize_t length = readlinkat(dirfd(fds), fd->d_name, target, sizeof(target) - 1);
+            if (length <= 0) {
+                continue;
+            }
+            target[length] = '\0';
+            const int index = matchTarget(target);
+            if (index >= 0) {
+                held[index] = true;
+            }
+        }
+        closedir(fds);
+
+        if (!anyDescriptor && isKernelThread(pid)) {
+            skipped.emplace(pid, entry->d_ino);
+            continue;
+        }
+
+        std::string name;
+        for (size_t i = 0; i < held.size(); ++i) {
+            if (held[i]) {
+                if (name.empty()) {
+                    name = processName(pid);
+                }
+                holders.push_back({pid, name, m_nodes[i].path});
+            }
+        }
+    }
+    closedir(proc);
+
+    m_skipped = std::move(skipped);  // Drops processes that have exited
+    m_scanStats.lastScanMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = m_scanStats;
+    return holders;
+}
+
+void DeviceHolderScanner::request(const std::vector<std::string> &devices, ResultCallback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingDevices = devices;
+        m_pendingCallback = std::move(callback);
+        m_hasPending = true;
+        if (!m_thread.joinable()) {
+            m_stopping = false;
+            m_thread = std::thread(&DeviceHolderScanner::workerLoop, this);
+        }
+    }
+    m_wake.notify_all();
+}
+
+void DeviceHolderScanner::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_hasPending = false;
+        m_pendingCallback = nullptr;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+DeviceHolderScanner::Stats DeviceHolderScanner::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void DeviceHolderScanner::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_stopping || m_hasPending; });
+        if (m_stopping) {
+            return;
+        }
+
+        const std::vector<std::string> devices = std::move(m_pendingDevices);
+        const ResultCallback callback = std::move(m_pendingCallback);
+        m_hasPending = false;
+
+        lock.unlock();
+        const auto holders = scan(devices);
+        if (callback) {
+            callback(holders);
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef DEVICEHOLDERSCANNER_H
+#define DEVICEHOLDERSCANNER_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Finds the processes that hold device nodes open, without lsof
+ *
+ * scan() walks /proc/[pid]/fd and compares each descriptor's target with the
+ * rdev of the requested character devices, so a symlinked or renamed node
+ * still matches. State is kept between scans to make repeated scans cheap:
+ * - Descriptor targets are classified once. Sockets, pipes and files outside
+ *   /dev are rejected from the link text; a /dev path is stat()ed on first
+ *   sight only.
+ * - Kernel threads and processes whose descriptors we may not read are
+ *   remembered and skipped until their /proc entry changes.
+ *
+ * This process is never reported. request() runs the scan on a worker thread
+ * started on first use, so the GUI never waits for it; a newer request
+ * replaces one that has not started yet.
+ */
+class DeviceHolderScanner
+{
+public:
+    struct Holder {
+        int pid;
+        std::string name;    // Process name (comm)
+        std::string device;  // Requested path of the node it holds open
+    };
+
+    struct Stats {
+        unsigned processes = 0;    // /proc entries seen by the last scan
+        unsigned skipped = 0;      // Of those, skipped from the cache
+        unsigned descriptors = 0;  // Descriptor links read by the last scan
+        unsigned stats = 0;        // Device paths stat()ed by the last scan
+        double lastScanMs = 0.0;
+    };
+
+    // Called on the worker thread
+    using ResultCallback = std::function<void(const std::vector<Holder> &holders)>;
+
+    DeviceHolderScanner();
+    ~DeviceHolderScanner();
+
+    // Scan on the calling thread; one thread at a time per scanner
+    std::vector<Holder> scan(const std::vector<std::string> &devices);
+
+    // Scan on the worker thread
+    void request(const std::vector<std::string> &devices, ResultCallback callback);
+
+    // Wait for a running request and drop a queued one
+    void stop();
+
+    Stats stats() const;
+
+private:
+    struct Node {
+        dev_t rdev;
+        std::string path;
+    };
+
+    // Scan state, touched only by the thread running scan()
+    std::vector<Node> m_nodes;
+    std::unordered_map<std::string, int> m_targets;  // Descriptor target -> index in m_nodes, -1 if none
+    std::unordered_map<int, ino_t> m_skipped;        // pid -> inode of its /proc entry when it was skipped
+    Stats m_scanStats;                                // Counted during the scan, published to m_stats at the end
+
+    // Worker
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+    bool m_hasPending;
+    std::vector<std::string> m_pendingDevices;
+    ResultCallback m_pendingCallback;
+    Stats m_stats;
+
+    bool setDevices(const std::vector<std::string> &devices);
+    int matchTarget(const char *target);
+    void workerLoop();
+};
+
+#endif // DEVICEHOLDERSCANNER_H
@@ -0,0 +1,110 @@
+#include "GimbalPresets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Normalised pan/tilt map onto the gimbal travel accepted by gimbalSetSpeedPositionR
+constexpr double kYawRangeDeg = 120.0;
+constexpr double kPitchRangeDeg = 90.0;
+constexpr double kMatchTolerance = 0.01;
+
+} // namespace
+
+namespace GimbalPresets {
+
+bool supported(ObsbotProductType product)
+{
+    return product == ObsbotProdTiny2 || product == ObsbotProdTiny2Lite || product == ObsbotProdTinySE ||
+           product == ObsbotProdTailAir;
+}
+
+Device::PresetPosInfo toDevice(int id, const Slot &slot)
+{
+    Device::PresetPosInfo info{};
+    info.id = id;
+    info.yaw = static_cast<float>(slot.pan * kYawRangeDeg);
+    info.pitch = static_cast<float>(slot.tilt * kPitchRangeDeg);
+    info.zoom = static_cast<float>(slot.zoom);
+    info.name_len = std::snprintf(info.name, sizeof(info.name), "Preset %d", id + 1);
+    return info;
+}
+
+Slot fromDevice(const Device::PresetPosInfo &info)
+{
+    Slot slot{};
+    slot.defined = true;
+    slot.pan = std::clamp(info.yaw / kYawRangeDeg, -1.0, 1.0);
+    slot.tilt = std::clamp(info.pitch / kPitchRangeDeg, -1.0, 1.0);
+    slot.zoom = std::clamp(static_cast<double>(info.zoom), 1.0, 2.0);
+    return slot;
+}
+
+bool matches(const Device::PresetPosInfo &info, const Slot &slot)
+{
+    auto device = fromDevice(info);
+    return std::abs(device.pan - slot.pan) < kMatchTolerance &&
+           std::abs(device.tilt - slot.tilt) < kMatchTolerance &&
+           std::abs(device.zoom - slot.zoom) < kMatchTolerance;
+}
+
+SyncResult sync(Device &dev, const std::vector<Slot> &presets)
+{
+    SyncResult result;
+    Device::DevDataArray ids{};
+    int32_t ret = dev.aiGetGimbalPresetListR(&ids);
+    if (ret != RM_RET_OK) {
+        result.failedCommand = "aiGetGimbalPresetListR";
+        result.failedResult = ret;
+        return result;
+    }
+
+    const int count = std::clamp(ids.len, 0, static_cast<int>(sizeof(ids.data_int32) / sizeof(ids.data_int32[0])));
+    for (int i = 0; i < count; ++i) {
+        int id = ids.data_int32[i];
+        Device::PresetPosInfo info{};
+        if (dev.aiGetGimbalPresetInfoWithIdR(&info, id) == RM_RET_OK) {
+            result.devicePresets[id] = info;
+        }
+    }
+
+    for (size_t i = 0; i < presets.size(); ++i) {
+        if (!presets[i].defined) {
+            continue;
+        }
+
+        int id = static_cast<int>(i);
+        auto info = toDevice(id, presets[i]);
+        auto existing = result.devicePresets.find(id);
+        if (existing == result.devicePresets.end()) {
+            ret = dev.aiAddGimbalPresetR(&info);
+            result.failedCommand = ret == RM_RET_OK ? nullptr : "aiAddGimbalPresetR";
+        } else if (!matches(existing->second, presets[i])) {
+            ret = dev.aiUpdGimbalPresetR(&info);
+            result.failedCommand = ret == RM_RET_OK ? nullptr : "aiUpdGimbalPresetR";
+        }
+        if (!result.ok()) {
+            result.failedResult = ret;
+            return result;
+        }
+    }
+    return result;
+}
+
+int32_t recall(Device &dev, int id, const Slot &slot)
+{
+    Device::PresetPosInfo info{};
+    if (dev.aiGetGimbalPresetInfoWithIdR(&info, id) != RM_RET_OK || !matches(info, slot)) {
+        // aiAddGimbalPresetR overwrites an existing preset with the same id
+        info = toDevice(id, slot);
+        int32_t ret = dev.aiAddGimbalPresetR(&info);
+        if (ret != RM_RET_OK) {
+            return ret;
+        }
+    }
+    return dev.aiTrgGimbalPresetR(id);
+}
+
+} // namespace GimbalPresets
@@ -0,0 +1,54 @@
+#ifndef GIMBALPRESETS_H
+#define GIMBALPRESETS_H
+
+#include <map>
+#include <vector>
+#include <dev/dev.hpp>
+#include "Config.h"
+
+/**
+ * @brief Mirrors settings.conf presets into the gimbal's own preset table
+ *
+ * Slot N of the config is gimbal preset id N, so a recall is a single
+ * aiTrgGimbalPresetR that moves and zooms in one motion. Everything here
+ * makes blocking USB round trips and may run on any thread.
+ */
+namespace GimbalPresets {
+
+using Slot = Config::CameraSettings::PresetSlot;
+
+// Preset list/update commands are only available on the Tiny 2 series and Tail Air
+bool supported(ObsbotProductType product);
+
+Device::PresetPosInfo toDevice(int id, const Slot &slot);
+Slot fromDevice(const Device::PresetPosInfo &info);
+bool matches(const Device::PresetPosInfo &info, const Slot &slot);
+
+struct SyncResult {
+    std::map<int, Device::PresetPosInfo> devicePresets;  // As read before any write
+    const char *failedCommand = nullptr;  // The SDK call that failed, if any
+    int32_t failedResult = RM_RET_OK;
+
+    bool ok() const { return failedCommand == nullptr; }
+};
+
+/**
+ * @brief Read the device's presets and add or update those the config defines
+ *
+ * Local presets win for slots both sides define; presets only the device
+ * has are returned for the caller to adopt. Stops at the first failure.
+ * Up to 2N+1 round trips, so keep it off the GUI thread.
+ */
+SyncResult sync(Device &dev, const std::vector<Slot> &presets);
+
+/**
+ * @brief Trigger preset id, first writing the slot if the device's copy differs
+ *
+ * For callers that do not keep the device in sync, such as the CLI. Returns
+ * the first SDK result that was not RM_RET_OK.
+ */
+int32_t recall(Device &dev, int id, const Slot &slot);
+
+} // namespace GimbalPresets
+
+#endif // GIMBALPRESETS_H
@@ -0,0 +1,216 @@
+#include "GimbalTelemetry.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// How often the writer wakes to move samples from the ring to disk
+constexpr auto kWriterInterval = std::chrono::milliseconds(100);
+
+template <typename T>
+void writeRecord(std::FILE *file, Telemetry::RecordType type, const T &record)
+{
+    std::fputc(type, file);
+    std::fwrite(&record, sizeof(record), 1, file);
+}
+
+} // namespace
+
+GimbalTelemetry::GimbalTelemetry()
+    : m_file(nullptr)
+    , m_rateHz(kDefaultRateHz)
+    , m_running(false)
+    , m_logging(false)
+    , m_droppedSamples(0)
+    , m_droppedCommands(0)
+{
+}
+
+GimbalTelemetry::~GimbalTelemetry()
+{
+    stop();
+}
+
+bool GimbalTelemetry::start(std::shared_ptr<Device> dev, const std::string &path, int rateHz)
+{
+    stop();
+    if (!dev) {
+        return false;
+    }
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "[Telemetry] Cannot create " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    m_device = std::move(dev);
+    m_rateHz = std::clamp(rateHz, 1, kMaxRateHz);
+    m_start = std::chrono::steady_clock::now();
+    m_droppedSamples = 0;
+    m_droppedCommands = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_pathMutex);
+        m_path = path;
+    }
+
+    Telemetry::FileHeader header{};
+    std::memcpy(header.magic, Telemetry::kMagic, sizeof(header.magic));
+    header.version = Telemetry::kVersion;
+    header.rateHz = static_cast<uint32_t>(m_rateHz);
+    header.startUnixUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::strncpy(header.deviceSn, m_device->devSn().c_str(), sizeof(header.deviceSn) - 1);
+    std::fwrite(&header, sizeof(header), 1, m_file);
+
+    {
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_logging = true;
+    }
+    m_running = true;
+    m_sampler = std::thread(&GimbalTelemetry::samplerLoop, this);
+    m_writer = std::thread(&GimbalTelemetry::writerLoop, this);
+
+    std::cout << "[Telemetry] Recording gimbal at " << m_rateHz << " Hz to " << path << std::endl;
+    return true;
+}
+
+void GimbalTelemetry::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (!m_running.exchange(false)) {
+            return;
+        }
+    }
+    m_wake.notify_all();
+    {
+        // A command logged after this would sit in the ring into the next recording
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_logging = false;
+    }
+
+    if (m_sampler.joinable()) {
+        m_sampler.join();
+    }
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+
+    drain();
+    std::fclose(m_file);
+    m_file = nullptr;
+    m_device.reset();
+
+    std::cout << "[Telemetry] Stopped recording " << path() << std::endl;
+}
+
+std::string GimbalTelemetry::path() const
+{
+    std::lock_guard<std::mutex> lock(m_pathMutex);
+    return m_path;
+}
+
+uint64_t GimbalTelemetry::elapsedUs() const
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_start).count());
+}
+
+void GimbalTelemetry::logCommand(const std::string &name, int32_t result)
+{
+    if (!m_running) {
+        return;  // Cheap early out; m_logging decides
+    }
+
+    Telemetry::Command record{};
+    record.result = result;
+    std::strncpy(record.name, name.c_str(), sizeof(record.name) - 1);
+    std::lock_guard<std::mutex> lock(m_commandMutex);
+    if (!m_logging) {
+        return;
+    }
+    record.timeUs = elapsedUs();
+    if (!m_commands.push(record)) {
+        ++m_droppedCommands;
+    }
+}
+
+void GimbalTelemetry::samplerLoop()
+{
+    const auto period = std::chrono::microseconds(1000000 / m_rateHz);
+    auto next = std::chrono::steady_clock::now();
+
+    while (m_running) {
+        Telemetry::Sample sample{};
+        sample.timeUs = elapsedUs();
+
+        float xyz[3] = {0.0f, 0.0f, 0.0f};
+        if (m_device->gimbalGetAttitudeInfoR(xyz) == 0) {
+            std::copy(xyz, xyz + 3, sample.attitude);
+            sample.flags |= Telemetry::AttitudeValid;
+        }
+
+        Device::AiGimbalStateInfo state{};
+        if (m_device->aiGetGimbalStateR(&state) == 0) {
+            sample.euler[0] = state.roll_euler;
+            sample.euler[1] = state.pitch_euler;
+            sample.euler[2] = state.yaw_euler;
+            sample.motor[0] = state.roll_motor;
+            sample.motor[1] = state.pitch_motor;
+            sample.motor[2] = state.yaw_motor;
+            sample.velocity[0] = state.roll_v;
+            sample.velocity[1] = state.pitch_v;
+            sample.velocity[2] = state.yaw_v;
+            sample.flags |= Telemetry::StateValid;
+        }
+
+        if (!m_samples.push(sample)) {
+            ++m_droppedSamples;
+        }
+
+        // Fixed cadence; if the USB round trip overran, skip the missed slots
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            next = now;
+        }
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_until(lock, next, [this]() { return !m_running; });
+    }
+}
+
+void GimbalTelemetry::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (!m_wake.wait_for(lock, kWriterInterval, [this]() { return !m_running; })) {
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void GimbalTelemetry::drain()
+{
+    Telemetry::Sample sample;
+    while (m_samples.pop(sample)) {
+        writeRecord(m_file, Telemetry::RecordSample, sample);
+    }
+
+    Telemetry::Command command;
+    while (m_commands.pop(command)) {
+        writeRecord(m_file, Telemetry::RecordCommand, command);
+    }
+
+    uint32_t droppedSamples = m_droppedSamples.exchange(0);
+    uint32_t droppedCommands = m_droppedCommands.exchange(0);
+    if (droppedSamples || droppedCommands) {
+        Telemetry::Dropped record{elapsedUs(), droppedSamples, droppedCommands};
+        writeRecord(m_file, Telemetry::RecordDropped, record);
+    }
+
+    std::fflush(m_file);
+}
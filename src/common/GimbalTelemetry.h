@@ -0,0 +1,170 @@
+#ifndef GIMBALTELEMETRY_H
+#define GIMBALTELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <dev/dev.hpp>
+
+/**
+ * @brief On-disk layout of a gimbal telemetry log (*.obtl)
+ *
+ * A TelemetryFileHeader followed by records, each a one-byte
+ * TelemetryRecordType and the matching packed struct. Integers and floats
+ * are little-endian, as written by the x86/ARM hosts we support.
+ * Timestamps are microseconds since the header's start time.
+ */
+namespace Telemetry {
+
+constexpr char kMagic[8] = {'O', 'B', 'S', 'B', 'T', 'L', 'M', '\0'};
+constexpr uint32_t kVersion = 1;
+
+enum RecordType : uint8_t {
+    RecordSample = 1,
+    RecordCommand = 2,
+    RecordDropped = 3,
+};
+
+enum SampleFlags : uint8_t {
+    AttitudeValid = 0x01,  // attitude[] from gimbalGetAttitudeInfoR
+    StateValid = 0x02,     // euler/motor/velocity[] from aiGetGimbalStateR
+};
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t rateHz;
+    int64_t startUnixUs;
+    char deviceSn[16];
+};
+
+struct Sample {
+    uint64_t timeUs;
+    uint8_t flags;
+    float attitude[3];  // roll, pitch, yaw (deg)
+    float euler[3];     // roll, pitch, yaw (deg)
+    float motor[3];     // roll, pitch, yaw motor angle (deg)
+    float velocity[3];  // roll, pitch, yaw (deg/s)
+};
+
+struct Command {
+    uint64_t timeUs;
+    int32_t result;
+    char name[48];
+};
+
+struct Dropped {
+    uint64_t timeUs;
+    uint32_t samples;
+    uint32_t commands;
+};
+#pragma pack(pop)
+
+/**
+ * @brief Bounded single-producer/single-consumer queue
+ *
+ * Lock-free so the sampler never waits on disk I/O: push() fails when the
+ * writer falls behind and the caller counts the drop instead.
+ */
+template <typename T, size_t Capacity>
+class Ring
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool push(const T &item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = m_items[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> m_items;
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+} // namespace Telemetry
+
+/**
+ * @brief Records gimbal attitude at a fixed rate, plus the commands sent
+ *
+ * A sampler thread polls gimbalGetAttitudeInfoR/aiGetGimbalStateR and a
+ * writer thread streams the results to a binary log, so neither the UI nor
+ * the sampling cadence waits on the disk. Use obsbot-telemetry-csv to turn
+ * a log into CSV for plotting.
+ */
+class GimbalTelemetry
+{
+public:
+    static constexpr int kDefaultRateHz = 50;
+    static constexpr int kMaxRateHz = 500;
+
+    GimbalTelemetry();
+    ~GimbalTelemetry();
+
+    /**
+     * @brief Start recording to path, replacing any running recording
+     * @param rateHz Samples per second, clamped to 1..kMaxRateHz
+     * @return false if the file could not be created
+     */
+    bool start(std::shared_ptr<Device> dev, const std::string &path, int rateHz = kDefaultRateHz);
+    void stop();
+    bool isRecording() const { return m_running.load(); }
+    std::string path() const;
+
+    // Record a command and its SDK result. Thread-safe.
+    void logCommand(const std::string &name, int32_t result);
+
+private:
+    std::shared_ptr<Device> m_device;
+    std::FILE *m_file;
+    std::string m_path;
+    mutable std::mutex m_pathMutex;
+    int m_rateHz;
+    std::chrono::steady_clock::time_point m_start;
+
+    std::atomic<bool> m_running;
+    std::thread m_sampler;
+    std::thread m_writer;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;  // Cuts the sampler/writer sleeps short on stop()
+
+    Telemetry::Ring<Telemetry::Sample, 4096> m_samples;
+    Telemetry::Ring<Telemetry::Command, 256> m_commands;
+    std::mutex m_commandMutex;  // Commands come from the UI and the sequencer thread; the ring has one producer
+    bool m_logging;             // Guarded by m_commandMutex; false from stop() on, so late commands are dropped
+    std::atomic<uint32_t> m_droppedSamples;
+    std::atomic<uint32_t> m_droppedCommands;
+
+    uint64_t elapsedUs() const;
+    void samplerLoop();
+    void writerLoop();
+    void drain();
+};
+
+#endif // GIMBALTELEMETRY_H
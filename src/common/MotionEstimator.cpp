@@ -0,0 +1,277 @@
+#include "MotionEstimator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr int kBaseWidth = 640;      // The base level is about this wide
+constexpr int kCoarseRange = 4;      // Exhaustive search on the smallest level, in its pixels
+constexpr int kBlockSize = 16;
+constexpr int kBlockRange = 2;       // Per-block search around the estimate from the level above
+constexpr int kBlockCandidates = 2 * kBlockRange + 1;
+constexpr int kTextureThreshold = 3 * kBlockSize * kBlockSize;  // Blocks flatter than this cannot be matched
+constexpr int kMinBlocks = 8;
+constexpr double kMinAgreement = 0.4;
+
+// Sum of absolute differences of two runs of bytes
+inline uint32_t sadRow(const uint8_t *a, const uint8_t *b, int count)
+{
+    uint32_t sum = 0;
+    int i = 0;
+#ifdef __SSE2__
+    __m128i accumulator = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        const __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        const __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        accumulator = _mm_add_epi64(accumulator, _mm_sad_epu8(left, right));
+    }
+    sum = static_cast<uint32_t>(_mm_cvtsi128_si32(accumulator))
+        + static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_unpackhi_epi64(accumulator, accumulator)));
+#endif
+    for (; i < count; ++i) {
+        sum += static_cast<uint32_t>(std::abs(a[i] - b[i]));
+    }
+    return sum;
+}
+
+// SAD of previous against current shifted by (dx, dy), over the same inner
+// rectangle for every candidate so the sums compare
+uint32_t shiftedSad(const std::vector<uint8_t> &previous, const std::vector<uint8_t> &current,
+                    int width, int height, int margin, int dx, int dy)
+{
+    uint32_t sum = 0;
+    const int count = width - 2 * margin;
+    for (int y = margin; y < height - margin; ++y) {
+        sum += sadRow(previous.data() + static_cast<size_t>(y) * width + margin,
+                      current.data() + static_cast<size_t>(y + dy) * width + margin + dx, count);
+    }
+    return sum;
+}
+
+// Minimum of a parabola through three samples, as an offset from the middle one
+double parabolaOffset(double before, double middle, double after)
+{
+    const double curvature = before - 2.0 * middle + after;
+    if (curvature <= 0.0) {
+        return 0.0;
+    }
+    return std::clamp((before - after) / (2.0 * curvature), -0.5, 0.5);
+}
+
+int median(std::vector<int> &values)
+{
+    const auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+} // namespace
+
+MotionEstimator::MotionEstimator()
+    : m_sourceWidth(0)
+    , m_sourceHeight(0)
+    , m_factor(1)
+    , m_hasPrevious(false)
+    , m_current(0)
+{
+}
+
+void MotionEstimator::reset()
+{
+    m_hasPrevious = false;
+}
+
+void MotionEstimator::buildPyramid(const uint8_t *pixels, int bytesPerLine, Level *levels) const
+{
+    // Base level: the mean luma of up to four samples per cell, spread
+    // across it, which averages noise without reading every source pixel
+    Level &base = levels[0];
+    base.width = m_sourceWidth / m_factor;
+    base.height = m_sourceHeight / m_factor;
+    base.luma.resize(static_cast<size_t>(base.width) * base.height);
+    const int step = m_factor / 2;  // 0 for a factor of 1: the four samples are one pixel
+    for (int y = 0; y < base.height; ++y) {
+        const uint8_t *top = pixels + static_cast<size_t>(y) * m_factor * bytesPerLine;
+        const uint8_t *bottom = top + static_cast<size_t>(step) * bytesPerLine;
+        uint8_t *out = base.luma.data() + static_cast<size_t>(y) * base.width;
+        for (int x = 0; x < base.width; ++x) {
+            const size_t left = static_cast<size_t>(x) * m_factor * 4;
+            const size_t right = left + static_cast<size_t>(step) * 4;
+            const int sum = top[left] + 2 * top[left + 1] + top[left + 2]
+                          + top[right] + 2 * top[right + 1] + top[right + 2]
+                          + bottom[left] + 2 * bottom[left + 1] + bottom[left + 2]
+                          + bottom[right] + 2 * bottom[right + 1] + bottom[right + 2];
+            out[x] = static_cast<uint8_t>((sum + 8) >> 4);
+        }
+    }
+
+    for (int level = 1; level < kLevels; ++level) {
+        const Level &below = levels[level - 1];
+        Level &above = levels[level];
+        above.width = below.width / 2;
+        above.height = below.height / 2;
+        above.luma.resize(static_cast<size_t>(above.width) * above.height);
+        for (int y = 0; y < above.height; ++y) {
+            const uint8_t *top = below.luma.data() + static_cast<size_t>(2 * y) * below.width;
+            const uint8_t *bottom = top + below.width;
+            uint8_t *out = above.luma.data() + static_cast<size_t>(y) * above.width;
+            for (int x = 0; x < above.width; ++x) {
+                out[x] = static_cast<uint8_t>((top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1] + 2) >> 2);
+            }
+        }
+    }
+}
+
+MotionEstimator::Motion MotionEstimator::estimate(const uint8_t *pixels, int width, int height, int bytesPerLine)
+{
+    Motion motion;
+    if (width != m_sourceWidth || height != m_sourceHeight) {
+        m_sourceWidth = width;
+        m_sourceHeight = height;
+        m_factor = std::max(1, (width + kBaseWidth / 2) / kBaseWidth);
+        m_hasPrevious = false;
+    }
+    // The smallest level needs room for the coarse search on both sides
+    const int smallest = (1 << (kLevels - 1)) * m_factor;
+    if (width / smallest < 4 * kCoarseRange || height / smallest < 4 * kCoarseRange) {
+        return motion;
+    }
+
+    m_current ^= 1;
+    Level *current = m_pyramids[m_current];
+    const Level *previous = m_pyramids[m_current ^ 1];
+    buildPyramid(pixels, bytesPerLine, current);
+    if (!m_hasPrevious) {
+        m_hasPrevious = true;
+        return motion;
+    }
+
+    // Exhaustive on the smallest level
+    int estimateX = 0;
+    int estimateY = 0;
+    {
+        const Level &now = current[kLevels - 1];
+        const Level &before = previous[kLevels - 1];
+        uint32_t best = UINT32_MAX;
+        for (int dy = -kCoarseRange; dy <= kCoarseRange; ++dy) {
+            for (int dx = -kCoarseRange; dx <= kCoarseRange; ++dx) {
+                const uint32_t sad = shiftedSad(before.luma, now.luma, now.width, now.height, kCoarseRange, dx, dy);
+                if (sad < best) {
+                    best = sad;
+                    estimateX = dx;
+                    estimateY = dy;
+                }
+            }
+        }
+    }
+
+    // One pixel either way on each level up to, but not including, the base
+    for (int level = kLevels - 2; level >= 1; --level) {
+        const Level &now = current[level];
+        const Level &before = previous[level];
+        const int centerX = estimateX * 2;
+        const int centerY = estimateY * 2;
+        const int margin = std::max(std::abs(centerX), std::abs(centerY)) + 2;
+        uint32_t best = UINT32_MAX;
+        for (int dy = centerY - 1; dy <= centerY + 1; ++dy) {
+            for (int dx = centerX - 1; dx <= centerX + 1; ++dx) {
+                const uint32_t sad = shiftedSad(before.luma, now.luma, now.width, now.height, margin, dx, dy);
+                if (sad < best) {
+                    best = sad;
+                    estimateX = dx;
+                    estimateY = dy;
+                }
+            }
+        }
+    }
+
+    // Base level: every textured block votes
+    const Level &now = current[0];
+    const Level &before = previous[0];
+    const int centerX = estimateX * 2;
+    const int centerY = estimateY * 2;
+    const int margin = std::max(std::abs(centerX), std::abs(centerY)) + kBlockRange + 1;
+    using Surface = std::array<uint32_t, kBlockCandidates * kBlockCandidates>;
+    std::vector<Surface> surfaces;
+    std::vector<int> votesX;
+    std::vector<int> votesY;
+    for (int by = margin; by + kBlockSize + margin <= now.height; by += kBlockSize) {
+        for (int bx = margin; bx + kBlockSize + margin <= now.width; bx += kBlockSize) {
+            Surface surface;
+            uint32_t best = UINT32_MAX;
+            uint64_t total = 0;
+            int bestX = 0;
+            int bestY = 0;
+            for (int oy = -kBlockRange; oy <= kBlockRange; ++oy) {
+                for (int ox = -kBlockRange; ox <= kBlockRange; ++ox) {
+                    uint32_t sad = 0;
+                    for (int row = 0; row < kBlockSize; ++row) {
+                        sad += sadRow(before.luma.data() + static_cast<size_t>(by + row) * now.width + bx,
+                                      now.luma.data() + static_cast<size_t>(by + row + centerY + oy) * now.width
+                                          + bx + centerX + ox,
+                                      kBlockSize);
+                    }
+                    surface[(oy + kBlockRange) * kBlockCandidates + ox + kBlockRange] = sad;
+                    total += sad;
+                    if (sad < best) {
+                        best = sad;
+                        bestX = ox;
+                        bestY = oy;
+                    }
+                }
+            }
+            if (total / surface.size() - best < static_cast<uint32_t>(kTextureThreshold)) {
+                continue;
+            }
+            surfaces.push_back(surface);
+            votesX.push_back(bestX);
+            votesY.push_back(bestY);
+        }
+    }
+    if (static_cast<int>(votesX.size()) < kMinBlocks) {
+        return motion;
+    }
+
+    std::vector<int> sortedX = votesX;
+    std::vector<int> sortedY = votesY;
+    const int medianX = median(sortedX);
+    const int medianY = median(sortedY);
+
+    // Sub-pixel from the summed difference surfaces of the blocks that agree
+    int agreeing = 0;
+    double sums[3][3] = {};
+    for (size_t i = 0; i < votesX.size(); ++i) {
+        if (std::abs(votesX[i] - medianX) > 1 || std::abs(votesY[i] - medianY) > 1) {
+            continue;
+        }
+        ++agreeing;
+        for (int oy = -1; oy <= 1; ++oy) {
+            for (int ox = -1; ox <= 1; ++ox) {
+                const int x = medianX + ox;
+                const int y = medianY + oy;
+                if (std::abs(x) <= kBlockRange && std::abs(y) <= kBlockRange) {
+                    sums[oy + 1][ox + 1] += surfaces[i][(y + kBlockRange) * kBlockCandidates + x + kBlockRange];
+                }
+            }
+        }
+    }
+    motion.agreement = static_cast<double>(agreeing) / votesX.size();
+    if (motion.agreement < kMinAgreement) {
+        return motion;
+    }
+
+    const bool interiorX = std::abs(medianX) < kBlockRange;
+    const bool interiorY = std::abs(medianY) < kBlockRange;
+    const double subX = interiorX ? parabolaOffset(sums[1][0], sums[1][1], sums[1][2]) : 0.0;
+    const double subY = interiorY ? parabolaOffset(sums[0][1], sums[1][1], sums[2][1]) : 0.0;
+    motion.dx = (centerX + medianX + subX) * m_factor;
+    motion.dy = (centerY + medianY + subY) * m_factor;
+    motion.valid = true;
+    return motion;
+}
@@ -0,0 +1,56 @@
+#ifndef MOTIONESTIMATOR_H
+#define MOTIONESTIMATOR_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Global translation between consecutive frames, for stabilization
+ *
+ * Each frame is reduced to a small luma pyramid, the base about 640 pixels
+ * wide. The shift is found coarse to fine: an exhaustive search on the
+ * smallest level, then a refinement on each larger one. On the base level
+ * each 16x16 block is matched on its own and the median vector is taken,
+ * so a person moving through the picture does not count as the camera
+ * moving. Block differences use SSE2 where the compiler targets it.
+ *
+ * Qt-free so obsbot-stabilize-bench can time it; ImageStabilizer runs it
+ * on its own thread.
+ */
+class MotionEstimator
+{
+public:
+    struct Motion {
+        double dx = 0.0;      // How far the picture moved since the previous frame,
+        double dy = 0.0;      // in pixels of the frames given
+        bool valid = false;   // False for the first frame, or when the blocks disagree
+        double agreement = 0.0;  // Share of textured blocks that back the result
+    };
+
+    MotionEstimator();
+
+    // RGBA8888; a new size restarts the comparison
+    Motion estimate(const uint8_t *pixels, int width, int height, int bytesPerLine);
+
+    void reset();
+
+private:
+    static constexpr int kLevels = 4;
+
+    struct Level {
+        std::vector<uint8_t> luma;
+        int width = 0;
+        int height = 0;
+    };
+
+    void buildPyramid(const uint8_t *pixels, int bytesPerLine, Level *levels) const;
+
+    int m_sourceWidth;
+    int m_sourceHeight;
+    int m_factor;  // Source pixels per base level pixel
+    bool m_hasPrevious;
+    Level m_pyramids[2][kLevels];
+    int m_current;  // Pyramid of the newest frame
+};
+
+#endif // MOTIONESTIMATOR_H
@@ -0,0 +1,359 @@
+#include "PtzSequencer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+// Normalised pan/tilt map onto the gimbal travel, as for presets
+constexpr double kYawRangeDeg = 120.0;
+constexpr double kPitchRangeDeg = 90.0;
+
+// gimbalSetSpeedPositionR accepts reference speeds up to 90 deg/s
+constexpr double kMaxSpeedDegPerSec = 90.0;
+constexpr double kMinSpeedDegPerSec = 0.5;
+
+// How far ahead of the path each tick aims. Covers a USB round trip plus
+// the motor's response so the gimbal is never chasing a point it passed.
+constexpr double kLookaheadMs = 60.0;
+
+// Skip resending an unchanged gimbal target while the gimbal is on it
+constexpr double kPositionDeadbandDeg = 0.05;
+
+// Approximate zoom ratio per second for each cameraSetZoomWithSpeedRelativeR
+// speed level (1-10); the feedback loop absorbs the difference per model.
+constexpr double kZoomRatePerLevel = 0.1;
+constexpr int kMaxZoomLevel = 10;
+constexpr double kZoomTolerance = 0.01;
+
+constexpr int kMaxConsecutiveFailures = 5;
+
+// Tracking error only counts once the camera has caught up with the path;
+// a sequence starting away from the current position begins with a long travel
+constexpr double kOnPathDeg = 1.0;
+constexpr double kOnPathZoom = 0.05;
+
+double speedFor(double distanceDeg)
+{
+    return std::clamp(std::abs(distanceDeg) / (kLookaheadMs / 1000.0), kMinSpeedDegPerSec, kMaxSpeedDegPerSec);
+}
+
+} // namespace
+
+PtzSequencer::PtzSequencer()
+    : m_running(false)
+{
+}
+
+PtzSequencer::~PtzSequencer()
+{
+    stop();
+}
+
+double PtzSequencer::ease(Config::CameraSettings::Easing easing, double t)
+{
+    t = std::clamp(t, 0.0, 1.0);
+    switch (easing) {
+    case Config::CameraSettings::EaseLinear:
+        return t;
+    case Config::CameraSettings::EaseIn:
+        return t * t * t;
+    case Config::CameraSettings::EaseOut:
+        return 1.0 - std::pow(1.0 - t, 3.0);
+    case Config::CameraSettings::EaseInOut:
+        return t < 0.5 ? 4.0 * t * t * t : 1.0 - std::pow(-2.0 * t + 2.0, 3.0) / 2.0;
+    case Config::CameraSettings::EaseHold:
+        return t < 1.0 ? 0.0 : 1.0;
+    }
+    return t;
+}
+
+PtzSequencer::Position PtzSequencer::positionAt(const std::vector<Keyframe> &keyframes, double timeMs)
+{
+    if (keyframes.empty()) {
+        return {0.0, 0.0, 1.0};
+    }
+
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), timeMs,
+                                 [](double t, const Keyframe &keyframe) { return t < keyframe.timeMs; });
+    if (next == keyframes.begin()) {
+        return {next->pan, next->tilt, next->zoom};
+    }
+    if (next == keyframes.end()) {
+        const auto &last = keyframes.back();
+        return {last.pan, last.tilt, last.zoom};
+    }
+
+    const auto &from = *(next - 1);
+    const auto &to = *next;
+    double u = ease(to.easing, (timeMs - from.timeMs) / (to.timeMs - from.timeMs));
+    return {from.pan + (to.pan - from.pan) * u,
+            from.tilt + (to.tilt - from.tilt) * u,
+            from.zoom + (to.zoom - from.zoom) * u};
+}
+
+bool PtzSequencer::start(std::shared_ptr<Device> dev, const Sequence &sequence, std::string &error)
+{
+    stop();
+    if (!dev) {
+        error = "no camera connected";
+        return false;
+    }
+    if (!Config::checkKeyframes(sequence.keyframes, error)) {
+        return false;
+    }
+
+    m_device = std::move(dev);
+    m_sequence = sequence;
+
+    // A sequence whose first keyframe is later than 0 eases in from wherever the camera is
+    if (m_sequence.keyframes.front().timeMs > 0) {
+        Keyframe origin{0, 0.0, 0.0, 1.0, Config::CameraSettings::EaseLinear};
+        float xyz[3] = {0.0f, 0.0f, 0.0f};
+        if (m_device->gimbalGetAttitudeInfoR(xyz) == RM_RET_OK) {
+            origin.pan = std::clamp(xyz[2] / kYawRangeDeg, -1.0, 1.0);
+            origin.tilt = std::clamp(xyz[1] / kPitchRangeDeg, -1.0, 1.0);
+        }
+        float zoom = 1.0f;
+        if (m_device->cameraGetZoomAbsoluteR(zoom) == RM_RET_OK) {
+            origin.zoom = std::clamp(static_cast<double>(zoom), 1.0, 2.0);
+        }
+        m_sequence.keyframes.insert(m_sequence.keyframes.begin(), origin);
+    }
+
+    // Easing concentrates a move in the middle of its segment, so a path can
+    // ask for more than the gimbal's top speed; it then lags behind until
+    // the path slows down again
+    const double durationMs = m_sequence.keyframes.back().timeMs;
+    constexpr double kStepMs = 5.0;
+    double peakSpeed = 0.0;
+    Position previous = positionAt(m_sequence.keyframes, 0.0);
+    for (double t = kStepMs; t <= durationMs; t += kStepMs) {
+        Position current = positionAt(m_sequence.keyframes, t);
+        double degrees = std::max(std::abs(current.pan - previous.pan) * kYawRangeDeg,
+                                  std::abs(current.tilt - previous.tilt) * kPitchRangeDeg);
+        peakSpeed = std::max(peakSpeed, degrees / (kStepMs / 1000.0));
+        previous = current;
+    }
+    if (peakSpeed > kMaxSpeedDegPerSec) {
+        std::cout << "[Sequencer] '" << sequence.name << "' needs " << static_cast<int>(peakSpeed)
+                  << " deg/s, the gimbal tops out at " << kMaxSpeedDegPerSec << "; lengthen its moves" << std::endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statusMutex);
+        m_status = Status();
+        m_status.running = true;
+        m_status.name = sequence.name;
+        m_status.durationMs = durationMs;
+        m_status.peakSpeedDeg = peakSpeed;
+    }
+
+    std::cout << "[Sequencer] Playing '" << sequence.name << "' (" << durationMs << " ms, "
+              << sequence.keyframes.size() << " keyframes)" << std::endl;
+    m_running = true;
+    m_thread = std::thread(&PtzSequencer::run, this);
+    return true;
+}
+
+void PtzSequencer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    join();
+}
+
+void PtzSequencer::join()
+{
+    if (m_thread.joinable() && m_thread.get_id() != std::this_thread::get_id()) {
+        m_thread.join();
+    }
+}
+
+PtzSequencer::Status PtzSequencer::status() const
+{
+    std::lock_guard<std::mutex> lock(m_statusMutex);
+    return m_status;
+}
+
+int32_t PtzSequencer::send(const char *name, int32_t result)
+{
+    if (m_logger) {
+        m_logger(name, result);
+    }
+    return result;
+}
+
+void PtzSequencer::run()
+{
+    const auto &keyframes = m_sequence.keyframes;
+    const double durationMs = keyframes.back().timeMs;
+    const auto period = std::chrono::microseconds(1000000 / kTickHz);
+    const auto started = std::chrono::steady_clock::now();
+    auto next = started;
+
+    bool completed = false;
+    std::string error;
+    int failures = 0;
+    bool gimbalAccepted = false;
+    bool relativeZoom = true;   // Falls back to absolute zoom steps where relative zoom is refused
+    int zoomLevel = 0;          // Signed speed level currently running: > 0 zooming in
+    double sentYaw = NAN;
+    double sentPitch = NAN;
+    double sentZoom = NAN;
+    bool gimbalOnPath = false;
+    bool zoomOnPath = false;
+
+    while (m_running) {
+        double t = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        if (t >= durationMs) {
+            completed = true;
+            break;
+        }
+
+        Position onPath = positionAt(keyframes, t);
+        Position target = positionAt(keyframes, t + kLookaheadMs);
+        double targetYaw = target.pan * kYawRangeDeg;
+        double targetPitch = target.tilt * kPitchRangeDeg;
+
+        // Feedback; without it, assume the last command was reached
+        float xyz[3] = {0.0f, 0.0f, 0.0f};
+        bool haveAttitude = m_device->gimbalGetAttitudeInfoR(xyz) == RM_RET_OK;
+        double yaw = haveAttitude ? xyz[2] : (std::isnan(sentYaw) ? targetYaw : sentYaw);
+        double pitch = haveAttitude ? xyz[1] : (std::isnan(sentPitch) ? targetPitch : sentPitch);
+        double errorDeg = std::max(std::abs(onPath.pan * kYawRangeDeg - yaw),
+                                   std::abs(onPath.tilt * kPitchRangeDeg - pitch));
+
+        float zoomValue = 1.0f;
+        bool haveZoom = m_device->cameraGetZoomAbsoluteR(zoomValue) == RM_RET_OK;
+        double zoom = haveZoom ? zoomValue : target.zoom;
+
+        bool ok = true;
+        bool moved = std::isnan(sentYaw) || std::abs(targetYaw - sentYaw) > kPositionDeadbandDeg ||
+                     std::abs(targetPitch - sentPitch) > kPositionDeadbandDeg;
+        if (moved || errorDeg > kPositionDeadbandDeg) {
+            int32_t ret = send("gimbalSetSpeedPositionR", m_device->gimbalSetSpeedPositionR(
+                0.0f, static_cast<float>(targetPitch), static_cast<float>(targetYaw), 0.0f,
+                static_cast<float>(speedFor(targetPitch - pitch)), static_cast<float>(speedFor(targetYaw - yaw))));
+            if (ret == RM_RET_OK) {
+                gimbalAccepted = true;
+                sentYaw = targetYaw;
+                sentPitch = targetPitch;
+            } else if (!gimbalAccepted) {
+                error = "gimbal refused speed/position moves (code: " + std::to_string(ret) + ")";
+                break;
+            } else {
+                ok = false;
+            }
+        }
+
+        double zoomGap = target.zoom - zoom;
+        if (relativeZoom && haveZoom) {
+            int level = 0;
+            if (std::abs(zoomGap) > kZoomTolerance) {
+                double rate = std::abs(zoomGap) / (kLookaheadMs / 1000.0);
+                level = std::clamp(static_cast<int>(std::ceil(rate / kZoomRatePerLevel)), 1, kMaxZoomLevel);
+                level = zoomGap > 0 ? level : -level;
+            }
+            if (level != zoomLevel) {
+                int32_t ret = level == 0
+                    ? send("cameraSetZoomStopR", m_device->cameraSetZoomStopR())
+                    : send("cameraSetZoomWithSpeedRelativeR",
+                           m_device->cameraSetZoomWithSpeedRelativeR(0, static_cast<uint32_t>(std::abs(level)),
+                                                                     false, level > 0));
+                if (ret == RM_RET_OK) {
+                    zoomLevel = level;
+                } else if (zoomLevel == 0 && level != 0) {
+                    std::cout << "[Sequencer] Relative zoom refused, using absolute zoom steps" << std::endl;
+                    relativeZoom = false;
+                } else {
+                    ok = false;
+                }
+            }
+        }
+        if (!relativeZoom && (std::isnan(sentZoom) || std::abs(target.zoom - sentZoom) > kZoomTolerance)) {
+            int32_t ret = send("cameraSetZoomAbsoluteR",
+                               m_device->cameraSetZoomAbsoluteR(static_cast<float>(target.zoom)));
+            if (ret == RM_RET_OK) {
+                sentZoom = target.zoom;
+            } else {
+                ok = false;
+            }
+        }
+
+        failures = ok ? 0 : failures + 1;
+        if (failures >= kMaxConsecutiveFailures) {
+            error = "camera stopped accepting commands";
+            break;
+        }
+
+        bool late = false;
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            next = now;
+            late = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_statusMutex);
+            m_status.elapsedMs = t;
+            gimbalOnPath = gimbalOnPath || (haveAttitude && errorDeg < kOnPathDeg);
+            if (gimbalOnPath && haveAttitude) {
+                m_status.maxErrorDeg = std::max(m_status.maxErrorDeg, errorDeg);
+            }
+            double zoomError = std::abs(onPath.zoom - zoom);
+            zoomOnPath = zoomOnPath || (haveZoom && zoomError < kOnPathZoom);
+            if (zoomOnPath && haveZoom) {
+                m_status.maxZoomError = std::max(m_status.maxZoomError, zoomError);
+            }
+            m_status.overruns += late ? 1 : 0;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_until(lock, next, [this]() { return !m_running; });
+    }
+
+    if (zoomLevel != 0) {
+        send("cameraSetZoomStopR", m_device->cameraSetZoomStopR());
+    }
+
+    if (completed) {
+        // Land on the last keyframe exactly; the loop only ever aimed just ahead of the path
+        const auto &last = keyframes.back();
+        float xyz[3] = {0.0f, 0.0f, 0.0f};
+        double yaw = last.pan * kYawRangeDeg;
+        double pitch = last.tilt * kPitchRangeDeg;
+        double remaining = m_device->gimbalGetAttitudeInfoR(xyz) == RM_RET_OK
+            ? std::max(std::abs(yaw - xyz[2]), std::abs(pitch - xyz[1])) : kMaxSpeedDegPerSec;
+        send("gimbalSetSpeedPositionR", m_device->gimbalSetSpeedPositionR(
+            0.0f, static_cast<float>(pitch), static_cast<float>(yaw), 0.0f,
+            static_cast<float>(speedFor(remaining)), static_cast<float>(speedFor(remaining))));
+        send("cameraSetZoomAbsoluteR", m_device->cameraSetZoomAbsoluteR(static_cast<float>(last.zoom)));
+    }
+
+    Status finalStatus;
+    {
+        std::lock_guard<std::mutex> lock(m_statusMutex);
+        m_status.running = false;
+        m_status.completed = completed;
+        m_status.error = error;
+        if (completed) {
+            m_status.elapsedMs = durationMs;
+        }
+        finalStatus = m_status;
+    }
+    m_running = false;
+
+    std::cout << "[Sequencer] '" << finalStatus.name << "' "
+              << (completed ? "finished" : (error.empty() ? "stopped" : "failed: " + error))
+              << ", max error " << finalStatus.maxErrorDeg << " deg" << std::endl;
+
+    if (m_finished) {
+        m_finished(finalStatus);
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef PTZSEQUENCER_H
+#define PTZSEQUENCER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <dev/dev.hpp>
+#include "Config.h"
+
+/**
+ * @brief Plays a keyframed pan/tilt/zoom sequence on the gimbal
+ *
+ * A timer thread ticks at kTickHz. Each tick samples the eased path a
+ * short lookahead ahead, reads the gimbal attitude and zoom back, and
+ * sends speed commands that close the gap: gimbalSetSpeedPositionR with a
+ * reference speed of (target - actual) / lookahead, and continuous
+ * cameraSetZoomWithSpeedRelativeR whose speed level follows the required
+ * zoom rate. Correcting from feedback each tick keeps USB latency and
+ * motor lag from accumulating over a long move. The last keyframe is
+ * landed with an absolute zoom so the end position is exact.
+ */
+class PtzSequencer
+{
+public:
+    using Sequence = Config::CameraSettings::Sequence;
+    using Keyframe = Config::CameraSettings::Keyframe;
+
+    static constexpr int kTickHz = 50;
+
+    struct Position {
+        double pan;
+        double tilt;
+        double zoom;
+    };
+
+    struct Status {
+        bool running = false;
+        std::string name;
+        double elapsedMs = 0.0;
+        double durationMs = 0.0;
+        double peakSpeedDeg = 0.0;  // Fastest pan/tilt speed the path asks for (deg/s)
+        // Largest deviation from the path once the camera first reached it
+        double maxErrorDeg = 0.0;   // Pan/tilt
+        double maxZoomError = 0.0;
+        int overruns = 0;           // Ticks that started late because the previous one overran
+        bool completed = false;     // Set when the last keyframe was reached
+        std::string error;          // Why the sequence ended early, empty when stopped
+    };
+
+    // Called on the sequencer thread when a sequence ends, completed or not
+    using FinishedCallback = std::function<void(const Status &status)>;
+    // Called on the sequencer thread for every command sent, e.g. to feed GimbalTelemetry
+    using CommandLogger = std::function<void(const std::string &name, int32_t result)>;
+
+    PtzSequencer();
+    ~PtzSequencer();
+
+    void setFinishedCallback(FinishedCallback callback) { m_finished = std::move(callback); }
+    void setCommandLogger(CommandLogger logger) { m_logger = std::move(logger); }
+
+    /**
+     * @brief Start playing, replacing any sequence already running
+     * @return false if the sequence is invalid; error says why
+     */
+    bool start(std::shared_ptr<Device> dev, const Sequence &sequence, std::string &error);
+
+    // Stop at the current position. Must not be called from the finished callback.
+    void stop();
+
+    bool isRunning() const { return m_running.load(); }
+    Status status() const;
+
+    // Eased position along the path at a time from the start
+    static Position positionAt(const std::vector<Keyframe> &keyframes, double timeMs);
+    static double ease(Config::CameraSettings::Easing easing, double t);
+
+private:
+    std::shared_ptr<Device> m_device;
+    Sequence m_sequence;
+    FinishedCallback m_finished;
+    CommandLogger m_logger;
+
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+
+    mutable std::mutex m_statusMutex;
+    Status m_status;
+
+    void run();
+    int32_t send(const char *name, int32_t result);
+    void join();
+};
+
+#endif // PTZSEQUENCER_H
@@ -0,0 +1,128 @@
+#include "StartupTimer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Time from exec() to now, from the start time the kernel keeps in clock
+// ticks since boot; 0 if /proc is not readable
+double sinceExecMs()
+{
+    FILE *file = std::fopen("/proc/self/stat", "re");
+    if (!file) {
+        return 0.0;
+    }
+    char buffer[1024];
+    const size_t length = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+    std::fclose(file);
+    buffer[length] = '\0';
+
+    // The command name may contain spaces; fields resume after its last ')'
+    const char *p = std::strrchr(buffer, ')');
+    if (!p) {
+        return 0.0;
+    }
+    unsigned long long startTicks = 0;
+    for (int field = 2; field < 22 && p; ++field) {  // starttime is field 22
+        p = std::strchr(p + 1, ' ');
+    }
+    if (!p || std::sscanf(p + 1, "%llu", &startTicks) != 1) {
+        return 0.0;
+    }
+
+    timespec now{};
+    const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    if (ticksPerSecond <= 0 || clock_gettime(CLOCK_BOOTTIME, &now) != 0) {
+        return 0.0;
+    }
+    const double nowMs = now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+    return std::max(0.0, nowMs - startTicks * 1000.0 / ticksPerSecond);
+}
+
+struct State {
+    Clock::time_point origin;  // exec(), on the steady clock
+    bool quiet;
+    std::mutex mutex;
+    std::map<std::string, double> phases;
+    double lastMs = 0.0;
+
+    State()
+        : origin(Clock::now() - std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double, std::milli>(sinceExecMs())))
+        , quiet(std::getenv("OBSBOT_STARTUP_QUIET") != nullptr)
+    {
+    }
+};
+
+State &state()
+{
+    static State instance;
+    return instance;
+}
+
+// Take the origin during static initialization, before main() runs
+const State &g_initialized = state();
+
+} // namespace
+
+namespace StartupTimer {
+
+double elapsedMs()
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - state().origin).count();
+}
+
+void mark(const std::string &phase)
+{
+    State &s = state();
+    const double ms = elapsedMs();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.phases.emplace(phase, ms).second) {
+        return;
+    }
+    if (!s.quiet) {
+        std::cout << std::fixed << std::setprecision(1) << "[Startup] " << phase << ": " << ms << " ms (+"
+                  << ms - s.lastMs << " ms), " << residentKb() / 1024.0 << " MiB resident" << std::defaultfloat
+                  << std::endl;
+    }
+    s.lastMs = std::max(s.lastMs, ms);
+}
+
+double phaseMs(const std::string &phase)
+{
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto found = s.phases.find(phase);
+    return found != s.phases.end() ? found->second : -1.0;
+}
+
+long residentKb()
+{
+    // statm is a single line of page counts, cheaper to parse than status
+    FILE *file = std::fopen("/proc/self/statm", "re");
+    if (!file) {
+        return -1;
+    }
+    long sizePages = 0;
+    long residentPages = -1;
+    const int fields = std::fscanf(file, "%ld %ld", &sizePages, &residentPages);
+    std::fclose(file);
+    if (fields != 2) {
+        return -1;
+    }
+    return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+} // namespace StartupTimer
@@ -0,0 +1,308 @@
+#include "TargetSelector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double kYawRangeDeg = 120.0;
+constexpr double kPitchRangeDeg = 90.0;
+
+// Aiming speed of the larger axis; the other is scaled so both arrive together
+constexpr double kAimSpeedDegPerSec = 60.0;
+constexpr double kMinSpeedDegPerSec = 1.0;
+
+// Box handed to aiSetSelectTargetByBox for a click: about a head and
+// shoulders at a few metres in a 16:9 frame
+constexpr float kClickBoxWidth = 0.12f;
+constexpr float kClickBoxHeight = 0.2f;
+
+// Attitude change that counts as the gimbal moving, above sensor noise
+constexpr double kMotionThresholdDeg = 0.1;
+constexpr auto kMotionPollInterval = std::chrono::milliseconds(5);
+constexpr auto kMotionTimeout = std::chrono::milliseconds(1500);
+
+double degrees(double radians)
+{
+    return radians * 180.0 / kPi;
+}
+
+double radians(double degrees)
+{
+    return degrees * kPi / 180.0;
+}
+
+double msSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool hasGimbal(ObsbotProductType product)
+{
+    return product == ObsbotProdTiny || product == ObsbotProdTiny4k || product == ObsbotProdTiny2 ||
+           product == ObsbotProdTiny2Lite || product == ObsbotProdTinySE || product == ObsbotProdTailAir;
+}
+
+// Diagonal field of view at 1x for the camera's FOV setting
+double diagonalFovDeg(uint8_t fov)
+{
+    switch (fov) {
+    case Device::FovType78:
+        return 78.0;
+    case Device::FovType65:
+        return 65.0;
+    default:
+        return 86.0;
+    }
+}
+
+} // namespace
+
+TargetSelector::TargetSelector()
+    : m_stopping(false)
+    , m_busy(false)
+    , m_cancelling(false)
+    , m_hasPending(false)
+{
+}
+
+TargetSelector::~TargetSelector()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+const char *TargetSelector::actionName(Action action)
+{
+    switch (action) {
+    case TrackAt:
+        return "track-at";
+    case FrameBox:
+        return "frame-box";
+    case TrackCentral:
+        return "track-central";
+    case TrackBiggest:
+        return "track-biggest";
+    }
+    return "unknown";
+}
+
+void TargetSelector::request(std::shared_ptr<Device> dev, const Request &request)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingDevice = std::move(dev);
+        m_pending = request;
+        m_hasPending = true;
+        if (!m_thread.joinable()) {
+            m_thread = std::thread(&TargetSelector::workerLoop, this);
+        }
+    }
+    m_wake.notify_all();
+}
+
+void TargetSelector::cancel()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_hasPending = false;
+    m_pendingDevice.reset();
+    m_cancelling = true;
+    m_wake.notify_all();
+    m_wake.wait(lock, [this]() { return !m_busy; });
+    m_cancelling = false;
+}
+
+void TargetSelector::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_stopping || m_hasPending; });
+        if (m_stopping) {
+            return;
+        }
+
+        std::shared_ptr<Device> dev = std::move(m_pendingDevice);
+        Request request = m_pending;
+        m_hasPending = false;
+        m_busy = true;
+        lock.unlock();
+
+        Result result = run(dev, request);
+        if (m_resultCallback) {
+            m_resultCallback(result);
+        }
+
+        lock.lock();
+        m_busy = false;
+        m_wake.notify_all();
+    }
+}
+
+bool TargetSelector::shouldAbandonWait()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasPending || m_cancelling || m_stopping;
+}
+
+int32_t TargetSelector::send(Result &result, const char *name, int32_t ret)
+{
+    if (m_logger) {
+        m_logger(name, ret);
+    }
+    if (result.command.empty()) {
+        result.command = name;
+    }
+    result.result = ret;
+    return ret;
+}
+
+TargetSelector::Result TargetSelector::run(const std::shared_ptr<Device> &dev, const Request &request)
+{
+    Result result;
+    result.action = request.action;
+    if (!dev) {
+        return result;
+    }
+
+    const ObsbotProductType product = dev->productType();
+    const bool native = product == ObsbotProdTailAir;
+
+    float xyz[3] = {0.0f, 0.0f, 0.0f};
+    const bool haveAttitude = hasGimbal(product) && dev->gimbalGetAttitudeInfoR(xyz) == RM_RET_OK;
+
+    const float x0 = std::clamp(std::min(request.x0, request.x1), 0.0f, 1.0f);
+    const float y0 = std::clamp(std::min(request.y0, request.y1), 0.0f, 1.0f);
+    const float x1 = std::clamp(std::max(request.x0, request.x1), 0.0f, 1.0f);
+    const float y1 = std::clamp(std::max(request.y0, request.y1), 0.0f, 1.0f);
+
+    result.sendMs = msSince(request.issued);
+    switch (request.action) {
+    case TrackCentral:
+        send(result, "aiSetSelectCentralTarget", dev->aiSetSelectCentralTarget());
+        break;
+    case TrackBiggest:
+        send(result, "aiSetSelectBiggestTarget", dev->aiSetSelectBiggestTarget());
+        break;
+    case TrackAt:
+        if (!native && haveAttitude) {
+            aim(dev, request, result, xyz[2], xyz[1]);
+        } else {
+            const float cx = std::clamp(request.x0, kClickBoxWidth / 2, 1.0f - kClickBoxWidth / 2);
+            const float cy = std::clamp(request.y0, kClickBoxHeight / 2, 1.0f - kClickBoxHeight / 2);
+            send(result, "aiSetSelectTargetByBox",
+                 dev->aiSetSelectTargetByBox(cx - kClickBoxWidth / 2, cy - kClickBoxHeight / 2,
+                                             cx + kClickBoxWidth / 2, cy + kClickBoxHeight / 2));
+        }
+        break;
+    case FrameBox:
+        if (!native && haveAttitude) {
+            aim(dev, request, result, xyz[2], xyz[1]);
+        } else {
+            send(result, "cameraSetRoiTarget",
+                 dev->cameraSetRoiTarget(1, Device::ROIViewDefault, x0, y0, x1, y1));
+        }
+        break;
+    }
+    result.ackMs = msSince(request.issued);
+
+    if (result.result == RM_RET_OK && haveAttitude) {
+        waitForMotion(dev, request, result, xyz[2], xyz[1]);
+    }
+
+    std::cout << "[Target] " << actionName(request.action) << " via " << result.command;
+    if (result.result != RM_RET_OK) {
+        std::cout << " failed (" << result.result << ")" << std::endl;
+        return result;
+    }
+    std::cout << std::fixed << std::setprecision(1) << ": ack " << result.ackMs << " ms";
+    if (result.motionMs >= 0.0) {
+        std::cout << ", motion " << result.motionMs << " ms";
+    } else if (result.superseded) {
+        std::cout << ", superseded";
+    } else if (haveAttitude) {
+        std::cout << ", no motion";
+    }
+    std::cout << std::defaultfloat << std::endl;
+    return result;
+}
+
+int32_t TargetSelector::aim(const std::shared_ptr<Device> &dev, const Request &request, Result &result,
+                            float yawDeg, float pitchDeg)
+{
+    float zoom = 1.0f;
+    if (dev->cameraGetZoomAbsoluteR(zoom) != RM_RET_OK) {
+        zoom = 1.0f;
+    }
+
+    // Angular half-extent of the frame at the current zoom, from the diagonal FOV
+    const double aspect = request.frameAspect > 0.0 ? request.frameAspect : 16.0 / 9.0;
+    const double halfDiagonal = std::tan(radians(diagonalFovDeg(dev->cameraStatus().tiny.fov) / 2.0));
+    const double halfWidth = halfDiagonal * aspect / std::sqrt(aspect * aspect + 1.0) / zoom;
+    const double halfHeight = halfWidth / aspect;
+
+    double cx = request.x0;
+    double cy = request.y0;
+    if (request.action == FrameBox) {
+        cx = (request.x0 + request.x1) / 2.0;
+        cy = (request.y0 + request.y1) / 2.0;
+    }
+
+    // Yaw grows to the right and pitch upwards; frame y grows downwards
+    const double deltaYaw = degrees(std::atan((2.0 * cx - 1.0) * halfWidth));
+    const double deltaPitch = -degrees(std::atan((2.0 * cy - 1.0) * halfHeight));
+    const double targetYaw = std::clamp(yawDeg + deltaYaw, -kYawRangeDeg, kYawRangeDeg);
+    const double targetPitch = std::clamp(pitchDeg + deltaPitch, -kPitchRangeDeg, kPitchRangeDeg);
+
+    const double distance = std::max({std::abs(deltaYaw), std::abs(deltaPitch), 1e-6});
+    const double speedYaw = std::max(kMinSpeedDegPerSec, kAimSpeedDegPerSec * std::abs(deltaYaw) / distance);
+    const double speedPitch = std::max(kMinSpeedDegPerSec, kAimSpeedDegPerSec * std::abs(deltaPitch) / distance);
+
+    int32_t ret = send(result, "gimbalSetSpeedPositionR",
+                       dev->gimbalSetSpeedPositionR(0.0f, static_cast<float>(targetPitch), static_cast<float>(targetYaw),
+                                                    0.0f, static_cast<float>(speedPitch), static_cast<float>(speedYaw)));
+    if (ret != RM_RET_OK || request.action != FrameBox) {
+        return ret;
+    }
+
+    // Zoom so the whole box fits; the zoom is centered, so aim and zoom compose
+    const double width = std::abs(request.x1 - request.x0);
+    const double height = std::abs(request.y1 - request.y0);
+    const double fill = std::min(1.0 / std::max(width, 0.01), 1.0 / std::max(height, 0.01));
+    const float targetZoom = static_cast<float>(std::clamp(zoom * fill, 1.0, 2.0));
+    if (std::abs(targetZoom - zoom) > 0.01f) {
+        ret = send(result, "cameraSetZoomAbsoluteR", dev->cameraSetZoomAbsoluteR(targetZoom));
+    }
+    return ret;
+}
+
+void TargetSelector::waitForMotion(const std::shared_ptr<Device> &dev, const Request &request, Result &result,
+                                   float yawDeg, float pitchDeg)
+{
+    const auto deadline = std::chrono::steady_clock::now() + kMotionTimeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (shouldAbandonWait()) {
+            result.superseded = true;
+            return;
+        }
+
+        float xyz[3] = {0.0f, 0.0f, 0.0f};
+        if (dev->gimbalGetAttitudeInfoR(xyz) == RM_RET_OK &&
+            (std::abs(xyz[2] - yawDeg) > kMotionThresholdDeg || std::abs(xyz[1] - pitchDeg) > kMotionThresholdDeg)) {
+            result.motionMs = msSince(request.issued);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait_for(lock, kMotionPollInterval, [this]() { return m_hasPending || m_cancelling || m_stopping; });
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef TARGETSELECTOR_H
+#define TARGETSELECTOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <dev/dev.hpp>
+
+/**
+ * @brief Points the camera at something picked in the video frame
+ *
+ * Coordinates are normalised to the camera's output frame (0..1, origin
+ * top-left), which already reflects the hardware zoom, so callers only map
+ * their own view onto it. The Tail Air takes the selection natively
+ * (aiSetSelectTargetByBox / cameraSetRoiTarget). Other gimbal models have
+ * no target selection, so the point is turned into yaw/pitch offsets from
+ * the field of view and the gimbal is aimed at it; the AI tracker, if on,
+ * then locks onto whoever is centered.
+ *
+ * request() hands the work to a worker thread and returns immediately; a
+ * newer request replaces one still waiting, so a burst of clicks costs one
+ * USB exchange. After the acknowledge the worker polls the gimbal attitude
+ * until it moves, which gives the click-to-motion latency.
+ */
+class TargetSelector
+{
+public:
+    enum Action {
+        TrackAt,       // Track the subject under a point (x0, y0)
+        FrameBox,      // Frame the box (x0, y0)-(x1, y1)
+        TrackCentral,  // Track the subject nearest the center
+        TrackBiggest,  // Track the largest subject
+    };
+
+    struct Request {
+        Action action = TrackCentral;
+        float x0 = 0.0f;
+        float y0 = 0.0f;
+        float x1 = 1.0f;
+        float y1 = 1.0f;
+        double frameAspect = 16.0 / 9.0;  // Width / height of the frame the coordinates refer to
+        std::chrono::steady_clock::time_point issued = std::chrono::steady_clock::now();
+    };
+
+    struct Result {
+        Action action = TrackCentral;
+        std::string command;    // SDK call that carried the request
+        int32_t result = RM_RET_ERR;
+        double sendMs = 0.0;    // Issued to command sent (queueing and attitude read)
+        double ackMs = 0.0;     // Issued to the device acknowledging the command
+        double motionMs = -1.0; // Issued to the gimbal first moving; -1 if it did not move
+        bool superseded = false;  // A newer request cut the motion wait short
+    };
+
+    // Called on the worker thread when a request completes
+    using ResultCallback = std::function<void(const Result &result)>;
+    // Called for every command sent, e.g. to feed GimbalTelemetry
+    using CommandLogger = std::function<void(const std::string &name, int32_t result)>;
+
+    TargetSelector();
+    ~TargetSelector();
+
+    void setResultCallback(ResultCallback callback) { m_resultCallback = std::move(callback); }
+    void setCommandLogger(CommandLogger logger) { m_logger = std::move(logger); }
+
+    // Queue a request for the worker, replacing one not yet started
+    void request(std::shared_ptr<Device> dev, const Request &request);
+
+    // Run a request on the calling thread and wait for the motion
+    Result run(const std::shared_ptr<Device> &dev, const Request &request);
+
+    // Drop any queued request and cut the one in flight short. Must not be
+    // called from the result callback.
+    void cancel();
+
+    static const char *actionName(Action action);
+
+private:
+    CommandLogger m_logger;
+    ResultCallback m_resultCallback;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+    bool m_busy;
+    bool m_cancelling;
+    bool m_hasPending;
+    std::shared_ptr<Device> m_pendingDevice;
+    Request m_pending;
+
+    void workerLoop();
+    bool shouldAbandonWait();
+    int32_t send(Result &result, const char *name, int32_t ret);
+    int32_t aim(const std::shared_ptr<Device> &dev, const Request &request, Result &result,
+                float yawDeg, float pitchDeg);
+    void waitForMotion(const std::shared_ptr<Device> &dev, const Request &request, Result &result,
+                       float yawDeg, float pitchDeg);
+};
+
+#endif // TARGETSELECTOR_H
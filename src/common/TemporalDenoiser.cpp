@@ -0,0 +1,134 @@
+#include "TemporalDenoiser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// Luma differences from this to three times it, in 0..1, go from still to
+// moving. The blurred frame is compared, so grain moves it far less than a
+// subject does
+double motionThreshold(float strength)
+{
+    return 0.01 + 0.03 * strength;
+}
+
+inline uint8_t clampToByte(int value)
+{
+    return static_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+} // namespace
+
+TemporalDenoiser::TemporalDenoiser()
+    : m_strength(-1.0f)
+    , m_width(0)
+    , m_height(0)
+    , m_hasHistory(false)
+    , m_low(0)
+    , m_rampScale(0)
+    , m_maxHistory(0)
+    , m_maxSpatial(0)
+{
+    setStrength(0.0f);
+}
+
+void TemporalDenoiser::setStrength(float strength)
+{
+    strength = std::clamp(strength, 0.0f, 1.0f);
+    if (strength == m_strength) {
+        return;
+    }
+    m_strength = strength;
+    if (strength <= 0.0f) {
+        m_hasHistory = false;
+    }
+
+    // Same curve as the shader pass in FilterPreviewWidget, with the
+    // smoothstep there as a straight ramp, which the compiler can vectorize
+    const double low = motionThreshold(strength) * 255.0 * 256.0;
+    m_low = static_cast<int>(std::lround(low));
+    m_rampScale = static_cast<int>(std::lround(256.0 * 65536.0 / (2.0 * low)));
+    m_maxHistory = strength > 0.0f ? static_cast<int>(std::lround(256.0 * (0.5 + 0.4 * strength))) : 0;
+    m_maxSpatial = static_cast<int>(std::lround(256.0 * 0.75 * strength));
+}
+
+void TemporalDenoiser::reset()
+{
+    m_hasHistory = false;
+}
+
+void TemporalDenoiser::process(uint8_t *pixels, int width, int height, int bytesPerLine)
+{
+    if (m_strength <= 0.0f || width < 3 || height < 3) {
+        m_hasHistory = false;
+        return;
+    }
+
+    if (width != m_width || height != m_height) {
+        m_width = width;
+        m_height = height;
+        m_luma.resize(static_cast<size_t>(width) * height);
+        m_horizontal.resize(m_luma.size());
+        m_history.resize(m_luma.size());
+        m_delta.resize(width);
+        m_hasHistory = false;
+    }
+
+    // BT.601 luma, and its horizontal 1-2-1 pass
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *src = pixels + static_cast<size_t>(y) * bytesPerLine;
+        uint8_t *luma = m_luma.data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            luma[x] = static_cast<uint8_t>((77 * src[4 * x] + 150 * src[4 * x + 1] + 29 * src[4 * x + 2] + 128) >> 8);
+        }
+        uint16_t *horizontal = m_horizontal.data() + static_cast<size_t>(y) * width;
+        horizontal[0] = 3 * luma[0] + luma[1];
+        for (int x = 1; x < width - 1; ++x) {
+            horizontal[x] = luma[x - 1] + 2 * luma[x] + luma[x + 1];
+        }
+        horizontal[width - 1] = luma[width - 2] + 3 * luma[width - 1];
+    }
+
+    // Without history the whole frame counts as moving: blur only
+    const int high = m_hasHistory ? 3 * m_low : -1;
+    const int rampScale = m_rampScale;
+    const int maxHistory = m_maxHistory;
+    const int maxSpatial = m_maxSpatial;
+    int16_t *delta = m_delta.data();
+
+    for (int y = 0; y < height; ++y) {
+        const uint16_t *above = m_horizontal.data() + static_cast<size_t>(std::max(y - 1, 0)) * width;
+        const uint16_t *row = m_horizontal.data() + static_cast<size_t>(y) * width;
+        const uint16_t *below = m_horizontal.data() + static_cast<size_t>(std::min(y + 1, height - 1)) * width;
+        const uint8_t *luma = m_luma.data() + static_cast<size_t>(y) * width;
+        uint16_t *history = m_history.data() + static_cast<size_t>(y) * width;
+
+        for (int x = 0; x < width; ++x) {
+            // 8.8 fixed point from here, so slow accumulation does not band
+            const int current = luma[x] << 8;
+            const int spatial = (above[x] + 2 * row[x] + below[x]) << 4;
+            const int previous = history[x];
+
+            // 256 where the blurred frame matches the history, 0 from 3x the threshold
+            const int difference = std::abs(spatial - previous);
+            const int stillness = std::clamp(((high - difference) * rampScale) >> 16, 0, 256);
+            const int historyWeight = (stillness * maxHistory) >> 8;
+            const int spatialWeight = ((256 - stillness) * maxSpatial) >> 8;
+
+            const int base = current + (((spatial - current) * spatialWeight) >> 8);
+            const int result = base + (((previous - base) * historyWeight) >> 8);
+            history[x] = static_cast<uint16_t>(result);
+            delta[x] = static_cast<int16_t>(((result + 128) >> 8) - (current >> 8));
+        }
+
+        uint8_t *dst = pixels + static_cast<size_t>(y) * bytesPerLine;
+        for (int x = 0; x < width; ++x) {
+            dst[4 * x] = clampToByte(dst[4 * x] + delta[x]);
+            dst[4 * x + 1] = clampToByte(dst[4 * x + 1] + delta[x]);
+            dst[4 * x + 2] = clampToByte(dst[4 * x + 2] + delta[x]);
+        }
+    }
+    m_hasHistory = true;
+}
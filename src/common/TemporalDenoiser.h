@@ -0,0 +1,54 @@
+#ifndef TEMPORALDENOISER_H
+#define TEMPORALDENOISER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Motion-adaptive temporal denoise of RGBA frames on the CPU
+ *
+ * Where the picture is still, each pixel is blended with the denoised
+ * history of the previous frames, which averages the grain of a dim room
+ * away. Where the frame differs from the history by more than grain would
+ * explain, the pixel is something moving: the history is dropped there and
+ * a 3x3 spatial blur is used instead, so moving people do not ghost.
+ *
+ * Only luma is filtered, and the change is added back to R, G and B
+ * equally. That keeps the cost to one channel, and chroma noise is far
+ * less visible than luma noise. The same filter runs as a shader pass in
+ * FilterPreviewWidget; this is its fallback where that is not available,
+ * and what obsbot-denoise-bench measures.
+ */
+class TemporalDenoiser
+{
+public:
+    TemporalDenoiser();
+
+    // 0 is off and drops the history, 1 the strongest
+    void setStrength(float strength);
+    float strength() const { return m_strength; }
+
+    // Denoise an RGBA8888 frame in place; a new size starts a new history
+    void process(uint8_t *pixels, int width, int height, int bytesPerLine);
+
+    // Forget the history, e.g. after a cut
+    void reset();
+
+private:
+    float m_strength;
+    int m_width;
+    int m_height;
+    bool m_hasHistory;
+    std::vector<uint8_t> m_luma;         // This frame
+    std::vector<uint16_t> m_horizontal;  // 1-2-1 horizontal pass of m_luma
+    std::vector<uint16_t> m_history;     // Denoised luma so far, 8.8 fixed point
+    std::vector<int16_t> m_delta;        // One row's luma change, added to R, G and B
+
+    // From the strength, in the 8.8 fixed point of the history; weights are 0..256
+    int m_low;          // Difference below which a pixel is still
+    int m_rampScale;    // 256 / (3 * m_low - m_low), scaled by 65536
+    int m_maxHistory;   // History kept where still
+    int m_maxSpatial;   // Blur used where moving
+};
+
+#endif // TEMPORALDENOISER_H
@@ -0,0 +1,276 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Event {
+    int64_t ns;        // steady_clock
+    const char *name;  // String literal from the Scope
+    char phase;        // 'B' or 'E', as in the Chrome format
+    char detail[47];   // Sized so an event is one cache line
+};
+
+// One per thread that has recorded; written by that thread only
+struct Buffer {
+    std::mutex mutex;  // Uncontended except while write() copies the ring
+    std::vector<Event> events;
+    uint64_t recorded = 0;  // Since start(); the ring holds the newest kEventsPerThread
+    long tid = 0;
+    std::string threadName;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Buffer>> buffers;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+thread_local std::shared_ptr<Buffer> t_buffer;
+thread_local const char *t_threadName = nullptr;
+
+Buffer &threadBuffer()
+{
+    if (!t_buffer) {
+        auto buffer = std::make_shared<Buffer>();
+        buffer->events.resize(Trace::kEventsPerThread);
+        buffer->tid = syscall(SYS_gettid);
+        if (t_threadName) {
+            buffer->threadName = t_threadName;
+        } else {
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            buffer->threadName = name;
+        }
+
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.push_back(buffer);
+        t_buffer = std::move(buffer);
+    }
+    return *t_buffer;
+}
+
+void record(char phase, const char *name, const char *detail)
+{
+    const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    Buffer &buffer = threadBuffer();
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    Event &event = buffer.events[buffer.recorded++ % Trace::kEventsPerThread];
+    event.ns = ns;
+    event.name = name;
+    event.phase = phase;
+    if (detail) {
+        std::strncpy(event.detail, detail, sizeof(event.detail) - 1);
+        event.detail[sizeof(event.detail) - 1] = '\0';
+    } else {
+        event.detail[0] = '\0';
+    }
+}
+
+void writeJsonString(std::ostream &out, const char *text)
+{
+    out << '"';
+    for (const char *p = text; *p; ++p) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            out << '\\' << *p;
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        } else {
+            out << *p;
+        }
+    }
+    out << '"';
+}
+
+// Category is the part of the name before the first '.'
+std::string categoryOf(const char *name)
+{
+    const char *dot = std::strchr(name, '.');
+    return dot ? std::string(name, dot) : std::string(name);
+}
+
+} // namespace
+
+namespace Trace {
+
+namespace detail {
+
+std::atomic<bool> enabled{false};
+
+void begin(const char *name, const char *detail)
+{
+    record('B', name, detail);
+}
+
+void end(const char *name)
+{
+    record('E', name, nullptr);
+}
+
+} // namespace detail
+
+void start()
+{
+    Registry &r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::vector<std::shared_ptr<Buffer>> live;
+        for (auto &buffer : r.buffers) {
+            if (buffer.use_count() == 1) {
+                continue;  // Its thread has exited; nothing will be recorded there again
+            }
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            buffer->recorded = 0;
+            live.push_back(buffer);
+        }
+        r.buffers.swap(live);
+    }
+    detail::enabled.store(true, std::memory_order_relaxed);
+    std::cout << "[Trace] Recording" << std::endl;
+}
+
+void stop()
+{
+    detail::enabled.store(false, std::memory_order_relaxed);
+}
+
+long write(const std::string &path, std::string &error)
+{
+    struct Track {
+        long tid;
+        std::string name;
+        std::vector<Event> events;
+    };
+
+    // Copy each ring oldest first so recording threads are held up only briefly
+    std::vector<Track> tracks;
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (auto &buffer : r.buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            Track track{buffer->tid, buffer->threadName, {}};
+            const uint64_t count = std::min<uint64_t>(buffer->recorded, kEventsPerThread);
+            track.events.reserve(count);
+            for (uint64_t i = buffer->recorded - count; i < buffer->recorded; ++i) {
+                track.events.push_back(buffer->events[i % kEventsPerThread]);
+            }
+            tracks.push_back(std::move(track));
+        }
+    }
+
+    std::ofstream out(path);
+    if (!out) {
+        error = "Cannot open " + path + ": " + std::strerror(errno);
+        return -1;
+    }
+
+    const long pid = getpid();
+    long written = 0;
+    int threads = 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid << ",\"args\":{\"name\":";
+    writeJsonString(out, program_invocation_short_name);
+    out << "}}";
+
+    char timestamp[32];
+    for (const Track &track : tracks) {
+        if (track.events.empty()) {
+            continue;
+        }
+        ++threads;
+        out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << track.tid
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, track.name.c_str());
+        out << "}}";
+
+        // The ring may have overwritten the begin of the oldest scopes; skip their ends
+        int depth = 0;
+        for (const Event &event : track.events) {
+            if (event.phase == 'E') {
+                if (depth == 0) {
+                    continue;
+                }
+                --depth;
+            } else {
+                ++depth;
+            }
+
+            std::snprintf(timestamp, sizeof(timestamp), "%.3f", event.ns / 1000.0);
+            out << ",\n{\"ph\":\"" << event.phase << "\",\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"cat\":";
+            writeJsonString(out, categoryOf(event.name).c_str());
+            out << ",\"ts\":" << timestamp << ",\"pid\":" << pid << ",\"tid\":" << track.tid;
+            if (event.detail[0]) {
+                out << ",\"args\":{\"detail\":";
+                writeJsonString(out, event.detail);
+                out << '}';
+            }
+            out << '}';
+            ++written;
+        }
+    }
+    out << "\n]}\n";
+
+    out.close();
+    if (!out) {
+        error = "Failed to write " + path;
+        return -1;
+    }
+    std::cout << "[Trace] Wrote " << written << " events from " << threads << " threads to " << path
+              << std::endl;
+    return written;
+}
+
+std::string outputPath()
+{
+    const char *configured = std::getenv("OBSBOT_TRACE");
+    if (configured && *configured) {
+        return configured;
+    }
+
+    char name[64];
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    std::strftime(name, sizeof(name), "/tmp/obsbot-trace-%Y%m%d-%H%M%S.json", &local);
+    return name;
+}
+
+void setThreadName(const char *name)
+{
+    t_threadName = name;
+    if (t_buffer) {
+        std::lock_guard<std::mutex> lock(t_buffer->mutex);
+        t_buffer->threadName = name;
+    }
+}
+
+} // namespace Trace
@@ -0,0 +1,100 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <string>
+
+/**
+ * @brief Timeline of what every thread was doing, for Perfetto
+ *
+ * Scopes record begin/end events into a ring buffer owned by the calling
+ * thread, so threads never contend with each other, and write() dumps them
+ * as Chrome trace JSON that ui.perfetto.dev and chrome://tracing open as one
+ * track per thread:
+ *
+ *   void FilterPreviewWidget::paintGL()
+ *   {
+ *       Trace::Scope trace("frame.paint");
+ *       ...
+ *
+ * The part of a name before the first '.' is the event category. Names must
+ * be string literals; per-call text such as a command description goes in
+ * the detail, which is copied. Each thread keeps its newest kEventsPerThread
+ * events, so a long recording ends with the last minute or so rather than
+ * growing without bound.
+ *
+ * While tracing is off a scope costs one relaxed atomic load; buffers are
+ * only allocated on threads that record an event while it is on.
+ */
+namespace Trace {
+
+constexpr size_t kEventsPerThread = 1 << 15;
+
+namespace detail {
+extern std::atomic<bool> enabled;
+void begin(const char *name, const char *detail);
+void end(const char *name);
+} // namespace detail
+
+inline bool isEnabled()
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+// Start recording, discarding anything recorded before
+void start();
+
+// Stop recording; what was recorded is kept for write()
+void stop();
+
+/**
+ * @brief Write the recorded events as Chrome trace JSON
+ * @return Number of events written, or -1 with error set
+ */
+long write(const std::string &path, std::string &error);
+
+// Where a recording is written: $OBSBOT_TRACE, or a time-stamped file in /tmp
+std::string outputPath();
+
+// Name the calling thread's track; the OS thread name is used otherwise
+void setThreadName(const char *name);
+
+class Scope
+{
+public:
+    explicit Scope(const char *name, const char *detail = nullptr)
+        : m_name(name)
+        , m_active(isEnabled())
+    {
+        if (m_active) {
+            detail::begin(name, detail);
+        }
+    }
+
+    ~Scope()
+    {
+        // A scope that began while on is closed even if tracing stopped since
+        if (m_active) {
+            detail::end(m_name);
+        }
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *m_name;
+    bool m_active;
+};
+
+// Run a single call inside a scope, e.g. an SDK getter inside an if
+template <typename Function>
+auto call(const char *name, Function &&function) -> decltype(function())
+{
+    Scope scope(name);
+    return function();
+}
+
+} // namespace Trace
+
+#endif // TRACE_H
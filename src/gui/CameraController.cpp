@@ -1,11 +1,58 @@
 #include "CameraController.h"
+#include "GimbalPresets.h"
+#include "StartupTimer.h"
+#include "Trace.h"
 #include <QThread>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+bool samePresets(const std::vector<GimbalPresets::Slot> &a, const std::vector<GimbalPresets::Slot> &b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto &x, const auto &y) {
+        return x.defined == y.defined && x.pan == y.pan && x.tilt == y.tilt && x.zoom == y.zoom;
+    });
+}
+
+// Cached ranges are confirmed against the device once connect-time traffic is over
+constexpr int kRangeRevalidationDelayMs = 5000;
+
+// Settling after a bulk apply polls the read-back of the fields just sent
+constexpr int kSettlingPollMs = 100;
+constexpr qint64 kSettlingTimeoutMs = 1500;
+// Auto framing is a confirmed two-step CommandSequence, up to 2 s per step
+constexpr qint64 kAutoFramingSettlingTimeoutMs = 4500;
+
+// Read-back may land on the nearest step rather than the exact value
+int stepTolerance(const ControlRanges::Range &range)
+{
+    return range.valid ? std::max(0, range.step - 1) : 0;
+}
+
+// False when every range query failed, e.g. the camera went away mid-query
+bool hasAnyRange(const ControlRanges &ranges)
+{
+    return ranges.brightness.valid || ranges.contrast.valid || ranges.saturation.valid ||
+           ranges.whiteBalanceKelvin.valid || !ranges.whiteBalanceTypes.empty();
+}
+
+} // namespace
 
 CameraController::CameraController(QObject *parent)
     : QObject(parent)
     , m_connected(false)
+    , m_connecting(false)
+    , m_sdkReady(false)
+    , m_configSaver(m_config)
+    , m_configWatcher(m_config)
     , m_settlingTimer(nullptr)
+    , m_rangeGeneration(0)
+    , m_hardwarePresetsSynced(false)
+    , m_presetSyncRunning(false)
+    , m_presetGeneration(0)
 {
     m_currentState = {};
     m_cachedState = {};
@@ -17,73 +64,194 @@ CameraController::CameraController(QObject *parent)
 
     // Create settling timer
     m_settlingTimer = new QTimer(this);
-    m_settlingTimer->setSingleShot(true);
+    m_settlingTimer->setInterval(kSettlingPollMs);
+    connect(m_settlingTimer, &QTimer::timeout, this, &CameraController::checkSettling);
 
     resetControlRanges();
+
+    m_sequencer.setCommandLogger([this](const std::string &name, int32_t result) {
+        m_telemetry.logCommand(name, result);
+    });
+    m_sequencer.setFinishedCallback([this](const PtzSequencer::Status &status) {
+        // Runs on the sequencer thread; hand over to the controller's thread
+        QMetaObject::invokeMethod(this, [this, status]() {
+            const auto settings = m_config.getSettings();
+            for (const auto &sequence : settings.sequences) {
+                if (status.completed && sequence.name == status.name) {
+                    const auto &last = sequence.keyframes.back();
+                    m_currentState.pan = last.pan;
+                    m_currentState.tilt = last.tilt;
+                    m_currentState.zoom = last.zoom;
+                    emit stateChanged(m_currentState);
+                }
+            }
+            emit sequenceFinished(QString::fromStdString(status.name), status.completed,
+                                  QString::fromStdString(status.error));
+        }, Qt::QueuedConnection);
+    });
+    m_targetSelector.setCommandLogger([this](const std::string &name, int32_t result) {
+        m_telemetry.logCommand(name, result);
+    });
+    m_targetSelector.setResultCallback([this](const TargetSelector::Result &result) {
+        // Runs on the selector's worker thread
+        QMetaObject::invokeMethod(this, [this, result]() {
+            const QString action = TargetSelector::actionName(result.action);
+            if (result.result != RM_RET_OK) {
+                emit commandFailed(QString("Select Target (%1 via %2)")
+                                       .arg(action, QString::fromStdString(result.command)),
+                                   result.result);
+            }
+            emit targetSelectionFinished(action, result.result == RM_RET_OK, result.ackMs, result.motionMs);
+        }, Qt::QueuedConnection);
+    });
+    m_commandSequence.setCommandLogger([this](const std::string &name, int32_t result) {
+        m_telemetry.logCommand(name, result);
+    });
+    m_commandSequence.setResultCallback([this](const CommandSequence::Result &result) {
+        // Runs on the sequence worker; a superseded sequence reports nothing
+        if (result.outcome == CommandSequence::Completed || result.outcome == CommandSequence::Cancelled) {
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this, result]() {
+            emit commandFailed(QString("%1 (%2 %3)")
+                                   .arg(QString::fromStdString(result.name), QString::fromStdString(result.step),
+                                        CommandSequence::outcomeName(result.outcome)),
+                               result.outcome == CommandSequence::Failed ? result.result : RM_RET_ERR);
+            // Show what the camera actually ended up in
+            if (m_connected && !isSettling()) {
+                updateState();
+            }
+        }, Qt::QueuedConnection);
+    });
 }
 
 CameraController::~CameraController()
 {
+    ++m_rangeGeneration;
+    ++m_presetGeneration;
+    joinRangeRevalidation();
+    joinPresetSync();
+    // An init thread that has finished set the callback even if its queued
+    // handoff never ran to mark the SDK ready
+    const bool sdkStarted = m_sdkReady || m_sdkInit.joinable();
+    joinSdkInit();
+    if (sdkStarted) {
+        Devices::get().setDevChangedCallback(nullptr, nullptr);
+    }
 }
 
 void CameraController::connectToCamera()
 {
-    // Setup device detection callback
-    auto onDevChanged = [this](std::string dev_sn, bool connected, void *param) {
-        if (connected) {
-            // Device connected
-            auto dev_list = Devices::get().getDevList();
-            if (!dev_list.empty()) {
-                m_device = dev_list.front();
-                m_connected = true;
-
-                m_cameraInfo.name = QString::fromStdString(m_device->devName());
-                m_cameraInfo.serialNumber = QString::fromStdString(m_device->devSn());
-                m_cameraInfo.version = QString::fromStdString(m_device->devVersion());
-                m_cameraInfo.productType = m_device->productType();
-                m_cameraInfo.connected = true;
-
-                refreshControlRanges();
-                emit cameraConnected(m_cameraInfo);
-                updateState();
-            }
-        } else {
-            m_connected = false;
-            m_cameraInfo.connected = false;
-            resetControlRanges();
-            emit cameraDisconnected();
-        }
-    };
+    if (m_connected || m_connecting) {
+        return;
+    }
+    m_connecting = true;
+
+    if (m_sdkReady) {
+        // The SDK keeps its device list current; asking is cheap from here on
+        finishConnect(Devices::get().getDevList());
+        return;
+    }
+    if (m_sdkInit.joinable()) {
+        return;  // The scan in flight finishes the connect
+    }
 
-    Devices::get().setDevChangedCallback(onDevChanged, nullptr);
-    Devices::get().setEnableMdnsScan(false);  // USB only
+    // Starting the SDK enumerates USB and can take a good while on a busy
+    // bus; do it on a worker so the window paints meanwhile
+    m_sdkInit = std::thread([this]() {
+        // Plug events arrive on the SDK's hotplug thread; handle them on ours
+        auto onDevChanged = [this](std::string dev_sn, bool connected, void *param) {
+            QMetaObject::invokeMethod(this, [this, connected]() {
+                if (connected) {
+                    m_connecting = true;
+                    finishConnect(Devices::get().getDevList());
+                } else {
+                    detachDevice();
+                }
+            }, Qt::QueuedConnection);
+        };
+        Devices::get().setDevChangedCallback(onDevChanged, nullptr);
+        Devices::get().setEnableMdnsScan(false);  // USB only
+
+        // The callback only fires on connect/disconnect events, so a camera
+        // that is already plugged in has to be picked up from the list
+        auto devices = Devices::get().getDevList();
+        StartupTimer::mark("SDK ready");
+        QMetaObject::invokeMethod(this, [this, devices]() {
+            joinSdkInit();
+            m_sdkReady = true;
+            finishConnect(devices);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CameraController::finishConnect(const std::list<std::shared_ptr<Device>> &devices)
+{
+    if (!m_connecting) {
+        return;  // Disconnected meanwhile
+    }
+    m_connecting = false;
+    if (m_connected || devices.empty()) {
+        emit deviceScanFinished(m_connected);
+        return;
+    }
 
-    // Actively check for existing devices (handles reconnection scenario)
-    // The callback only fires on connect/disconnect events, so if the device
-    // is already connected (e.g., after window restore), we need to connect directly
-    auto dev_list = Devices::get().getDevList();
-    if (!dev_list.empty() && !m_connected) {
-        m_device = dev_list.front();
-        m_connected = true;
+    m_device = devices.front();
+    m_connected = true;
 
-        m_cameraInfo.name = QString::fromStdString(m_device->devName());
-        m_cameraInfo.serialNumber = QString::fromStdString(m_device->devSn());
+    m_cameraInfo.name = QString::fromStdString(m_device->devName());
+    m_cameraInfo.serialNumber = QString::fromStdString(m_device->devSn());
     m_cameraInfo.version = QString::fromStdString(m_device->devVersion());
     m_cameraInfo.productType = m_device->productType();
     m_cameraInfo.connected = true;
 
     refreshControlRanges();
+    syncPresetsWithDevice();
     emit cameraConnected(m_cameraInfo);
+    emit deviceScanFinished(true);
     updateState();
+    StartupTimer::mark("camera connected");
+}
+
+void CameraController::detachDevice()
+{
+    ++m_rangeGeneration;
+    ++m_presetGeneration;
+    m_sequencer.stop();
+    m_targetSelector.cancel();
+    m_commandSequence.cancel();
+    m_telemetry.stop();
+    m_connecting = false;
+    m_connected = false;
+    m_hardwarePresetsSynced = false;
+    m_cameraInfo.connected = false;
+    resetControlRanges();
+    emit cameraDisconnected();
+}
+
+void CameraController::joinSdkInit()
+{
+    if (m_sdkInit.joinable()) {
+        m_sdkInit.join();
     }
 }
 
 void CameraController::disconnectFromCamera()
 {
+    m_connecting = false;  // A scan still in flight attaches nothing
     if (m_connected) {
         // Release our device handle - this allows other apps to access the camera
+        ++m_rangeGeneration;
+        ++m_presetGeneration;
+        m_sequencer.stop();
+        m_targetSelector.cancel();
+        m_commandSequence.cancel();
+        m_telemetry.stop();
+        joinRangeRevalidation();
+        joinPresetSync();
         m_device.reset();
         m_connected = false;
+        m_hardwarePresetsSynced = false;
         m_cameraInfo.connected = false;
         resetControlRanges();
 
@@ -110,33 +278,16 @@ bool CameraController::enableAutoFraming(bool enabled)
     if (!m_connected) return false;
 
     if (enabled) {
-        // Step 1: Set MediaMode to AutoFrame
-        if (!executeCommand("Set MediaMode to AutoFrame", [this]() {
-            return m_device->cameraSetMediaModeU(Device::MediaModeAutoFrame);
-        })) {
-            return false;
-        }
+        m_sequencer.stop();  // Tracking takes over the gimbal
+    }
 
-        // Step 2: Set auto-framing mode after a brief delay (non-blocking)
-        QTimer::singleShot(500, [this]() {
-            executeCommand("Set AutoFraming mode", [this]() {
-                return m_device->cameraSetAutoFramingModeU(Device::AutoFrmSingle, Device::AutoFrmUpperBody);
-            });
-        });
+    // Media mode first, then the framing mode once the camera reports the
+    // switch; a failure or timeout arrives later through commandFailed
+    m_commandSequence.start(m_device, CommandSequence::autoFraming(m_device->productType(), enabled));
 
-        m_currentState.autoFramingEnabled = true;
-        emit stateChanged(m_currentState);
-        return true;  // First command succeeded, second is pending
-    } else {
-        bool success = executeCommand("Disable AutoFraming", [this]() {
-            return m_device->cameraSetMediaModeU(Device::MediaModeNormal);
-        });
-        if (success) {
-            m_currentState.autoFramingEnabled = false;
-            emit stateChanged(m_currentState);
-        }
-        return success;
-    }
+    m_currentState.autoFramingEnabled = enabled;
+    emit stateChanged(m_currentState);
+    return true;
 }
 
 bool CameraController::setAiMode(int mode, int subMode)
@@ -215,6 +366,7 @@ bool CameraController::setPanTilt(double pan, double tilt)
     pan = qBound(-1.0, pan, 1.0);
     tilt = qBound(-1.0, tilt, 1.0);
 
+    m_sequencer.stop();
     bool success = executeCommand("Set Pan/Tilt", [this, pan, tilt]() {
         return m_device->cameraSetPanTiltAbsolute(pan, tilt);
     });
@@ -247,6 +399,7 @@ bool CameraController::setZoom(double zoom)
     // Clamp to valid range (1.0 - 2.0)
     zoom = qBound(1.0, zoom, 2.0);
 
+    m_sequencer.stop();
     bool success = executeCommand("Set Zoom", [this, zoom]() {
         return m_device->cameraSetZoomAbsoluteR(zoom);
     });
@@ -264,6 +417,141 @@ bool CameraController::centerView()
     return setPanTilt(0.0, 0.0);
 }
 
+bool CameraController::hasHardwarePresets() const
+{
+    return GimbalPresets::supported(m_cameraInfo.productType);
+}
+
+bool CameraController::recallPreset(int index)
+{
+    if (!m_connected) return false;
+
+    auto settings = m_config.getSettings();
+    if (index < 0 || index >= static_cast<int>(settings.presets.size())) {
+        return false;
+    }
+    const auto slot = settings.presets[static_cast<size_t>(index)];
+    if (!slot.defined) {
+        return false;
+    }
+
+    if (!m_hardwarePresetsSynced) {
+        bool moved = setPanTilt(slot.pan, slot.tilt);
+        bool zoomed = setZoom(slot.zoom);
+        return moved && zoomed;
+    }
+
+    // Single trigger: the gimbal moves and zooms in one motion
+    m_sequencer.stop();
+    bool success = executeCommand("Recall Preset", [this, index]() {
+        return m_device->aiTrgGimbalPresetR(index);
+    });
+
+    if (success) {
+        m_currentState.pan = slot.pan;
+        m_currentState.tilt = slot.tilt;
+        m_currentState.zoom = slot.zoom;
+        emit stateChanged(m_currentState);
+    }
+
+    return success;
+}
+
+bool CameraController::storePreset(int index)
+{
+    if (index < 0 || index >= Config::kMaxPresets) {
+        return false;
+    }
+
+    auto state = getCurrentState();
+    Config::CameraSettings::PresetSlot slot{true, state.pan, state.tilt, state.zoom};
+
+    // Prefer the real gimbal attitude; tracking may have moved it since the last set
+    float xyz[3] = {0.0f, 0.0f, 0.0f};
+    if (m_connected && m_hardwarePresetsSynced && m_device->gimbalGetAttitudeInfoR(xyz) == RM_RET_OK) {
+        Device::PresetPosInfo attitude{};
+        attitude.pitch = xyz[1];
+        attitude.yaw = xyz[2];
+        attitude.zoom = static_cast<float>(slot.zoom);
+        slot = GimbalPresets::fromDevice(attitude);
+    }
+
+    auto settings = m_config.getSettings();
+    if (settings.presets.size() <= static_cast<size_t>(index)) {
+        settings.presets.resize(static_cast<size_t>(index) + 1, {false, 0.0, 0.0, 1.0});
+    }
+    settings.presets[static_cast<size_t>(index)] = slot;
+    m_config.setSettings(settings);
+
+    if (!m_connected || !m_hardwarePresetsSynced) {
+        return true;
+    }
+
+    // aiAddGimbalPresetR overwrites an existing preset with the same id
+    auto info = GimbalPresets::toDevice(index, slot);
+    return executeCommand("Store Preset", [this, &info]() {
+        return m_device->aiAddGimbalPresetR(&info);
+    });
+}
+
+bool CameraController::startTelemetry(const QString &path, int rateHz)
+{
+    if (!m_connected) return false;
+    return m_telemetry.start(m_device, path.toStdString(), rateHz);
+}
+
+void CameraController::stopTelemetry()
+{
+    m_telemetry.stop();
+}
+
+bool CameraController::playSequence(const QString &name)
+{
+    if (!m_connected) return false;
+
+    if (m_currentState.autoFramingEnabled) {
+        // AI tracking would steer the gimbal against the sequence
+        emit commandFailed("Play Sequence (turn off AI tracking first)", -1);
+        return false;
+    }
+
+    const auto settings = m_config.getSettings();
+    auto it = std::find_if(settings.sequences.begin(), settings.sequences.end(),
+                           [&name](const Config::CameraSettings::Sequence &sequence) {
+                               return sequence.name == name.toStdString();
+                           });
+    if (it == settings.sequences.end()) {
+        return false;
+    }
+
+    std::string error;
+    if (!m_sequencer.start(m_device, *it, error)) {
+        emit commandFailed(QString("Play Sequence (%1)").arg(QString::fromStdString(error)), -1);
+        return false;
+    }
+    emit sequenceStarted(name);
+    return true;
+}
+
+void CameraController::stopSequence()
+{
+    m_sequencer.stop();
+}
+
+bool CameraController::selectTarget(const TargetSelector::Request &request)
+{
+    if (!m_connected) return false;
+
+    m_sequencer.stop();
+    m_targetSelector.request(m_device, request);
+    return true;
+}
+
+bool CameraController::hasSubjectSelection() const
+{
+    return m_cameraInfo.productType == ObsbotProdTailAir;
+}
+
 bool CameraController::setHDR(bool enabled)
 {
     if (!m_connected) return false;
@@ -443,7 +731,13 @@ bool CameraController::setWhiteBalanceManual(int kelvin)
 
 bool CameraController::executeCommand(const QString &description, std::function<int32_t()> command)
 {
-    int32_t ret = command();
+    int32_t ret;
+    {
+        const QByteArray label = Trace::isEnabled() ? description.toUtf8() : QByteArray();
+        Trace::Scope trace("sdk.command", label.constData());
+        ret = command();
+    }
+    m_telemetry.logCommand(description.toStdString(), ret);
     if (ret != 0) {
         emit commandFailed(description, ret);
         return false;
@@ -460,7 +754,8 @@ void CameraController::updateState()
         return;
     }
 
-    auto status = m_device->cameraStatus();
+    Trace::Scope trace("sdk.poll");
+    auto status = Trace::call("sdk.cameraStatus", [this]() { return m_device->cameraStatus(); });
 
     m_currentState.aiMode = status.tiny.ai_mode;
     m_currentState.aiSubMode = status.tiny.ai_sub_mode;
@@ -485,16 +780,16 @@ void CameraController::updateState()
     Device::DevWhiteBalanceType wbType;
     int32_t wbParam;
 
-    if (m_device->cameraGetImageBrightnessR(brightness) == 0) {
+    if (Trace::call("sdk.cameraGetImageBrightnessR", [&]() { return m_device->cameraGetImageBrightnessR(brightness); }) == 0) {
         m_currentState.brightness = clampToRange(brightness, m_brightnessRange, 0, 255);
     }
-    if (m_device->cameraGetImageContrastR(contrast) == 0) {
+    if (Trace::call("sdk.cameraGetImageContrastR", [&]() { return m_device->cameraGetImageContrastR(contrast); }) == 0) {
         m_currentState.contrast = clampToRange(contrast, m_contrastRange, 0, 255);
     }
-    if (m_device->cameraGetImageSaturationR(saturation) == 0) {
+    if (Trace::call("sdk.cameraGetImageSaturationR", [&]() { return m_device->cameraGetImageSaturationR(saturation); }) == 0) {
         m_currentState.saturation = clampToRange(saturation, m_saturationRange, 0, 255);
     }
-    if (m_device->cameraGetWhiteBalanceR(wbType, wbParam) == 0) {
+    if (Trace::call("sdk.cameraGetWhiteBalanceR", [&]() { return m_device->cameraGetWhiteBalanceR(wbType, wbParam); }) == 0) {
         m_currentState.whiteBalance = static_cast<int>(wbType);
         if (wbType == Device::DevWhiteBalanceManual) {
             m_currentState.whiteBalanceKelvin = clampToRange(wbParam, m_whiteBalanceKelvinRange, 2000, 10000);
@@ -517,23 +812,312 @@ void CameraController::updateState()
     emit stateChanged(m_currentState);
 }
 
-void CameraController::beginSettling(int durationMs)
+void CameraController::beginSettling(const CameraState &intended)
 {
-    // Cache the current intended state
-    m_cachedState = m_currentState;
-    m_settlingTimer->start(durationMs);
+    m_cachedState = intended;
+    m_settlingFields.clear();
+
+    auto addField = [this](const QString &name, int wanted, int tolerance, qint64 timeoutMs,
+                           std::function<bool(int &value)> read) {
+        m_settlingFields.push_back({name, wanted, tolerance, timeoutMs, std::move(read), 0, false, false});
+    };
+    // Status fields come from the SDK's pushed cache and cost no USB traffic
+    auto addStatusField = [this, &addField](const QString &name, int wanted, qint64 timeoutMs,
+                                            std::function<int(const Device::CameraStatus &status)> value) {
+        addField(name, wanted, 0, timeoutMs, [this, value](int &read) {
+            read = value(m_device->cameraStatus());
+            return true;
+        });
+    };
+
+    // CameraStatus is a union; only read the layout this model reports in
+    const ObsbotProductType product = m_cameraInfo.productType;
+    const bool meetStatus = CommandSequence::usesMeetStatus(product);
+    const bool tinyStatus = !meetStatus && product != ObsbotProdTailAir;
+    if (meetStatus) {
+        addStatusField("auto_framing", intended.autoFramingEnabled, kAutoFramingSettlingTimeoutMs,
+                       [](const Device::CameraStatus &status) {
+                           return status.meet.media_mode == static_cast<uint8_t>(Device::MediaModeAutoFrame);
+                       });
+    } else if (tinyStatus) {
+        addStatusField("auto_framing", intended.autoFramingEnabled, kAutoFramingSettlingTimeoutMs,
+                       [](const Device::CameraStatus &status) { return status.tiny.ai_mode != Device::AiWorkModeNone; });
+    }
+    if (isTiny2Family()) {
+        addStatusField("track_speed", intended.trackSpeedMode, kSettlingTimeoutMs,
+                       [](const Device::CameraStatus &status) { return status.tiny.ai_tracker_speed; });
+        addStatusField("audio_auto_gain", intended.audioAutoGainEnabled, kSettlingTimeoutMs,
+                       [](const Device::CameraStatus &status) { return status.tiny.audio_auto_gain; });
+    }
+    if (tinyStatus) {
+        addStatusField("hdr", intended.hdrEnabled, kSettlingTimeoutMs,
+                       [](const Device::CameraStatus &status) { return status.tiny.hdr; });
+        addStatusField("fov", intended.fovMode, kSettlingTimeoutMs,
+                       [](const Device::CameraStatus &status) { return status.tiny.fov; });
+        addStatusField("face_ae", intended.faceAEEnabled, kSettlingTimeoutMs,
+                       [](const Device::CameraStatus &status) { return status.tiny.face_ae; });
+        addStatusField("face_focus", intended.faceFocusEnabled, kSettlingTimeoutMs,
+                       [](const Device::CameraStatus &status) { return status.tiny.face_auto_focus; });
+    }
+
+    // Image controls in auto mode are not sent, so there is nothing to wait for
+    if (!intended.brightnessAuto) {
+        addField("brightness", clampToRange(intended.brightness, m_brightnessRange, 0, 255),
+                 stepTolerance(m_brightnessRange), kSettlingTimeoutMs,
+                 [this](int &read) { return m_device->cameraGetImageBrightnessR(read) == 0; });
+    }
+    if (!intended.contrastAuto) {
+        addField("contrast", clampToRange(intended.contrast, m_contrastRange, 0, 255),
+                 stepTolerance(m_contrastRange), kSettlingTimeoutMs,
+                 [this](int &read) { return m_device->cameraGetImageContrastR(read) == 0; });
+    }
+    if (!intended.saturationAuto) {
+        addField("saturation", clampToRange(intended.saturation, m_saturationRange, 0, 255),
+                 stepTolerance(m_saturationRange), kSettlingTimeoutMs,
+                 [this](int &read) { return m_device->cameraGetImageSaturationR(read) == 0; });
+    }
+
+    // A preset the camera lacks is applied as manual Kelvin; compare what
+    // updateState() would show, i.e. the preset it stands in for
+    addField("white_balance", intended.whiteBalance, 0, kSettlingTimeoutMs, [this](int &read) {
+        Device::DevWhiteBalanceType type;
+        int32_t param;
+        if (m_device->cameraGetWhiteBalanceR(type, param) != 0) {
+            return false;
+        }
+        read = m_whiteBalanceFallbackActive ? m_fallbackWhiteBalanceMode : static_cast<int>(type);
+        return true;
+    });
+    if (intended.whiteBalance == static_cast<int>(Device::DevWhiteBalanceManual)) {
+        addField("white_balance_kelvin", clampToRange(intended.whiteBalanceKelvin, m_whiteBalanceKelvinRange, 2000, 10000),
+                 stepTolerance(m_whiteBalanceKelvinRange), kSettlingTimeoutMs, [this](int &read) {
+                     Device::DevWhiteBalanceType type;
+                     int32_t param;
+                     if (m_device->cameraGetWhiteBalanceR(type, param) != 0) {
+                         return false;
+                     }
+                     read = param;
+                     return true;
+                 });
+    }
+
+    m_settlingClock.start();
+    m_settlingTimer->start();
+}
+
+void CameraController::checkSettling()
+{
+    if (!m_connected) {
+        m_settlingTimer->stop();
+        m_settlingFields.clear();
+        return;
+    }
+
+    // Converged fields are not read again; the rest are read until they
+    // match or, once past their timeout, until everything else is done
+    const qint64 elapsedMs = m_settlingClock.elapsed();
+    bool waiting = false;
+    for (auto &field : m_settlingFields) {
+        if (field.converged) {
+            continue;
+        }
+        if (field.read(field.lastRead)) {
+            field.haveRead = true;
+            if (std::abs(field.lastRead - field.intended) <= field.tolerance) {
+                field.converged = true;
+                continue;
+            }
+        }
+        if (elapsedMs < field.timeoutMs) {
+            waiting = true;
+        }
+    }
+    if (waiting) {
+        return;
+    }
+
+    m_settlingTimer->stop();
+
+    QStringList drift;
+    for (const auto &field : m_settlingFields) {
+        if (field.converged) {
+            continue;
+        }
+        if (field.haveRead) {
+            drift << QString("%1: wanted %2, camera reports %3").arg(field.name).arg(field.intended).arg(field.lastRead);
+        } else {
+            drift << QString("%1: wanted %2, not readable").arg(field.name).arg(field.intended);
+        }
+    }
+    m_settlingFields.clear();
+
+    if (drift.isEmpty()) {
+        std::cout << "[Settling] Camera matched the applied state after " << elapsedMs << " ms" << std::endl;
+    } else {
+        std::cout << "[Settling] " << drift.size() << " field(s) did not match after " << elapsedMs << " ms:" << std::endl;
+        for (const QString &line : drift) {
+            std::cout << "[Settling]   " << line.toStdString() << std::endl;
+        }
+    }
+
+    emit settlingFinished(static_cast<int>(elapsedMs), drift);
+    updateState();  // Publish what the camera actually reports
 }
 
 bool CameraController::loadConfig(std::vector<Config::ValidationError> &errors)
 {
-    return m_config.load(errors);
+    bool ok = m_config.load(errors);
+
+    // Pick up edits by other programs (provisioning, a text editor) while running
+    m_configWatcher.start([this](const ConfigWatcher::Change &change) {
+        // Runs on the watcher thread
+        QMetaObject::invokeMethod(this, [this, change]() {
+            applyExternalConfig(change);
+        }, Qt::QueuedConnection);
+    });
+    return ok;
+}
+
+void CameraController::applyExternalConfig(const ConfigWatcher::Change &change)
+{
+    if (!change.errors.empty()) {
+        // Keep running on the settings we have; the next save rewrites the file
+        std::cerr << "[Config] Ignoring external edit of settings.conf with " << change.errors.size()
+                  << " error(s):" << std::endl;
+        for (const auto &error : change.errors) {
+            std::cerr << "[Config]   " << (error.lineNumber > 0 ? "line " + std::to_string(error.lineNumber) + ": " : "")
+                      << error.message << std::endl;
+        }
+        return;
+    }
+
+    // A save still waiting out its debounce holds older content; it must not land over the edit
+    m_configSaver.cancel();
+    const auto keys = Config::changedKeys(m_config.getSettings(), change.settings);
+    m_config.acceptExternalEdit(change.settings, change.content);
+    if (keys.empty()) {
+        return;
+    }
+
+    QStringList changed;
+    for (const auto &key : keys) {
+        changed << QString::fromStdString(key);
+    }
+    std::cout << "[Config] settings.conf edited externally: " << changed.join(", ").toStdString() << std::endl;
+
+    applyChangedSettings(change.settings, changed);
+    emit settingsReplaced(changed);
+}
+
+bool CameraController::applyProfile(const QString &name)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto settings = m_config.getSettings();
+    std::vector<Config::ValidationError> errors;
+    if (!m_config.loadProfile(name.toStdString(), settings, errors)) {
+        std::cerr << "[Profile] Cannot apply '" << name.toStdString() << "'"
+                  << (errors.empty() ? "" : ": " + errors.front().message) << std::endl;
+        return false;
+    }
+
+    QStringList changed;
+    for (const auto &key : Config::changedKeys(m_config.getSettings(), settings)) {
+        changed << QString::fromStdString(key);
+    }
+    m_config.setSettings(settings);
+    applyChangedSettings(settings, changed);
+    saveConfig();
+
+    std::cout << "[Profile] Switched to '" << name.toStdString() << "': " << changed.size()
+              << " setting(s) changed in " << timer.nsecsElapsed() / 1000000.0 << " ms" << std::endl;
+    emit settingsReplaced(changed);
+    return true;
+}
+
+void CameraController::applyChangedSettings(const Config::CameraSettings &after, const QStringList &changed)
+{
+    auto has = [&changed](const char *key) { return changed.contains(QLatin1String(key)); };
+
+    // Take the changed settings as the state first. Each setter below emits
+    // stateChanged, which saves m_currentState over the config; a field its
+    // setter leaves alone (brightness in auto mode, a failed command) would
+    // otherwise save its old value and undo the change
+    m_currentState.brightnessAuto = after.brightnessAuto;
+    m_currentState.contrastAuto = after.contrastAuto;
+    m_currentState.saturationAuto = after.saturationAuto;
+    if (has("face_tracking")) m_currentState.autoFramingEnabled = after.faceTracking;
+    if (has("hdr")) m_currentState.hdrEnabled = after.hdr;
+    if (has("fov")) m_currentState.fovMode = after.fov;
+    if (has("face_ae")) m_currentState.faceAEEnabled = after.faceAE;
+    if (has("face_focus")) m_currentState.faceFocusEnabled = after.faceFocus;
+    if (has("zoom")) m_currentState.zoom = after.zoom;
+    if (has("pan") || has("tilt")) {
+        m_currentState.pan = after.pan;
+        m_currentState.tilt = after.tilt;
+    }
+    if (has("ai_mode") || has("ai_sub_mode")) {
+        m_currentState.aiMode = after.aiMode;
+        m_currentState.aiSubMode = after.aiSubMode;
+    }
+    if (has("auto_zoom")) m_currentState.autoZoomEnabled = after.autoZoom;
+    if (has("track_speed")) m_currentState.trackSpeedMode = after.trackSpeed;
+    if (has("audio_auto_gain")) m_currentState.audioAutoGainEnabled = after.audioAutoGain;
+    if (has("brightness")) m_currentState.brightness = after.brightness;
+    if (has("contrast")) m_currentState.contrast = after.contrast;
+    if (has("saturation")) m_currentState.saturation = after.saturation;
+    if (has("white_balance") || has("white_balance_kelvin")) {
+        m_currentState.whiteBalance = after.whiteBalance;
+        m_currentState.whiteBalanceKelvin = after.whiteBalanceKelvin;
+    }
+    if (!m_connected) {
+        return;  // Nothing to send
+    }
+
+    // Only what changed goes to the camera, back to back
+    if (has("face_tracking")) enableAutoFraming(after.faceTracking);
+    if (isTiny2Family()) {
+        if (has("ai_mode") || has("ai_sub_mode")) setAiMode(after.aiMode, after.aiSubMode);
+        if (has("auto_zoom")) setAutoZoom(after.autoZoom);
+        if (has("track_speed")) setTrackSpeed(after.trackSpeed);
+        if (has("audio_auto_gain")) setAudioAutoGain(after.audioAutoGain);
+    }
+    if (has("hdr")) setHDR(after.hdr);
+    if (has("fov")) setFOV(after.fov);
+    if (has("face_ae")) setFaceAE(after.faceAE);
+    if (has("face_focus")) setFaceFocus(after.faceFocus);
+    if (has("zoom")) setZoom(after.zoom);
+    if (has("pan") || has("tilt")) setPanTilt(after.pan, after.tilt);
+    if (has("brightness") || has("brightness_auto")) setBrightness(after.brightness);
+    if (has("contrast") || has("contrast_auto")) setContrast(after.contrast);
+    if (has("saturation") || has("saturation_auto")) setSaturation(after.saturation);
+    if (has("white_balance") || has("white_balance_kelvin")) {
+        if (after.whiteBalance == static_cast<int>(Device::DevWhiteBalanceManual)) {
+            setWhiteBalanceManual(after.whiteBalanceKelvin);
+        } else {
+            setWhiteBalance(after.whiteBalance);
+        }
+    }
+    if (has("presets")) syncPresetsWithDevice();
 }
 
 bool CameraController::saveConfig()
 {
     // Update config with current camera state before saving
     saveCurrentStateToConfig();
-    return m_config.save();
+    if (!m_config.isSavingEnabled()) {
+        return false;
+    }
+
+    // Serializing is cheap; the file write waits for a quiet moment off this thread
+    m_configSaver.request(Trace::call("config.serialize", [this]() { return m_config.serialize(); }));
+    return true;
+}
+
+bool CameraController::flushConfig()
+{
+    return m_configSaver.flush();
 }
 
 void CameraController::applyConfigToCamera()
@@ -585,11 +1169,8 @@ void CameraController::applyCurrentStateToCamera(const CameraState &uiState)
     m_currentState.contrastAuto = uiState.contrastAuto;
     m_currentState.saturationAuto = uiState.saturationAuto;
 
-    // Cache the intended state
-    m_cachedState = uiState;
-
-    // Begin settling period - block status updates for 2 seconds
-    beginSettling(2000);
+    // Serve the intended state until the camera reports it
+    beginSettling(uiState);
 
     // Apply the current UI state to camera (respects user changes)
     enableAutoFraming(uiState.autoFramingEnabled);
@@ -664,31 +1245,31 @@ void CameraController::refreshControlRanges()
         return;
     }
 
-    auto fetchRange = [this](int32_t (Device::*getter)(Device::UvcParamRange &), ParamRange &target) {
-        Device::UvcParamRange sdkRange{};
-        if ((m_device.get()->*getter)(sdkRange) == 0) {
-            target.min = sdkRange.min_;
-            target.max = sdkRange.max_;
-            target.step = sdkRange.step_ == 0 ? 1 : sdkRange.step_;
-            target.defaultValue = sdkRange.default_;
-            target.valid = true;
-        } else {
-            target = {};
-        }
-    };
-
-    fetchRange(&Device::cameraGetRangeImageBrightnessR, m_brightnessRange);
-    fetchRange(&Device::cameraGetRangeImageContrastR, m_contrastRange);
-    fetchRange(&Device::cameraGetRangeImageSaturationR, m_saturationRange);
-    fetchRange(&Device::cameraGetRangeWhiteBalanceR, m_whiteBalanceKelvinRange);
+    // Ranges only change with firmware: a known serial/version skips five
+    // blocking round trips on connect and is confirmed later in the background
+    const std::string serial = m_device->devSn();
+    const std::string version = m_device->devVersion();
+    ControlRanges ranges;
+    if (m_rangeCache.lookup(serial, version, ranges)) {
+        applyControlRanges(ranges);
+        scheduleRangeRevalidation();
+        return;
+    }
 
-    m_supportedWhiteBalanceTypes.clear();
-    std::vector<int32_t> wbList;
-    int32_t wbMin = 0;
-    int32_t wbMax = 0;
-    if (m_device->cameraGetWhiteBalanceListR(wbList, wbMin, wbMax) == 0) {
-        m_supportedWhiteBalanceTypes.assign(wbList.begin(), wbList.end());
+    ranges = ControlRanges::query(*m_device);
+    applyControlRanges(ranges);
+    if (hasAnyRange(ranges)) {
+        m_rangeCache.store(serial, version, ranges);
     }
+}
+
+void CameraController::applyControlRanges(const ControlRanges &ranges)
+{
+    m_brightnessRange = ranges.brightness;
+    m_contrastRange = ranges.contrast;
+    m_saturationRange = ranges.saturation;
+    m_whiteBalanceKelvinRange = ranges.whiteBalanceKelvin;
+    m_supportedWhiteBalanceTypes = ranges.whiteBalanceTypes;
 
     if (m_whiteBalanceKelvinRange.valid) {
         int clampedCurrent = clampToRange(
@@ -701,6 +1282,129 @@ void CameraController::refreshControlRanges()
     }
 }
 
+void CameraController::scheduleRangeRevalidation()
+{
+    const unsigned generation = ++m_rangeGeneration;
+
+    // May be called from the SDK's hotplug thread; timers belong to ours
+    QMetaObject::invokeMethod(this, [this, generation]() {
+        QTimer::singleShot(kRangeRevalidationDelayMs, this, [this, generation]() {
+            if (generation != m_rangeGeneration || !m_device) {
+                return;
+            }
+
+            joinRangeRevalidation();
+            std::shared_ptr<Device> dev = m_device;
+            m_rangeRevalidation = std::thread([this, dev, generation]() {
+                ControlRanges ranges = ControlRanges::query(*dev);
+                ControlRanges cached;
+                const std::string serial = dev->devSn();
+                const std::string version = dev->devVersion();
+                if (generation != m_rangeGeneration || !hasAnyRange(ranges) ||
+                    (m_rangeCache.lookup(serial, version, cached) && cached == ranges)) {
+                    return;  // Disconnected meanwhile, query failed, or cache confirmed
+                }
+
+                std::cout << "[RangeCache] Ranges for " << serial << " changed, updating cache" << std::endl;
+                m_rangeCache.store(serial, version, ranges);
+                QMetaObject::invokeMethod(this, [this, ranges, generation]() {
+                    if (generation != m_rangeGeneration) {
+                        return;
+                    }
+                    applyControlRanges(ranges);
+                    emit stateChanged(m_currentState);
+                }, Qt::QueuedConnection);
+            });
+        });
+    }, Qt::QueuedConnection);
+}
+
+void CameraController::joinRangeRevalidation()
+{
+    if (m_rangeRevalidation.joinable()) {
+        m_rangeRevalidation.join();
+    }
+}
+
+void CameraController::syncPresetsWithDevice()
+{
+    m_hardwarePresetsSynced = false;  // Replay presets in software until the device has them
+    if (!m_device || !hasHardwarePresets() || m_presetSyncRunning) {
+        return;  // A sync in flight starts over when it finds the presets changed
+    }
+
+    // Up to 2N+1 blocking round trips; the connect path and the GUI don't wait for them
+    m_presetSyncRunning = true;
+    joinPresetSync();
+    const unsigned generation = m_presetGeneration;
+    const auto presets = m_config.getSettings().presets;
+    std::shared_ptr<Device> dev = m_device;
+    m_presetSync = std::thread([this, dev, presets, generation]() {
+        GimbalPresets::SyncResult result;
+        {
+            Trace::Scope trace("presets.sync");
+            result = GimbalPresets::sync(*dev, presets);
+        }
+        QMetaObject::invokeMethod(this, [this, presets, result, generation]() {
+            finishPresetSync(presets, result, generation);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CameraController::finishPresetSync(const std::vector<Config::CameraSettings::PresetSlot> &sent,
+                                        const GimbalPresets::SyncResult &result, unsigned generation)
+{
+    m_presetSyncRunning = false;
+    if (generation != m_presetGeneration) {
+        if (m_connected) {
+            syncPresetsWithDevice();  // Reconnected meanwhile; that connect's sync was skipped
+        }
+        return;
+    }
+    if (!result.ok()) {
+        // Keep replaying presets in software rather than trigger a stale device preset
+        m_telemetry.logCommand(result.failedCommand, result.failedResult);
+        emit commandFailed(QStringLiteral("Sync Gimbal Presets (%1)").arg(QLatin1String(result.failedCommand)),
+                           result.failedResult);
+    }
+
+    auto settings = m_config.getSettings();
+    const bool changedMeanwhile = !samePresets(settings.presets, sent);
+
+    // Presets only the device knows about (e.g. saved by another app) fill empty slots
+    bool configChanged = false;
+    for (const auto &[id, info] : result.devicePresets) {
+        if (id < 0 || id >= Config::kMaxPresets) {
+            continue;
+        }
+        if (settings.presets.size() <= static_cast<size_t>(id)) {
+            settings.presets.resize(static_cast<size_t>(id) + 1, {false, 0.0, 0.0, 1.0});
+        }
+        auto &slot = settings.presets[static_cast<size_t>(id)];
+        if (!slot.defined) {
+            slot = GimbalPresets::fromDevice(info);
+            configChanged = true;
+        }
+    }
+    if (configChanged) {
+        m_config.setSettings(settings);
+        emit presetsSynced();
+    }
+
+    if (changedMeanwhile) {
+        syncPresetsWithDevice();  // Stored or edited while this one ran
+    } else {
+        m_hardwarePresetsSynced = result.ok();
+    }
+}
+
+void CameraController::joinPresetSync()
+{
+    if (m_presetSync.joinable()) {
+        m_presetSync.join();
+    }
+}
+
 void CameraController::resetControlRanges()
 {
     m_brightnessRange = {};
@@ -1,13 +1,26 @@
 #ifndef CAMERACONTROLLER_H
 #define CAMERACONTROLLER_H
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QStringList>
 #include <QTimer>
+#include <atomic>
 #include <memory>
 #include <functional>
+#include <list>
+#include <thread>
 #include <vector>
 #include <dev/devs.hpp>
+#include "CommandSequence.h"
 #include "Config.h"
+#include "ConfigSaver.h"
+#include "ConfigWatcher.h"
+#include "ControlRangeCache.h"
+#include "GimbalPresets.h"
+#include "GimbalTelemetry.h"
+#include "PtzSequencer.h"
+#include "TargetSelector.h"
 
 /**
  * @brief Handles all camera communication and state management
@@ -64,20 +77,17 @@ public:
         int devStatus;
     };
 
-    struct ParamRange {
-        int min = 0;
-        int max = 0;
-        int step = 1;
-        int defaultValue = 0;
-        bool valid = false;
-    };
+    using ParamRange = ControlRanges::Range;
 
     explicit CameraController(QObject *parent = nullptr);
     ~CameraController();
 
     // Connection
     bool isConnected() const { return m_connected; }
+    bool isConnecting() const { return m_connecting; }  // Waiting on the device scan
     CameraInfo getCameraInfo() const { return m_cameraInfo; }
+    // Returns at once; the first call starts the SDK on a worker thread.
+    // deviceScanFinished follows, preceded by cameraConnected if one was found
     void connectToCamera();
     void disconnectFromCamera();
 
@@ -86,6 +96,8 @@ public:
     bool hasTiny2Capabilities() const;
 
     // Tracking controls
+    // Asynchronous: the steps run on a worker, each once the camera confirms
+    // the last; calling again supersedes a sequence still in progress
     bool enableAutoFraming(bool enabled);
     bool setAiMode(int mode, int subMode);
     bool setAutoZoom(bool enabled);
@@ -99,6 +111,26 @@ public:
     bool setZoom(double zoom);
     bool centerView();
 
+    // PTZ presets - stored on the gimbal where supported, replayed as pan/tilt/zoom otherwise
+    bool hasHardwarePresets() const;
+    bool recallPreset(int index);
+    bool storePreset(int index);  // Store the current position into config preset slot
+
+    // Gimbal telemetry - attitude samples plus every command sent, see GimbalTelemetry
+    bool startTelemetry(const QString &path, int rateHz);
+    void stopTelemetry();
+    bool isTelemetryRecording() const { return m_telemetry.isRecording(); }
+
+    // Keyframed PTZ sequences from config; any manual PTZ command stops a running one
+    bool playSequence(const QString &name);
+    void stopSequence();
+    bool isSequenceRunning() const { return m_sequencer.isRunning(); }
+
+    // Click-to-frame from the preview. Sent from a worker thread so the
+    // preview never waits on USB; the outcome arrives as targetSelectionFinished.
+    bool selectTarget(const TargetSelector::Request &request);
+    bool hasSubjectSelection() const;  // Central/biggest subject selection (Tail Air)
+
     // Camera settings
     bool setHDR(bool enabled);
     bool setFOV(int fovMode);  // 0=Wide, 1=Medium, 2=Narrow
@@ -117,14 +149,19 @@ public:
 
     // Configuration
     bool loadConfig(std::vector<Config::ValidationError> &errors);
-    bool saveConfig();
+    bool saveConfig();  // Debounced; written on a background thread
+    bool flushConfig();  // Write a pending save now
     void applyConfigToCamera();  // Apply loaded config settings to camera
     void applyCurrentStateToCamera(const CameraState &uiState);  // Apply UI state to camera
     Config& getConfig() { return m_config; }
 
-    // Settling state
+    // Lay a named profile over the settings and send only the fields that change
+    bool applyProfile(const QString &name);
+
+    // Settling state: after a bulk apply the intended state is served until
+    // the camera reports each applied field, or that field times out
     bool isSettling() const { return m_settlingTimer && m_settlingTimer->isActive(); }
-    void beginSettling(int durationMs = 2000);  // Start settling period
+    void beginSettling(const CameraState &intended);
 
     // Ranges
     ParamRange getBrightnessRange() const { return m_brightnessRange; }
@@ -135,34 +172,87 @@ public:
 
 signals:
     void cameraConnected(const CameraInfo &info);
+    void deviceScanFinished(bool found);  // Ends a connectToCamera()
     void cameraDisconnected();
     void stateChanged(const CameraState &state);
     void commandFailed(const QString &description, int errorCode);
     void configLoaded();  // Emitted after config is successfully loaded
+    void presetsSynced();  // Emitted when presets found on the device were merged into config
+    // Settings replaced by an edit of settings.conf or a profile switch; the camera already has them
+    void settingsReplaced(const QStringList &changedKeys);
+    void sequenceStarted(const QString &name);
+    void sequenceFinished(const QString &name, bool completed, const QString &error);
+    // motionMs is from the request to the gimbal first moving, -1 if it did not
+    void targetSelectionFinished(const QString &action, bool ok, double ackMs, double motionMs);
+    // drift lists the fields that never matched, e.g. "hdr: wanted 1, camera reports 0"
+    void settlingFinished(int elapsedMs, const QStringList &drift);
 
 private:
     std::shared_ptr<Device> m_device;
     bool m_connected;
+    bool m_connecting;      // connectToCamera() waiting on a device scan
+    bool m_sdkReady;        // Devices initialized and the hotplug callback set
+    std::thread m_sdkInit;  // Initializes the SDK off the GUI thread
     CameraInfo m_cameraInfo;
     CameraState m_currentState;
     CameraState m_cachedState;  // Cache intended state during settling
     Config m_config;
-    QTimer *m_settlingTimer;  // Timer for settling period after config apply
+    ConfigSaver m_configSaver;  // After m_config: flushes into it on destruction
+    ConfigWatcher m_configWatcher;  // Likewise: reads it until stopped
+    QTimer *m_settlingTimer;  // Polls the read-back while settling
+
+    // A field applied by a bulk apply, polled until the camera reports it
+    struct SettlingField {
+        QString name;
+        int intended;
+        int tolerance;  // Largest accepted difference, e.g. for step quantization
+        qint64 timeoutMs;
+        std::function<bool(int &value)> read;
+        int lastRead;
+        bool haveRead;
+        bool converged;
+    };
+    std::vector<SettlingField> m_settlingFields;
+    QElapsedTimer m_settlingClock;
     ParamRange m_brightnessRange;
     ParamRange m_contrastRange;
     ParamRange m_saturationRange;
     ParamRange m_whiteBalanceKelvinRange;
     std::vector<int> m_supportedWhiteBalanceTypes;
+    ControlRangeCache m_rangeCache;
+    std::thread m_rangeRevalidation;         // Confirms cached ranges against the device
+    std::atomic<unsigned> m_rangeGeneration; // Bumped per connect/disconnect; stale revalidations drop out
     int m_lastRequestedWhiteBalance;
     bool m_whiteBalanceFallbackActive;
     int m_fallbackWhiteBalanceMode;
+    bool m_hardwarePresetsSynced;  // Config presets mirrored on the device, recall by trigger
+    bool m_presetSyncRunning;      // Until its result is back on the GUI thread
+    std::thread m_presetSync;      // Mirrors presets onto the device off the GUI thread
+    std::atomic<unsigned> m_presetGeneration;  // Bumped per disconnect; stale syncs drop out
+    GimbalTelemetry m_telemetry;
+    PtzSequencer m_sequencer;  // After m_telemetry: logs into it until stopped
+    TargetSelector m_targetSelector;  // Likewise
+    CommandSequence m_commandSequence;  // Likewise
     bool isTiny2Family() const;
 
     // Helper
     bool executeCommand(const QString &description, std::function<int32_t()> command);
     void updateState();
+    void checkSettling();
+    void applyExternalConfig(const ConfigWatcher::Change &change);
+    void applyChangedSettings(const Config::CameraSettings &settings, const QStringList &changed);
     void saveCurrentStateToConfig();  // Update config with current camera state
     void refreshControlRanges();
+    void applyControlRanges(const ControlRanges &ranges);
+    void scheduleRangeRevalidation();
+    void joinRangeRevalidation();
+    void syncPresetsWithDevice();
+    void finishPresetSync(const std::vector<Config::CameraSettings::PresetSlot> &sent,
+                          const GimbalPresets::SyncResult &result, unsigned generation);
+    void joinPresetSync();
+    void finishConnect(const std::list<std::shared_ptr<Device>> &devices);
+    void detachDevice();  // The camera was unplugged
+    void joinSdkInit();
     void resetControlRanges();
     int clampToRange(int value, const ParamRange &range, int fallbackMin, int fallbackMax) const;
     int whiteBalancePresetToKelvin(int mode) const;
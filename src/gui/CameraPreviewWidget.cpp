@@ -70,8 +70,11 @@ CameraPreviewWidget::CameraPreviewWidget(QWidget *parent)
     , m_controlRow(nullptr)
     , m_virtualCameraStreamer(nullptr)
     , m_selectedFormatId(QStringLiteral("auto"))
+    , m_videoEffects(FilterPreviewWidget::VideoEffectsSettings::defaults())
     , m_previewEnabled(false)
     , m_isApplyingFormat(false)
+    , m_targetSelectionEnabled(false)
+    , m_subjectSelection(false)
 {
     setupUI();
 }
@@ -109,9 +112,26 @@ void CameraPreviewWidget::setupUI()
     m_statusLabel = new QLabel(tr("Preview disabled"), this);
     m_statusLabel->setStyleSheet("color: palette(mid); font-size: 11px;");
     layout->addWidget(m_statusLabel);
+    layout->addStretch(1);  // Holds the space the filter preview takes once created
+}
+
+void CameraPreviewWidget::ensureFilterPreview()
+{
+    if (m_filterPreviewWidget) {
+        return;
+    }
+
+    // Created with the first preview: until then the window has no OpenGL
+    // context, and a session that never previews never pays for one
+    QVBoxLayout *layout = static_cast<QVBoxLayout *>(this->layout());
+    delete layout->takeAt(layout->count() - 1);  // The placeholder stretch
 
     m_filterPreviewWidget = new FilterPreviewWidget(this);
     m_filterPreviewWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    m_filterPreviewWidget->setVideoEffects(m_videoEffects);
+    m_filterPreviewWidget->setOutputSize(m_outputSize);
+    m_filterPreviewWidget->setTargetSelectionEnabled(m_targetSelectionEnabled, m_subjectSelection);
+    m_filterPreviewWidget->setOverlayInputsProvider([this]() { return overlayInputs(); });
     layout->addWidget(m_filterPreviewWidget, 1);
 
     connect(m_filterPreviewWidget, &FilterPreviewWidget::processedFrameReady,
@@ -120,6 +140,8 @@ void CameraPreviewWidget::setupUI()
                     m_virtualCameraStreamer->onProcessedFrameReady(image);
                 }
             });
+    connect(m_filterPreviewWidget, &FilterPreviewWidget::targetSelected,
+            this, &CameraPreviewWidget::targetSelected);
 }
 
 bool CameraPreviewWidget::isPreviewEnabled() const
@@ -190,6 +212,7 @@ void CameraPreviewWidget::setVirtualCameraStreamer(VirtualCameraStreamer *stream
 
 void CameraPreviewWidget::setVideoEffects(const FilterPreviewWidget::VideoEffectsSettings &settings)
 {
+    m_videoEffects = settings;
     if (!m_filterPreviewWidget) {
         return;
     }
@@ -199,11 +222,28 @@ void CameraPreviewWidget::setVideoEffects(const FilterPreviewWidget::VideoEffect
 FilterPreviewWidget::VideoEffectsSettings CameraPreviewWidget::videoEffects() const
 {
     if (!m_filterPreviewWidget) {
-        return FilterPreviewWidget::VideoEffectsSettings::defaults();
+        return m_videoEffects;
     }
     return m_filterPreviewWidget->videoEffects();
 }
 
+void CameraPreviewWidget::setOutputSize(const QSize &size)
+{
+    m_outputSize = size;
+    if (m_filterPreviewWidget) {
+        m_filterPreviewWidget->setOutputSize(size);
+    }
+}
+
+void CameraPreviewWidget::setTargetSelectionEnabled(bool enabled, bool subjectSelection)
+{
+    m_targetSelectionEnabled = enabled;
+    m_subjectSelection = subjectSelection;
+    if (m_filterPreviewWidget) {
+        m_filterPreviewWidget->setTargetSelectionEnabled(enabled, subjectSelection);
+    }
+}
+
 void CameraPreviewWidget::startPreview()
 {
     if (m_previewEnabled) {
@@ -215,6 +255,7 @@ void CameraPreviewWidget::startPreview()
     if (!initializeCamera()) {
         return;
     }
+    ensureFilterPreview();
 
     applySelectedFormat();
     updateStatus(tr("Opening camera..."));
@@ -309,6 +350,32 @@ void CameraPreviewWidget::handleIncomingFrame(const QVideoFrame &frame)
     }
 }
 
+FilterPreviewWidget::OverlayInputs CameraPreviewWidget::overlayInputs() const
+{
+    FilterPreviewWidget::OverlayInputs inputs;
+    if (m_camera && m_camera->isActive()) {
+        const QCameraFormat format = m_camera->cameraFormat();
+        if (!format.isNull()) {
+            // Plain ASCII: the overlay's glyph atlas has nothing else
+            inputs.captureFormat = QStringLiteral("%1x%2 %3 @ %4 fps")
+                                       .arg(format.resolution().width())
+                                       .arg(format.resolution().height())
+                                       .arg(QVideoFrameFormat::pixelFormatToString(format.pixelFormat()))
+                                       .arg(static_cast<int>(std::round(format.maxFrameRate())));
+        }
+    }
+
+    if (m_virtualCameraStreamer && m_virtualCameraStreamer->isEnabled()) {
+        const VirtualCameraStreamer::Stats stats = m_virtualCameraStreamer->stats();
+        inputs.virtualCameraOn = true;
+        inputs.virtualCameraFrames = stats.framesWritten;
+        inputs.virtualCameraDropped = stats.framesDropped;
+        inputs.virtualCameraQueue = stats.queued;
+        inputs.virtualCameraMs = stats.frameMs;
+    }
+    return inputs;
+}
+
 void CameraPreviewWidget::applySelectedFormat()
 {
     if (!m_camera) {
@@ -41,6 +41,8 @@ public:
     void setVirtualCameraStreamer(VirtualCameraStreamer *streamer);
     void setVideoEffects(const FilterPreviewWidget::VideoEffectsSettings &settings);
     FilterPreviewWidget::VideoEffectsSettings videoEffects() const;
+    void setOutputSize(const QSize &size);  // See FilterPreviewWidget::setOutputSize
+    void setTargetSelectionEnabled(bool enabled, bool subjectSelection = false);
 
 signals:
     void previewStateChanged(bool enabled);
@@ -48,6 +50,7 @@ signals:
     void previewStarted();  // Emitted when preview successfully starts
     void previewFailed(const QString &error);  // Emitted when preview fails to start
     void preferredFormatChanged(const QString &formatId);
+    void targetSelected(FilterPreviewWidget::TargetGesture gesture, const QRectF &frameRect, double frameAspect);
 
 private slots:
     void onCameraError(QCamera::Error error);
@@ -56,10 +59,12 @@ private slots:
 
 private:
     void setupUI();
+    void ensureFilterPreview();
     bool initializeCamera();
     void startPreview();
     void stopPreview();
     void handleIncomingFrame(const QVideoFrame &frame);
+    FilterPreviewWidget::OverlayInputs overlayInputs() const;
     QCameraFormat findFormatById(const QString &id) const;
     QCameraDevice resolveCameraDevice() const;
     void refreshFormatOptions(const QCameraDevice &device);
@@ -73,7 +78,7 @@ private:
     QCamera *m_camera;
     QMediaCaptureSession *m_captureSession;
     QVideoSink *m_videoSink;
-    FilterPreviewWidget *m_filterPreviewWidget;
+    FilterPreviewWidget *m_filterPreviewWidget;  // Null until the first preview
     QComboBox *m_formatCombo;
     QLabel *m_statusLabel;
     QWidget *m_controlRow;
@@ -81,9 +86,13 @@ private:
     QString m_selectedFormatId;
     QString m_requestedDeviceId;
     QList<QCameraFormat> m_availableFormats;
+    FilterPreviewWidget::VideoEffectsSettings m_videoEffects;  // Handed to the filter preview when created
+    QSize m_outputSize;
 
     bool m_previewEnabled;
     bool m_isApplyingFormat;
+    bool m_targetSelectionEnabled;
+    bool m_subjectSelection;
 };
 
 #endif // CAMERAPREVIEWWIDGET_H
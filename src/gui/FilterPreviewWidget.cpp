@@ -1,12 +1,29 @@
 #include "FilterPreviewWidget.h"
+#include "ImageStabilizer.h"
+#include "Trace.h"
 
+#include <QApplication>
+#include <QContextMenuEvent>
 #include <QDebug>
+#include <QFontDatabase>
+#include <QFontInfo>
+#include <QFontMetricsF>
+#include <QMenu>
+#include <QMouseEvent>
 #include <QOpenGLFunctions>
+#include <QPainter>
+#include <QTimer>
 #include <QVector2D>
+#include <QVector4D>
 #include <QVideoFrame>
 #include <QtMath>
+#include <QVector>
 #include <cmath>
 
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+
 namespace {
 
 const char *kVertexShaderSource = R"(#version 330 core
@@ -28,6 +45,7 @@ void main()
 const char *kFragmentShaderSource = R"(#version 330 core
 uniform sampler2D u_texture;
 uniform vec2 u_texelSize;
+uniform vec4 u_crop;  // Digital PTZ: x, y, width, height of the part shown, from the top-left
 uniform float u_brightness;
 uniform float u_contrast;
 uniform float u_exposure;
@@ -63,7 +81,8 @@ float random(vec2 co)
 
 void main()
 {
-    vec2 uv = vec2(v_texCoord.x, 1.0 - v_texCoord.y);
+    vec2 view = u_crop.xy + v_texCoord * u_crop.zw;
+    vec2 uv = vec2(view.x, 1.0 - view.y);
     if (u_horizontalFlip == 1) {
         uv.x = 1.0 - uv.x;
     }
@@ -156,6 +175,140 @@ void main()
 }
 )";
 
+// Denoise pass, in texture space: current frame plus history into the next history
+const char *kDenoiseVertexShaderSource = R"(#version 330 core
+layout(location = 0) in vec2 a_position;
+
+out vec2 v_uv;
+
+void main()
+{
+    gl_Position = vec4(a_position, 0.0, 1.0);
+    v_uv = a_position * 0.5 + 0.5;
+}
+)";
+
+// Still pixels lean on the history; where the blurred frame and the history
+// disagree by more than grain would, something moved, so the history is
+// dropped and a 3x3 blur hides the grain instead. TemporalDenoiser is the
+// same filter on the CPU
+const char *kDenoiseFragmentShaderSource = R"(#version 330 core
+uniform sampler2D u_current;
+uniform sampler2D u_history;
+uniform vec2 u_texelSize;
+uniform float u_strength;
+uniform int u_hasHistory;
+
+in vec2 v_uv;
+out vec4 fragColor;
+
+float luminance(vec3 color)
+{
+    return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+    vec4 current = texture(u_current, v_uv);
+
+    vec3 spatial = vec3(0.0);
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            float weight = float((2 - abs(x)) * (2 - abs(y)));
+            spatial += texture(u_current, v_uv + vec2(x, y) * u_texelSize).rgb * weight;
+        }
+    }
+    spatial /= 16.0;
+
+    float stillness = 0.0;
+    vec3 history = spatial;
+    if (u_hasHistory == 1) {
+        history = texture(u_history, v_uv).rgb;
+        float threshold = 0.01 + 0.03 * u_strength;
+        stillness = 1.0 - smoothstep(threshold, threshold * 3.0, abs(luminance(spatial) - luminance(history)));
+    }
+
+    vec3 base = mix(current.rgb, spatial, 0.75 * u_strength * (1.0 - stillness));
+    fragColor = vec4(mix(base, history, stillness * (0.5 + 0.4 * u_strength)), current.a);
+}
+)";
+
+// Performance overlay: text quads in widget pixels sampling a glyph atlas
+const char *kOverlayVertexShaderSource = R"(#version 330 core
+layout(location = 0) in vec2 a_position;
+layout(location = 1) in vec2 a_texCoord;
+layout(location = 2) in vec4 a_color;
+
+uniform vec2 u_viewSize;
+
+out vec2 v_texCoord;
+out vec4 v_color;
+
+void main()
+{
+    gl_Position = vec4(a_position.x / u_viewSize.x * 2.0 - 1.0, 1.0 - a_position.y / u_viewSize.y * 2.0, 0.0, 1.0);
+    v_texCoord = a_texCoord;
+    v_color = a_color;
+}
+)";
+
+const char *kOverlayFragmentShaderSource = R"(#version 330 core
+uniform sampler2D u_atlas;
+
+in vec2 v_texCoord;
+in vec4 v_color;
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vec4(v_color.rgb, v_color.a * texture(u_atlas, v_texCoord).a);
+}
+)";
+
+// How long a pick stays outlined once the request has gone out
+constexpr int kSelectionFadeMs = 600;
+
+// The overlay's figures are rates over this window
+constexpr int kOverlayRefreshMs = 500;
+
+// Atlas cells: printable ASCII, then one solid cell for the backing panel
+constexpr int kFirstGlyph = 32;
+constexpr int kGlyphCount = 95;
+constexpr int kAtlasColumns = 16;
+constexpr int kAtlasRows = 6;
+constexpr int kSolidCell = kGlyphCount;
+constexpr qreal kOverlayMargin = 8.0;
+constexpr qreal kOverlayPadding = 6.0;
+constexpr int kOverlayVertexFloats = 8;  // x, y, u, v, r, g, b, a
+
+// Digital PTZ spring: settles a move in about half a second without overshoot
+constexpr double kViewStiffness = 10.0;  // Natural frequency, rad/s
+constexpr double kViewSettled = 1e-5;
+constexpr float kMaxDigitalZoom = 4.0f;
+
+// Weight of the newest sample in the per-stage moving averages
+constexpr double kStageSmoothing = 0.1;
+
+double smoothed(double average, double sample)
+{
+    return average == 0.0 ? sample : average + (sample - average) * kStageSmoothing;
+}
+
+double elapsedMs(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1e6;
+}
+
+// Critically damped spring toward goal, solved exactly so a long frame cannot make it overshoot
+void springStep(double &value, double &velocity, double goal, double dt)
+{
+    const double offset = value - goal;
+    const double decay = std::exp(-kViewStiffness * dt);
+    const double rate = velocity + kViewStiffness * offset;
+    value = goal + (offset + rate * dt) * decay;
+    velocity = (velocity - kViewStiffness * rate * dt) * decay;
+}
+
 } // namespace
 
 FilterPreviewWidget::FilterPreviewWidget(QWidget *parent)
@@ -165,9 +318,32 @@ FilterPreviewWidget::FilterPreviewWidget(QWidget *parent)
     , m_effectSettings(VideoEffectsSettings::defaults())
     , m_vertexBuffer(QOpenGLBuffer::VertexBuffer)
     , m_geometryInitialized(false)
+    , m_denoiseCurrent(-1)
+    , m_cpuDenoise(qEnvironmentVariableIsSet("OBSBOT_DENOISE_CPU"))
+    , m_stabilizer(nullptr)
+    , m_targetSelectionEnabled(false)
+    , m_subjectSelectionEnabled(false)
+    , m_dragging(false)
+    , m_selectionFadeTimer(new QTimer(this))
+    , m_virtualCameraFramesAtRefresh(0)
+    , m_lastFrameTime(-1)
+    , m_frameInterval(0.0)
+    , m_overlayVisible(false)
+    , m_overlayTimer(new QTimer(this))
+    , m_overlayGeometryDirty(true)
+    , m_overlayBuffer(QOpenGLBuffer::VertexBuffer)
+    , m_glyphAtlasDpr(0.0)
+    , m_overlayVertexCount(0)
 {
     setMinimumSize(320, 240);
     setUpdateBehavior(QOpenGLWidget::PartialUpdate);
+
+    m_selectionFadeTimer->setSingleShot(true);
+    m_selectionFadeTimer->setInterval(kSelectionFadeMs);
+    connect(m_selectionFadeTimer, &QTimer::timeout, this, QOverload<>::of(&FilterPreviewWidget::update));
+
+    m_overlayTimer->setInterval(kOverlayRefreshMs);
+    connect(m_overlayTimer, &QTimer::timeout, this, QOverload<>::of(&FilterPreviewWidget::update));
 }
 
 FilterPreviewWidget::~FilterPreviewWidget()
@@ -185,16 +361,55 @@ void FilterPreviewWidget::setVideoEffects(const VideoEffectsSettings &settings)
         return;
     }
     m_effectSettings = settings;
+    if (settings.denoise <= 0.0f) {
+        m_denoiseCurrent = -1;  // Turned back on, it starts from a fresh history
+    }
+    if (settings.stabilization > 0.0f) {
+        if (!m_stabilizer) {
+            m_stabilizer = new ImageStabilizer(this);
+            connect(m_stabilizer, &ImageStabilizer::frameReady, this, &FilterPreviewWidget::presentFrame);
+        }
+        m_stabilizer->setStrength(settings.stabilization);
+        m_stabilizer->setLookahead(settings.stabilizationLookahead);
+    } else if (m_stabilizer) {
+        m_stabilizer->reset();  // Held frames are dropped; the next camera frame is shown directly
+        m_stabilizerCorrection = QPointF();
+    }
     update();
 }
 
+void FilterPreviewWidget::setOutputSize(const QSize &size)
+{
+    m_outputSize = size.isValid() && !size.isEmpty() ? size : QSize();
+}
+
 void FilterPreviewWidget::updateVideoFrame(const QVideoFrame &frame)
 {
+    Trace::Scope trace("frame.convert");
+    QElapsedTimer stage;
+    stage.start();
     QVideoFrame copy(frame);
     if (!copy.isValid()) {
         return;
     }
 
+    // The camera's timestamps show frames it sent twice or skipped. The
+    // interval follows the camera when it slows down in low light; a gap
+    // over a second is a restart rather than a hitch
+    const qint64 frameTime = copy.startTime();
+    if (frameTime >= 0 && frameTime == m_lastFrameTime) {
+        ++m_counters.repeated;
+    } else if (frameTime >= 0 && m_lastFrameTime >= 0 && frameTime > m_lastFrameTime) {
+        const double interval = frameTime - m_lastFrameTime;
+        if (interval < 1e6) {
+            if (m_frameInterval > 0.0 && interval > 1.5 * m_frameInterval) {
+                m_counters.missed += static_cast<quint64>(std::lround(interval / m_frameInterval)) - 1;
+            }
+            m_frameInterval = smoothed(m_frameInterval, interval);
+        }
+    }
+    m_lastFrameTime = frameTime;
+
     QImage image = copy.toImage();
     if (image.isNull()) {
         return;
@@ -204,12 +419,454 @@ void FilterPreviewWidget::updateVideoFrame(const QVideoFrame &frame)
         image = image.convertToFormat(QImage::Format_RGBA8888);
     }
 
+    ++m_counters.received;
+    m_counters.convertMs = smoothed(m_counters.convertMs, elapsedMs(stage));
+
+    if (m_stabilizer && m_effectSettings.stabilization > 0.0f) {
+        m_stabilizer->pushFrame(image);  // Comes back to presentFrame after the look-ahead
+        return;
+    }
+    presentFrame(image, QPointF());
+}
+
+void FilterPreviewWidget::presentFrame(const QImage &image, const QPointF &correction)
+{
+    if (m_textureDirty) {
+        ++m_counters.replaced;  // The previous frame never reached the screen
+    }
     m_currentImage = image;
+    m_stabilizerCorrection = correction;
     m_textureDirty = true;
     m_emitPending = true;
     update();
 }
 
+void FilterPreviewWidget::setTargetSelectionEnabled(bool enabled, bool subjectSelection)
+{
+    m_targetSelectionEnabled = enabled;
+    m_subjectSelectionEnabled = enabled && subjectSelection;
+    if (!enabled) {
+        m_dragging = false;
+        m_selectionFadeTimer->stop();
+    }
+    setCursor(enabled ? Qt::CrossCursor : Qt::ArrowCursor);
+    setToolTip(enabled ? tr("Click a person to track them, or drag a box to frame it") : QString());
+    update();
+}
+
+QRectF FilterPreviewWidget::pictureRect() const
+{
+    // Same letterbox fit renderToCurrentTarget applies through u_scale
+    const QSizeF frameSize = frameAspectSize();
+    const qreal frameAspect = frameSize.width() / frameSize.height();
+    const qreal targetAspect = static_cast<qreal>(width()) / height();
+
+    if (frameAspect > targetAspect) {
+        const qreal pictureHeight = width() / frameAspect;
+        return QRectF(0.0, (height() - pictureHeight) / 2.0, width(), pictureHeight);
+    }
+    const qreal pictureWidth = height() * frameAspect;
+    return QRectF((width() - pictureWidth) / 2.0, 0.0, pictureWidth, height());
+}
+
+bool FilterPreviewWidget::mapToFrame(const QPointF &widgetPos, QPointF &framePos) const
+{
+    const QRectF picture = pictureRect();
+    if (m_currentImage.isNull() || picture.isEmpty() || !picture.contains(widgetPos)) {
+        return false;
+    }
+
+    const QRectF crop = viewCrop();
+    qreal x = crop.left() + (widgetPos.x() - picture.left()) / picture.width() * crop.width();
+    const qreal y = crop.top() + (widgetPos.y() - picture.top()) / picture.height() * crop.height();
+    if (m_effectSettings.horizontalFlip) {
+        x = 1.0 - x;  // The preview is mirrored, the camera's frame is not
+    }
+    framePos = QPointF(qBound(0.0, x, 1.0), qBound(0.0, y, 1.0));
+    return true;
+}
+
+QRectF FilterPreviewWidget::frameToWidget(const QRectF &frameRect) const
+{
+    const QRectF picture = pictureRect();
+    const QRectF crop = viewCrop();
+    qreal left = frameRect.left();
+    qreal right = frameRect.right();
+    if (m_effectSettings.horizontalFlip) {
+        left = 1.0 - frameRect.right();
+        right = 1.0 - frameRect.left();
+    }
+    const auto toWidgetX = [&](qreal x) { return picture.left() + (x - crop.left()) / crop.width() * picture.width(); };
+    const auto toWidgetY = [&](qreal y) { return picture.top() + (y - crop.top()) / crop.height() * picture.height(); };
+    return QRectF(QPointF(toWidgetX(left), toWidgetY(frameRect.top())),
+                  QPointF(toWidgetX(right), toWidgetY(frameRect.bottom())));
+}
+
+void FilterPreviewWidget::mousePressEvent(QMouseEvent *event)
+{
+    QPointF framePos;
+    if (!m_targetSelectionEnabled || event->button() != Qt::LeftButton || !mapToFrame(event->position(), framePos)) {
+        QOpenGLWidget::mousePressEvent(event);
+        return;
+    }
+
+    m_dragging = true;
+    m_dragStart = event->position();
+    m_dragCurrent = m_dragStart;
+    event->accept();
+}
+
+void FilterPreviewWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_dragging) {
+        QOpenGLWidget::mouseMoveEvent(event);
+        return;
+    }
+
+    // Keep the box inside the picture so it never covers the letterbox bars
+    const QRectF picture = pictureRect();
+    m_dragCurrent = QPointF(qBound(picture.left(), event->position().x(), picture.right()),
+                            qBound(picture.top(), event->position().y(), picture.bottom()));
+    update();
+    event->accept();
+}
+
+void FilterPreviewWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (!m_dragging || event->button() != Qt::LeftButton) {
+        QOpenGLWidget::mouseReleaseEvent(event);
+        return;
+    }
+    m_dragging = false;
+    event->accept();
+
+    QPointF start;
+    QPointF end;
+    if (!mapToFrame(m_dragStart, start)) {
+        update();
+        return;
+    }
+
+    const QSizeF frameSize = frameAspectSize();
+    const double frameAspect = frameSize.width() / frameSize.height();
+    const bool isClick = (m_dragCurrent - m_dragStart).manhattanLength() < QApplication::startDragDistance();
+    if (isClick || !mapToFrame(m_dragCurrent, end)) {
+        m_lastSelection = QRectF(start, QSizeF(0.0, 0.0));
+        emit targetSelected(TargetClick, m_lastSelection, frameAspect);
+    } else {
+        m_lastSelection = QRectF(start, end).normalized();
+        emit targetSelected(TargetBox, m_lastSelection, frameAspect);
+    }
+    m_selectionFadeTimer->start();
+    update();
+}
+
+void FilterPreviewWidget::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *central = nullptr;
+    QAction *biggest = nullptr;
+    if (m_subjectSelectionEnabled && !m_currentImage.isNull()) {
+        central = menu.addAction(tr("Track Subject in Center"));
+        biggest = menu.addAction(tr("Track Largest Subject"));
+        menu.addSeparator();
+    }
+    QAction *overlay = menu.addAction(tr("Show Performance Overlay"));
+    overlay->setCheckable(true);
+    overlay->setChecked(m_overlayVisible);
+
+    QAction *chosen = menu.exec(event->globalPos());
+    if (!chosen) {
+        return;
+    }
+    if (chosen == overlay) {
+        setOverlayVisible(!m_overlayVisible);
+        return;
+    }
+
+    const QSizeF frameSize = frameAspectSize();
+    const double frameAspect = frameSize.width() / frameSize.height();
+    if (chosen == central) {
+        emit targetSelected(TargetCentral, QRectF(0.0, 0.0, 1.0, 1.0), frameAspect);
+    } else if (chosen == biggest) {
+        emit targetSelected(TargetBiggest, QRectF(0.0, 0.0, 1.0, 1.0), frameAspect);
+    }
+}
+
+void FilterPreviewWidget::drawSelectionOverlay()
+{
+    if (!m_dragging && !m_selectionFadeTimer->isActive()) {
+        return;
+    }
+
+    // On-screen only: the virtual camera frame was read back before this
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QPen pen(QColor(255, 255, 255, 220), 1.5, Qt::DashLine);
+    painter.setPen(pen);
+
+    if (m_dragging) {
+        painter.setBrush(QColor(255, 255, 255, 40));
+        painter.drawRect(QRectF(m_dragStart, m_dragCurrent).normalized());
+    } else if (m_lastSelection.width() > 0.0) {
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(frameToWidget(m_lastSelection));
+    } else {
+        const QPointF center = frameToWidget(m_lastSelection).topLeft();
+        pen.setStyle(Qt::SolidLine);
+        painter.setPen(pen);
+        painter.setBrush(Qt::NoBrush);
+        painter.drawEllipse(center, 14.0, 14.0);
+        painter.drawLine(center - QPointF(6.0, 0.0), center + QPointF(6.0, 0.0));
+        painter.drawLine(center - QPointF(0.0, 6.0), center + QPointF(0.0, 6.0));
+    }
+}
+
+void FilterPreviewWidget::setOverlayVisible(bool visible)
+{
+    if (m_overlayVisible == visible) {
+        return;
+    }
+    m_overlayVisible = visible;
+    if (visible) {
+        m_overlayClock.invalidate();  // Start a fresh window on the next paint
+        m_overlayTimer->start();
+    } else {
+        m_overlayTimer->stop();
+    }
+    update();
+}
+
+void FilterPreviewWidget::setOverlayInputsProvider(std::function<OverlayInputs()> provider)
+{
+    m_overlayInputsProvider = std::move(provider);
+}
+
+void FilterPreviewWidget::refreshOverlayText()
+{
+    const OverlayInputs inputs = m_overlayInputsProvider ? m_overlayInputsProvider() : OverlayInputs();
+    const double seconds = m_overlayClock.isValid() ? m_overlayClock.nsecsElapsed() / 1e9 : 0.0;
+    const auto rate = [seconds](quint64 now, quint64 before) {
+        return seconds > 0.0 && now >= before ? (now - before) / seconds : 0.0;
+    };
+    const auto fps = [](double value) { return QString::number(value, 'f', 1).rightJustified(5); };
+    const auto ms = [](double value) { return QString::number(value, 'f', 1); };
+
+    // Read top to bottom: a low rate or a count going up points at that stage
+    m_overlayLines = {
+        QStringLiteral("capture  %1").arg(inputs.captureFormat.isEmpty() ? QStringLiteral("-") : inputs.captureFormat),
+        QStringLiteral("camera   %1 fps  missed %2  repeated %3")
+            .arg(fps(rate(m_counters.received, m_countersAtRefresh.received)))
+            .arg(m_counters.missed)
+            .arg(m_counters.repeated),
+        QStringLiteral("effects  %1 fps  dropped %2")
+            .arg(fps(rate(m_counters.processed, m_countersAtRefresh.processed)))
+            .arg(m_counters.replaced),
+        inputs.virtualCameraOn
+            ? QStringLiteral("vcam     %1 fps  queue %2  dropped %3")
+                  .arg(fps(rate(inputs.virtualCameraFrames, m_virtualCameraFramesAtRefresh)))
+                  .arg(inputs.virtualCameraQueue)
+                  .arg(inputs.virtualCameraDropped)
+            : QStringLiteral("vcam     off"),
+        QStringLiteral("ms       convert %1  upload %2  readback %3  draw %4")
+            .arg(ms(m_counters.convertMs), ms(m_counters.uploadMs), ms(m_counters.readbackMs), ms(m_counters.drawMs)),
+    };
+    if (m_effectSettings.denoise > 0.0f) {
+        m_overlayLines.last() += QStringLiteral("  denoise %1%2")
+                                     .arg(ms(m_counters.denoiseMs), m_cpuDenoise ? QStringLiteral(" (cpu)") : QString());
+    }
+    if (inputs.virtualCameraOn) {
+        m_overlayLines.last() += QStringLiteral("  vcam %1").arg(ms(inputs.virtualCameraMs));
+    }
+    if (stabilizerMargin() > 0.0) {
+        const ImageStabilizer::Stats stats = m_stabilizer->stats();
+        m_overlayLines << QStringLiteral("stabilize %1 ms  held %2  late %3")
+                              .arg(ms(stats.estimateMs))
+                              .arg(stats.held)
+                              .arg(stats.late);
+    }
+
+    m_countersAtRefresh = m_counters;
+    m_virtualCameraFramesAtRefresh = inputs.virtualCameraFrames;
+    m_overlayClock.start();
+    m_overlayGeometryDirty = true;
+}
+
+void FilterPreviewWidget::ensureOverlayResources()
+{
+    if (!m_overlayProgram) {
+        m_overlayProgram = std::make_unique<QOpenGLShaderProgram>();
+        if (!m_overlayProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, kOverlayVertexShaderSource) ||
+            !m_overlayProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, kOverlayFragmentShaderSource) ||
+            !m_overlayProgram->link()) {
+            qWarning() << "Failed to build performance overlay shader:" << m_overlayProgram->log();
+            m_overlayProgram.reset();
+            return;
+        }
+    }
+
+    if (!m_overlayArray.isCreated()) {
+        m_overlayArray.create();
+        QOpenGLVertexArrayObject::Binder binder(&m_overlayArray);
+        m_overlayBuffer.create();
+        m_overlayBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+        m_overlayBuffer.bind();
+        const int stride = kOverlayVertexFloats * sizeof(float);
+        m_overlayProgram->bind();
+        m_overlayProgram->enableAttributeArray(0);
+        m_overlayProgram->enableAttributeArray(1);
+        m_overlayProgram->enableAttributeArray(2);
+        m_overlayProgram->setAttributeBuffer(0, GL_FLOAT, 0, 2, stride);
+        m_overlayProgram->setAttributeBuffer(1, GL_FLOAT, 2 * sizeof(float), 2, stride);
+        m_overlayProgram->setAttributeBuffer(2, GL_FLOAT, 4 * sizeof(float), 4, stride);
+        m_overlayProgram->release();
+        m_overlayBuffer.release();
+        m_overlayGeometryDirty = true;
+    }
+
+    // The glyphs are drawn once, at device resolution, and only again when
+    // the widget moves to a screen with another scale
+    const qreal dpr = devicePixelRatioF();
+    if (m_glyphAtlas && qFuzzyCompare(m_glyphAtlasDpr, dpr)) {
+        return;
+    }
+
+    QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    font.setPixelSize(qRound(QFontInfo(font).pixelSize() * dpr));
+    const QFontMetricsF metrics(font);
+    const QSize cell(qCeil(metrics.horizontalAdvance(QLatin1Char('M'))), qCeil(metrics.height()));
+
+    QImage atlas(cell.width() * kAtlasColumns, cell.height() * kAtlasRows, QImage::Format_RGBA8888);
+    atlas.fill(Qt::transparent);
+    {
+        QPainter painter(&atlas);
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+        for (int i = 0; i < kGlyphCount; ++i) {
+            const QPointF origin((i % kAtlasColumns) * cell.width(), (i / kAtlasColumns) * cell.height());
+            painter.drawText(origin + QPointF(0.0, metrics.ascent()), QString(QChar(kFirstGlyph + i)));
+        }
+        painter.fillRect(QRect(QPoint((kSolidCell % kAtlasColumns) * cell.width(), (kSolidCell / kAtlasColumns) * cell.height()),
+                               cell),
+                         Qt::white);
+    }
+
+    m_glyphAtlas = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+    m_glyphAtlas->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    m_glyphAtlas->setSize(atlas.width(), atlas.height());
+    m_glyphAtlas->setMipLevels(1);
+    m_glyphAtlas->setWrapMode(QOpenGLTexture::ClampToEdge);
+    m_glyphAtlas->setMinificationFilter(QOpenGLTexture::Nearest);
+    m_glyphAtlas->setMagnificationFilter(QOpenGLTexture::Nearest);
+    m_glyphAtlas->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    m_glyphAtlas->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, atlas.constBits());
+
+    m_glyphSize = QSizeF(cell) / dpr;
+    m_glyphAtlasDpr = dpr;
+    m_overlayGeometryDirty = true;
+}
+
+void FilterPreviewWidget::buildOverlayGeometry()
+{
+    QVector<float> vertices;
+    const qreal atlasWidth = m_glyphAtlas->width();
+    const qreal atlasHeight = m_glyphAtlas->height();
+    const QSizeF cellPixels = m_glyphSize * m_glyphAtlasDpr;
+
+    const auto addQuad = [&](const QRectF &rect, int cellIndex, const QColor &color) {
+        QRectF uv(QPointF((cellIndex % kAtlasColumns) * cellPixels.width() / atlasWidth,
+                          (cellIndex / kAtlasColumns) * cellPixels.height() / atlasHeight),
+                  QSizeF(cellPixels.width() / atlasWidth, cellPixels.height() / atlasHeight));
+        if (cellIndex == kSolidCell) {
+            uv = QRectF(uv.center(), QSizeF(0.0, 0.0));  // Away from the edges of the cell
+        }
+        const float corners[6][4] = {
+            {float(rect.left()), float(rect.top()), float(uv.left()), float(uv.top())},
+            {float(rect.right()), float(rect.top()), float(uv.right()), float(uv.top())},
+            {float(rect.left()), float(rect.bottom()), float(uv.left()), float(uv.bottom())},
+            {float(rect.right()), float(rect.top()), float(uv.right()), float(uv.top())},
+            {float(rect.right()), float(rect.bottom()), float(uv.right()), float(uv.bottom())},
+            {float(rect.left()), float(rect.bottom()), float(uv.left()), float(uv.bottom())},
+        };
+        for (const auto &corner : corners) {
+            vertices << corner[0] << corner[1] << corner[2] << corner[3]
+                     << float(color.redF()) << float(color.greenF()) << float(color.blueF()) << float(color.alphaF());
+        }
+    };
+
+    int columns = 0;
+    for (const QString &line : m_overlayLines) {
+        columns = qMax(columns, int(line.size()));
+    }
+    // Whole device pixels, so the glyphs land on the texels they were drawn in
+    const qreal origin = std::round(kOverlayMargin * m_glyphAtlasDpr) / m_glyphAtlasDpr;
+    const qreal padding = std::round(kOverlayPadding * m_glyphAtlasDpr) / m_glyphAtlasDpr;
+    addQuad(QRectF(origin, origin, columns * m_glyphSize.width() + 2 * padding,
+                   m_overlayLines.size() * m_glyphSize.height() + 2 * padding),
+            kSolidCell, QColor(0, 0, 0, 160));
+
+    const QColor textColor(235, 235, 235);
+    for (int row = 0; row < m_overlayLines.size(); ++row) {
+        const QString &line = m_overlayLines.at(row);
+        for (int column = 0; column < line.size(); ++column) {
+            const int code = line.at(column).unicode();
+            if (code == ' ') {
+                continue;
+            }
+            const int glyph = (code > kFirstGlyph && code < kFirstGlyph + kGlyphCount) ? code - kFirstGlyph : '?' - kFirstGlyph;
+            const QPointF topLeft(origin + padding + column * m_glyphSize.width(),
+                                  origin + padding + row * m_glyphSize.height());
+            addQuad(QRectF(topLeft, m_glyphSize), glyph, textColor);
+        }
+    }
+
+    m_overlayBuffer.bind();
+    m_overlayBuffer.allocate(vertices.constData(), vertices.size() * int(sizeof(float)));
+    m_overlayBuffer.release();
+    m_overlayVertexCount = vertices.size() / kOverlayVertexFloats;
+    m_overlayGeometryDirty = false;
+}
+
+void FilterPreviewWidget::drawPerformanceOverlay()
+{
+    if (!m_overlayVisible) {
+        return;
+    }
+
+    // The text only changes when the figures refresh; between refreshes
+    // drawing it is one draw call from a cached buffer
+    if (!m_overlayClock.isValid() || m_overlayClock.elapsed() >= kOverlayRefreshMs) {
+        refreshOverlayText();
+    }
+    ensureOverlayResources();
+    if (!m_overlayProgram || !m_glyphAtlas) {
+        return;
+    }
+    if (m_overlayGeometryDirty) {
+        buildOverlayGeometry();
+    }
+
+    const QSize physicalSize = (QSizeF(size()) * devicePixelRatioF()).toSize();
+    glViewport(0, 0, physicalSize.width(), physicalSize.height());
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_overlayProgram->bind();
+    m_overlayProgram->setUniformValue("u_viewSize", QVector2D(width(), height()));
+    m_overlayProgram->setUniformValue("u_atlas", 0);
+    glActiveTexture(GL_TEXTURE0);
+    m_glyphAtlas->bind();
+    {
+        QOpenGLVertexArrayObject::Binder binder(&m_overlayArray);
+        glDrawArrays(GL_TRIANGLES, 0, m_overlayVertexCount);
+    }
+    m_glyphAtlas->release();
+    m_overlayProgram->release();
+
+    glDisable(GL_BLEND);
+}
+
 void FilterPreviewWidget::initializeGL()
 {
     initializeOpenGLFunctions();
@@ -237,44 +894,131 @@ void FilterPreviewWidget::resizeGL(int w, int h)
 
 void FilterPreviewWidget::paintGL()
 {
+    Trace::Scope trace("frame.paint");
     glClear(GL_COLOR_BUFFER_BIT);
 
     if (m_currentImage.isNull()) {
         m_emitPending = false;
+        drawPerformanceOverlay();
         return;
     }
 
     ensureProgram();
     ensureGeometry();
+    QElapsedTimer stage;
+    stage.start();
+    const bool uploading = m_textureDirty;
     uploadTextureIfNeeded();
+    if (uploading) {
+        m_counters.uploadMs = smoothed(m_counters.uploadMs, elapsedMs(stage));
+    }
 
     if (!m_program || !m_texture) {
         return;
     }
 
     const QSize frameSize = m_currentImage.size();
+    if (uploading) {
+        denoiseFrame(frameSize);
+    }
+    const bool viewMoving = advanceView();
+
     m_program->bind();
     m_program->setUniformValue("u_texelSize", QVector2D(1.0f / frameSize.width(), 1.0f / frameSize.height()));
     applyEffectsUniforms();
 
-    ensureFramebuffer(frameSize);
+    const QSize outputSize = m_outputSize.isValid() ? m_outputSize : frameSize;
+    ensureFramebuffer(outputSize);
 
     if (m_emitPending && m_framebuffer) {
+        Trace::Scope readbackTrace("frame.readback");
+        stage.start();
         m_framebuffer->bind();
-        renderToCurrentTarget(frameSize);
+        renderToCurrentTarget(outputSize, true);
 
-        QImage output(frameSize, QImage::Format_RGBA8888);
+        QImage output(outputSize, QImage::Format_RGBA8888);
         glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        glReadPixels(0, 0, frameSize.width(), frameSize.height(),
+        glReadPixels(0, 0, outputSize.width(), outputSize.height(),
                      GL_RGBA, GL_UNSIGNED_BYTE, output.bits());
         m_framebuffer->release();
 
         emit processedFrameReady(output.flipped(Qt::Vertical));
         m_emitPending = false;
+        ++m_counters.processed;
+        m_counters.readbackMs = smoothed(m_counters.readbackMs, elapsedMs(stage));
     }
 
-    renderToCurrentTarget(size());
+    stage.start();
+    renderToCurrentTarget(size(), false);
     m_program->release();
+    m_counters.drawMs = smoothed(m_counters.drawMs, elapsedMs(stage));
+
+    // After the readback above, so the overlay never reaches processedFrameReady
+    drawPerformanceOverlay();
+    drawSelectionOverlay();
+
+    // Frames keep the move going at the camera's rate; this covers a slow or stalled camera
+    if (viewMoving) {
+        update();
+    }
+}
+
+bool FilterPreviewWidget::advanceView()
+{
+    const double zoom = qBound(1.0f, m_effectSettings.digitalZoom, kMaxDigitalZoom);
+    const double travel = (1.0 - 1.0 / zoom) / 2.0;
+    ViewState target;
+    // Stabilization crops its margin on top, through the same spring so a
+    // change of strength zooms rather than jumps
+    target.logZoom = std::log(zoom) - std::log(1.0 - 2.0 * stabilizerMargin());
+    target.centerX = 0.5 + qBound(-1.0f, m_effectSettings.digitalPan, 1.0f) * travel;
+    target.centerY = 0.5 - qBound(-1.0f, m_effectSettings.digitalTilt, 1.0f) * travel;
+
+    // The first frame shows the saved framing rather than zooming into it
+    if (!m_viewClock.isValid()) {
+        m_viewClock.start();
+        m_view = target;
+        m_viewVelocity = ViewState{0.0, 0.0, 0.0};
+        return false;
+    }
+
+    const double dt = qMin(m_viewClock.restart() / 1000.0, 0.1);
+    springStep(m_view.logZoom, m_viewVelocity.logZoom, target.logZoom, dt);
+    springStep(m_view.centerX, m_viewVelocity.centerX, target.centerX, dt);
+    springStep(m_view.centerY, m_viewVelocity.centerY, target.centerY, dt);
+
+    const auto settled = [](double value, double velocity, double goal) {
+        return std::abs(value - goal) < kViewSettled && std::abs(velocity) < kViewSettled;
+    };
+    if (settled(m_view.logZoom, m_viewVelocity.logZoom, target.logZoom)
+        && settled(m_view.centerX, m_viewVelocity.centerX, target.centerX)
+        && settled(m_view.centerY, m_viewVelocity.centerY, target.centerY)) {
+        m_view = target;
+        m_viewVelocity = ViewState{0.0, 0.0, 0.0};
+        return false;
+    }
+    return true;
+}
+
+QRectF FilterPreviewWidget::viewCrop() const
+{
+    // Zoom and center ease separately, so keep the crop on the picture mid-move
+    const double extent = qBound(0.5 / kMaxDigitalZoom, std::exp(-m_view.logZoom), 1.0);
+    double centerX = m_view.centerX;
+    double centerY = m_view.centerY;
+    if (stabilizerMargin() > 0.0) {
+        // The correction is in the camera's frame; the crop is in the mirrored output
+        centerX += m_effectSettings.horizontalFlip ? -m_stabilizerCorrection.x() : m_stabilizerCorrection.x();
+        centerY += m_stabilizerCorrection.y();
+    }
+    const double left = qBound(0.0, centerX - extent / 2.0, 1.0 - extent);
+    const double top = qBound(0.0, centerY - extent / 2.0, 1.0 - extent);
+    return QRectF(left, top, extent, extent);
+}
+
+double FilterPreviewWidget::stabilizerMargin() const
+{
+    return m_stabilizer && m_effectSettings.stabilization > 0.0f ? m_stabilizer->margin() : 0.0;
 }
 
 void FilterPreviewWidget::ensureProgram()
@@ -360,6 +1104,7 @@ void FilterPreviewWidget::uploadTextureIfNeeded()
         return;
     }
 
+    Trace::Scope trace("frame.upload");
     const QSize frameSize = m_currentImage.size();
     if (!m_texture) {
         m_texture = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
@@ -383,6 +1128,17 @@ void FilterPreviewWidget::uploadTextureIfNeeded()
     }
 
     QImage glImage = m_currentImage.flipped(Qt::Vertical);
+
+    // Zero strength also drops the history, so turning it back on starts clean
+    m_cpuDenoiser.setStrength(m_cpuDenoise ? m_effectSettings.denoise : 0.0f);
+    if (m_cpuDenoiser.strength() > 0.0f) {
+        Trace::Scope denoiseTrace("frame.denoise");
+        QElapsedTimer stage;
+        stage.start();
+        m_cpuDenoiser.process(glImage.bits(), glImage.width(), glImage.height(), glImage.bytesPerLine());
+        m_counters.denoiseMs = smoothed(m_counters.denoiseMs, elapsedMs(stage));
+    }
+
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
                     frameSize.width(), frameSize.height(),
@@ -392,14 +1148,106 @@ void FilterPreviewWidget::uploadTextureIfNeeded()
     m_textureDirty = false;
 }
 
-void FilterPreviewWidget::renderToCurrentTarget(const QSize &targetSize)
+bool FilterPreviewWidget::ensureDenoiseResources(const QSize &size)
+{
+    if (!m_denoiseProgram) {
+        m_denoiseProgram = std::make_unique<QOpenGLShaderProgram>();
+        if (!m_denoiseProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, kDenoiseVertexShaderSource)
+            || !m_denoiseProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, kDenoiseFragmentShaderSource)
+            || !m_denoiseProgram->link()) {
+            qWarning() << "Failed to build denoise shader program:" << m_denoiseProgram->log();
+            m_denoiseProgram.reset();
+            return false;
+        }
+    }
+
+    if (m_denoiseTargets[0] && m_denoiseTargets[0]->size() == size) {
+        return true;
+    }
+
+    // Half float: at 8 bits the small steps of a slow blend round away, and
+    // a still picture settles with bands instead of converging
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::NoAttachment);
+    format.setTextureTarget(GL_TEXTURE_2D);
+    format.setInternalTextureFormat(GL_RGBA16F);
+    m_denoiseCurrent = -1;
+    for (auto &target : m_denoiseTargets) {
+        target = std::make_unique<QOpenGLFramebufferObject>(size, format);
+        if (!target->isValid()) {
+            qWarning() << "Failed to create denoise framebuffer objects";
+            m_denoiseTargets[0].reset();
+            m_denoiseTargets[1].reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+void FilterPreviewWidget::denoiseFrame(const QSize &frameSize)
+{
+    if (m_cpuDenoise || m_effectSettings.denoise <= 0.0f) {
+        m_denoiseCurrent = -1;
+        return;
+    }
+
+    Trace::Scope trace("frame.denoise");
+    QElapsedTimer stage;
+    stage.start();
+    if (!ensureDenoiseResources(frameSize)) {
+        qWarning() << "Denoising on the CPU instead";
+        m_cpuDenoise = true;
+        m_denoiseCurrent = -1;
+        return;
+    }
+
+    const int history = m_denoiseCurrent;
+    const int target = history == 0 ? 1 : 0;
+    m_denoiseTargets[target]->bind();
+    glViewport(0, 0, frameSize.width(), frameSize.height());
+
+    m_denoiseProgram->bind();
+    m_denoiseProgram->setUniformValue("u_current", 0);
+    m_denoiseProgram->setUniformValue("u_history", 1);
+    m_denoiseProgram->setUniformValue("u_texelSize", QVector2D(1.0f / frameSize.width(), 1.0f / frameSize.height()));
+    m_denoiseProgram->setUniformValue("u_strength", qBound(0.0f, m_effectSettings.denoise, 1.0f));
+    m_denoiseProgram->setUniformValue("u_hasHistory", history >= 0 ? 1 : 0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, history >= 0 ? m_denoiseTargets[history]->texture() : 0);
+    glActiveTexture(GL_TEXTURE0);
+    m_texture->bind();
+    {
+        QOpenGLVertexArrayObject::Binder binder(&m_vertexArray);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    m_texture->release();
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    m_denoiseProgram->release();
+    m_denoiseTargets[target]->release();
+    m_denoiseCurrent = target;
+    m_counters.denoiseMs = smoothed(m_counters.denoiseMs, elapsedMs(stage));
+}
+
+GLuint FilterPreviewWidget::sourceTexture() const
+{
+    if (m_denoiseCurrent >= 0) {
+        return m_denoiseTargets[m_denoiseCurrent]->texture();
+    }
+    return m_texture ? m_texture->textureId() : 0;
+}
+
+void FilterPreviewWidget::renderToCurrentTarget(const QSize &targetSize, bool offscreen)
 {
     if (!m_program || !m_texture) {
         return;
     }
 
-    const qreal dpr = devicePixelRatioF();
-    const QSize physicalSize = (QSizeF(targetSize) * dpr).toSize();
+    // Framebuffer objects are sized in pixels already; only the widget scales
+    const QSize physicalSize = offscreen ? targetSize : (QSizeF(targetSize) * devicePixelRatioF()).toSize();
 
     glViewport(0, 0, physicalSize.width(), physicalSize.height());
     glClear(GL_COLOR_BUFFER_BIT);
@@ -410,22 +1258,34 @@ void FilterPreviewWidget::renderToCurrentTarget(const QSize &targetSize)
     const qreal frameAspect = frameSize.width() / frameSize.height();
     const qreal targetAspect = static_cast<qreal>(targetSize.width()) / targetSize.height();
 
+    // The crop keeps the frame's aspect. The screen letterboxes it; the
+    // output is filled by trimming it instead, as the virtual camera used to
+    QRectF crop = viewCrop();
     QVector2D scale(1.0f, 1.0f);
-    if (frameAspect > targetAspect) {
+    if (offscreen) {
+        if (frameAspect > targetAspect) {
+            const qreal trimmedWidth = crop.width() * targetAspect / frameAspect;
+            crop = QRectF(crop.center().x() - trimmedWidth / 2.0, crop.top(), trimmedWidth, crop.height());
+        } else {
+            const qreal trimmedHeight = crop.height() * frameAspect / targetAspect;
+            crop = QRectF(crop.left(), crop.center().y() - trimmedHeight / 2.0, crop.width(), trimmedHeight);
+        }
+    } else if (frameAspect > targetAspect) {
         scale.setY(frameAspect / targetAspect);
     } else {
         scale.setX(targetAspect / frameAspect);
     }
 
     m_program->setUniformValue("u_scale", scale);
+    m_program->setUniformValue("u_crop", QVector4D(crop.x(), crop.y(), crop.width(), crop.height()));
 
     glActiveTexture(GL_TEXTURE0);
-    m_texture->bind();
+    glBindTexture(GL_TEXTURE_2D, sourceTexture());
 
     QOpenGLVertexArrayObject::Binder binder(&m_vertexArray);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-    m_texture->release();
+    glBindTexture(GL_TEXTURE_2D, 0);
     m_program->release();
 }
 
@@ -454,6 +1314,25 @@ void FilterPreviewWidget::cleanupGLResources()
     }
     m_program.reset();
     m_geometryInitialized = false;
+
+    m_denoiseTargets[0].reset();
+    m_denoiseTargets[1].reset();
+    m_denoiseProgram.reset();
+    m_denoiseCurrent = -1;
+
+    if (m_glyphAtlas) {
+        m_glyphAtlas->destroy();
+        m_glyphAtlas.reset();
+    }
+    if (m_overlayBuffer.isCreated()) {
+        m_overlayBuffer.destroy();
+    }
+    if (m_overlayArray.isCreated()) {
+        m_overlayArray.destroy();
+    }
+    m_overlayProgram.reset();
+    m_glyphAtlasDpr = 0.0;
+    m_overlayGeometryDirty = true;
 }
 
 void FilterPreviewWidget::handleContextAboutToBeDestroyed()
@@ -2,6 +2,7 @@
 #define FILTERPREVIEWWIDGET_H
 
 #include <QColor>
+#include <QElapsedTimer>
 #include <QImage>
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
@@ -10,10 +11,20 @@
 #include <QOpenGLTexture>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWidget>
+#include <QPointF>
+#include <QRectF>
+#include <QStringList>
 #include <QVideoFrame>
+#include <functional>
 #include <memory>
 #include <QtGlobal>
 #include <QVector3D>
+#include "TemporalDenoiser.h"
+
+class ImageStabilizer;
+class QContextMenuEvent;
+class QMouseEvent;
+class QTimer;
 
 class FilterPreviewWidget : public QOpenGLWidget, protected QOpenGLFunctions
 {
@@ -37,6 +48,12 @@ public:
         float bloom = 0.0f;           // 0.0 to 1.0
         float softFocus = 0.0f;       // 0.0 to 1.0
         float duoToneIntensity = 0.0f; // 0.0 to 1.0
+        float denoise = 0.0f;         // 0.0 to 1.0
+        float digitalZoom = 1.0f;     // 1.0 to 4.0, on top of the camera's own zoom
+        float digitalPan = 0.0f;      // -1.0 to 1.0 of the room the zoom leaves
+        float digitalTilt = 0.0f;     // -1.0 to 1.0, positive up
+        float stabilization = 0.0f;   // 0.0 to 1.0
+        int stabilizationLookahead = 2; // Frames held back, 0 to 8
         QColor duoToneShadow = QColor(30, 30, 60);
         QColor duoToneHighlight = QColor(220, 180, 160);
         bool horizontalFlip = false;
@@ -59,6 +76,12 @@ public:
                 && qFuzzyCompare(1.0f + bloom, 1.0f + other.bloom)
                 && qFuzzyCompare(1.0f + softFocus, 1.0f + other.softFocus)
                 && qFuzzyCompare(1.0f + duoToneIntensity, 1.0f + other.duoToneIntensity)
+                && qFuzzyCompare(1.0f + denoise, 1.0f + other.denoise)
+                && qFuzzyCompare(digitalZoom, other.digitalZoom)
+                && qFuzzyCompare(1.0f + digitalPan, 1.0f + other.digitalPan)
+                && qFuzzyCompare(1.0f + digitalTilt, 1.0f + other.digitalTilt)
+                && qFuzzyCompare(1.0f + stabilization, 1.0f + other.stabilization)
+                && stabilizationLookahead == other.stabilizationLookahead
                 && duoToneShadow == other.duoToneShadow
                 && duoToneHighlight == other.duoToneHighlight
                 && horizontalFlip == other.horizontalFlip;
@@ -72,6 +95,25 @@ public:
         static VideoEffectsSettings defaults() { return VideoEffectsSettings{}; }
     };
 
+    // What the user picked in the preview for the camera to frame
+    enum TargetGesture {
+        TargetClick,    // Track the subject at a point
+        TargetBox,      // Frame a dragged box
+        TargetCentral,  // Track the subject nearest the center (context menu)
+        TargetBiggest,  // Track the largest subject (context menu)
+    };
+    Q_ENUM(TargetGesture)
+
+    // Figures the performance overlay shows that come from outside this widget
+    struct OverlayInputs {
+        QString captureFormat;
+        bool virtualCameraOn = false;
+        quint64 virtualCameraFrames = 0;   // Written since the streamer started
+        quint64 virtualCameraDropped = 0;  // Dropped from its full queue
+        int virtualCameraQueue = 0;
+        double virtualCameraMs = 0.0;      // Per frame, on its worker thread
+    };
+
     explicit FilterPreviewWidget(QWidget *parent = nullptr);
     ~FilterPreviewWidget() override;
 
@@ -79,27 +121,80 @@ public:
     VideoEffectsSettings videoEffects() const { return m_effectSettings; }
     void updateVideoFrame(const QVideoFrame &frame);
 
+    // Click-to-track and drag-to-frame; subjectSelection adds the central/biggest menu
+    void setTargetSelectionEnabled(bool enabled, bool subjectSelection = false);
+
+    /**
+     * @brief Map a widget position to normalised camera frame coordinates
+     *
+     * Frame coordinates run 0..1 from the top-left of the frame as the
+     * camera sends it, so the letterbox fit and the mirror flip are undone.
+     * @return false if the position is outside the picture
+     */
+    bool mapToFrame(const QPointF &widgetPos, QPointF &framePos) const;
+
+    /**
+     * @brief Size of the frames for processedFrameReady; empty for the camera's size
+     *
+     * The picture is cropped to fill it rather than letterboxed, and the
+     * digital zoom is sampled straight at this size, so a 4K camera feeds a
+     * 1080p virtual camera at 2x with no scaling pass and no loss.
+     */
+    void setOutputSize(const QSize &size);
+
+    /**
+     * @brief Show frame rates, stage times and drops over the preview
+     *
+     * The overlay is drawn on screen after the frame for processedFrameReady
+     * has been read back, so it never reaches the virtual camera. The
+     * provider is asked for the figures this widget cannot see each time
+     * the overlay refreshes.
+     */
+    void setOverlayVisible(bool visible);
+    bool isOverlayVisible() const { return m_overlayVisible; }
+    void setOverlayInputsProvider(std::function<OverlayInputs()> provider);
+
 signals:
     void processedFrameReady(const QImage &frame);
+    // frameRect is in frame coordinates; empty at the clicked point for TargetClick
+    void targetSelected(FilterPreviewWidget::TargetGesture gesture, const QRectF &frameRect, double frameAspect);
 
 protected:
     void initializeGL() override;
     void resizeGL(int w, int h) override;
     void paintGL() override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
 
 private:
     void ensureProgram();
     void ensureGeometry();
     void ensureFramebuffer(const QSize &size);
     void uploadTextureIfNeeded();
-    void renderToCurrentTarget(const QSize &targetSize);
+    bool ensureDenoiseResources(const QSize &size);
+    void denoiseFrame(const QSize &frameSize);
+    GLuint sourceTexture() const;  // The denoised frame, or the camera frame as uploaded
+    void renderToCurrentTarget(const QSize &targetSize, bool offscreen);
+    bool advanceView();   // Steps the digital PTZ toward the settings; true while still moving
+    QRectF viewCrop() const;  // The part of the picture shown, in output coordinates
+    double stabilizerMargin() const;  // Share cropped off each side for stabilization, 0 when off
     void applyEffectsUniforms();
     QVector3D srgbColorToLinearVec3(const QColor &color) const;
 
     QSizeF frameAspectSize() const;
+    QRectF pictureRect() const;  // Where the letterboxed frame is drawn, in widget coordinates
+    QRectF frameToWidget(const QRectF &frameRect) const;
+    void drawSelectionOverlay();
+    void ensureOverlayResources();
+    void refreshOverlayText();
+    void buildOverlayGeometry();
+    void drawPerformanceOverlay();
     void cleanupGLResources();
 
     QImage m_currentImage;
+    QSize m_outputSize;
     bool m_textureDirty;
     bool m_emitPending;
     VideoEffectsSettings m_effectSettings;
@@ -111,7 +206,74 @@ private:
     QOpenGLVertexArrayObject m_vertexArray;
     bool m_geometryInitialized;
 
+    // Denoise effect: a shader pass from m_texture into a pair of float
+    // targets, each frame reading the other as its history. Runs on the CPU
+    // before upload instead when the pass is unavailable or OBSBOT_DENOISE_CPU is set
+    std::unique_ptr<QOpenGLShaderProgram> m_denoiseProgram;
+    std::unique_ptr<QOpenGLFramebufferObject> m_denoiseTargets[2];
+    int m_denoiseCurrent;  // Target holding the last denoised frame, -1 for none
+    bool m_cpuDenoise;
+    TemporalDenoiser m_cpuDenoiser;
+
+    // Digital PTZ, eased toward the settings by a critically damped spring,
+    // per axis, so a new target mid-move bends the path instead of jerking it
+    struct ViewState {
+        double logZoom = 0.0;   // ln(zoom): a zoom moves at an even pace to the eye
+        double centerX = 0.5;   // Output coordinates, 0..1 from the top-left
+        double centerY = 0.5;
+    };
+    ViewState m_view;
+    ViewState m_viewVelocity;
+    QElapsedTimer m_viewClock;  // Invalid until the first frame; the view snaps to it
+
+    // Stabilization: frames go through m_stabilizer, created when first
+    // enabled, and come back to presentFrame with the crop offset to draw them at
+    ImageStabilizer *m_stabilizer;
+    QPointF m_stabilizerCorrection;  // For m_currentImage, as a share of the frame
+
+    bool m_targetSelectionEnabled;
+    bool m_subjectSelectionEnabled;
+    bool m_dragging;
+    QPointF m_dragStart;    // Widget coordinates
+    QPointF m_dragCurrent;
+    QRectF m_lastSelection; // Frame coordinates, outlined while m_selectionFadeTimer runs
+    QTimer *m_selectionFadeTimer;
+
+    // Performance overlay; the counters run whether or not it is shown
+    struct PipelineCounters {
+        quint64 received = 0;    // Frames handed to updateVideoFrame
+        quint64 replaced = 0;    // Replaced by a newer frame before being drawn
+        quint64 missed = 0;      // Gaps in the camera's frame timestamps
+        quint64 repeated = 0;    // Sent again by the camera with the same timestamp
+        quint64 processed = 0;   // Read back for processedFrameReady
+        double convertMs = 0.0;  // Moving averages per stage
+        double uploadMs = 0.0;
+        double denoiseMs = 0.0;
+        double readbackMs = 0.0;
+        double drawMs = 0.0;
+    };
+    PipelineCounters m_counters;
+    PipelineCounters m_countersAtRefresh;
+    quint64 m_virtualCameraFramesAtRefresh;
+    qint64 m_lastFrameTime;      // Camera timestamp of the last frame, in us
+    double m_frameInterval;      // Moving average of the camera's frame interval, in us
+    bool m_overlayVisible;
+    QTimer *m_overlayTimer;      // Refreshes the figures even when no frames arrive
+    QElapsedTimer m_overlayClock;
+    std::function<OverlayInputs()> m_overlayInputsProvider;
+    QStringList m_overlayLines;
+    bool m_overlayGeometryDirty;
+
+    std::unique_ptr<QOpenGLShaderProgram> m_overlayProgram;
+    std::unique_ptr<QOpenGLTexture> m_glyphAtlas;  // Printable ASCII, drawn once per device pixel ratio
+    QOpenGLBuffer m_overlayBuffer;
+    QOpenGLVertexArrayObject m_overlayArray;
+    QSizeF m_glyphSize;  // One monospace cell, in widget pixels
+    qreal m_glyphAtlasDpr;
+    int m_overlayVertexCount;
+
 private slots:
+    void presentFrame(const QImage &image, const QPointF &correction);
     void handleContextAboutToBeDestroyed();
 };
 
@@ -0,0 +1,234 @@
+#include "ImageStabilizer.h"
+#include "MotionEstimator.h"
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Frames held past the look-ahead while estimates are late, before they are shown anyway
+constexpr int kMaxBacklog = 3;
+// Frames at the worker at once; one arriving beyond that is not measured,
+// and the next estimate covers its motion
+constexpr int kMaxInFlight = 4;
+// Shown frames kept for the smoothing to look back on; three of the widest sigma
+constexpr size_t kHistory = 48;
+// Weight of the newest sample in the estimate time average
+constexpr double kStatsSmoothing = 0.1;
+
+} // namespace
+
+class ImageStabilizerWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    void estimate(quint64 sequence, const QImage &frame)
+    {
+        Trace::Scope trace("stabilize.estimate");
+        QElapsedTimer timer;
+        timer.start();
+        const MotionEstimator::Motion motion =
+            m_estimator.estimate(frame.constBits(), frame.width(), frame.height(), frame.bytesPerLine());
+        emit motionEstimated(sequence, motion.dx, motion.dy, motion.valid, timer.nsecsElapsed() / 1e6);
+    }
+
+    void reset()
+    {
+        m_estimator.reset();
+    }
+
+signals:
+    void motionEstimated(quint64 sequence, double dx, double dy, bool valid, double ms);
+
+private:
+    MotionEstimator m_estimator;
+};
+
+ImageStabilizer::ImageStabilizer(QObject *parent)
+    : QObject(parent)
+    , m_workerThread(nullptr)
+    , m_worker(nullptr)
+    , m_nextSequence(0)
+    , m_inFlight(0)
+    , m_lookahead(2)
+    , m_sigma(0.0)
+    , m_margin(0.0)
+    , m_estimateMs(0.0)
+    , m_late(0)
+{
+    setStrength(0.5f);
+}
+
+ImageStabilizer::~ImageStabilizer()
+{
+    if (m_workerThread) {
+        m_workerThread->quit();
+        m_workerThread->wait();
+    }
+}
+
+void ImageStabilizer::setStrength(float strength)
+{
+    strength = std::clamp(strength, 0.0f, 1.0f);
+    m_sigma = 2.0 + 13.0 * strength;    // A sixth to half a second at 30 fps
+    m_margin = 0.02 + 0.06 * strength;  // Enough for a monitor mount knocked by typing
+}
+
+void ImageStabilizer::setLookahead(int frames)
+{
+    m_lookahead = std::clamp(frames, 0, kMaxLookahead);
+    releaseFrames();
+}
+
+ImageStabilizer::Stats ImageStabilizer::stats() const
+{
+    Stats stats;
+    stats.estimateMs = m_estimateMs;
+    stats.held = static_cast<int>(std::count_if(m_frames.begin(), m_frames.end(),
+                                                [](const Entry &entry) { return !entry.image.isNull(); }));
+    stats.late = m_late;
+    return stats;
+}
+
+void ImageStabilizer::reset()
+{
+    // Estimates still on their way back find no entry and are dropped
+    m_frames.clear();
+    m_origin = QPointF();
+    if (m_worker) {
+        QMetaObject::invokeMethod(m_worker, &ImageStabilizerWorker::reset, Qt::QueuedConnection);
+    }
+}
+
+void ImageStabilizer::ensureWorker()
+{
+    if (m_workerThread) {
+        return;
+    }
+
+    m_workerThread = new QThread(this);
+    m_workerThread->setObjectName(QStringLiteral("Stabilizer"));  // Thread name in top and traces
+    m_worker = new ImageStabilizerWorker();
+    m_worker->moveToThread(m_workerThread);
+    connect(m_worker, &ImageStabilizerWorker::motionEstimated,
+            this, &ImageStabilizer::handleMotion);
+    connect(m_workerThread, &QThread::finished,
+            m_worker, &QObject::deleteLater);
+    m_workerThread->start();
+}
+
+void ImageStabilizer::pushFrame(const QImage &frame)
+{
+    if (frame.isNull()) {
+        return;
+    }
+
+    ensureWorker();
+    Entry entry{m_nextSequence++, frame, QPointF(), false};
+    if (m_inFlight < kMaxInFlight) {
+        entry.pending = true;
+        ++m_inFlight;
+        QMetaObject::invokeMethod(m_worker,
+            [worker = m_worker, sequence = entry.sequence, image = frame]() {
+                worker->estimate(sequence, image);
+            },
+            Qt::QueuedConnection);
+    }
+    m_frames.push_back(entry);
+    releaseFrames();
+}
+
+void ImageStabilizer::handleMotion(quint64 sequence, double dx, double dy, bool valid, double ms)
+{
+    --m_inFlight;
+    m_estimateMs = m_estimateMs == 0.0 ? ms : m_estimateMs + (ms - m_estimateMs) * kStatsSmoothing;
+
+    if (m_frames.empty() || sequence < m_frames.front().sequence
+        || sequence - m_frames.front().sequence >= m_frames.size()) {
+        return;  // From before a reset
+    }
+    Entry &entry = m_frames[sequence - m_frames.front().sequence];
+    entry.motion = valid ? QPointF(dx, dy) : QPointF();  // A frame the blocks disagree on counts as still
+    entry.pending = false;
+    releaseFrames();
+}
+
+QPointF ImageStabilizer::correctionAt(size_t index) const
+{
+    // Path positions, summed from the origin; a pending entry adds nothing yet
+    const size_t last = std::min(m_frames.size() - 1, index + m_lookahead);
+    std::vector<QPointF> positions(last + 1);
+    QPointF position = m_origin;
+    for (size_t i = 0; i <= last; ++i) {
+        position += m_frames[i].motion;
+        positions[i] = position;
+    }
+
+    const size_t reach = static_cast<size_t>(std::ceil(3.0 * m_sigma));
+    QPointF sum;
+    double weights = 0.0;
+    for (size_t i = index > reach ? index - reach : 0; i <= last; ++i) {
+        if (m_frames[i].pending) {
+            continue;
+        }
+        const double offset = static_cast<double>(i) - static_cast<double>(index);
+        const double weight = std::exp(-offset * offset / (2.0 * m_sigma * m_sigma));
+        sum += positions[i] * weight;
+        weights += weight;
+    }
+    if (weights <= 0.0) {
+        return QPointF();
+    }
+    return positions[index] - sum / weights;
+}
+
+void ImageStabilizer::releaseFrames()
+{
+    for (;;) {
+        const auto held = std::find_if(m_frames.begin(), m_frames.end(),
+                                       [](const Entry &entry) { return !entry.image.isNull(); });
+        if (held == m_frames.end()) {
+            break;
+        }
+        const size_t index = static_cast<size_t>(held - m_frames.begin());
+        const size_t heldCount = m_frames.size() - index;
+
+        // Shown once it and the look-ahead after it are measured, or once it has waited too long
+        bool ready = heldCount > static_cast<size_t>(m_lookahead);
+        for (size_t i = index; ready && i <= index + m_lookahead; ++i) {
+            ready = !m_frames[i].pending;
+        }
+        const bool overdue = heldCount > static_cast<size_t>(m_lookahead + kMaxBacklog);
+        if (!ready && !overdue) {
+            break;
+        }
+        if (held->pending) {
+            ++m_late;
+        }
+
+        const QImage image = held->image;
+        held->image = QImage();
+        const QPointF correction = correctionAt(index);
+        const double x = std::clamp(correction.x() / image.width(), -m_margin, m_margin);
+        const double y = std::clamp(correction.y() / image.height(), -m_margin, m_margin);
+        emit frameReady(image, QPointF(x, y));
+    }
+
+    // Keep enough shown frames for the smoothing to look back on
+    size_t shown = static_cast<size_t>(std::count_if(m_frames.begin(), m_frames.end(),
+                                                     [](const Entry &entry) { return entry.image.isNull(); }));
+    while (shown > kHistory && !m_frames.front().pending && m_frames.front().image.isNull()) {
+        m_origin += m_frames.front().motion;
+        m_frames.pop_front();
+        --shown;
+    }
+}
+
+#include "ImageStabilizer.moc"
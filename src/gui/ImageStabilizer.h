@@ -0,0 +1,87 @@
+#ifndef IMAGESTABILIZER_H
+#define IMAGESTABILIZER_H
+
+#include <QImage>
+#include <QObject>
+#include <QPointF>
+#include <deque>
+
+class QThread;
+class ImageStabilizerWorker;
+
+/**
+ * @brief Takes camera shake out of the preview frames
+ *
+ * Each frame goes to a worker thread, where MotionEstimator measures how
+ * far the picture moved since the one before. Adding those up gives the
+ * path the camera took; a Gaussian average of it, over recent frames and
+ * a few held back for look-ahead, is the path it should have taken. Frames
+ * come back in order with the difference, for the render pass to move its
+ * crop by. Shake is taken out, and deliberate moves come through smoothed.
+ *
+ * Latency is bounded: a frame is held for the look-ahead plus at most
+ * kMaxBacklog more while the worker catches up. Past that it is shown
+ * with the path as known so far.
+ */
+class ImageStabilizer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kMaxLookahead = 8;
+
+    // Read by the preview's performance overlay
+    struct Stats {
+        double estimateMs = 0.0;  // Moving average per frame, on the worker thread
+        int held = 0;             // Frames waiting for look-ahead or estimates
+        quint64 late = 0;         // Shown before their estimate arrived
+    };
+
+    explicit ImageStabilizer(QObject *parent = nullptr);
+    ~ImageStabilizer() override;
+
+    // 0 to 1: how smooth the path is made, and the margin cropped off to pay for it
+    void setStrength(float strength);
+    // Frames held back so the smoothing can see where the camera goes next
+    void setLookahead(int frames);
+    // Share of the frame cropped off each side
+    double margin() const { return m_margin; }
+
+    void pushFrame(const QImage &frame);
+    void reset();  // Drops held frames and starts a new path
+    Stats stats() const;
+
+signals:
+    // correction: how far to move the crop, as a share of the frame, to put
+    // the picture where the smoothed path has it
+    void frameReady(const QImage &frame, const QPointF &correction);
+
+private slots:
+    void handleMotion(quint64 sequence, double dx, double dy, bool valid, double ms);
+
+private:
+    struct Entry {
+        quint64 sequence;
+        QImage image;     // Null once shown
+        QPointF motion;   // Since the entry before, in pixels
+        bool pending;     // Sent to the worker with no estimate back yet
+    };
+
+    void ensureWorker();
+    void releaseFrames();
+    QPointF correctionAt(size_t index) const;
+
+    QThread *m_workerThread;
+    ImageStabilizerWorker *m_worker;
+    std::deque<Entry> m_frames;  // Shown frames kept for the smoothing, then held ones
+    QPointF m_origin;            // Path position of the entry before m_frames.front()
+    quint64 m_nextSequence;
+    int m_inFlight;
+    int m_lookahead;
+    double m_sigma;              // Smoothing width, in frames
+    double m_margin;
+    double m_estimateMs;
+    quint64 m_late;
+};
+
+#endif // IMAGESTABILIZER_H
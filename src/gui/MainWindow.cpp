@@ -1,8 +1,11 @@
 #include "MainWindow.h"
 #include "PreviewWindow.h"
 #include "VirtualCameraStreamer.h"
+#include "StartupTimer.h"
+#include "Trace.h"
 
 #include <QMessageBox>
+#include <QInputDialog>
 #include <QWidget>
 #include <QIcon>
 #include <QEvent>
@@ -10,7 +13,7 @@
 #include <QApplication>
 #include <QCoreApplication>
 #include <QTimer>
-#include <QProcess>
+#include <QElapsedTimer>
 #include <QRegularExpression>
 #include <QMediaDevices>
 #include <QCameraDevice>
@@ -30,9 +33,12 @@
 #include <QPalette>
 #include <QList>
 #include <QFileInfo>
+#include <QShortcut>
+#include <QKeySequence>
 #include <iostream>
 #include <array>
 #include <algorithm>
+#include <cmath>
 
 namespace {
 
@@ -134,6 +140,71 @@ QString modprobeCommandForDevice(const QString &devicePath)
         .arg(videoNr);
 }
 
+FilterPreviewWidget::VideoEffectsSettings effectsFromConfig(const Config::CameraSettings::VideoEffects &stored)
+{
+    FilterPreviewWidget::VideoEffectsSettings effects;
+    effects.brightness = static_cast<float>(stored.brightness);
+    effects.contrast = static_cast<float>(stored.contrast);
+    effects.exposure = static_cast<float>(stored.exposure);
+    effects.highlights = static_cast<float>(stored.highlights);
+    effects.shadows = static_cast<float>(stored.shadows);
+    effects.saturation = static_cast<float>(stored.saturation);
+    effects.vibrance = static_cast<float>(stored.vibrance);
+    effects.temperature = static_cast<float>(stored.temperature);
+    effects.tint = static_cast<float>(stored.tint);
+    effects.noise = static_cast<float>(stored.noise);
+    effects.blur = static_cast<float>(stored.blur);
+    effects.sharpen = static_cast<float>(stored.sharpen);
+    effects.glow = static_cast<float>(stored.glow);
+    effects.bloom = static_cast<float>(stored.bloom);
+    effects.softFocus = static_cast<float>(stored.softFocus);
+    effects.duoToneIntensity = static_cast<float>(stored.duoToneIntensity);
+    effects.denoise = static_cast<float>(stored.denoise);
+    effects.digitalZoom = static_cast<float>(stored.digitalZoom);
+    effects.digitalPan = static_cast<float>(stored.digitalPan);
+    effects.digitalTilt = static_cast<float>(stored.digitalTilt);
+    effects.stabilization = static_cast<float>(stored.stabilize);
+    effects.stabilizationLookahead = stored.stabilizeLookahead;
+    effects.duoToneShadow = QColor(QStringLiteral("#") + QString::fromStdString(stored.duoToneShadow));
+    effects.duoToneHighlight = QColor(QStringLiteral("#") + QString::fromStdString(stored.duoToneHighlight));
+    effects.horizontalFlip = stored.horizontalFlip;
+    return effects;
+}
+
+Config::CameraSettings::VideoEffects effectsToConfig(const FilterPreviewWidget::VideoEffectsSettings &effects)
+{
+    // Float sliders written as 0.1 rather than 0.100000001, so a restore round-trips
+    const auto round = [](float value) { return std::round(value * 10000.0) / 10000.0; };
+
+    Config::CameraSettings::VideoEffects stored;
+    stored.brightness = round(effects.brightness);
+    stored.contrast = round(effects.contrast);
+    stored.exposure = round(effects.exposure);
+    stored.highlights = round(effects.highlights);
+    stored.shadows = round(effects.shadows);
+    stored.saturation = round(effects.saturation);
+    stored.vibrance = round(effects.vibrance);
+    stored.temperature = round(effects.temperature);
+    stored.tint = round(effects.tint);
+    stored.noise = round(effects.noise);
+    stored.blur = round(effects.blur);
+    stored.sharpen = round(effects.sharpen);
+    stored.glow = round(effects.glow);
+    stored.bloom = round(effects.bloom);
+    stored.softFocus = round(effects.softFocus);
+    stored.duoToneIntensity = round(effects.duoToneIntensity);
+    stored.denoise = round(effects.denoise);
+    stored.digitalZoom = round(effects.digitalZoom);
+    stored.digitalPan = round(effects.digitalPan);
+    stored.digitalTilt = round(effects.digitalTilt);
+    stored.stabilize = round(effects.stabilization);
+    stored.stabilizeLookahead = effects.stabilizationLookahead;
+    stored.duoToneShadow = effects.duoToneShadow.name().mid(1).toStdString();  // Config stores rrggbb
+    stored.duoToneHighlight = effects.duoToneHighlight.name().mid(1).toStdString();
+    stored.horizontalFlip = effects.horizontalFlip;
+    return stored;
+}
+
 } // namespace
 
 MainWindow::MainWindow(QWidget *parent)
@@ -148,8 +219,15 @@ MainWindow::MainWindow(QWidget *parent)
     , m_virtualCameraDeviceEdit(nullptr)
     , m_virtualCameraResolutionCombo(nullptr)
     , m_virtualCameraStatusLabel(nullptr)
+    , m_trackingWidget(nullptr)
+    , m_ptzWidget(nullptr)
+    , m_settingsWidget(nullptr)
     , m_effectsWidget(nullptr)
     , m_virtualCameraStreamer(nullptr)
+    , m_holderScanSerial(0)
+    , m_uiBuilt(false)
+    , m_trayResident(false)
+    , m_startupFinished(false)
     , m_isApplyingStyle(false)
     , m_virtualCameraErrorNotified(false)
     , m_virtualCameraAvailable(false)
@@ -169,42 +247,81 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onStateChanged);
     connect(m_controller, &CameraController::commandFailed,
             this, &MainWindow::onCommandFailed);
+    // Imported device presets are persisted with the next regular config save
+    connect(m_controller, &CameraController::presetsSynced,
+            this, &MainWindow::applyPresetsFromConfig);
+    connect(m_controller, &CameraController::settingsReplaced,
+            this, &MainWindow::onSettingsReplaced);
+    connect(m_controller, &CameraController::deviceScanFinished,
+            this, &MainWindow::onDeviceScanFinished);
+
+    // Start connecting to camera; the SDK's device scan runs on a worker
+    // while the window is built and painted
+    m_controller->connectToCamera();
 
     m_virtualCameraStreamer = new VirtualCameraStreamer(this);
     connect(m_virtualCameraStreamer, &VirtualCameraStreamer::errorOccurred,
             this, &MainWindow::onVirtualCameraError);
 
-    setupUI();
     setupTrayIcon();
 
-    m_lastDockedSize = size();
-
     // Load configuration
     loadConfiguration();
-
-    // Check if we should start minimized
-    if (m_controller->getConfig().getSettings().startMinimized) {
-        // Start hidden in tray
-        QTimer::singleShot(0, this, [this]() {
-            hide();
-        });
+    StartupTimer::mark("config loaded");
+
+    // Launched minimized: live in the tray with just the controller, and
+    // build the window, preview included, the first time it is opened
+    m_trayResident = m_controller->getConfig().getSettings().startMinimized &&
+                     QSystemTrayIcon::isSystemTrayAvailable();
+    if (m_trayResident) {
+        StartupTimer::mark("tray ready");
+    } else {
+        ensureUI();
     }
 
-    // Start connecting to camera
-    m_controller->connectToCamera();
-
     // Update status periodically
     m_statusTimer = new QTimer(this);
     connect(m_statusTimer, &QTimer::timeout, this, &MainWindow::updateStatus);
     m_statusTimer->start(2000);
 }
 
+void MainWindow::setVisible(bool visible)
+{
+    if (visible) {
+        ensureUI();
+    }
+    QMainWindow::setVisible(visible);
+}
+
+void MainWindow::ensureUI()
+{
+    if (m_uiBuilt) {
+        return;
+    }
+
+    setupUI();
+    m_uiBuilt = true;
+    m_lastDockedSize = size();
+
+    applyConfigToWidgets();
+    updateVirtualCameraStreamerState();
+    if (m_controller->isConnected()) {
+        showCameraInfo(m_controller->getCameraInfo());
+    }
+    StartupTimer::mark("window built");
+}
+
 MainWindow::~MainWindow()
 {
+    // Their callbacks queue onto this window
+    m_usageWatcher.stop();
+    m_holderScanner.stop();
+
     // Save config on exit
     if (m_controller->isConnected()) {
         m_controller->saveConfig();
     }
+    m_controller->flushConfig();
 }
 
 void MainWindow::setupUI()
@@ -333,30 +450,29 @@ void MainWindow::setupUI()
     connect(m_reconnectButton, &QPushButton::clicked, this, [this]() {
         m_controller->disconnectFromCamera();
         m_controller->connectToCamera();
+        if (m_controller->isConnecting()) {
+            m_deviceInfoLabel->setText(tr("Connecting to camera..."));
+            updateStatusBanner(false);
+        }
     });
     actionLayout->addWidget(m_reconnectButton);
 
     controlLayout->addWidget(actionRow);
 
-    m_trackingWidget = new TrackingControlWidget(m_controller, this);
-    m_ptzWidget = new PTZControlWidget(m_controller, this);
-    m_settingsWidget = new CameraSettingsWidget(m_controller, this);
-    m_ptzWidget->setCameraSettingsWidget(m_settingsWidget);
-    connect(m_ptzWidget, &PTZControlWidget::presetUpdated,
-            this, &MainWindow::onPresetUpdated);
-
+    // Tabs start as empty pages; ensureControlTab() builds each one the
+    // first time it is shown, so the window paints before any of them exist
     m_tabWidget = new QTabWidget(m_controlCard);
     m_tabWidget->setObjectName("controlTabs");
     m_tabWidget->setDocumentMode(true);
-    m_tabWidget->addTab(m_trackingWidget, tr("Tracking"));
-    m_tabWidget->addTab(m_ptzWidget, tr("Presets"));
-    m_tabWidget->addTab(m_settingsWidget, tr("Camera Image"));
-    m_effectsWidget = new VideoEffectsWidget(this);
-    connect(m_effectsWidget, &VideoEffectsWidget::effectsChanged,
-            this, &MainWindow::onVideoEffectsChanged);
-    m_tabWidget->addTab(m_effectsWidget, tr("Creative FX"));
+    for (const QString &label : {tr("Tracking"), tr("Presets"), tr("Camera Image"), tr("Creative FX")}) {
+        QWidget *page = new QWidget(m_tabWidget);
+        QVBoxLayout *pageLayout = new QVBoxLayout(page);
+        pageLayout->setContentsMargins(0, 0, 0, 0);
+        m_tabWidget->addTab(page, label);
+    }
+    connect(m_tabWidget, &QTabWidget::currentChanged,
+            this, &MainWindow::ensureControlTab);
     controlLayout->addWidget(m_tabWidget, 1);
-    m_effectsWidget->reset();
 
     QGroupBox *virtualCameraGroup = new QGroupBox(tr("Virtual Camera"), m_controlCard);
     QVBoxLayout *virtualLayout = new QVBoxLayout(virtualCameraGroup);
@@ -445,6 +561,12 @@ void MainWindow::setupUI()
             this, &MainWindow::onPreviewFailed);
     connect(m_previewWidget, &CameraPreviewWidget::preferredFormatChanged,
             this, &MainWindow::onPreviewFormatChanged);
+    connect(m_previewWidget, &CameraPreviewWidget::targetSelected,
+            this, &MainWindow::onPreviewTargetSelected);
+    connect(m_controller, &CameraController::targetSelectionFinished,
+            this, &MainWindow::onTargetSelectionFinished);
+    connect(m_controller, &CameraController::settlingFinished,
+            this, &MainWindow::onSettlingFinished);
 
     applyModernStyle();
     updateStatusBanner(false);
@@ -547,6 +669,9 @@ void MainWindow::applyModernStyle()
             background-color: %5;
             border: 1px solid %6;
         }
+        QFrame#statusBanner[state="connecting"] {
+            border: 1px dashed %6;
+        }
         QLabel#deviceInfoLabel {
             font-weight: 600;
         }
@@ -640,7 +765,16 @@ bool MainWindow::event(QEvent *event)
     case QEvent::PaletteChange:
     case QEvent::ApplicationPaletteChange:
     case QEvent::ThemeChange:
-        applyModernStyle();
+        if (m_uiBuilt) {
+            applyModernStyle();
+        }
+        break;
+    case QEvent::Paint:
+        if (!m_startupFinished) {
+            StartupTimer::mark("first paint");
+            // Let the frame reach the screen before building the rest
+            QTimer::singleShot(0, this, &MainWindow::finishStartup);
+        }
         break;
     default:
         break;
@@ -779,8 +913,11 @@ void MainWindow::updatePreviewControls()
 
 void MainWindow::updateStatusBanner(bool connected)
 {
-    m_statusBanner->setProperty("state", connected ? "connected" : "disconnected");
-    m_statusChip->setText(connected ? tr("Camera • Online") : tr("Camera • Offline"));
+    const bool searching = !connected && m_controller->isConnecting();
+    m_statusBanner->setProperty("state", connected ? "connected" : searching ? "connecting" : "disconnected");
+    m_statusChip->setText(connected   ? tr("Camera • Online")
+                          : searching ? tr("Camera • Searching…")
+                                      : tr("Camera • Offline"));
     m_statusBanner->style()->unpolish(m_statusBanner);
     m_statusBanner->style()->polish(m_statusBanner);
     m_statusBanner->update();
@@ -804,36 +941,29 @@ void MainWindow::onTogglePreview(bool enabled)
             return;
         }
 
-        // Check if camera is already in use BEFORE doing any layout changes
-        QString process = getProcessUsingCamera(devicePath);
-        if (!process.isEmpty()) {
-            // Camera is in use - show warning and abort
-            QString warningText = "⚠ Cannot open camera preview\n(In use by: " + process + ")";
-            m_cameraWarningLabel->setText(warningText);
-            m_cameraWarningLabel->setVisible(true);
-
-            // Uncheck the button
-            m_previewToggleButton->setChecked(false);
-            return;
-        }
-
-        // Try to enable preview - will emit previewStarted() or previewFailed()
-        m_previewWidget->setCameraDeviceId(devicePath);
-        m_previewWidget->enablePreview(true);
+        // Check if camera is already in use BEFORE doing any layout changes.
+        // The check runs off the UI thread; the preview starts when it reports back.
+        const int serial = ++m_holderScanSerial;
+        findProcessUsingCamera(devicePath, [this, serial, devicePath](const QString &process) {
+            if (serial != m_holderScanSerial || !m_previewToggleButton->isChecked()) {
+                return;  // Turned off, or asked again, while the check ran
+            }
+            if (!process.isEmpty()) {
+                // Camera is in use - show warning and abort
+                QString warningText = "⚠ Cannot open camera preview\n(In use by: " + process + ")";
+                m_cameraWarningLabel->setText(warningText);
+                m_cameraWarningLabel->setVisible(true);
 
-        if (!m_previewDetached) {
-            if (m_previewStack->indexOf(m_previewWidget) == -1) {
-                m_previewStack->insertWidget(0, m_previewWidget);
+                // Uncheck the button
+                m_previewToggleButton->setChecked(false);
+                return;
             }
-            m_previewStack->setCurrentWidget(m_previewWidget);
-        } else {
-            m_previewWindow->setPreviewWidget(m_previewWidget);
-            m_previewWindow->show();
-            m_previewWindow->raise();
-            m_previewWindow->activateWindow();
-        }
+            startPreview(devicePath);
+        });
+        return;
 
     } else {
+        ++m_holderScanSerial;
         attachPreviewToPanel();
         m_previewWidget->enablePreview(false);
         m_previewWindow->hide();
@@ -844,6 +974,28 @@ void MainWindow::onTogglePreview(bool enabled)
     updatePreviewControls();
 }
 
+void MainWindow::startPreview(const QString &devicePath)
+{
+    // Try to enable preview - will emit previewStarted() or previewFailed()
+    m_previewWidget->setCameraDeviceId(devicePath);
+    m_previewWidget->enablePreview(true);
+
+    if (!m_previewDetached) {
+        if (m_previewStack->indexOf(m_previewWidget) == -1) {
+            m_previewStack->insertWidget(0, m_previewWidget);
+        }
+        m_previewStack->setCurrentWidget(m_previewWidget);
+    } else {
+        m_previewWindow->setPreviewWidget(m_previewWidget);
+        m_previewWindow->show();
+        m_previewWindow->raise();
+        m_previewWindow->activateWindow();
+    }
+
+    updateVirtualCameraStreamerState();
+    updatePreviewControls();
+}
+
 void MainWindow::onDetachPreviewToggled(bool checked)
 {
     if (!m_previewToggleButton->isChecked()) {
@@ -874,7 +1026,7 @@ void MainWindow::onPreviewWindowClosed()
     updatePreviewControls();
 }
 
-void MainWindow::onCameraConnected(const CameraController::CameraInfo &info)
+void MainWindow::showCameraInfo(const CameraController::CameraInfo &info)
 {
     QString deviceText = QString("✓ Connected:\n%1\n(v%2)")
         .arg(info.name)
@@ -882,8 +1034,15 @@ void MainWindow::onCameraConnected(const CameraController::CameraInfo &info)
 
     m_deviceInfoLabel->setText(deviceText);
     updateStatusBanner(true);
+    m_previewWidget->setTargetSelectionEnabled(true, m_controller->hasSubjectSelection());
     m_cameraWarningLabel->setVisible(false);
     m_cameraWarningLabel->setText("");
+}
+
+void MainWindow::onCameraConnected(const CameraController::CameraInfo &info)
+{
+    // The camera's /dev/video node may only exist now
+    restartUsageWatcher();
 
     // Apply current UI state to camera asynchronously (respects user changes before connection)
     // Use a short delay to let the connection stabilize
@@ -892,6 +1051,10 @@ void MainWindow::onCameraConnected(const CameraController::CameraInfo &info)
         m_controller->applyCurrentStateToCamera(uiState);
     });
 
+    if (!m_uiBuilt) {
+        return;  // In the tray; ensureUI() shows the camera
+    }
+    showCameraInfo(info);
     updateStatus();
 
     if (m_previewToggleButton->isChecked()) {
@@ -907,9 +1070,17 @@ void MainWindow::onCameraConnected(const CameraController::CameraInfo &info)
 
 void MainWindow::onCameraDisconnected()
 {
+    m_targetLatencyText.clear();
+    m_settlingText.clear();
+    if (!m_uiBuilt) {
+        return;
+    }
+
     m_deviceInfoLabel->setText("❌ Camera Disconnected");
     updateStatusBanner(false);
+    m_previewWidget->setTargetSelectionEnabled(false);
     m_statusLabel->setText("Status: Not connected");
+    m_statusLabel->setToolTip(QString());
     m_cameraWarningLabel->setVisible(false);
     m_cameraWarningLabel->setText("");
 
@@ -924,11 +1095,24 @@ void MainWindow::onCameraDisconnected()
     }
 }
 
+void MainWindow::onDeviceScanFinished(bool found)
+{
+    if (found || !m_uiBuilt) {
+        return;  // onCameraConnected took over, or there is no window to tell
+    }
+    m_deviceInfoLabel->setText(tr("No camera found.\nPlug it in, or press Reconnect."));
+    updateStatusBanner(false);
+}
+
 void MainWindow::onStateChanged(const CameraController::CameraState &state)
 {
-    // Update all widgets with new state
-    m_trackingWidget->updateFromState(state);
-    m_settingsWidget->updateFromState(state);
+    // Update the widgets built so far; the others read it when built
+    if (m_trackingWidget) {
+        m_trackingWidget->updateFromState(state);
+    }
+    if (m_settingsWidget) {
+        m_settingsWidget->updateFromState(state);
+    }
 }
 
 void MainWindow::onCommandFailed(const QString &description, int errorCode)
@@ -937,9 +1121,64 @@ void MainWindow::onCommandFailed(const QString &description, int errorCode)
         QString("%1 failed with error code: %2").arg(description).arg(errorCode));
 }
 
+void MainWindow::onPreviewTargetSelected(FilterPreviewWidget::TargetGesture gesture, const QRectF &frameRect,
+                                         double frameAspect)
+{
+    TargetSelector::Request request;
+    switch (gesture) {
+    case FilterPreviewWidget::TargetClick:
+        request.action = TargetSelector::TrackAt;
+        break;
+    case FilterPreviewWidget::TargetBox:
+        request.action = TargetSelector::FrameBox;
+        break;
+    case FilterPreviewWidget::TargetCentral:
+        request.action = TargetSelector::TrackCentral;
+        break;
+    case FilterPreviewWidget::TargetBiggest:
+        request.action = TargetSelector::TrackBiggest;
+        break;
+    }
+    request.x0 = static_cast<float>(frameRect.left());
+    request.y0 = static_cast<float>(frameRect.top());
+    request.x1 = static_cast<float>(frameRect.right());
+    request.y1 = static_cast<float>(frameRect.bottom());
+    request.frameAspect = frameAspect;
+    m_controller->selectTarget(request);
+}
+
+void MainWindow::onTargetSelectionFinished(const QString &action, bool ok, double ackMs, double motionMs)
+{
+    Q_UNUSED(action);
+    if (!ok) {
+        m_targetLatencyText.clear();
+    } else if (motionMs >= 0.0) {
+        m_targetLatencyText = QString("Click to motion: %1 ms").arg(qRound(motionMs));
+    } else {
+        m_targetLatencyText = QString("Click acknowledged: %1 ms").arg(qRound(ackMs));
+    }
+    updateStatus();
+}
+
+void MainWindow::onSettlingFinished(int elapsedMs, const QStringList &drift)
+{
+    QString toolTip;
+    if (drift.isEmpty()) {
+        m_settlingText = QString("Settled: %1 ms").arg(elapsedMs);
+    } else {
+        m_settlingText = QString("Drift: %1 setting(s)").arg(drift.size());
+        toolTip = "Not confirmed by the camera after applying:\n" + drift.join("\n");
+    }
+    if (m_uiBuilt) {
+        m_statusLabel->setToolTip(toolTip);
+    }
+    updateStatus();
+}
+
 void MainWindow::updateStatus()
 {
-    if (!m_controller->isConnected()) {
+    // Nobody sees the status line from the tray; skip the camera round trip too
+    if (!m_uiBuilt || !m_controller->isConnected()) {
         return;
     }
 
@@ -951,17 +1190,22 @@ void MainWindow::updateStatus()
     statusParts << QString("HDR: %1").arg(state.hdrEnabled ? "On" : "Off");
     statusParts << QString("Face AE: %1").arg(state.faceAEEnabled ? "On" : "Off");
     statusParts << QString("Focus: %1").arg(state.autoFocusEnabled ? "Auto" : "Manual");
+    if (!m_targetLatencyText.isEmpty()) {
+        statusParts << m_targetLatencyText;
+    }
+    if (!m_settlingText.isEmpty()) {
+        statusParts << m_settlingText;
+    }
 
     m_statusLabel->setText("Status: " + statusParts.join(" | "));
 }
 
 QString MainWindow::currentVirtualCameraDevicePath() const
 {
-    if (!m_virtualCameraDeviceEdit) {
-        return QStringLiteral("/dev/video42");
-    }
-
-    const QString path = m_virtualCameraDeviceEdit->text().trimmed();
+    // The window may not be built yet; the field shows the config when it is
+    const QString path = m_virtualCameraDeviceEdit
+        ? m_virtualCameraDeviceEdit->text().trimmed()
+        : QString::fromStdString(m_controller->getConfig().getSettings().virtualCameraDevice);
     if (path.isEmpty()) {
         return QStringLiteral("/dev/video42");
     }
@@ -988,6 +1232,9 @@ void MainWindow::updateVirtualCameraAvailability(const QString &devicePath)
 
     if (deviceExists) {
         statusText = tr("Virtual camera available (%1)").arg(devicePath);
+        if (!m_virtualCameraReaders.isEmpty()) {
+            statusText += tr("\nRead by: %1").arg(m_virtualCameraReaders.join(", "));
+        }
         statusColor = QStringLiteral("#2e7d32");
         m_virtualCameraAvailable = true;
     } else if (moduleLoaded) {
@@ -1011,7 +1258,8 @@ void MainWindow::updateVirtualCameraAvailability(const QString &devicePath)
 
 void MainWindow::updateVirtualCameraStreamerState()
 {
-    if (!m_virtualCameraStreamer) {
+    // Output follows the preview, which only exists with the window
+    if (!m_virtualCameraStreamer || !m_uiBuilt) {
         return;
     }
 
@@ -1029,6 +1277,9 @@ void MainWindow::updateVirtualCameraStreamerState()
     }
     const QSize forcedSize = resolutionSizeForKey(resolutionKey);
     m_virtualCameraStreamer->setForcedResolution(forcedSize);
+    if (m_previewWidget) {
+        m_previewWidget->setOutputSize(forcedSize);  // Rendered at this size, so the streamer need not scale
+    }
 
     const bool userRequested = m_virtualCameraCheckbox && m_virtualCameraCheckbox->isChecked();
     const bool previewActive = m_previewWidget && m_previewWidget->isPreviewEnabled();
@@ -1044,40 +1295,47 @@ void MainWindow::loadConfiguration()
         handleConfigErrors(errors);
     }
 
+    applyConfigToWidgets();
+
+    m_virtualCameraErrorNotified = false;
+    updateVirtualCameraStreamerState();
+    restartUsageWatcher();
+}
+
+void MainWindow::onSettingsReplaced(const QStringList &changedKeys)
+{
+    // The controller already applied camera changes; bring the widgets in line
+    applyConfigToWidgets();
+
+    if (changedKeys.contains("virtual_camera_enabled") || changedKeys.contains("virtual_camera_device") ||
+        changedKeys.contains("virtual_camera_resolution")) {
+        m_virtualCameraErrorNotified = false;
+        updateVirtualCameraStreamerState();
+    }
+    if (changedKeys.contains("auto_profile_rules") || changedKeys.contains("virtual_camera_device")) {
+        restartUsageWatcher();
+    }
+}
+
+void MainWindow::applyConfigToWidgets()
+{
     // Initialize UI widgets from config
     auto settings = m_controller->getConfig().getSettings();
-    m_trackingWidget->setTrackingEnabled(settings.faceTracking);
-    m_trackingWidget->setAiMode(settings.aiMode);
-    m_trackingWidget->setHumanSubMode(settings.aiSubMode);
-    m_trackingWidget->setAutoZoomEnabled(settings.autoZoom);
-    m_trackingWidget->setTrackSpeed(settings.trackSpeed);
-    m_trackingWidget->setAudioAutoGain(settings.audioAutoGain);
-    m_settingsWidget->setHDREnabled(settings.hdr);
-    m_settingsWidget->setFOVMode(settings.fov);
-    m_settingsWidget->setFaceAEEnabled(settings.faceAE);
-    m_settingsWidget->setFaceFocusEnabled(settings.faceFocus);
-
-    // Image controls
-    m_settingsWidget->setBrightnessAuto(settings.brightnessAuto);
-    m_settingsWidget->setBrightness(settings.brightness);
-    m_settingsWidget->setContrastAuto(settings.contrastAuto);
-    m_settingsWidget->setContrast(settings.contrast);
-    m_settingsWidget->setSaturationAuto(settings.saturationAuto);
-    m_settingsWidget->setSaturation(settings.saturation);
-    m_settingsWidget->setWhiteBalance(settings.whiteBalance);
+    applySequencesFromConfig();  // Hotkeys, and the Presets tab once built
+    if (!m_uiBuilt) {
+        return;  // ensureUI() applies the rest
+    }
+
+    for (int index = 0; index < m_tabWidget->count(); ++index) {
+        applyConfigToTab(index, settings);
+    }
     m_previewWidget->setPreferredFormatId(QString::fromStdString(settings.previewFormat));
 
-    std::array<PTZControlWidget::PresetState, 3> presetStates{};
-    for (int i = 0; i < 3; ++i) {
-        const auto &preset = settings.presets[static_cast<size_t>(i)];
-        presetStates[static_cast<size_t>(i)] = {
-            preset.defined,
-            preset.pan,
-            preset.tilt,
-            preset.zoom
-        };
+    // Restore the grade on the preview before it can deliver a frame; the
+    // Creative FX tab passes it on itself once built
+    if (!m_effectsWidget) {
+        m_previewWidget->setVideoEffects(effectsFromConfig(settings.effects));
     }
-    m_ptzWidget->applyPresetStates(presetStates);
 
     // Application settings - block signals to prevent saving during initialization
     m_startMinimizedCheckbox->blockSignals(true);
@@ -1096,8 +1354,6 @@ void MainWindow::loadConfiguration()
         m_virtualCameraDeviceEdit->blockSignals(false);
     }
 
-    m_settingsWidget->setWhiteBalanceKelvin(settings.whiteBalanceKelvin);
-
     if (m_virtualCameraResolutionCombo) {
         const QString key = QString::fromStdString(settings.virtualCameraResolution);
         m_virtualCameraResolutionCombo->blockSignals(true);
@@ -1119,9 +1375,119 @@ void MainWindow::loadConfiguration()
         }
         m_virtualCameraResolutionCombo->blockSignals(false);
     }
+}
 
-    m_virtualCameraErrorNotified = false;
-    updateVirtualCameraStreamerState();
+void MainWindow::applyConfigToTab(int index, const Config::CameraSettings &settings)
+{
+    switch (index) {
+    case TrackingTab:
+        if (m_trackingWidget) {
+            m_trackingWidget->setTrackingEnabled(settings.faceTracking);
+            m_trackingWidget->setAiMode(settings.aiMode);
+            m_trackingWidget->setHumanSubMode(settings.aiSubMode);
+            m_trackingWidget->setAutoZoomEnabled(settings.autoZoom);
+            m_trackingWidget->setTrackSpeed(settings.trackSpeed);
+            m_trackingWidget->setAudioAutoGain(settings.audioAutoGain);
+        }
+        break;
+    case PresetsTab:
+        if (m_ptzWidget) {
+            applyPresetsFromConfig();
+            m_ptzWidget->applySequences(settings.sequences);
+        }
+        break;
+    case ImageTab:
+        if (m_settingsWidget) {
+            m_settingsWidget->setHDREnabled(settings.hdr);
+            m_settingsWidget->setFOVMode(settings.fov);
+            m_settingsWidget->setFaceAEEnabled(settings.faceAE);
+            m_settingsWidget->setFaceFocusEnabled(settings.faceFocus);
+
+            // Image controls
+            m_settingsWidget->setBrightnessAuto(settings.brightnessAuto);
+            m_settingsWidget->setBrightness(settings.brightness);
+            m_settingsWidget->setContrastAuto(settings.contrastAuto);
+            m_settingsWidget->setContrast(settings.contrast);
+            m_settingsWidget->setSaturationAuto(settings.saturationAuto);
+            m_settingsWidget->setSaturation(settings.saturation);
+            m_settingsWidget->setWhiteBalance(settings.whiteBalance);
+            m_settingsWidget->setWhiteBalanceKelvin(settings.whiteBalanceKelvin);
+        }
+        break;
+    case EffectsTab:
+        if (m_effectsWidget) {
+            // Passes the grade on to the preview through effectsChanged
+            m_effectsWidget->applySettings(effectsFromConfig(settings.effects));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void MainWindow::ensureControlTab(int index)
+{
+    QWidget *page = m_tabWidget->widget(index);
+    if (!page) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QWidget *built = nullptr;
+    switch (index) {
+    case TrackingTab:
+        if (!m_trackingWidget) {
+            built = m_trackingWidget = new TrackingControlWidget(m_controller, page);
+        }
+        break;
+    case PresetsTab:
+        if (!m_ptzWidget) {
+            ensureControlTab(ImageTab);  // Image presets capture its controls
+            built = m_ptzWidget = new PTZControlWidget(m_controller, page);
+            m_ptzWidget->setCameraSettingsWidget(m_settingsWidget);
+            connect(m_ptzWidget, &PTZControlWidget::presetUpdated,
+                    this, &MainWindow::onPresetUpdated);
+            connect(m_ptzWidget, &PTZControlWidget::sequencesEdited,
+                    this, &MainWindow::onSequencesEdited);
+        }
+        break;
+    case ImageTab:
+        if (!m_settingsWidget) {
+            built = m_settingsWidget = new CameraSettingsWidget(m_controller, page);
+        }
+        break;
+    case EffectsTab:
+        if (!m_effectsWidget) {
+            built = m_effectsWidget = new VideoEffectsWidget(page);
+            connect(m_effectsWidget, &VideoEffectsWidget::effectsChanged,
+                    this, &MainWindow::onVideoEffectsChanged);
+        }
+        break;
+    default:
+        break;
+    }
+    if (!built) {
+        return;
+    }
+
+    page->layout()->addWidget(built);
+    applyConfigToTab(index, m_controller->getConfig().getSettings());
+    if (m_controller->isConnected()) {
+        onStateChanged(m_controller->getCurrentState());
+    }
+    std::cout << "[Startup] Built the " << m_tabWidget->tabText(index).toStdString() << " tab in "
+              << timer.elapsed() << " ms" << std::endl;
+}
+
+void MainWindow::finishStartup()
+{
+    if (m_startupFinished) {
+        return;
+    }
+    m_startupFinished = true;
+    ensureControlTab(m_tabWidget->currentIndex());
+    StartupTimer::mark("controls built");
 }
 
 void MainWindow::handleConfigErrors(const std::vector<Config::ValidationError> &errors)
@@ -1176,27 +1542,53 @@ CameraController::CameraState MainWindow::getUIState() const
     // Construct a state object from current UI widget values
     CameraController::CameraState state = {};
 
-    // Get state from widgets
-    state.autoFramingEnabled = m_trackingWidget->isTrackingEnabled();
-    state.aiMode = m_trackingWidget->currentAiMode();
-    state.aiSubMode = m_trackingWidget->currentHumanSubMode();
-    state.autoZoomEnabled = m_trackingWidget->isAutoZoomEnabled();
-    state.trackSpeedMode = m_trackingWidget->currentTrackSpeed();
-    state.audioAutoGainEnabled = m_trackingWidget->isAudioAutoGainEnabled();
-    state.hdrEnabled = m_settingsWidget->isHDREnabled();
-    state.fovMode = m_settingsWidget->getFOVMode();
-    state.faceAEEnabled = m_settingsWidget->isFaceAEEnabled();
-    state.faceFocusEnabled = m_settingsWidget->isFaceFocusEnabled();
-
-    // Image controls
-    state.brightnessAuto = m_settingsWidget->isBrightnessAuto();
-    state.brightness = m_settingsWidget->getBrightness();
-    state.contrastAuto = m_settingsWidget->isContrastAuto();
-    state.contrast = m_settingsWidget->getContrast();
-    state.saturationAuto = m_settingsWidget->isSaturationAuto();
-    state.saturation = m_settingsWidget->getSaturation();
-    state.whiteBalance = m_settingsWidget->getWhiteBalance();
-    state.whiteBalanceKelvin = m_settingsWidget->getWhiteBalanceKelvin();
+    // Get state from widgets; a tab not opened yet still shows the config
+    const auto settings = m_controller->getConfig().getSettings();
+    if (m_trackingWidget) {
+        state.autoFramingEnabled = m_trackingWidget->isTrackingEnabled();
+        state.aiMode = m_trackingWidget->currentAiMode();
+        state.aiSubMode = m_trackingWidget->currentHumanSubMode();
+        state.autoZoomEnabled = m_trackingWidget->isAutoZoomEnabled();
+        state.trackSpeedMode = m_trackingWidget->currentTrackSpeed();
+        state.audioAutoGainEnabled = m_trackingWidget->isAudioAutoGainEnabled();
+    } else {
+        state.autoFramingEnabled = settings.faceTracking;
+        state.aiMode = settings.aiMode;
+        state.aiSubMode = settings.aiSubMode;
+        state.autoZoomEnabled = settings.autoZoom;
+        state.trackSpeedMode = settings.trackSpeed;
+        state.audioAutoGainEnabled = settings.audioAutoGain;
+    }
+
+    if (m_settingsWidget) {
+        state.hdrEnabled = m_settingsWidget->isHDREnabled();
+        state.fovMode = m_settingsWidget->getFOVMode();
+        state.faceAEEnabled = m_settingsWidget->isFaceAEEnabled();
+        state.faceFocusEnabled = m_settingsWidget->isFaceFocusEnabled();
+
+        // Image controls
+        state.brightnessAuto = m_settingsWidget->isBrightnessAuto();
+        state.brightness = m_settingsWidget->getBrightness();
+        state.contrastAuto = m_settingsWidget->isContrastAuto();
+        state.contrast = m_settingsWidget->getContrast();
+        state.saturationAuto = m_settingsWidget->isSaturationAuto();
+        state.saturation = m_settingsWidget->getSaturation();
+        state.whiteBalance = m_settingsWidget->getWhiteBalance();
+        state.whiteBalanceKelvin = m_settingsWidget->getWhiteBalanceKelvin();
+    } else {
+        state.hdrEnabled = settings.hdr;
+        state.fovMode = settings.fov;
+        state.faceAEEnabled = settings.faceAE;
+        state.faceFocusEnabled = settings.faceFocus;
+        state.brightnessAuto = settings.brightnessAuto;
+        state.brightness = settings.brightness;
+        state.contrastAuto = settings.contrastAuto;
+        state.contrast = settings.contrast;
+        state.saturationAuto = settings.saturationAuto;
+        state.saturation = settings.saturation;
+        state.whiteBalance = settings.whiteBalance;
+        state.whiteBalanceKelvin = settings.whiteBalanceKelvin;
+    }
 
     // Get PTZ state from controller (defaults from config)
     auto currentState = m_controller->getCurrentState();
@@ -1275,17 +1667,8 @@ void MainWindow::onPreviewFailed(const QString &error)
 {
     Q_UNUSED(error);
     // Show warning when preview fails
-    QString warningText = "⚠ Cannot open camera preview";
-
-    // Try to detect which process is using the camera
-    QString process = getProcessUsingCamera("/dev/video0");
-    if (!process.isEmpty()) {
-        warningText += "\n(In use by: " + process + ")";
-    } else {
-        warningText += "\n(In use by another application)";
-    }
-
-    m_cameraWarningLabel->setText(warningText);
+    const QString warningText = "⚠ Cannot open camera preview";
+    m_cameraWarningLabel->setText(warningText + "\n(In use by another application)");
     m_cameraWarningLabel->setVisible(true);
 
     attachPreviewToPanel();
@@ -1297,6 +1680,18 @@ void MainWindow::onPreviewFailed(const QString &error)
     } else {
         updatePreviewControls();
     }
+
+    // Try to detect which process is using the camera, and name it once known
+    QString devicePath = findObsbotVideoDevice();
+    if (devicePath.isEmpty()) {
+        devicePath = QStringLiteral("/dev/video0");
+    }
+    const int serial = ++m_holderScanSerial;
+    findProcessUsingCamera(devicePath, [this, serial, warningText](const QString &process) {
+        if (serial == m_holderScanSerial && !process.isEmpty()) {
+            m_cameraWarningLabel->setText(warningText + "\n(In use by: " + process + ")");
+        }
+    });
 }
 
 void MainWindow::onPreviewFormatChanged(const QString &formatId)
@@ -1308,6 +1703,26 @@ void MainWindow::onPreviewFormatChanged(const QString &formatId)
     updateVirtualCameraStreamerState();
 }
 
+void MainWindow::applyPresetsFromConfig()
+{
+    if (!m_ptzWidget) {
+        return;  // Read from the config when the Presets tab is built
+    }
+
+    const auto settings = m_controller->getConfig().getSettings();
+    std::vector<PTZControlWidget::PresetState> presetStates;
+    presetStates.reserve(settings.presets.size());
+    for (const auto &preset : settings.presets) {
+        presetStates.push_back({
+            preset.defined,
+            preset.pan,
+            preset.tilt,
+            preset.zoom
+        });
+    }
+    m_ptzWidget->applyPresetStates(presetStates);
+}
+
 void MainWindow::onPresetUpdated(int index, double pan, double tilt, double zoom, bool defined)
 {
     auto settings = m_controller->getConfig().getSettings();
@@ -1325,6 +1740,42 @@ void MainWindow::onPresetUpdated(int index, double pan, double tilt, double zoom
     m_controller->saveConfig();
 }
 
+void MainWindow::applySequencesFromConfig()
+{
+    const auto settings = m_controller->getConfig().getSettings();
+    if (m_ptzWidget) {
+        m_ptzWidget->applySequences(settings.sequences);
+    }
+
+    qDeleteAll(m_sequenceShortcuts);
+    m_sequenceShortcuts.clear();
+
+    // Application-wide so a hotkey works from the detached preview too; for
+    // desktop-wide hotkeys bind "obsbot-cli --client sequence play <name>"
+    for (const auto &sequence : settings.sequences) {
+        QKeySequence keys(QString::fromStdString(sequence.hotkey));
+        if (sequence.hotkey.empty() || keys.isEmpty()) {
+            continue;
+        }
+        auto *shortcut = new QShortcut(keys, this);
+        shortcut->setContext(Qt::ApplicationShortcut);
+        const QString name = QString::fromStdString(sequence.name);
+        connect(shortcut, &QShortcut::activated, this, [this, name]() {
+            m_controller->playSequence(name);
+        });
+        m_sequenceShortcuts.append(shortcut);
+    }
+}
+
+void MainWindow::onSequencesEdited(const std::vector<Config::CameraSettings::Sequence> &sequences)
+{
+    auto settings = m_controller->getConfig().getSettings();
+    settings.sequences = sequences;
+    m_controller->getConfig().setSettings(settings);
+    m_controller->saveConfig();
+    applySequencesFromConfig();
+}
+
 QString MainWindow::findObsbotVideoDevice()
 {
     // Find which /dev/video* device is the OBSBOT camera
@@ -1346,43 +1797,89 @@ QString MainWindow::findObsbotVideoDevice()
     return QString();
 }
 
-QString MainWindow::getProcessUsingCamera(const QString &devicePath)
+void MainWindow::findProcessUsingCamera(const QString &devicePath,
+                                        std::function<void(const QString &process)> done)
 {
-    // Use lsof to find which process has the camera device open
-    QProcess process;
-    process.start("lsof", QStringList() << devicePath);
-    process.waitForFinished(1000);
+    // The loopback node is scanned too, to show who reads the virtual camera
+    const QString virtualDevice = currentVirtualCameraDevicePath();
+    const std::vector<std::string> devices = {devicePath.toStdString(), virtualDevice.toStdString()};
+
+    m_holderScanner.request(devices, [this, devicePath, virtualDevice, done](
+                                         const std::vector<DeviceHolderScanner::Holder> &holders) {
+        QString process;
+        QStringList readers;
+        for (const auto &holder : holders) {
+            const QString device = QString::fromStdString(holder.device);
+            const QString name = QString::fromStdString(holder.name);
+            if (device == devicePath && process.isEmpty()) {
+                process = QString("%1 (PID: %2)").arg(name).arg(holder.pid);
+            } else if (device == virtualDevice && !readers.contains(name)) {
+                readers << name;
+            }
+        }
 
-    QString output = process.readAllStandardOutput();
-    QStringList lines = output.split('\n');
+        QMetaObject::invokeMethod(this, [this, done, process, readers]() {
+            if (readers != m_virtualCameraReaders) {
+                m_virtualCameraReaders = readers;
+                updateVirtualCameraAvailability(currentVirtualCameraDevicePath());
+            }
+            done(process);
+        }, Qt::QueuedConnection);
+    });
+}
 
-    // Get our own PID to filter ourselves out
-    qint64 ourPid = QCoreApplication::applicationPid();
+void MainWindow::restartUsageWatcher()
+{
+    m_usageWatcher.stop();
 
-    // lsof output format:
-    // COMMAND   PID USER   FD   TYPE DEVICE SIZE/OFF NODE NAME
-    // chrome  12345 user   42u   CHR  81,0      0t0  123 /dev/video0
+    const auto settings = m_controller->getConfig().getSettings();
+    if (settings.autoProfileRules.empty()) {
+        return;  // Nothing to switch on; keep the thread and inotify watch off
+    }
 
-    for (int i = 1; i < lines.size(); ++i) {  // Skip header line
-        QString line = lines[i].trimmed();
-        if (line.isEmpty()) continue;
+    // Applications open the OBSBOT node directly, or the loopback node when OBS feeds it
+    const QString obsbotDevice = findObsbotVideoDevice();
+    std::vector<std::string> devices;
+    if (!obsbotDevice.isEmpty()) {
+        devices.push_back(obsbotDevice.toStdString());
+    }
+    devices.push_back(settings.virtualCameraDevice);
 
-        QStringList parts = line.split(QRegularExpression("\\s+"));
-        if (parts.size() >= 2) {
-            QString command = parts[0];
-            QString pidStr = parts[1];
-            qint64 pid = pidStr.toLongLong();
+    const bool started = m_usageWatcher.start(devices, [this](const std::vector<CameraUsageWatcher::Consumer> &consumers) {
+        QStringList processes;
+        for (const auto &consumer : consumers) {
+            processes << QString::fromStdString(consumer.name);
+        }
+        QMetaObject::invokeMethod(this, [this, processes]() {
+            onCameraConsumersChanged(processes);
+        }, Qt::QueuedConnection);
+    });
+    if (!started) {
+        std::cerr << "[AutoProfile] No camera device to watch; automatic profiles are off" << std::endl;
+    }
+}
 
-            // Skip our own process - we already have the camera for control
-            if (pid == ourPid) {
-                continue;
-            }
+void MainWindow::onCameraConsumersChanged(const QStringList &processes)
+{
+    const auto settings = m_controller->getConfig().getSettings();
+    std::vector<Config::ProfileRule> rules;
+    std::string error;
+    if (!Config::parseProfileRules(settings.autoProfileRules, rules, error)) {
+        return;  // Validation already reported it
+    }
 
-            return QString("%1 (PID: %2)").arg(command).arg(pidStr);
-        }
+    std::vector<std::string> names;
+    for (const QString &process : processes) {
+        names.push_back(process.toStdString());
+    }
+    const std::string profile = Config::profileForProcesses(rules, names);
+    if (profile.empty() || profile == settings.activeProfile) {
+        return;  // No rule for these applications, or already there; keep the current settings
     }
 
-    return QString();  // Not found (or only we're using it)
+    std::cout << "[AutoProfile] " << processes.join(", ").toStdString() << " opened the camera; switching to '"
+              << profile << "'" << std::endl;
+    m_controller->applyProfile(QString::fromStdString(profile));
 }
 
 void MainWindow::setupTrayIcon()
@@ -1395,6 +1892,12 @@ void MainWindow::setupTrayIcon()
     // Create context menu
     m_trayMenu = new QMenu(this);
     QAction *showHideAction = m_trayMenu->addAction("Show/Hide");
+    m_profilesMenu = m_trayMenu->addMenu("Profiles");
+    connect(m_profilesMenu, &QMenu::aboutToShow, this, &MainWindow::rebuildProfilesMenu);
+    QAction *traceAction = m_trayMenu->addAction("Record Trace");
+    traceAction->setCheckable(true);
+    traceAction->setChecked(Trace::isEnabled());  // OBSBOT_TRACE starts recording at launch
+    connect(traceAction, &QAction::toggled, this, &MainWindow::onTraceToggled);
     m_trayMenu->addSeparator();
     QAction *quitAction = m_trayMenu->addAction("Quit");
 
@@ -1410,6 +1913,69 @@ void MainWindow::setupTrayIcon()
     m_trayIcon->show();
 }
 
+void MainWindow::rebuildProfilesMenu()
+{
+    m_profilesMenu->clear();
+
+    const Config &config = m_controller->getConfig();
+    const auto names = config.profileNames();
+    const QString active = QString::fromStdString(config.getSettings().activeProfile);
+    for (const auto &profile : names) {
+        const QString name = QString::fromStdString(profile);
+        QAction *action = m_profilesMenu->addAction(name);
+        action->setCheckable(true);
+        action->setChecked(name == active);
+        connect(action, &QAction::triggered, this, [this, name]() {
+            if (!m_controller->applyProfile(name)) {
+                QMessageBox::warning(this, "Profile", QString("Profile \"%1\" could not be applied.").arg(name));
+            }
+        });
+    }
+    if (names.empty()) {
+        m_profilesMenu->addAction("No saved profiles")->setEnabled(false);
+    }
+
+    m_profilesMenu->addSeparator();
+    connect(m_profilesMenu->addAction("Save Current Settings as Profile..."), &QAction::triggered,
+            this, &MainWindow::onSaveProfileAction);
+    if (!names.empty()) {
+        QMenu *deleteMenu = m_profilesMenu->addMenu("Delete Profile");
+        for (const auto &profile : names) {
+            const QString name = QString::fromStdString(profile);
+            connect(deleteMenu->addAction(name), &QAction::triggered, this, [this, name]() {
+                m_controller->getConfig().removeProfile(name.toStdString());
+            });
+        }
+    }
+}
+
+void MainWindow::onSaveProfileAction()
+{
+    bool ok = false;
+    const QString name = QInputDialog::getText(this, "Save Profile",
+        "Camera, video and virtual camera settings are saved under this name:",
+        QLineEdit::Normal, QString::fromStdString(m_controller->getConfig().getSettings().activeProfile), &ok).trimmed();
+    if (!ok || name.isEmpty()) {
+        return;
+    }
+    if (!Config::isValidProfileName(name.toStdString())) {
+        QMessageBox::warning(this, "Save Profile", "Use letters, digits, spaces, '-' and '_' (up to 32 characters).");
+        return;
+    }
+
+    // Fold the live camera state into the settings before taking the snapshot
+    m_controller->saveConfig();
+    auto &config = m_controller->getConfig();
+    if (!config.saveProfile(name.toStdString())) {
+        QMessageBox::warning(this, "Save Profile", QString("Profile \"%1\" could not be saved.").arg(name));
+        return;
+    }
+    auto settings = config.getSettings();
+    settings.activeProfile = name.toStdString();
+    config.setSettings(settings);
+    m_controller->saveConfig();
+}
+
 void MainWindow::onTrayIconActivated(QSystemTrayIcon::ActivationReason reason)
 {
     if (reason == QSystemTrayIcon::Trigger) {
@@ -1456,9 +2022,30 @@ void MainWindow::onQuitAction()
     if (m_controller->isConnected()) {
         m_controller->saveConfig();
     }
+    m_controller->flushConfig();
     QApplication::quit();
 }
 
+void MainWindow::onTraceToggled(bool recording)
+{
+    if (recording) {
+        Trace::start();
+        return;
+    }
+
+    Trace::stop();
+    const std::string path = Trace::outputPath();
+    std::string error;
+    if (Trace::write(path, error) < 0) {
+        std::cerr << "[Trace] " << error << std::endl;
+        m_trayIcon->showMessage("OBSBOT Control", QString::fromStdString(error), QSystemTrayIcon::Warning, 5000);
+        return;
+    }
+    m_trayIcon->showMessage("OBSBOT Control",
+                            QString("Trace saved to %1. Open it at ui.perfetto.dev.").arg(QString::fromStdString(path)),
+                            QSystemTrayIcon::Information, 5000);
+}
+
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     // Check if we should minimize to tray or quit
@@ -1500,6 +2087,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
         if (m_controller->isConnected()) {
             m_controller->saveConfig();
         }
+        m_controller->flushConfig();
         if (m_previewWidget->isPreviewEnabled()) {
             m_previewToggleButton->setChecked(false);
         }
@@ -1562,8 +2150,10 @@ void MainWindow::onVirtualCameraDeviceEdited()
     m_controller->getConfig().setSettings(settings);
     m_controller->saveConfig();
 
+    m_virtualCameraReaders.clear();  // They were reading the old device
     m_virtualCameraErrorNotified = false;
     updateVirtualCameraStreamerState();
+    restartUsageWatcher();
 }
 
 void MainWindow::onVirtualCameraResolutionChanged(int index)
@@ -1622,4 +2212,14 @@ void MainWindow::onVideoEffectsChanged(const FilterPreviewWidget::VideoEffectsSe
         return;
     }
     m_previewWidget->setVideoEffects(settings);
+
+    // Slider drags arrive per step; the config saver coalesces the writes
+    auto config = m_controller->getConfig().getSettings();
+    auto updated = config;
+    updated.effects = effectsToConfig(settings);
+    if (Config::changedKeys(config, updated).empty()) {
+        return;  // Restored from the config, or a no-op
+    }
+    m_controller->getConfig().setSettings(updated);
+    m_controller->saveConfig();
 }
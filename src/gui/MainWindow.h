@@ -10,6 +10,9 @@
 #include <QSystemTrayIcon>
 #include <QMenu>
 #include "CameraController.h"
+#include "CameraUsageWatcher.h"
+#include "DeviceHolderScanner.h"
+#include <functional>
 #include "TrackingControlWidget.h"
 #include "PTZControlWidget.h"
 #include "CameraSettingsWidget.h"
@@ -24,6 +27,7 @@ class QFrame;
 class QWidget;
 class QLineEdit;
 class QComboBox;
+class QShortcut;
 class VirtualCameraStreamer;
 
 /**
@@ -39,9 +43,16 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Launched minimized into the tray: main() must not show the window,
+    // which is built on first open
+    bool isTrayResident() const { return m_trayResident; }
+
+    void setVisible(bool visible) override;  // Builds the window on first show
+
 private slots:
     void onCameraConnected(const CameraController::CameraInfo &info);
     void onCameraDisconnected();
+    void onDeviceScanFinished(bool found);
     void onStateChanged(const CameraController::CameraState &state);
     void onCommandFailed(const QString &description, int errorCode);
     void updateStatus();
@@ -52,9 +63,11 @@ private slots:
     void onPreviewFailed(const QString &error);
     void onPreviewFormatChanged(const QString &formatId);
     void onPresetUpdated(int index, double pan, double tilt, double zoom, bool defined);
+    void onSequencesEdited(const std::vector<Config::CameraSettings::Sequence> &sequences);
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
     void onShowHideAction();
     void onQuitAction();
+    void onTraceToggled(bool recording);
     void onStartMinimizedToggled(bool checked);
     void onPreviewWindowClosed();
     void onVirtualCameraToggled(bool enabled);
@@ -62,28 +75,54 @@ private slots:
     void onVirtualCameraResolutionChanged(int index);
     void onVirtualCameraError(const QString &message);
     void onVideoEffectsChanged(const FilterPreviewWidget::VideoEffectsSettings &settings);
+    void onPreviewTargetSelected(FilterPreviewWidget::TargetGesture gesture, const QRectF &frameRect, double frameAspect);
+    void onTargetSelectionFinished(const QString &action, bool ok, double ackMs, double motionMs);
+    void onSettlingFinished(int elapsedMs, const QStringList &drift);
+    void onSettingsReplaced(const QStringList &changedKeys);
+    void rebuildProfilesMenu();
+    void onSaveProfileAction();
+    void onCameraConsumersChanged(const QStringList &processes);
+    void ensureControlTab(int index);  // Builds a control tab the first time it is shown
+    void finishStartup();  // After the first paint: builds the visible tab
 
 private:
+    enum ControlTab {
+        TrackingTab,
+        PresetsTab,
+        ImageTab,
+        EffectsTab,
+    };
+
     void setupUI();
+    void ensureUI();
     void setupTrayIcon();
     void loadConfiguration();
+    void applyConfigToWidgets();
+    void applyConfigToTab(int index, const Config::CameraSettings &settings);  // No-op until the tab is built
+    void applyPresetsFromConfig();
+    void applySequencesFromConfig();  // Sequence list and their hotkeys
     void handleConfigErrors(const std::vector<Config::ValidationError> &errors);
     CameraController::CameraState getUIState() const;  // Get current UI state
-    QString getProcessUsingCamera(const QString &devicePath);  // Detect which process is using camera
+    // Finds who has the camera open on a worker thread, then calls done on the UI thread with
+    // "name (PID: n)" or an empty string; also refreshes the virtual camera's reader list
+    void findProcessUsingCamera(const QString &devicePath, std::function<void(const QString &process)> done);
+    void startPreview(const QString &devicePath);
     QString findObsbotVideoDevice();  // Find which /dev/video* device is the OBSBOT camera
     void applyModernStyle();
     void detachPreviewToWindow();
     void attachPreviewToPanel();
     void updatePreviewControls();
     void updateStatusBanner(bool connected);
+    void showCameraInfo(const CameraController::CameraInfo &info);
     QString currentVirtualCameraDevicePath() const;
     void updateVirtualCameraAvailability(const QString &devicePath);
     void updateVirtualCameraStreamerState();
+    void restartUsageWatcher();  // Follows auto_profile_rules and the watched device nodes
 
     // Controller
     CameraController *m_controller;
 
-    // UI
+    // UI, built by ensureUI()
     QPushButton *m_previewToggleButton;
     QPushButton *m_detachPreviewButton;
     QPushButton *m_reconnectButton;
@@ -105,7 +144,7 @@ private:
     QComboBox *m_virtualCameraResolutionCombo;
     QLabel *m_virtualCameraStatusLabel;
 
-    // Control widgets
+    // Control widgets; the tab pages are null until first shown
     TrackingControlWidget *m_trackingWidget;
     PTZControlWidget *m_ptzWidget;
     CameraSettingsWidget *m_settingsWidget;
@@ -114,6 +153,10 @@ private:
     PreviewWindow *m_previewWindow;
     VirtualCameraStreamer *m_virtualCameraStreamer;
 
+    QList<QShortcut *> m_sequenceShortcuts;
+    QString m_targetLatencyText;  // Last click-to-frame timing, shown in the status line
+    QString m_settlingText;       // Outcome of the last apply on connect, shown in the status line
+
     // Status timer
     QTimer *m_statusTimer;
 
@@ -129,6 +172,18 @@ private:
     // System tray
     QSystemTrayIcon *m_trayIcon;
     QMenu *m_trayMenu;
+    QMenu *m_profilesMenu;  // Rebuilt from profiles/ each time it opens
+
+    // Switches profile by the application using the camera
+    CameraUsageWatcher m_usageWatcher;
+
+    DeviceHolderScanner m_holderScanner;  // For the in-use checks around the preview
+    int m_holderScanSerial;               // Bumped to drop the result of an outdated check
+    QStringList m_virtualCameraReaders;   // Applications reading the loopback device, as of the last scan
+
+    bool m_uiBuilt;          // Everything but the controller and the tray icon exists
+    bool m_trayResident;     // Started in the tray without building the window
+    bool m_startupFinished;  // Set once the first paint is done
 
     bool m_isApplyingStyle;
     bool m_virtualCameraErrorNotified;
@@ -2,11 +2,27 @@
 #include "CameraSettingsWidget.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <algorithm>
 
 PTZControlWidget::PTZControlWidget(CameraController *controller, QWidget *parent)
     : QWidget(parent)
     , m_controller(controller)
     , m_settingsWidget(nullptr)
+    , m_presetLayout(nullptr)
+    , m_addPresetButton(nullptr)
+    , m_sequenceCombo(nullptr)
+    , m_playSequenceButton(nullptr)
+    , m_stopSequenceButton(nullptr)
+    , m_addKeyframeButton(nullptr)
+    , m_deleteSequenceButton(nullptr)
+    , m_keyframeSecondsSpin(nullptr)
+    , m_keyframeEasingCombo(nullptr)
+    , m_sequenceStatusLabel(nullptr)
 {
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->setContentsMargins(8, 14, 8, 14);
@@ -18,41 +34,85 @@ PTZControlWidget::PTZControlWidget(CameraController *controller, QWidget *parent
     presetLayout->setContentsMargins(16, 16, 16, 16);
     presetLayout->setSpacing(8);
 
-    for (int i = 0; i < 3; ++i) {
-        PresetUi presetUi{};
-        presetUi.defined = false;
-        presetUi.pan = 0.0;
-        presetUi.tilt = 0.0;
-        presetUi.zoom = 1.0;
-
-        QHBoxLayout *row = new QHBoxLayout();
-        row->setSpacing(8);
-        QLabel *titleLabel = new QLabel(QString("Preset %1").arg(i + 1), this);
-        titleLabel->setStyleSheet("font-weight: 600; font-size: 11px;");
-        row->addWidget(titleLabel);
-
-        presetUi.statusLabel = new QLabel("Empty", this);
-        presetUi.statusLabel->setStyleSheet("color: palette(mid); font-size: 11px;");
-        row->addWidget(presetUi.statusLabel, 1);
-
-        presetUi.recallButton = new QPushButton("Recall", this);
-        presetUi.recallButton->setProperty("presetIndex", i);
-        presetUi.recallButton->setEnabled(false);
-        connect(presetUi.recallButton, &QPushButton::clicked, this, &PTZControlWidget::onRecallPreset);
-        row->addWidget(presetUi.recallButton);
-
-        presetUi.saveButton = new QPushButton("Save", this);
-        presetUi.saveButton->setProperty("presetIndex", i);
-        connect(presetUi.saveButton, &QPushButton::clicked, this, &PTZControlWidget::onStorePreset);
-        row->addWidget(presetUi.saveButton);
+    m_presetLayout = new QVBoxLayout();
+    m_presetLayout->setSpacing(8);
+    presetLayout->addLayout(m_presetLayout);
 
-        presetLayout->addLayout(row);
-        m_presets[static_cast<size_t>(i)] = presetUi;
-        updatePresetLabel(i);
+    for (int i = 0; i < Config::kDefaultPresetCount; ++i) {
+        addPresetRow();
     }
 
+    m_addPresetButton = new QPushButton("Add Preset", this);
+    connect(m_addPresetButton, &QPushButton::clicked, this, &PTZControlWidget::onAddPreset);
+    presetLayout->addWidget(m_addPresetButton, 0, Qt::AlignRight);
+
     layout->addWidget(presetGroup);
 
+    // Sequences section: keyframed moves played by the controller's sequencer
+    QGroupBox *sequenceGroup = new QGroupBox("Camera Moves", this);
+    QVBoxLayout *sequenceLayout = new QVBoxLayout(sequenceGroup);
+    sequenceLayout->setContentsMargins(16, 16, 16, 16);
+    sequenceLayout->setSpacing(8);
+
+    QHBoxLayout *playRow = new QHBoxLayout();
+    playRow->setSpacing(8);
+    m_sequenceCombo = new QComboBox(this);
+    connect(m_sequenceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, [this](int) { updateSequenceControls(); });
+    playRow->addWidget(m_sequenceCombo, 1);
+
+    m_playSequenceButton = new QPushButton("Play", this);
+    connect(m_playSequenceButton, &QPushButton::clicked, this, &PTZControlWidget::onPlaySequence);
+    playRow->addWidget(m_playSequenceButton);
+
+    m_stopSequenceButton = new QPushButton("Stop", this);
+    connect(m_stopSequenceButton, &QPushButton::clicked, m_controller, &CameraController::stopSequence);
+    playRow->addWidget(m_stopSequenceButton);
+    sequenceLayout->addLayout(playRow);
+
+    QHBoxLayout *editRow = new QHBoxLayout();
+    editRow->setSpacing(8);
+    QPushButton *newSequenceButton = new QPushButton("New…", this);
+    connect(newSequenceButton, &QPushButton::clicked, this, &PTZControlWidget::onNewSequence);
+    editRow->addWidget(newSequenceButton);
+
+    m_keyframeSecondsSpin = new QDoubleSpinBox(this);
+    m_keyframeSecondsSpin->setRange(0.1, 60.0);
+    m_keyframeSecondsSpin->setSingleStep(0.5);
+    m_keyframeSecondsSpin->setValue(3.0);
+    m_keyframeSecondsSpin->setSuffix(" s");
+    m_keyframeSecondsSpin->setToolTip("Time to move from the previous keyframe to the new one");
+    editRow->addWidget(m_keyframeSecondsSpin);
+
+    m_keyframeEasingCombo = new QComboBox(this);
+    m_keyframeEasingCombo->addItem("Ease in/out", Config::CameraSettings::EaseInOut);
+    m_keyframeEasingCombo->addItem("Ease in", Config::CameraSettings::EaseIn);
+    m_keyframeEasingCombo->addItem("Ease out", Config::CameraSettings::EaseOut);
+    m_keyframeEasingCombo->addItem("Linear", Config::CameraSettings::EaseLinear);
+    m_keyframeEasingCombo->addItem("Cut", Config::CameraSettings::EaseHold);
+    editRow->addWidget(m_keyframeEasingCombo);
+
+    m_addKeyframeButton = new QPushButton("Add Keyframe", this);
+    m_addKeyframeButton->setToolTip("Append the current pan/tilt/zoom to the selected move");
+    connect(m_addKeyframeButton, &QPushButton::clicked, this, &PTZControlWidget::onAddKeyframe);
+    editRow->addWidget(m_addKeyframeButton);
+
+    m_deleteSequenceButton = new QPushButton("Delete", this);
+    connect(m_deleteSequenceButton, &QPushButton::clicked, this, &PTZControlWidget::onDeleteSequence);
+    editRow->addWidget(m_deleteSequenceButton);
+    sequenceLayout->addLayout(editRow);
+
+    m_sequenceStatusLabel = new QLabel(this);
+    m_sequenceStatusLabel->setStyleSheet("color: palette(mid); font-size: 11px;");
+    m_sequenceStatusLabel->setWordWrap(true);
+    sequenceLayout->addWidget(m_sequenceStatusLabel);
+
+    connect(m_controller, &CameraController::sequenceStarted, this, &PTZControlWidget::onSequenceStarted);
+    connect(m_controller, &CameraController::sequenceFinished, this, &PTZControlWidget::onSequenceFinished);
+
+    layout->addWidget(sequenceGroup);
+    updateSequenceControls();
+
     // Image Quality Presets section
     QGroupBox *imagePresetGroup = new QGroupBox("Image Quality Presets", this);
     QVBoxLayout *imagePresetLayout = new QVBoxLayout(imagePresetGroup);
@@ -92,25 +152,80 @@ PTZControlWidget::PTZControlWidget(CameraController *controller, QWidget *parent
     layout->addWidget(imagePresetGroup);
     layout->addStretch();
 }
-void PTZControlWidget::applyPresetStates(const std::array<PresetState, 3> &presets)
+void PTZControlWidget::addPresetRow()
 {
-    for (int i = 0; i < 3; ++i) {
-        auto &ui = m_presets[static_cast<size_t>(i)];
-        const auto &preset = presets[static_cast<size_t>(i)];
-        ui.defined = preset.defined;
-        ui.pan = preset.pan;
-        ui.tilt = preset.tilt;
-        ui.zoom = preset.zoom;
-        updatePresetLabel(i);
+    const int i = static_cast<int>(m_presets.size());
+
+    PresetUi presetUi{};
+    presetUi.defined = false;
+    presetUi.pan = 0.0;
+    presetUi.tilt = 0.0;
+    presetUi.zoom = 1.0;
+
+    QHBoxLayout *row = new QHBoxLayout();
+    row->setSpacing(8);
+    QLabel *titleLabel = new QLabel(QString("Preset %1").arg(i + 1), this);
+    titleLabel->setStyleSheet("font-weight: 600; font-size: 11px;");
+    row->addWidget(titleLabel);
+
+    presetUi.statusLabel = new QLabel("Empty", this);
+    presetUi.statusLabel->setStyleSheet("color: palette(mid); font-size: 11px;");
+    row->addWidget(presetUi.statusLabel, 1);
+
+    presetUi.recallButton = new QPushButton("Recall", this);
+    presetUi.recallButton->setProperty("presetIndex", i);
+    presetUi.recallButton->setEnabled(false);
+    connect(presetUi.recallButton, &QPushButton::clicked, this, &PTZControlWidget::onRecallPreset);
+    row->addWidget(presetUi.recallButton);
+
+    presetUi.saveButton = new QPushButton("Save", this);
+    presetUi.saveButton->setProperty("presetIndex", i);
+    connect(presetUi.saveButton, &QPushButton::clicked, this, &PTZControlWidget::onStorePreset);
+    row->addWidget(presetUi.saveButton);
+
+    m_presetLayout->addLayout(row);
+    m_presets.push_back(presetUi);
+    updatePresetLabel(i);
+
+    if (m_addPresetButton) {
+        m_addPresetButton->setEnabled(static_cast<int>(m_presets.size()) < Config::kMaxPresets);
     }
 }
 
-std::array<PTZControlWidget::PresetState, 3> PTZControlWidget::currentPresets() const
+void PTZControlWidget::onAddPreset()
 {
-    std::array<PresetState, 3> out{};
-    for (int i = 0; i < 3; ++i) {
-        const auto &ui = m_presets[static_cast<size_t>(i)];
-        out[static_cast<size_t>(i)] = {ui.defined, ui.pan, ui.tilt, ui.zoom};
+    if (static_cast<int>(m_presets.size()) < Config::kMaxPresets) {
+        addPresetRow();
+    }
+}
+
+void PTZControlWidget::applyPresetStates(const std::vector<PresetState> &presets)
+{
+    while (m_presets.size() < presets.size() && static_cast<int>(m_presets.size()) < Config::kMaxPresets) {
+        addPresetRow();
+    }
+
+    for (size_t i = 0; i < m_presets.size(); ++i) {
+        auto &ui = m_presets[i];
+        if (i < presets.size()) {
+            const auto &preset = presets[i];
+            ui.defined = preset.defined;
+            ui.pan = preset.pan;
+            ui.tilt = preset.tilt;
+            ui.zoom = preset.zoom;
+        } else {
+            ui.defined = false;
+        }
+        updatePresetLabel(static_cast<int>(i));
+    }
+}
+
+std::vector<PTZControlWidget::PresetState> PTZControlWidget::currentPresets() const
+{
+    std::vector<PresetState> out;
+    out.reserve(m_presets.size());
+    for (const auto &ui : m_presets) {
+        out.push_back({ui.defined, ui.pan, ui.tilt, ui.zoom});
     }
     return out;
 }
@@ -131,8 +246,7 @@ void PTZControlWidget::onRecallPreset()
         return;
     }
 
-    m_controller->setPanTilt(preset.pan, preset.tilt);
-    m_controller->setZoom(preset.zoom);
+    m_controller->recallPreset(index);
 }
 
 void PTZControlWidget::onStorePreset()
@@ -146,12 +260,19 @@ void PTZControlWidget::onStorePreset()
         return;
     }
 
-    auto state = m_controller->getCurrentState();
+    // Controller records the slot in config and mirrors it to the gimbal
+    m_controller->storePreset(index);
+    const auto settings = m_controller->getConfig().getSettings();
+    if (index >= static_cast<int>(settings.presets.size())) {
+        return;
+    }
+
+    const auto &slot = settings.presets[static_cast<size_t>(index)];
     auto &preset = m_presets[static_cast<size_t>(index)];
-    preset.defined = true;
-    preset.pan = state.pan;
-    preset.tilt = state.tilt;
-    preset.zoom = state.zoom;
+    preset.defined = slot.defined;
+    preset.pan = slot.pan;
+    preset.tilt = slot.tilt;
+    preset.zoom = slot.zoom;
     updatePresetLabel(index);
 
     emit presetUpdated(index, preset.pan, preset.tilt, preset.zoom, true);
@@ -289,3 +410,135 @@ std::array<PTZControlWidget::ImagePresetState, 3> PTZControlWidget::currentImage
     }
     return out;
 }
+
+void PTZControlWidget::applySequences(const std::vector<Config::CameraSettings::Sequence> &sequences)
+{
+    const QString selected = m_sequenceCombo->currentData().toString();
+    m_sequences = sequences;
+
+    m_sequenceCombo->blockSignals(true);
+    m_sequenceCombo->clear();
+    for (const auto &sequence : m_sequences) {
+        QString label = QString::fromStdString(sequence.name);
+        if (!sequence.hotkey.empty()) {
+            label += QString("  (%1)").arg(QString::fromStdString(sequence.hotkey));
+        }
+        m_sequenceCombo->addItem(label, QString::fromStdString(sequence.name));
+    }
+    int index = m_sequenceCombo->findData(selected);
+    m_sequenceCombo->setCurrentIndex(index >= 0 ? index : 0);
+    m_sequenceCombo->blockSignals(false);
+
+    updateSequenceControls();
+}
+
+void PTZControlWidget::updateSequenceControls()
+{
+    const int index = m_sequenceCombo->currentIndex();
+    const bool haveSequence = index >= 0 && index < static_cast<int>(m_sequences.size());
+    const bool running = m_controller->isSequenceRunning();
+
+    m_playSequenceButton->setEnabled(haveSequence && !m_sequences[static_cast<size_t>(index)].keyframes.empty());
+    m_stopSequenceButton->setEnabled(running);
+    m_addKeyframeButton->setEnabled(haveSequence && !running);
+    m_deleteSequenceButton->setEnabled(haveSequence && !running);
+
+    if (running) {
+        return;  // Keep the "Playing" message
+    }
+    if (!haveSequence) {
+        m_sequenceStatusLabel->setText("Create a move, then add a keyframe at each position.");
+        return;
+    }
+    const auto &keyframes = m_sequences[static_cast<size_t>(index)].keyframes;
+    m_sequenceStatusLabel->setText(keyframes.empty()
+        ? QString("No keyframes yet")
+        : QString("%1 keyframes, %2 s").arg(keyframes.size()).arg(keyframes.back().timeMs / 1000.0, 0, 'f', 1));
+}
+
+void PTZControlWidget::onPlaySequence()
+{
+    const int index = m_sequenceCombo->currentIndex();
+    if (index < 0 || index >= static_cast<int>(m_sequences.size())) {
+        return;
+    }
+    m_controller->playSequence(QString::fromStdString(m_sequences[static_cast<size_t>(index)].name));
+}
+
+void PTZControlWidget::onNewSequence()
+{
+    bool ok = false;
+    const QString name = QInputDialog::getText(this, "New Camera Move",
+                                               "Name (letters, digits and '-'):", QLineEdit::Normal,
+                                               QString("move-%1").arg(m_sequences.size() + 1), &ok).trimmed();
+    if (!ok || name.isEmpty()) {
+        return;
+    }
+    const std::string key = name.toStdString();
+    if (!Config::isValidSequenceName(key)) {
+        QMessageBox::warning(this, "New Camera Move", "Use only letters, digits and '-' (up to 32).");
+        return;
+    }
+    auto existing = std::find_if(m_sequences.begin(), m_sequences.end(),
+                                 [&key](const auto &sequence) { return sequence.name == key; });
+    if (existing != m_sequences.end()) {
+        QMessageBox::warning(this, "New Camera Move", QString("A move named '%1' already exists.").arg(name));
+        return;
+    }
+
+    m_sequences.push_back({key, std::string(), {}});
+    applySequences(m_sequences);
+    m_sequenceCombo->setCurrentIndex(m_sequenceCombo->findData(name));
+    emit sequencesEdited(m_sequences);
+}
+
+void PTZControlWidget::onAddKeyframe()
+{
+    const int index = m_sequenceCombo->currentIndex();
+    if (index < 0 || index >= static_cast<int>(m_sequences.size())) {
+        return;
+    }
+    auto &keyframes = m_sequences[static_cast<size_t>(index)].keyframes;
+    if (static_cast<int>(keyframes.size()) >= Config::kMaxKeyframes) {
+        return;
+    }
+
+    const auto state = m_controller->getCurrentState();
+    Config::CameraSettings::Keyframe keyframe{};
+    keyframe.timeMs = keyframes.empty()
+        ? 0 : keyframes.back().timeMs + static_cast<int>(m_keyframeSecondsSpin->value() * 1000.0);
+    keyframe.pan = state.pan;
+    keyframe.tilt = state.tilt;
+    keyframe.zoom = std::clamp(state.zoom, 1.0, 2.0);
+    keyframe.easing = static_cast<Config::CameraSettings::Easing>(m_keyframeEasingCombo->currentData().toInt());
+    keyframes.push_back(keyframe);
+
+    updateSequenceControls();
+    emit sequencesEdited(m_sequences);
+}
+
+void PTZControlWidget::onDeleteSequence()
+{
+    const int index = m_sequenceCombo->currentIndex();
+    if (index < 0 || index >= static_cast<int>(m_sequences.size())) {
+        return;
+    }
+    m_sequences.erase(m_sequences.begin() + index);
+    applySequences(m_sequences);
+    emit sequencesEdited(m_sequences);
+}
+
+void PTZControlWidget::onSequenceStarted(const QString &name)
+{
+    m_sequenceStatusLabel->setText(QString("Playing %1…").arg(name));
+    updateSequenceControls();
+}
+
+void PTZControlWidget::onSequenceFinished(const QString &name, bool completed, const QString &error)
+{
+    updateSequenceControls();
+    if (!completed) {
+        m_sequenceStatusLabel->setText(error.isEmpty() ? QString("%1 stopped").arg(name)
+                                                       : QString("%1 failed: %2").arg(name, error));
+    }
+}
@@ -7,9 +7,13 @@
 #include <QLabel>
 #include <QGroupBox>
 #include <array>
+#include <vector>
 #include "CameraController.h"
 
 class CameraSettingsWidget;
+class QVBoxLayout;
+class QComboBox;
+class QDoubleSpinBox;
 
 /**
  * @brief Widget for camera preset management
@@ -32,8 +36,8 @@ public:
         double tilt;
         double zoom;
     };
-    void applyPresetStates(const std::array<PresetState, 3> &presets);
-    std::array<PresetState, 3> currentPresets() const;
+    void applyPresetStates(const std::vector<PresetState> &presets);
+    std::vector<PresetState> currentPresets() const;
 
     struct ImagePresetState {
         bool defined;
@@ -53,15 +57,25 @@ public:
     void applyImagePresetStates(const std::array<ImagePresetState, 3> &presets);
     std::array<ImagePresetState, 3> currentImagePresets() const;
 
+    void applySequences(const std::vector<Config::CameraSettings::Sequence> &sequences);
+
 signals:
     void presetUpdated(int index, double pan, double tilt, double zoom, bool defined);
     void imagePresetUpdated(int index);
+    void sequencesEdited(const std::vector<Config::CameraSettings::Sequence> &sequences);
 
 private slots:
     void onRecallPreset();
     void onStorePreset();
+    void onAddPreset();
     void onRecallImagePreset();
     void onStoreImagePreset();
+    void onPlaySequence();
+    void onNewSequence();
+    void onAddKeyframe();
+    void onDeleteSequence();
+    void onSequenceStarted(const QString &name);
+    void onSequenceFinished(const QString &name, bool completed, const QString &error);
 
 private:
     CameraController *m_controller;
@@ -84,9 +98,23 @@ private:
         ImagePresetState state;
     };
 
-    std::array<PresetUi, 3> m_presets;
+    QVBoxLayout *m_presetLayout;
+    QPushButton *m_addPresetButton;
+    std::vector<PresetUi> m_presets;
     std::array<ImagePresetUi, 3> m_imagePresets;
 
+    std::vector<Config::CameraSettings::Sequence> m_sequences;
+    QComboBox *m_sequenceCombo;
+    QPushButton *m_playSequenceButton;
+    QPushButton *m_stopSequenceButton;
+    QPushButton *m_addKeyframeButton;
+    QPushButton *m_deleteSequenceButton;
+    QDoubleSpinBox *m_keyframeSecondsSpin;
+    QComboBox *m_keyframeEasingCombo;
+    QLabel *m_sequenceStatusLabel;
+
+    void addPresetRow();
+    void updateSequenceControls();
     void updatePresetLabel(int index);
     void updateImagePresetLabel(int index);
 };
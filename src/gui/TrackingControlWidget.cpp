@@ -1,5 +1,8 @@
 #include "TrackingControlWidget.h"
 #include <QLabel>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
 #include <dev/dev.hpp>
 
 TrackingControlWidget::TrackingControlWidget(CameraController *controller, QWidget *parent)
@@ -93,6 +96,27 @@ TrackingControlWidget::TrackingControlWidget(CameraController *controller, QWidg
     connect(m_audioGainCheckBox, &QCheckBox::toggled, this, &TrackingControlWidget::onAudioGainToggled);
     advancedLayout->addWidget(m_audioGainCheckBox);
 
+    // Gimbal telemetry, for tuning tracking speed against the actual motion
+    QHBoxLayout *telemetryLayout = new QHBoxLayout();
+    m_telemetryCheckBox = new QCheckBox("Record Gimbal Telemetry", this);
+    m_telemetryCheckBox->setStyleSheet("font-size: 11px;");
+    m_telemetryCheckBox->setToolTip("Log gimbal attitude and camera commands; convert with obsbot-telemetry-csv");
+    connect(m_telemetryCheckBox, &QCheckBox::toggled, this, &TrackingControlWidget::onTelemetryToggled);
+    m_telemetryRateSpin = new QSpinBox(this);
+    m_telemetryRateSpin->setRange(1, GimbalTelemetry::kMaxRateHz);
+    m_telemetryRateSpin->setValue(GimbalTelemetry::kDefaultRateHz);
+    m_telemetryRateSpin->setSuffix(" Hz");
+    telemetryLayout->addWidget(m_telemetryCheckBox, 1);
+    telemetryLayout->addWidget(m_telemetryRateSpin);
+    advancedLayout->addLayout(telemetryLayout);
+
+    m_telemetryLabel = new QLabel(this);
+    m_telemetryLabel->setStyleSheet("font-size: 10px; color: gray;");
+    m_telemetryLabel->setWordWrap(true);
+    m_telemetryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_telemetryLabel->hide();
+    advancedLayout->addWidget(m_telemetryLabel);
+
     groupLayout->addWidget(m_advancedContainer);
     updateTiny2Visibility();
 
@@ -313,6 +337,13 @@ void TrackingControlWidget::updateFromState(const CameraController::CameraState
         }
     }
 
+    // Recording stops by itself when the camera goes away
+    if (m_telemetryCheckBox->isChecked() && !m_controller->isTelemetryRecording()) {
+        QSignalBlocker blocker(m_telemetryCheckBox);
+        m_telemetryCheckBox->setChecked(false);
+        m_telemetryRateSpin->setEnabled(true);
+    }
+
     // If command completed and timer expired, we can now accept state updates
     if (!commandInFlight && m_userInitiated) {
         m_userInitiated = false;
@@ -384,6 +415,31 @@ void TrackingControlWidget::onAudioGainToggled(bool checked)
     m_commandTimer->start(1000);
 }
 
+void TrackingControlWidget::onTelemetryToggled(bool checked)
+{
+    if (!checked) {
+        m_controller->stopTelemetry();
+        m_telemetryRateSpin->setEnabled(true);
+        return;
+    }
+
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/obsbot-control/telemetry";
+    QDir().mkpath(dir);
+    QString path = dir + QDateTime::currentDateTime().toString("'/gimbal-'yyyyMMdd-HHmmss'.obtl'");
+
+    if (!m_controller->startTelemetry(path, m_telemetryRateSpin->value())) {
+        QSignalBlocker blocker(m_telemetryCheckBox);
+        m_telemetryCheckBox->setChecked(false);
+        m_telemetryLabel->setText("Could not start recording (is the camera connected?)");
+        m_telemetryLabel->show();
+        return;
+    }
+
+    m_telemetryRateSpin->setEnabled(false);
+    m_telemetryLabel->setText(QString("Recording to %1").arg(QDir::toNativeSeparators(path)));
+    m_telemetryLabel->show();
+}
+
 void TrackingControlWidget::updateTiny2Visibility()
 {
     if (!m_advancedContainer) {
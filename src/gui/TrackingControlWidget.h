@@ -6,6 +6,7 @@
 #include <QComboBox>
 #include <QPushButton>
 #include <QSlider>
+#include <QSpinBox>
 #include <QLabel>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -50,6 +51,7 @@ private slots:
     void onAutoZoomToggled(bool checked);
     void onSpeedChanged(int index);
     void onAudioGainToggled(bool checked);
+    void onTelemetryToggled(bool checked);
 
     // Manual PTZ control slots
     void onPanLeftClicked();
@@ -67,6 +69,9 @@ private:
     QCheckBox *m_autoZoomCheckBox;
     QComboBox *m_speedCombo;
     QCheckBox *m_audioGainCheckBox;
+    QCheckBox *m_telemetryCheckBox;
+    QSpinBox *m_telemetryRateSpin;
+    QLabel *m_telemetryLabel;
     QWidget *m_advancedContainer;
     bool m_userInitiated;  // Track if change was user-initiated
     QTimer *m_commandTimer;  // Debounce timer for command completion
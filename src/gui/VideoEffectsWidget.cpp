@@ -163,6 +163,10 @@ VideoEffectsWidget::VideoEffectsWidget(QWidget *parent)
     QGroupBox *effectsGroup = new QGroupBox(tr("Creative Effects"));
     QVBoxLayout *effectsLayout = new QVBoxLayout(effectsGroup);
     effectsLayout->setSpacing(6);
+    addSlider(effectsLayout, tr("Denoise"), 0.0f, 1.0f, m_settings.denoise, [this](float v) {
+        m_settings.denoise = v;
+        emitSettingsChanged();
+    });
     addSlider(effectsLayout, tr("Noise"), 0.0f, 0.4f, m_settings.noise, [this](float v) {
         m_settings.noise = v;
         emitSettingsChanged();
@@ -189,6 +193,46 @@ VideoEffectsWidget::VideoEffectsWidget(QWidget *parent)
     });
     rootLayout->addWidget(effectsGroup);
 
+    // Digital PTZ
+    QGroupBox *digitalGroup = new QGroupBox(tr("Digital PTZ"));
+    QVBoxLayout *digitalLayout = new QVBoxLayout(digitalGroup);
+    digitalLayout->setSpacing(6);
+    QLabel *digitalHint = new QLabel(tr("Crops into the picture on top of the camera's zoom, and moves smoothly. A 4K camera feeding a 1080p virtual camera stays sharp up to 2x."), digitalGroup);
+    digitalHint->setWordWrap(true);
+    digitalHint->setStyleSheet("color: palette(mid); font-size: 11px;");
+    digitalLayout->addWidget(digitalHint);
+    addSlider(digitalLayout, tr("Digital Zoom"), 1.0f, 4.0f, m_settings.digitalZoom, [this](float v) {
+        m_settings.digitalZoom = v;
+        emitSettingsChanged();
+    });
+    addSlider(digitalLayout, tr("Digital Pan"), -1.0f, 1.0f, m_settings.digitalPan, [this](float v) {
+        m_settings.digitalPan = v;
+        emitSettingsChanged();
+    });
+    addSlider(digitalLayout, tr("Digital Tilt"), -1.0f, 1.0f, m_settings.digitalTilt, [this](float v) {
+        m_settings.digitalTilt = v;
+        emitSettingsChanged();
+    });
+    rootLayout->addWidget(digitalGroup);
+
+    // Stabilization
+    QGroupBox *stabilizationGroup = new QGroupBox(tr("Stabilization"));
+    QVBoxLayout *stabilizationLayout = new QVBoxLayout(stabilizationGroup);
+    stabilizationLayout->setSpacing(6);
+    QLabel *stabilizationHint = new QLabel(tr("Takes out shake by cropping up to 8% off each side. Look-ahead smooths better but delays the picture by that many frames."), stabilizationGroup);
+    stabilizationHint->setWordWrap(true);
+    stabilizationHint->setStyleSheet("color: palette(mid); font-size: 11px;");
+    stabilizationLayout->addWidget(stabilizationHint);
+    addSlider(stabilizationLayout, tr("Stabilize"), 0.0f, 1.0f, m_settings.stabilization, [this](float v) {
+        m_settings.stabilization = v;
+        emitSettingsChanged();
+    });
+    addSlider(stabilizationLayout, tr("Look-ahead"), 0.0f, 8.0f, static_cast<float>(m_settings.stabilizationLookahead), [this](float v) {
+        m_settings.stabilizationLookahead = qRound(v);
+        emitSettingsChanged();
+    });
+    rootLayout->addWidget(stabilizationGroup);
+
     // Orientation
     QGroupBox *orientationGroup = new QGroupBox(tr("Orientation"));
     QVBoxLayout *orientationLayout = new QVBoxLayout(orientationGroup);
@@ -245,12 +289,20 @@ void VideoEffectsWidget::applySettings(const FilterPreviewWidget::VideoEffectsSe
             syncSlider(group, tr("Tint"), -0.2f, 0.2f, m_settings.tint);
             syncSlider(group, tr("Duo Tone Mix"), 0.0f, 1.0f, m_settings.duoToneIntensity);
         } else if (group->title() == tr("Creative Effects")) {
+            syncSlider(group, tr("Denoise"), 0.0f, 1.0f, m_settings.denoise);
             syncSlider(group, tr("Noise"), 0.0f, 0.4f, m_settings.noise);
             syncSlider(group, tr("Blur"), 0.0f, 1.0f, m_settings.blur);
             syncSlider(group, tr("Sharpen"), 0.0f, 1.0f, m_settings.sharpen);
             syncSlider(group, tr("Glow"), 0.0f, 1.0f, m_settings.glow);
             syncSlider(group, tr("Bloom"), 0.0f, 1.0f, m_settings.bloom);
             syncSlider(group, tr("Soft Focus"), 0.0f, 1.0f, m_settings.softFocus);
+        } else if (group->title() == tr("Digital PTZ")) {
+            syncSlider(group, tr("Digital Zoom"), 1.0f, 4.0f, m_settings.digitalZoom);
+            syncSlider(group, tr("Digital Pan"), -1.0f, 1.0f, m_settings.digitalPan);
+            syncSlider(group, tr("Digital Tilt"), -1.0f, 1.0f, m_settings.digitalTilt);
+        } else if (group->title() == tr("Stabilization")) {
+            syncSlider(group, tr("Stabilize"), 0.0f, 1.0f, m_settings.stabilization);
+            syncSlider(group, tr("Look-ahead"), 0.0f, 8.0f, static_cast<float>(m_settings.stabilizationLookahead));
         }
     }
 
@@ -1,6 +1,8 @@
 #include "VirtualCameraStreamer.h"
+#include "Trace.h"
 
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QImage>
 #include <QLoggingCategory>
 #include <QMetaObject>
@@ -9,6 +11,7 @@
 #include <QThread>
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstdint>
 #include <cstring>
@@ -116,6 +119,10 @@ public:
         , m_frameWidth(0)
         , m_frameHeight(0)
         , m_processing(false)
+        , m_framesWritten(0)
+        , m_framesDropped(0)
+        , m_queued(0)
+        , m_frameMs(0.0)
     {
     }
 
@@ -178,9 +185,11 @@ public slots:
 
         if (m_frameQueue.size() >= 3) {
             m_frameQueue.dequeue(); // Drop oldest frame to avoid backlog
+            ++m_framesDropped;
         }
 
         m_frameQueue.enqueue(frame);
+        m_queued = m_frameQueue.size();
 
         if (!m_processing) {
             m_processing = true;
@@ -195,6 +204,16 @@ public slots:
         closeDevice();
     }
 
+    VirtualCameraStreamer::Stats stats() const
+    {
+        VirtualCameraStreamer::Stats stats;
+        stats.framesWritten = m_framesWritten.load(std::memory_order_relaxed);
+        stats.framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+        stats.queued = m_queued.load(std::memory_order_relaxed);
+        stats.frameMs = m_frameMs.load(std::memory_order_relaxed);
+        return stats;
+    }
+
 signals:
     void errorOccurred(const QString &message);
     void streamingStateChanged(bool enabled);
@@ -213,12 +232,20 @@ private:
             return;
         }
 
+        QElapsedTimer timer;
+        timer.start();
         QImage image = prepareFrame(m_frameQueue.dequeue());
+        m_queued = m_frameQueue.size();
         if (!image.isNull()) {
             const int width = image.width();
             const int height = image.height();
             if (ensureDevice(width, height)) {
-                if (!writeFrame(image)) {
+                if (writeFrame(image)) {
+                    ++m_framesWritten;
+                    const double ms = timer.nsecsElapsed() / 1e6;
+                    const double average = m_frameMs.load(std::memory_order_relaxed);
+                    m_frameMs.store(average == 0.0 ? ms : average + (ms - average) * 0.1, std::memory_order_relaxed);
+                } else {
                     closeDevice();
                 }
             }
@@ -233,6 +260,7 @@ private:
 
     QImage prepareFrame(const QImage &frame) const
     {
+        Trace::Scope trace("vcam.prepare");
         if (frame.isNull()) {
             return QImage();
         }
@@ -342,14 +370,14 @@ private:
         }
 
         QByteArray buffer;
-        if (!convertRgbToYuyv(image, buffer)) {
+        if (!Trace::call("vcam.convert", [&]() { return convertRgbToYuyv(image, buffer); })) {
             emit errorOccurred(tr("Failed to convert frame for virtual camera output"));
             qCWarning(VirtualCameraLog) << "Frame conversion to YUYV failed";
             return false;
         }
 
         const ssize_t frameSize = buffer.size();
-        const ssize_t written = ::write(m_fd, buffer.constData(), frameSize);
+        const ssize_t written = Trace::call("vcam.write", [&]() { return ::write(m_fd, buffer.constData(), frameSize); });
         if (written != frameSize) {
             emit errorOccurred(tr("Failed to write frame to virtual camera: %1")
                 .arg(errnoString()));
@@ -374,6 +402,7 @@ private:
     void clearQueue()
     {
         m_frameQueue.clear();
+        m_queued = 0;
         m_processing = false;
     }
 
@@ -386,6 +415,12 @@ private:
     QSize m_forcedResolution;
     QQueue<QImage> m_frameQueue;
     bool m_processing;
+
+    // Written on the worker thread, read from the GUI thread by stats()
+    std::atomic<quint64> m_framesWritten;
+    std::atomic<quint64> m_framesDropped;
+    std::atomic<int> m_queued;
+    std::atomic<double> m_frameMs;
 };
 
 VirtualCameraStreamer::VirtualCameraStreamer(QObject *parent)
@@ -465,6 +500,14 @@ void VirtualCameraStreamer::setForcedResolution(const QSize &resolution)
         Qt::QueuedConnection);
 }
 
+VirtualCameraStreamer::Stats VirtualCameraStreamer::stats() const
+{
+    if (!m_workerInitialized || !m_worker) {
+        return Stats();
+    }
+    return m_worker->stats();
+}
+
 void VirtualCameraStreamer::onProcessedFrameReady(const QImage &frame)
 {
     if (!m_enabled || frame.isNull()) {
@@ -482,6 +525,7 @@ void VirtualCameraStreamer::ensureWorker()
     }
 
     m_workerThread = new QThread(this);
+    m_workerThread->setObjectName(QStringLiteral("VirtualCamera"));  // Thread name in top and traces
     m_worker = new VirtualCameraStreamerWorker();
     m_worker->moveToThread(m_workerThread);
     connect(m_worker, &VirtualCameraStreamerWorker::errorOccurred,
@@ -22,6 +22,14 @@ class VirtualCameraStreamer : public QObject
     Q_OBJECT
 
 public:
+    // Read by the preview's performance overlay; safe from the GUI thread
+    struct Stats {
+        quint64 framesWritten = 0;
+        quint64 framesDropped = 0;  // Oldest frames dropped from a full queue
+        int queued = 0;
+        double frameMs = 0.0;       // Moving average of scaling, conversion and write
+    };
+
     explicit VirtualCameraStreamer(QObject *parent = nullptr);
     ~VirtualCameraStreamer() override;
 
@@ -32,6 +40,7 @@ public:
     void setEnabled(bool enabled);
     void setForcedResolution(const QSize &resolution);
     QSize forcedResolution() const { return m_forcedResolution; }
+    Stats stats() const;
 
 public slots:
     void onProcessedFrameReady(const QImage &frame);
@@ -1,12 +1,74 @@
 #include <QApplication>
+#include <cstdlib>
+#include <iostream>
 #include "MainWindow.h"
+#include "StartupTimer.h"
+#include "Trace.h"
+
+namespace {
+
+// Events that get a slice on the trace; the rest would only add noise
+const char *traceName(QEvent::Type type)
+{
+    switch (type) {
+    case QEvent::MouseButtonPress: return "ui.mousePress";
+    case QEvent::MouseButtonRelease: return "ui.mouseRelease";
+    case QEvent::MouseMove: return "ui.mouseMove";
+    case QEvent::Wheel: return "ui.wheel";
+    case QEvent::KeyPress: return "ui.keyPress";
+    case QEvent::KeyRelease: return "ui.keyRelease";
+    case QEvent::Paint: return "ui.paint";
+    case QEvent::UpdateRequest: return "ui.updateRequest";
+    case QEvent::Timer: return "ui.timer";
+    case QEvent::MetaCall: return "ui.queuedCall";  // Worker results, queued signals
+    default: return nullptr;
+    }
+}
+
+// Wraps every event dispatch, on any thread, so a stall shows which handler it was in
+class TracingApplication : public QApplication
+{
+public:
+    using QApplication::QApplication;
+
+    bool notify(QObject *receiver, QEvent *event) override
+    {
+        const char *name = Trace::isEnabled() ? traceName(event->type()) : nullptr;
+        if (!name) {
+            return QApplication::notify(receiver, event);
+        }
+        Trace::Scope trace(name, receiver->metaObject()->className());
+        return QApplication::notify(receiver, event);
+    }
+};
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
-    QApplication app(argc, argv);
+    Trace::setThreadName("GUI");
+    if (std::getenv("OBSBOT_TRACE")) {
+        Trace::start();
+    }
+
+    TracingApplication app(argc, argv);
+    StartupTimer::mark("Qt initialized");
 
     MainWindow window;
-    window.show();
+    if (!window.isTrayResident()) {
+        window.show();
+        StartupTimer::mark("window shown");
+    }
+
+    const int result = app.exec();
 
-    return app.exec();
+    // Still recording: started by OBSBOT_TRACE, or from the tray and never stopped
+    if (Trace::isEnabled()) {
+        Trace::stop();
+        std::string error;
+        if (Trace::write(Trace::outputPath(), error) < 0) {
+            std::cerr << "[Trace] " << error << std::endl;
+        }
+    }
+    return result;
 }
@@ -0,0 +1,798 @@
+#include "SimulatedSdk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// ---------------------------------------------------------------------------
+// DevicePrivate
+
+DevicePrivate::DevicePrivate(const DeviceId &deviceId)
+    : id(deviceId)
+{
+    std::memset(&status, 0, sizeof(status));
+    status.tiny.dev_status = Device::DevStatusRun;
+    status.tiny.fov = Device::FovType86;
+    status.tiny.auto_focus = 1;
+    status.tiny.ai_mode = Device::AiWorkModeNone;
+    status.tiny.fps = 30;
+
+    // Same 0-255 image ranges the app falls back to without a device
+    brightnessRange.min_ = 0;
+    brightnessRange.max_ = 255;
+    brightnessRange.step_ = 1;
+    brightnessRange.default_ = 128;
+    brightnessRange.valid_ = true;
+
+    contrastRange = brightnessRange;
+    saturationRange = brightnessRange;
+
+    whiteBalanceRange.min_ = 2000;
+    whiteBalanceRange.max_ = 10000;
+    whiteBalanceRange.step_ = 100;
+    whiteBalanceRange.default_ = 5000;
+    whiteBalanceRange.valid_ = true;
+
+    zoomRange.min_ = 100;
+    zoomRange.max_ = 200;
+    zoomRange.step_ = 1;
+    zoomRange.default_ = 100;
+    zoomRange.valid_ = true;
+
+    whiteBalanceList = {
+        Device::DevWhiteBalanceAuto,
+        Device::DevWhiteBalanceDaylight,
+        Device::DevWhiteBalanceFluorescent,
+        Device::DevWhiteBalanceTungsten,
+        Device::DevWhiteBalanceCloudy,
+        Device::DevWhiteBalanceManual,
+    };
+}
+
+int32_t DevicePrivate::command(const char *name, std::function<void(DevicePrivate &)> apply)
+{
+    const SimConfig &config = SimConfig::get();
+    auto start = std::chrono::steady_clock::now();
+
+    bool failed;
+    {
+        std::lock_guard<std::mutex> pipe(m_pipeMutex);
+        std::this_thread::sleep_for(config.sampleLatency());
+        failed = !attached || config.shouldFail(name);
+    }
+
+    if (!failed && apply) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (config.statusLagMs > 0) {
+            m_pending.push_back({std::chrono::steady_clock::now() + std::chrono::milliseconds(config.statusLagMs),
+                                 std::move(apply)});
+        } else {
+            apply(*this);
+        }
+    }
+
+    if (config.verbose) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cerr << "[Sim] " << id.sn << " " << name << (failed ? " FAILED" : " ok")
+                  << " (" << elapsed << "ms)" << std::endl;
+    }
+
+    return failed ? RM_RET_ERR : RM_RET_OK;
+}
+
+int32_t DevicePrivate::reject(const char *name)
+{
+    if (SimConfig::get().verbose) {
+        std::cerr << "[Sim] " << id.sn << " " << name << " rejected: invalid argument" << std::endl;
+    }
+    return RM_RET_ERR;
+}
+
+int32_t DevicePrivate::unsupported(const char *name)
+{
+    if (SimConfig::get().verbose) {
+        std::cerr << "[Sim] " << id.sn << " " << name << " not supported by this model" << std::endl;
+    }
+    return RM_RET_ERR;
+}
+
+void DevicePrivate::read(const std::function<void(DevicePrivate &)> &reader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    advanceMotion();
+    flushPending();
+    reader(*this);
+}
+
+void DevicePrivate::flushPending()
+{
+    auto now = std::chrono::steady_clock::now();
+    while (!m_pending.empty() && m_pending.front().due <= now) {
+        m_pending.front().apply(*this);
+        m_pending.pop_front();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Device: identity
+
+Device::Device(DeviceId *id)
+    : d_ptr(new DevicePrivate(*id))
+{
+}
+
+Device::~Device()
+{
+    delete d_ptr;
+}
+
+const std::string &Device::devName()
+{
+    R_D(Device);
+    return d->id.name;
+}
+
+std::string Device::devVersion()
+{
+    R_D(Device);
+    return d->id.version;
+}
+
+std::string Device::devSn()
+{
+    R_D(Device);
+    return d->id.sn;
+}
+
+Device::DevUuid Device::uuid()
+{
+    R_D(Device);
+    DevUuid uuid{};
+    std::copy_n(d->id.sn.begin(), std::min(d->id.sn.size(), uuid.size()), uuid.begin());
+    return uuid;
+}
+
+ObsbotProductType Device::productType()
+{
+    R_D(Device);
+    return d->id.product;
+}
+
+Device::CameraStatus Device::cameraStatus()
+{
+    // The real SDK serves this from a periodically pushed cache, so no latency
+    R_D(Device);
+    CameraStatus status;
+    d->read([&status](DevicePrivate &m) { status = m.status; });
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Device: AI / tracking
+
+int32_t Device::cameraSetAiModeU(AiWorkModeType mode, int32_t sub_mode_or_from)
+{
+    R_D(Device);
+    return d->command("cameraSetAiModeU", [mode, sub_mode_or_from](DevicePrivate &m) {
+        m.status.tiny.ai_mode = static_cast<uint8_t>(mode);
+        m.status.tiny.ai_sub_mode = mode == AiWorkModeHuman ? static_cast<uint8_t>(sub_mode_or_from) : 0;
+    });
+}
+
+int32_t Device::aiSetAiAutoZoomR(bool enabled)
+{
+    R_D(Device);
+    // Auto zoom is not reflected in CameraStatus on real hardware either
+    (void)enabled;
+    return d->command("aiSetAiAutoZoomR");
+}
+
+int32_t Device::aiSetTrackSpeedTypeR(AiTrackSpeedType speed_type)
+{
+    R_D(Device);
+    return d->command("aiSetTrackSpeedTypeR", [speed_type](DevicePrivate &m) {
+        m.status.tiny.ai_tracker_speed = static_cast<uint8_t>(speed_type);
+    });
+}
+
+int32_t Device::cameraSetAudioAutoGainU(bool enabled)
+{
+    R_D(Device);
+    return d->command("cameraSetAudioAutoGainU", [enabled](DevicePrivate &m) {
+        m.status.tiny.audio_auto_gain = enabled ? 1 : 0;
+    });
+}
+
+int32_t Device::cameraSetMediaModeU(MediaMode mode)
+{
+    R_D(Device);
+    // Meet-style auto framing maps onto the tiny AI mode the app reads back
+    return d->command("cameraSetMediaModeU", [mode](DevicePrivate &m) {
+        if (m.id.product == ObsbotProdMeet || m.id.product == ObsbotProdMeet4k) {
+            m.status.meet.media_mode = static_cast<uint8_t>(mode);
+            return;
+        }
+        if (mode == MediaModeAutoFrame && m.status.tiny.ai_mode == AiWorkModeNone) {
+            m.status.tiny.ai_mode = AiWorkModeHuman;
+        } else if (mode == MediaModeNormal) {
+            m.status.tiny.ai_mode = AiWorkModeNone;
+            m.status.tiny.ai_sub_mode = 0;
+        }
+    });
+}
+
+int32_t Device::cameraSetAutoFramingModeU(AutoFramingType group_single, AutoFramingType close_upper)
+{
+    R_D(Device);
+    return d->command("cameraSetAutoFramingModeU", [group_single, close_upper](DevicePrivate &m) {
+        if (m.id.product == ObsbotProdMeet || m.id.product == ObsbotProdMeet4k) {
+            m.status.meet.group_single = static_cast<uint8_t>(group_single);
+            m.status.meet.close_upper = static_cast<uint8_t>(close_upper);
+            return;
+        }
+        if (group_single == AutoFrmGroup) {
+            m.status.tiny.ai_mode = AiWorkModeGroup;
+            m.status.tiny.ai_sub_mode = 0;
+        } else {
+            m.status.tiny.ai_mode = AiWorkModeHuman;
+            m.status.tiny.ai_sub_mode = close_upper == AutoFrmCloseUp ? AiSubModeCloseUp : AiSubModeUpperBody;
+        }
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Device: PTZ
+
+int32_t Device::cameraSetPanTiltAbsolute(double pan_deg, double tilt_deg)
+{
+    R_D(Device);
+    if (pan_deg < -1.0 || pan_deg > 1.0 || tilt_deg < -1.0 || tilt_deg > 1.0) {
+        return d->reject("cameraSetPanTiltAbsolute");
+    }
+    return d->command("cameraSetPanTiltAbsolute", [pan_deg, tilt_deg](DevicePrivate &m) {
+        m.motion.gimbalActive = false;
+        m.pan = pan_deg;
+        m.tilt = tilt_deg;
+    });
+}
+
+int32_t Device::cameraGetRangeZoomAbsoluteR(UvcParamRange &range)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetRangeZoomAbsoluteR");
+    if (ret == RM_RET_OK) {
+        d->read([&range](DevicePrivate &m) { range = m.zoomRange; });
+    }
+    return ret;
+}
+
+int32_t Device::cameraSetZoomAbsoluteR(float zoom)
+{
+    R_D(Device);
+    if (zoom < 1.0f || zoom > 2.0f) {
+        return d->reject("cameraSetZoomAbsoluteR");
+    }
+    return d->command("cameraSetZoomAbsoluteR", [zoom](DevicePrivate &m) {
+        m.motion.zoomRate = 0.0;
+        m.zoom = zoom;
+        m.status.tiny.zoom_ratio = static_cast<uint16_t>((zoom - 1.0f) * 100.0f + 0.5f);
+    });
+}
+
+int32_t Device::cameraGetZoomAbsoluteR(float &zoom)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetZoomAbsoluteR");
+    if (ret == RM_RET_OK) {
+        d->read([&zoom](DevicePrivate &m) { zoom = m.zoom; });
+    }
+    return ret;
+}
+
+namespace {
+
+// Zoom ratio per second for a cameraSetZoomWithSpeedRelativeR speed
+double zoomRateForSpeed(uint32_t speed)
+{
+    if (speed == 0) {
+        return 0.5;   // "Decided by device"
+    }
+    return std::min(speed, 15u) * 0.1;   // 255 (maximum) saturates at 1.5x per second
+}
+
+void setZoomRatio(DevicePrivate &m, double zoom)
+{
+    m.zoom = static_cast<float>(std::clamp(zoom, 1.0, 2.0));
+    m.status.tiny.zoom_ratio = static_cast<uint16_t>((m.zoom - 1.0f) * 100.0f + 0.5f);
+}
+
+} // namespace
+
+int32_t Device::cameraSetZoomWithSpeedRelativeR(uint32_t zoom_step, uint32_t zoom_speed, bool step_mode, bool in_out)
+{
+    R_D(Device);
+    return d->command("cameraSetZoomWithSpeedRelativeR", [=](DevicePrivate &m) {
+        m.advanceMotion();
+        if (step_mode) {
+            m.motion.zoomRate = 0.0;
+            setZoomRatio(m, m.zoom + (in_out ? 1.0 : -1.0) * zoom_step / 100.0);
+        } else {
+            m.motion.zoomRate = (in_out ? 1.0 : -1.0) * zoomRateForSpeed(zoom_speed);
+        }
+    });
+}
+
+int32_t Device::cameraSetZoomStopR()
+{
+    R_D(Device);
+    return d->command("cameraSetZoomStopR", [](DevicePrivate &m) {
+        m.advanceMotion();
+        m.motion.zoomRate = 0.0;
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Device: gimbal
+//
+// Normalised pan/tilt maps onto +/-120 deg yaw and +/-90 deg pitch, the
+// travel gimbalSetSpeedPositionR documents.
+
+namespace {
+
+constexpr float kYawRangeDeg = 120.0f;
+constexpr float kPitchRangeDeg = 90.0f;
+
+// Move value towards target by at most step; true once it arrives
+bool approach(double &value, double target, double step)
+{
+    if (std::abs(target - value) <= step) {
+        value = target;
+        return true;
+    }
+    value += target > value ? step : -step;
+    return false;
+}
+
+} // namespace
+
+void DevicePrivate::advanceMotion()
+{
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - motion.updated).count();
+    motion.updated = now;
+
+    if (motion.gimbalActive) {
+        double yaw = pan * kYawRangeDeg;
+        double pitch = tilt * kPitchRangeDeg;
+        bool yawDone = approach(yaw, motion.targetYaw, motion.speedYaw * seconds);
+        bool pitchDone = approach(pitch, motion.targetPitch, motion.speedPitch * seconds);
+        pan = yaw / kYawRangeDeg;
+        tilt = pitch / kPitchRangeDeg;
+        motion.gimbalActive = !(yawDone && pitchDone);
+    }
+
+    if (motion.zoomRate != 0.0) {
+        double next = zoom + motion.zoomRate * seconds;
+        setZoomRatio(*this, next);
+        if (next <= 1.0 || next >= 2.0) {
+            motion.zoomRate = 0.0;   // Hit the end of the zoom range
+        }
+    }
+}
+
+// The simulated gimbal has no roll axis
+int32_t Device::gimbalSetSpeedPositionR(float /*roll*/, float pitch, float yaw, float /*s_roll*/, float s_pitch, float s_yaw)
+{
+    R_D(Device);
+    if (pitch < -kPitchRangeDeg || pitch > kPitchRangeDeg || yaw < -kYawRangeDeg || yaw > kYawRangeDeg ||
+        std::abs(s_pitch) > 90.0f || std::abs(s_yaw) > 90.0f) {
+        return d->reject("gimbalSetSpeedPositionR");
+    }
+    return d->command("gimbalSetSpeedPositionR", [=](DevicePrivate &m) {
+        m.advanceMotion();
+        m.motion.gimbalActive = true;
+        m.motion.targetYaw = yaw;
+        m.motion.targetPitch = pitch;
+        m.motion.speedYaw = std::abs(s_yaw);
+        m.motion.speedPitch = std::abs(s_pitch);
+    });
+}
+
+int32_t Device::gimbalGetAttitudeInfoR(float xyz[3], RxDataCallback callback, void *param, GetMethod method)
+{
+    R_D(Device);
+    int32_t ret = d->command("gimbalGetAttitudeInfoR");
+    if (ret != RM_RET_OK) {
+        return ret;
+    }
+    float attitude[3] = {0.0f, 0.0f, 0.0f};
+    d->read([&attitude](DevicePrivate &m) {
+        attitude[1] = static_cast<float>(m.tilt) * kPitchRangeDeg;
+        attitude[2] = static_cast<float>(m.pan) * kYawRangeDeg;
+    });
+    if (xyz) {
+        std::copy(attitude, attitude + 3, xyz);
+    }
+    if (method == NonBlock && callback) {
+        callback(param, attitude);
+    }
+    return ret;
+}
+
+int32_t Device::aiGetGimbalStateR(AiGimbalStateInfo *gim_info, RxDataCallback callback, void *param, GetMethod method)
+{
+    R_D(Device);
+    // The simulated gimbal has no lag: motors sit exactly at the commanded angles
+    return d->get<AiGimbalStateInfo>("aiGetGimbalStateR", gim_info, callback, param, method,
+                                     [](DevicePrivate &m, AiGimbalStateInfo &out) {
+        out.pitch_euler = out.pitch_motor = static_cast<float>(m.tilt) * kPitchRangeDeg;
+        out.yaw_euler = out.yaw_motor = static_cast<float>(m.pan) * kYawRangeDeg;
+    });
+}
+
+int32_t Device::aiGetGimbalPresetListR(DevDataArray *ids, RxDataCallback callback, void *param, GetMethod method)
+{
+    R_D(Device);
+    return d->get<DevDataArray>("aiGetGimbalPresetListR", ids, callback, param, method,
+                                [](DevicePrivate &m, DevDataArray &out) {
+        out.len = 0;
+        for (const auto &entry : m.gimbalPresets) {
+            if (out.len >= 16) break;
+            out.data_int32[out.len++] = entry.first;
+        }
+    });
+}
+
+int32_t Device::aiGetGimbalPresetInfoWithIdR(PresetPosInfo *preset_info, int32_t id, RxDataCallback callback,
+                                             void *param, GetMethod method)
+{
+    R_D(Device);
+    bool exists = false;
+    d->read([&exists, id](DevicePrivate &m) { exists = m.gimbalPresets.count(id) > 0; });
+    if (!exists) {
+        return d->reject("aiGetGimbalPresetInfoWithIdR");
+    }
+    return d->get<PresetPosInfo>("aiGetGimbalPresetInfoWithIdR", preset_info, callback, param, method,
+                                 [id](DevicePrivate &m, PresetPosInfo &out) { out = m.gimbalPresets[id]; });
+}
+
+int32_t Device::aiAddGimbalPresetR(PresetPosInfo *preset_info)
+{
+    R_D(Device);
+    if (!preset_info) {
+        return d->reject("aiAddGimbalPresetR");
+    }
+    PresetPosInfo info = *preset_info;
+    return d->command("aiAddGimbalPresetR", [info](DevicePrivate &m) {
+        m.gimbalPresets[info.id] = info;
+    });
+}
+
+int32_t Device::aiUpdGimbalPresetR(PresetPosInfo *preset_info, bool presets_flag)
+{
+    R_D(Device);
+    (void)presets_flag;
+    if (!preset_info) {
+        return d->reject("aiUpdGimbalPresetR");
+    }
+    PresetPosInfo info = *preset_info;
+    // Updates of unknown ids are silently ignored, as documented
+    return d->command("aiUpdGimbalPresetR", [info](DevicePrivate &m) {
+        auto it = m.gimbalPresets.find(info.id);
+        if (it != m.gimbalPresets.end()) {
+            it->second = info;
+        }
+    });
+}
+
+int32_t Device::aiTrgGimbalPresetR(int pos_id)
+{
+    R_D(Device);
+    bool exists = false;
+    d->read([&exists, pos_id](DevicePrivate &m) { exists = m.gimbalPresets.count(pos_id) > 0; });
+    if (!exists) {
+        return d->reject("aiTrgGimbalPresetR");
+    }
+    return d->command("aiTrgGimbalPresetR", [pos_id](DevicePrivate &m) {
+        m.motion = DevicePrivate::Motion();
+        const auto &info = m.gimbalPresets[pos_id];
+        m.pan = std::clamp(info.yaw / kYawRangeDeg, -1.0f, 1.0f);
+        m.tilt = std::clamp(info.pitch / kPitchRangeDeg, -1.0f, 1.0f);
+        m.zoom = std::clamp(info.zoom, 1.0f, 2.0f);
+        m.status.tiny.zoom_ratio = static_cast<uint16_t>((m.zoom - 1.0f) * 100.0f + 0.5f);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Device: target selection
+//
+// Tail Air only. The simulated subject sits wherever it was selected, so
+// the tracker turns the gimbal until the selection is centered.
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kTrackerSpeedDegPerSec = 60.0;
+
+bool validBox(float x_min, float y_min, float x_max, float y_max)
+{
+    return x_min >= 0.0f && y_min >= 0.0f && x_max <= 1.0f && y_max <= 1.0f && x_min < x_max && y_min < y_max;
+}
+
+// Turn the gimbal so the frame point (cx, cy) ends up centered, assuming the
+// default 86 deg diagonal FOV of a 16:9 frame. Caller holds the model mutex.
+void centerOn(DevicePrivate &m, double cx, double cy, bool smooth)
+{
+    const double halfWidth = std::tan(43.0 * kPi / 180.0) * 16.0 / std::sqrt(16.0 * 16.0 + 9.0 * 9.0) / m.zoom;
+    const double halfHeight = halfWidth * 9.0 / 16.0;
+    const double yaw = std::clamp(m.pan * kYawRangeDeg + std::atan((2.0 * cx - 1.0) * halfWidth) * 180.0 / kPi,
+                                  -double(kYawRangeDeg), double(kYawRangeDeg));
+    const double pitch = std::clamp(m.tilt * kPitchRangeDeg - std::atan((2.0 * cy - 1.0) * halfHeight) * 180.0 / kPi,
+                                    -double(kPitchRangeDeg), double(kPitchRangeDeg));
+
+    m.advanceMotion();
+    if (!smooth) {
+        m.motion.gimbalActive = false;
+        m.pan = yaw / kYawRangeDeg;
+        m.tilt = pitch / kPitchRangeDeg;
+        return;
+    }
+    m.motion.gimbalActive = true;
+    m.motion.targetYaw = yaw;
+    m.motion.targetPitch = pitch;
+    m.motion.speedYaw = kTrackerSpeedDegPerSec;
+    m.motion.speedPitch = kTrackerSpeedDegPerSec;
+}
+
+void startTracking(DevicePrivate &m)
+{
+    m.status.tiny.ai_mode = Device::AiWorkModeHuman;
+    m.status.tiny.ai_sub_mode = Device::AiSubModeUpperBody;
+}
+
+} // namespace
+
+int32_t Device::aiSetSelectTargetByBox(float x_min, float y_min, float x_max, float y_max)
+{
+    R_D(Device);
+    if (d->id.product != ObsbotProdTailAir) {
+        return d->unsupported("aiSetSelectTargetByBox");
+    }
+    if (!validBox(x_min, y_min, x_max, y_max)) {
+        return d->reject("aiSetSelectTargetByBox");
+    }
+    return d->command("aiSetSelectTargetByBox", [=](DevicePrivate &m) {
+        startTracking(m);
+        centerOn(m, (x_min + x_max) / 2.0, (y_min + y_max) / 2.0, true);
+    });
+}
+
+int32_t Device::aiSetSelectBiggestTarget(int32_t target_type)
+{
+    R_D(Device);
+    (void)target_type;
+    if (d->id.product != ObsbotProdTailAir) {
+        return d->unsupported("aiSetSelectBiggestTarget");
+    }
+    return d->command("aiSetSelectBiggestTarget", [](DevicePrivate &m) { startTracking(m); });
+}
+
+int32_t Device::aiSetSelectCentralTarget(int32_t target_type)
+{
+    R_D(Device);
+    (void)target_type;
+    if (d->id.product != ObsbotProdTailAir) {
+        return d->unsupported("aiSetSelectCentralTarget");
+    }
+    return d->command("aiSetSelectCentralTarget", [](DevicePrivate &m) { startTracking(m); });
+}
+
+int32_t Device::cameraSetRoiTarget(int32_t roi_type, int32_t vid, float x_min, float y_min, float x_max, float y_max)
+{
+    R_D(Device);
+    if (d->id.product != ObsbotProdTailAir) {
+        return d->unsupported("cameraSetRoiTarget");
+    }
+    if ((roi_type != 0 && roi_type != 1) || vid < ROIViewDefault || vid > ROIViewStdGroup ||
+        !validBox(x_min, y_min, x_max, y_max)) {
+        return d->reject("cameraSetRoiTarget");
+    }
+    return d->command("cameraSetRoiTarget", [=](DevicePrivate &m) {
+        centerOn(m, (x_min + x_max) / 2.0, (y_min + y_max) / 2.0, roi_type == 1);
+        const double fill = std::min(1.0 / (x_max - x_min), 1.0 / (y_max - y_min));
+        m.motion.zoomRate = 0.0;
+        setZoomRatio(m, m.zoom * fill);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Device: camera settings
+
+int32_t Device::cameraSetWdrR(int32_t mode)
+{
+    R_D(Device);
+    return d->command("cameraSetWdrR", [mode](DevicePrivate &m) {
+        m.status.tiny.hdr = mode != DevWdrModeNone ? 1 : 0;
+    });
+}
+
+int32_t Device::cameraSetFovU(FovType fov_type)
+{
+    R_D(Device);
+    if (fov_type < FovType86 || fov_type > FovType65) {
+        return d->reject("cameraSetFovU");
+    }
+    return d->command("cameraSetFovU", [fov_type](DevicePrivate &m) {
+        m.status.tiny.fov = static_cast<uint8_t>(fov_type);
+    });
+}
+
+int32_t Device::cameraSetFaceAER(int32_t face_ae)
+{
+    R_D(Device);
+    return d->command("cameraSetFaceAER", [face_ae](DevicePrivate &m) {
+        m.status.tiny.face_ae = face_ae ? 1 : 0;
+    });
+}
+
+int32_t Device::cameraSetFaceFocusR(bool enable)
+{
+    R_D(Device);
+    return d->command("cameraSetFaceFocusR", [enable](DevicePrivate &m) {
+        m.status.tiny.face_auto_focus = enable ? 1 : 0;
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Device: image controls
+
+namespace {
+
+bool inRange(long value, const Device::UvcParamRange &range)
+{
+    return value >= range.min_ && value <= range.max_;
+}
+
+} // namespace
+
+int32_t Device::cameraSetImageBrightnessR(int32_t brightness)
+{
+    R_D(Device);
+    if (!inRange(brightness, d->brightnessRange)) {
+        return d->reject("cameraSetImageBrightnessR");
+    }
+    return d->command("cameraSetImageBrightnessR", [brightness](DevicePrivate &m) { m.brightness = brightness; });
+}
+
+int32_t Device::cameraGetImageBrightnessR(int32_t &brightness)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetImageBrightnessR");
+    if (ret == RM_RET_OK) {
+        d->read([&brightness](DevicePrivate &m) { brightness = m.brightness; });
+    }
+    return ret;
+}
+
+int32_t Device::cameraGetRangeImageBrightnessR(UvcParamRange &range)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetRangeImageBrightnessR");
+    if (ret == RM_RET_OK) {
+        d->read([&range](DevicePrivate &m) { range = m.brightnessRange; });
+    }
+    return ret;
+}
+
+int32_t Device::cameraSetImageContrastR(int32_t contrast)
+{
+    R_D(Device);
+    if (!inRange(contrast, d->contrastRange)) {
+        return d->reject("cameraSetImageContrastR");
+    }
+    return d->command("cameraSetImageContrastR", [contrast](DevicePrivate &m) { m.contrast = contrast; });
+}
+
+int32_t Device::cameraGetImageContrastR(int32_t &contrast)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetImageContrastR");
+    if (ret == RM_RET_OK) {
+        d->read([&contrast](DevicePrivate &m) { contrast = m.contrast; });
+    }
+    return ret;
+}
+
+int32_t Device::cameraGetRangeImageContrastR(UvcParamRange &range)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetRangeImageContrastR");
+    if (ret == RM_RET_OK) {
+        d->read([&range](DevicePrivate &m) { range = m.contrastRange; });
+    }
+    return ret;
+}
+
+int32_t Device::cameraSetImageSaturationR(int32_t saturation)
+{
+    R_D(Device);
+    if (!inRange(saturation, d->saturationRange)) {
+        return d->reject("cameraSetImageSaturationR");
+    }
+    return d->command("cameraSetImageSaturationR", [saturation](DevicePrivate &m) { m.saturation = saturation; });
+}
+
+int32_t Device::cameraGetImageSaturationR(int32_t &saturation)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetImageSaturationR");
+    if (ret == RM_RET_OK) {
+        d->read([&saturation](DevicePrivate &m) { saturation = m.saturation; });
+    }
+    return ret;
+}
+
+int32_t Device::cameraGetRangeImageSaturationR(UvcParamRange &range)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetRangeImageSaturationR");
+    if (ret == RM_RET_OK) {
+        d->read([&range](DevicePrivate &m) { range = m.saturationRange; });
+    }
+    return ret;
+}
+
+int32_t Device::cameraSetWhiteBalanceR(DevWhiteBalanceType wb_type, int32_t param)
+{
+    R_D(Device);
+    bool supported = std::find(d->whiteBalanceList.begin(), d->whiteBalanceList.end(),
+                               static_cast<int32_t>(wb_type)) != d->whiteBalanceList.end();
+    if (!supported || (wb_type == DevWhiteBalanceManual && !inRange(param, d->whiteBalanceRange))) {
+        return d->reject("cameraSetWhiteBalanceR");
+    }
+    return d->command("cameraSetWhiteBalanceR", [wb_type, param](DevicePrivate &m) {
+        m.whiteBalance = wb_type;
+        if (wb_type == DevWhiteBalanceManual) {
+            m.whiteBalanceKelvin = param;
+        }
+    });
+}
+
+int32_t Device::cameraGetWhiteBalanceR(DevWhiteBalanceType &wb_type, int32_t &param)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetWhiteBalanceR");
+    if (ret == RM_RET_OK) {
+        d->read([&wb_type, &param](DevicePrivate &m) {
+            wb_type = m.whiteBalance;
+            param = m.whiteBalanceKelvin;
+        });
+    }
+    return ret;
+}
+
+int32_t Device::cameraGetWhiteBalanceListR(std::vector<int32_t> &wb_list, int32_t &wb_min, int32_t &wb_max)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetWhiteBalanceListR");
+    if (ret == RM_RET_OK) {
+        d->read([&](DevicePrivate &m) {
+            wb_list = m.whiteBalanceList;
+            wb_min = static_cast<int32_t>(m.whiteBalanceRange.min_);
+            wb_max = static_cast<int32_t>(m.whiteBalanceRange.max_);
+        });
+    }
+    return ret;
+}
+
+int32_t Device::cameraGetRangeWhiteBalanceR(UvcParamRange &range)
+{
+    R_D(Device);
+    int32_t ret = d->command("cameraGetRangeWhiteBalanceR");
+    if (ret == RM_RET_OK) {
+        d->read([&range](DevicePrivate &m) { range = m.whiteBalanceRange; });
+    }
+    return ret;
+}
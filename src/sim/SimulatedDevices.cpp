@@ -0,0 +1,375 @@
+#include "SimulatedSdk.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+int envInt(const char *name, int fallback)
+{
+    const char *value = std::getenv(name);
+    if (!value || !*value) {
+        return fallback;
+    }
+    try {
+        return std::stoi(value);
+    } catch (...) {
+        std::cerr << "[Sim] Ignoring invalid " << name << "=" << value << std::endl;
+        return fallback;
+    }
+}
+
+double envDouble(const char *name, double fallback)
+{
+    const char *value = std::getenv(name);
+    if (!value || !*value) {
+        return fallback;
+    }
+    try {
+        return std::stod(value);
+    } catch (...) {
+        std::cerr << "[Sim] Ignoring invalid " << name << "=" << value << std::endl;
+        return fallback;
+    }
+}
+
+std::string envString(const char *name, const std::string &fallback)
+{
+    const char *value = std::getenv(name);
+    return (value && *value) ? std::string(value) : fallback;
+}
+
+ObsbotProductType parseProduct(const std::string &text)
+{
+    std::string key;
+    for (char c : text) {
+        if (c != ' ' && c != '-' && c != '_') {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+
+    if (key == "tiny") return ObsbotProdTiny;
+    if (key == "tiny4k") return ObsbotProdTiny4k;
+    if (key == "tiny2") return ObsbotProdTiny2;
+    if (key == "tiny2lite") return ObsbotProdTiny2Lite;
+    if (key == "tinyse") return ObsbotProdTinySE;
+    if (key == "tailair") return ObsbotProdTailAir;
+    if (key == "meet") return ObsbotProdMeet;
+    if (key == "meet4k") return ObsbotProdMeet4k;
+    if (key == "meet2") return ObsbotProdMeet2;
+    if (key == "meetse") return ObsbotProdMeetSE;
+
+    std::cerr << "[Sim] Unknown OBSBOT_SIM_PRODUCT '" << text << "', using tiny2" << std::endl;
+    return ObsbotProdTiny2;
+}
+
+std::string productName(ObsbotProductType product)
+{
+    switch (product) {
+    case ObsbotProdTiny: return "OBSBOT Tiny";
+    case ObsbotProdTiny4k: return "OBSBOT Tiny 4K";
+    case ObsbotProdTiny2: return "OBSBOT Tiny 2";
+    case ObsbotProdTiny2Lite: return "OBSBOT Tiny 2 Lite";
+    case ObsbotProdTinySE: return "OBSBOT Tiny SE";
+    case ObsbotProdTailAir: return "OBSBOT Tail Air";
+    case ObsbotProdMeet: return "OBSBOT Meet";
+    case ObsbotProdMeet4k: return "OBSBOT Meet 4K";
+    case ObsbotProdMeet2: return "OBSBOT Meet 2";
+    case ObsbotProdMeetSE: return "OBSBOT Meet SE";
+    default: return "OBSBOT Camera";
+    }
+}
+
+// Serial numbers are 14 characters; bump the trailing digits per device
+std::string serialForIndex(const std::string &base, int index)
+{
+    if (index == 0) {
+        return base;
+    }
+    std::string sn = base;
+    std::string suffix = std::to_string(index);
+    if (suffix.size() < sn.size()) {
+        sn.replace(sn.size() - suffix.size(), suffix.size(), suffix);
+    }
+    return sn;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// SimConfig
+
+SimConfig::SimConfig()
+{
+    product = parseProduct(envString("OBSBOT_SIM_PRODUCT", "tiny2"));
+    serialBase = envString("OBSBOT_SIM_SN", serialBase);
+    version = envString("OBSBOT_SIM_VERSION", version);
+    deviceCount = std::max(0, envInt("OBSBOT_SIM_DEVICES", deviceCount));
+
+    latencyMs = std::max(0, envInt("OBSBOT_SIM_LATENCY_MS", latencyMs));
+    jitterMs = std::max(0, envInt("OBSBOT_SIM_JITTER_MS", jitterMs));
+    failureRate = std::clamp(envDouble("OBSBOT_SIM_FAILURE_RATE", failureRate), 0.0, 1.0);
+    statusLagMs = std::max(0, envInt("OBSBOT_SIM_STATUS_LAG_MS", statusLagMs));
+
+    std::stringstream failList(envString("OBSBOT_SIM_FAIL_COMMANDS", ""));
+    std::string name;
+    while (std::getline(failList, name, ',')) {
+        if (!name.empty()) {
+            failCommands.insert(name);
+        }
+    }
+
+    connectDelayMs = std::max(0, envInt("OBSBOT_SIM_CONNECT_DELAY_MS", connectDelayMs));
+    unplugAfterMs = envInt("OBSBOT_SIM_UNPLUG_AFTER_MS", unplugAfterMs);
+    replugAfterMs = envInt("OBSBOT_SIM_REPLUG_AFTER_MS", replugAfterMs);
+
+    verbose = envInt("OBSBOT_SIM_VERBOSE", 0) != 0;
+    seed = static_cast<unsigned>(envInt("OBSBOT_SIM_SEED", 0));
+    m_rng.seed(seed != 0 ? seed : std::random_device{}());
+
+    std::cerr << "[Sim] Simulated OBSBOT SDK: " << productName(product)
+              << ", " << deviceCount << " device(s), latency " << latencyMs
+              << "+/-" << jitterMs << "ms, failure rate " << failureRate << std::endl;
+}
+
+const SimConfig &SimConfig::get()
+{
+    static SimConfig config;
+    return config;
+}
+
+std::chrono::milliseconds SimConfig::sampleLatency() const
+{
+    if (jitterMs == 0) {
+        return std::chrono::milliseconds(latencyMs);
+    }
+    std::lock_guard<std::mutex> lock(m_rngMutex);
+    std::uniform_int_distribution<int> spread(-jitterMs, jitterMs);
+    return std::chrono::milliseconds(std::max(0, latencyMs + spread(m_rng)));
+}
+
+bool SimConfig::shouldFail(const char *command) const
+{
+    if (failCommands.count(command)) {
+        return true;
+    }
+    if (failureRate <= 0.0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_rngMutex);
+    return std::uniform_real_distribution<double>(0.0, 1.0)(m_rng) < failureRate;
+}
+
+// ---------------------------------------------------------------------------
+// DevicesPrivate
+
+DevicesPrivate::DevicesPrivate()
+{
+    m_hotplugThread = std::thread(&DevicesPrivate::hotplugLoop, this);
+}
+
+DevicesPrivate::~DevicesPrivate()
+{
+    stop();
+}
+
+DevicePrivate *DevicesPrivate::model(Device &dev)
+{
+    return dev.d_func();
+}
+
+void DevicesPrivate::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_hotplugThread.joinable()) {
+        m_hotplugThread.join();
+    }
+}
+
+bool DevicesPrivate::sleepFor(int ms)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return !m_wake.wait_for(lock, std::chrono::milliseconds(ms), [this]() { return m_stopping; });
+}
+
+void DevicesPrivate::hotplugLoop()
+{
+    const SimConfig &config = SimConfig::get();
+
+    if (!sleepFor(config.connectDelayMs)) return;
+    plugIn();
+
+    while (config.unplugAfterMs >= 0) {
+        if (!sleepFor(config.unplugAfterMs)) return;
+        unplug();
+
+        if (config.replugAfterMs < 0) return;
+        if (!sleepFor(config.replugAfterMs)) return;
+        plugIn();
+    }
+}
+
+void DevicesPrivate::plugIn()
+{
+    const SimConfig &config = SimConfig::get();
+    std::vector<std::string> added;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < config.deviceCount; ++i) {
+            DeviceId id;
+            id.sn = serialForIndex(config.serialBase, i);
+            id.name = productName(config.product);
+            id.version = config.version;
+            id.product = config.product;
+            devices.push_back(std::make_shared<Device>(&id));
+            added.push_back(id.sn);
+        }
+    }
+
+    for (const auto &sn : added) {
+        notify(sn, true);
+    }
+}
+
+void DevicesPrivate::unplug()
+{
+    std::vector<std::string> removed;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &dev : devices) {
+            model(*dev)->attached = false;
+            removed.push_back(dev->devSn());
+        }
+        devices.clear();
+    }
+
+    for (const auto &sn : removed) {
+        notify(sn, false);
+    }
+}
+
+void DevicesPrivate::notify(const std::string &sn, bool connected)
+{
+    Devices::devChangedCallback cb;
+    void *param = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cb = callback;
+        param = callbackParam;
+    }
+
+    if (SimConfig::get().verbose) {
+        std::cerr << "[Sim] Device " << sn << (connected ? " plugged in" : " unplugged") << std::endl;
+    }
+
+    // Like the real SDK, the callback runs on the detection thread
+    if (cb) {
+        cb(sn, connected, param);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Devices
+
+Devices::Devices()
+    : d_ptr(new DevicesPrivate)
+{
+}
+
+Devices::~Devices()
+{
+    delete d_ptr;
+}
+
+Devices &Devices::get()
+{
+    static Devices instance;
+    return instance;
+}
+
+void Devices::close()
+{
+    d_ptr->stop();
+}
+
+void Devices::setDevChangedCallback(devChangedCallback callback, void *param)
+{
+    std::lock_guard<std::mutex> lock(d_ptr->mutex);
+    d_ptr->callback = std::move(callback);
+    d_ptr->callbackParam = param;
+}
+
+void Devices::setNetDevHeartbeatInterval(int)
+{
+}
+
+size_t Devices::getDevNum()
+{
+    std::lock_guard<std::mutex> lock(d_ptr->mutex);
+    return d_ptr->devices.size();
+}
+
+bool Devices::containDev(Device::DevUuid &uuid)
+{
+    return getDevByUuid(uuid) != nullptr;
+}
+
+std::shared_ptr<Device> Devices::getDevByName(const std::string &dev_name)
+{
+    std::lock_guard<std::mutex> lock(d_ptr->mutex);
+    for (auto &dev : d_ptr->devices) {
+        if (DevicesPrivate::model(*dev)->id.name == dev_name) {
+            return dev;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Device> Devices::getDevByUuid(Device::DevUuid &uuid)
+{
+    std::lock_guard<std::mutex> lock(d_ptr->mutex);
+    for (auto &dev : d_ptr->devices) {
+        if (dev->uuid() == uuid) {
+            return dev;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Device> Devices::getDevBySn(const std::string &dev_sn)
+{
+    std::lock_guard<std::mutex> lock(d_ptr->mutex);
+    for (auto &dev : d_ptr->devices) {
+        if (DevicesPrivate::model(*dev)->id.sn == dev_sn) {
+            return dev;
+        }
+    }
+    return nullptr;
+}
+
+std::list<std::shared_ptr<Device>> Devices::getDevList()
+{
+    std::lock_guard<std::mutex> lock(d_ptr->mutex);
+    return d_ptr->devices;
+}
+
+void Devices::setTailAirWhiteList(std::list<std::string>)
+{
+}
+
+int32_t Devices::startNetworkScanImmediately()
+{
+    return RM_RET_OK;
+}
+
+void Devices::setEnableMdnsScan(bool)
+{
+}
@@ -0,0 +1,210 @@
+#ifndef SIMULATEDSDK_H
+#define SIMULATEDSDK_H
+
+#include <dev/devs.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Runtime knobs for the simulated SDK
+ *
+ * Everything is read once from OBSBOT_SIM_* environment variables so the
+ * same build can be driven into slow, flaky or hotplug-heavy scenarios
+ * without recompiling. See docs/BUILD.md for the full list.
+ */
+struct SimConfig
+{
+    ObsbotProductType product = ObsbotProdTiny2;
+    std::string serialBase = "RMOWSIM0000001";
+    std::string version = "sim-1.0.0";
+    int deviceCount = 1;
+
+    int latencyMs = 0;          // Base per-command round trip
+    int jitterMs = 0;           // Uniform +/- spread applied to latencyMs
+    double failureRate = 0.0;   // Probability (0..1) that any command fails
+    std::set<std::string> failCommands;  // Commands that always fail
+    int statusLagMs = 0;        // Delay before cameraStatus()/getters reflect a set
+
+    int connectDelayMs = 200;   // Time until the device is "plugged in"
+    int unplugAfterMs = -1;     // Unplug this long after connect (-1 = never)
+    int replugAfterMs = -1;     // Re-plug this long after unplug (-1 = never)
+
+    bool verbose = false;
+    unsigned seed = 0;          // 0 = non-deterministic
+
+    static const SimConfig &get();
+
+    // Latency for one command, including jitter. Thread-safe.
+    std::chrono::milliseconds sampleLatency() const;
+    // Whether a command with this name should fail. Thread-safe.
+    bool shouldFail(const char *command) const;
+
+private:
+    mutable std::mutex m_rngMutex;
+    mutable std::mt19937 m_rng;
+
+    SimConfig();
+};
+
+/**
+ * @brief Identity of one simulated device, handed to Device's constructor
+ */
+class DeviceId
+{
+public:
+    std::string sn;
+    std::string name;
+    std::string version;
+    ObsbotProductType product;
+};
+
+/**
+ * @brief Mutable model behind a simulated Device
+ *
+ * Holds the values a real camera would report back. Setters go through
+ * command(), which serialises on a single "USB pipe", applies the
+ * configured latency and failure injection, and then commits the change
+ * (optionally after statusLagMs to mimic the camera's status lag).
+ */
+class DevicePrivate
+{
+public:
+    explicit DevicePrivate(const DeviceId &id);
+
+    DeviceId id;
+    std::atomic<bool> attached{true};
+
+    // Model state, guarded by mutex
+    std::mutex mutex;
+    Device::CameraStatus status;
+    double pan = 0.0;
+    double tilt = 0.0;
+    float zoom = 1.0f;
+    std::map<int32_t, Device::PresetPosInfo> gimbalPresets;
+    int32_t brightness = 128;
+    int32_t contrast = 128;
+    int32_t saturation = 128;
+    Device::DevWhiteBalanceType whiteBalance = Device::DevWhiteBalanceAuto;
+    int32_t whiteBalanceKelvin = 5000;
+
+    Device::UvcParamRange brightnessRange;
+    Device::UvcParamRange contrastRange;
+    Device::UvcParamRange saturationRange;
+    Device::UvcParamRange whiteBalanceRange;
+    Device::UvcParamRange zoomRange;
+    std::vector<int32_t> whiteBalanceList;
+
+    // Speed-controlled moves (gimbalSetSpeedPositionR, relative zoom) in
+    // progress; integrated into pan/tilt/zoom whenever the model is read
+    struct Motion {
+        bool gimbalActive = false;
+        double targetYaw = 0.0;     // deg
+        double targetPitch = 0.0;   // deg
+        double speedYaw = 0.0;      // deg/s
+        double speedPitch = 0.0;    // deg/s
+        double zoomRate = 0.0;      // Zoom ratio per second, negative to zoom out
+        std::chrono::steady_clock::time_point updated = std::chrono::steady_clock::now();
+    } motion;
+
+    // Bring pan/tilt/zoom up to date with the motion in progress. Caller holds mutex.
+    void advanceMotion();
+
+    /**
+     * @brief Run a simulated command
+     * @param name SDK method name, used for logging and OBSBOT_SIM_FAIL_COMMANDS
+     * @param apply Mutation to commit on success (may be empty for getters)
+     * @return RM_RET_OK or RM_RET_ERR
+     */
+    int32_t command(const char *name, std::function<void(DevicePrivate &)> apply = {});
+
+    /**
+     * @brief Run a simulated getter with the SDK's optional async callback
+     *
+     * NonBlock requests complete before returning; the callback still fires
+     * so callers exercise their async path.
+     */
+    template <typename T>
+    int32_t get(const char *name, T *out, Device::RxDataCallback callback, void *param,
+                Device::GetMethod method, const std::function<void(DevicePrivate &, T &)> &reader)
+    {
+        int32_t ret = command(name);
+        if (ret != RM_RET_OK) {
+            return ret;
+        }
+        T value{};
+        read([&](DevicePrivate &m) { reader(m, value); });
+        if (out) {
+            *out = value;
+        }
+        if (method == Device::NonBlock && callback) {
+            callback(param, &value);
+        }
+        return ret;
+    }
+
+    // Invalid argument: fails immediately without touching the pipe, like the SDK's own checks
+    int32_t reject(const char *name);
+
+    // Command the simulated model does not have, e.g. Tail Air only calls on a Tiny 2
+    int32_t unsupported(const char *name);
+
+    // Read model state under the lock, after committing any due changes
+    void read(const std::function<void(DevicePrivate &)> &reader);
+
+    // Commit pending lagged changes whose time has come. Caller holds mutex.
+    void flushPending();
+
+private:
+    struct PendingChange {
+        std::chrono::steady_clock::time_point due;
+        std::function<void(DevicePrivate &)> apply;
+    };
+
+    std::mutex m_pipeMutex;  // One command in flight at a time, like the real UVC pipe
+    std::deque<PendingChange> m_pending;
+};
+
+/**
+ * @brief Device list and hotplug simulation behind Devices::get()
+ */
+class DevicesPrivate
+{
+public:
+    DevicesPrivate();
+    ~DevicesPrivate();
+
+    std::mutex mutex;
+    std::list<std::shared_ptr<Device>> devices;
+    Devices::devChangedCallback callback;
+    void *callbackParam = nullptr;
+
+    void stop();
+
+    // Device only befriends DevicesPrivate, so model access goes through here
+    static DevicePrivate *model(Device &dev);
+
+private:
+    std::thread m_hotplugThread;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+
+    void hotplugLoop();
+    bool sleepFor(int ms);  // false if stopped while sleeping
+    void plugIn();
+    void unplug();
+    void notify(const std::string &sn, bool connected);
+};
+
+#endif // SIMULATEDSDK_H
@@ -0,0 +1,227 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Config.h"
+
+using namespace std;
+
+// Fuzzes and times Config's table-driven settings.conf parser. The fuzzer
+// mutates a valid file (flipped bytes, dropped and repeated lines, odd
+// values, truncation) and parses each result. Any file that parses and
+// validates must serialize to content that parses back to the same text.
+// Build with -fsanitize=address,undefined to catch memory errors as well.
+// The benchmark reports parse() time per line on a typical file and on
+// large generated ones.
+
+namespace {
+
+const char *const kOddValues[] = {
+    "", "-1", "0", "999999999", "1e308", "-1e308", "nan", "inf", "abc", "0x10", " 1 ", "1.5", "2.0000001",
+    "enabled", "disabled", "manual", "255", "ffffff", "#", "=", "match", "1920X1080", "0x0",
+    "0 0 0 1; 100 1 1 2 hold", "0 0 0 1;", "100 0 0 1; 50 0 0 1", "obs=Work; chrome=", "/dev/video0",
+};
+
+const char *const kOddLines[] = {
+    "=", "key_without_value", "=value", "preset99_pan=0.5", "preset1_pan=", "preset0_zoom=1",
+    "sequence_=0 0 0 1", "sequence_a b=0 0 0 1", "sequence_x_hotkey=Ctrl+1", "sequence_y=0 0 0 1; 10 1 1 2",
+    "unknown_key=1", "zoom==1.5", "  # indented comment", "\t\r",
+};
+
+double elapsedNs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+// Defaults plus presets and sequences, as a well-used install would have
+string typicalFile()
+{
+    Config config;
+    Config::CameraSettings settings = config.getSettings();
+    settings.presets[0] = {true, 0.25, -0.1, 1.4};
+    settings.presets[1] = {true, -0.5, 0.2, 1.0};
+    settings.sequences.push_back({"panel", "Ctrl+Alt+1",
+                                  {{0, -0.5, 0.0, 1.0, Config::CameraSettings::EaseInOut},
+                                   {4000, 0.5, -0.1, 1.0, Config::CameraSettings::EaseInOut},
+                                   {5500, 0.5, -0.1, 1.6, Config::CameraSettings::EaseOut}}});
+    config.setSettings(settings);
+    return config.serialize();
+}
+
+vector<string> splitLines(const string &content)
+{
+    vector<string> lines;
+    size_t start = 0;
+    while (start < content.size()) {
+        size_t end = content.find('\n', start);
+        if (end == string::npos) {
+            end = content.size();
+        }
+        lines.push_back(content.substr(start, end - start));
+        start = end + 1;
+    }
+    return lines;
+}
+
+string joinLines(const vector<string> &lines)
+{
+    string content;
+    for (const auto &line : lines) {
+        content += line + "\n";
+    }
+    return content;
+}
+
+string mutate(const string &original, mt19937 &random)
+{
+    vector<string> lines = splitLines(original);
+    uniform_int_distribution<int> count(1, 4);
+    for (int i = count(random); i > 0 && !lines.empty(); --i) {
+        const size_t line = uniform_int_distribution<size_t>(0, lines.size() - 1)(random);
+        switch (uniform_int_distribution<int>(0, 5)(random)) {
+        case 0:
+            if (!lines[line].empty()) {
+                lines[line][uniform_int_distribution<size_t>(0, lines[line].size() - 1)(random)] =
+                    static_cast<char>(uniform_int_distribution<int>(1, 255)(random));
+            }
+            break;
+        case 1:
+            lines.erase(lines.begin() + static_cast<long>(line));
+            break;
+        case 2:
+            lines.insert(lines.begin() + static_cast<long>(line), lines[line]);
+            break;
+        case 3: {
+            const size_t equals = lines[line].find('=');
+            if (equals != string::npos) {
+                const size_t pick = uniform_int_distribution<size_t>(0, size(kOddValues) - 1)(random);
+                lines[line] = lines[line].substr(0, equals + 1) + kOddValues[pick];
+            }
+            break;
+        }
+        case 4:
+            lines.insert(lines.begin() + static_cast<long>(line),
+                         kOddLines[uniform_int_distribution<size_t>(0, size(kOddLines) - 1)(random)]);
+            break;
+        default:
+            lines[line].resize(uniform_int_distribution<size_t>(0, lines[line].size())(random));
+            break;
+        }
+    }
+    return joinLines(lines);
+}
+
+// Returns false and explains when a file that validated does not round-trip
+bool roundTrips(const string &content, string &why)
+{
+    Config first;
+    vector<Config::ValidationError> errors;
+    if (!first.parse(content, errors) || !first.validateSettings(errors)) {
+        return true;  // Rejected input only has to not crash
+    }
+
+    const string written = first.serialize();
+    Config second;
+    if (!second.parse(written, errors) || !second.validateSettings(errors)) {
+        why = "serialized content does not load: " + (errors.empty() ? string() : errors.front().message);
+        return false;
+    }
+    if (second.serialize() != written) {
+        why = "serialized content changes when loaded and serialized again";
+        return false;
+    }
+    return true;
+}
+
+// Average parse() time per line over enough runs to fill about half a second
+double nsPerLine(const string &content)
+{
+    const size_t lines = splitLines(content).size();
+    vector<Config::ValidationError> errors;
+    double total = 0.0;
+    int runs = 0;
+    while (total < 5e8 || runs < 3) {
+        Config config;
+        const auto start = chrono::steady_clock::now();
+        config.parse(content, errors);
+        total += elapsedNs(start);
+        ++runs;
+    }
+    return total / runs / lines;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int iterations = 20000;
+    int largeLines = 100000;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--fuzz") == 0 && i + 1 < argc) {
+            iterations = max(atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            largeLines = max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            cout << "Usage: " << argv[0] << " [--fuzz N] [--lines N] [--seed S]" << endl;
+            cout << "Example: " << argv[0] << " --fuzz 100000 --lines 200000" << endl;
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    const string typical = typicalFile();
+    int failures = 0;
+    {
+        string why;
+        if (!roundTrips(typical, why)) {
+            cout << "typical file: " << why << endl;
+            ++failures;
+        }
+    }
+
+    mt19937 random(seed);
+    int accepted = 0;
+    for (int i = 0; i < iterations; ++i) {
+        const string content = mutate(typical, random);
+        vector<Config::ValidationError> errors;
+        Config probe;
+        if (probe.parse(content, errors) && probe.validateSettings(errors)) {
+            ++accepted;
+        }
+        string why;
+        if (!roundTrips(content, why)) {
+            if (failures++ == 0) {
+                cout << "fuzz case " << i << ": " << why << "\n--- input ---\n" << content << "--- end ---" << endl;
+            }
+        }
+    }
+    if (iterations > 0) {
+        cout << "fuzz: " << iterations << " mutated files, " << accepted << " valid, " << failures
+             << " round-trip failure(s), seed " << seed << endl;
+    }
+
+    // Large files: the typical one repeated (later keys win), and one that
+    // is mostly sequence lines, which go through the indexed-key path
+    const size_t typicalLines = splitLines(typical).size();
+    string scalars;
+    for (size_t lines = 0; lines < static_cast<size_t>(largeLines); lines += typicalLines) {
+        scalars += typical;
+    }
+    string sequences = typical;
+    for (int i = 0; i < largeLines; ++i) {
+        sequences += "sequence_s" + to_string(i % 2000) + "=0 0 0 1; 1500 0.5 -0.2 1.5 ease-out; 3000 -0.5 0.1 1 hold\n";
+    }
+
+    cout << fixed << setprecision(0);
+    cout << "parse, ns per line:" << endl;
+    cout << "  typical file (" << typicalLines << " lines): " << nsPerLine(typical) << endl;
+    cout << "  " << splitLines(scalars).size() << " scalar lines: " << nsPerLine(scalars) << endl;
+    cout << "  " << splitLines(sequences).size() << " lines of sequences: " << nsPerLine(sequences) << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "TemporalDenoiser.h"
+
+using namespace std;
+
+// Times TemporalDenoiser, the CPU fallback of the preview's Denoise effect,
+// on synthetic frames: a still gradient with grain, and a square moving
+// across it. Reports the time per frame and how much grain is left, both
+// where the picture is still and on the moving square, where the filter
+// has to give up history instead of smearing it.
+
+namespace {
+
+const int kSquareSize = 160;
+const int kSquareSpeed = 12;  // Pixels per frame, a brisk hand wave at 1080p30
+
+struct Region {
+    double noiseBefore = 0.0;  // Sum of squared luma error against the clean frame
+    double noiseAfter = 0.0;
+    long pixels = 0;
+
+    void add(double before, double after)
+    {
+        noiseBefore += before * before;
+        noiseAfter += after * after;
+        ++pixels;
+    }
+};
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+double luma(const uint8_t *pixel)
+{
+    return 0.299 * pixel[0] + 0.587 * pixel[1] + 0.114 * pixel[2];
+}
+
+void renderClean(vector<uint8_t> &frame, int width, int height, int frameIndex)
+{
+    const int squareX = (frameIndex * kSquareSpeed) % max(width - kSquareSize, 1);
+    const int squareY = (height - kSquareSize) / 2;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint8_t *pixel = frame.data() + (static_cast<size_t>(y) * width + x) * 4;
+            const bool inSquare = x >= squareX && x < squareX + kSquareSize && y >= squareY && y < squareY + kSquareSize;
+            if (inSquare) {
+                pixel[0] = 200;
+                pixel[1] = 180;
+                pixel[2] = 150;
+            } else {
+                pixel[0] = static_cast<uint8_t>(40 + 80 * x / width);
+                pixel[1] = static_cast<uint8_t>(50 + 60 * y / height);
+                pixel[2] = 70;
+            }
+            pixel[3] = 255;
+        }
+    }
+}
+
+bool parseSize(const char *text, int &width, int &height)
+{
+    return sscanf(text, "%dx%d", &width, &height) == 2 && width >= 3 && height >= 3;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int width = 1920;
+    int height = 1080;
+    int frames = 120;
+    float strength = 0.6f;
+    double grain = 8.0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc && parseSize(argv[i + 1], width, height)) {
+            ++i;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = max(atoi(argv[++i]), 2);
+        } else if (strcmp(argv[i], "--strength") == 0 && i + 1 < argc) {
+            strength = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(argv[i], "--grain") == 0 && i + 1 < argc) {
+            grain = atof(argv[++i]);
+        } else {
+            cout << "Usage: " << argv[0] << " [--size WxH] [--frames N] [--strength 0..1] [--grain sigma]" << endl;
+            cout << "Example: " << argv[0] << " --size 1920x1080 --frames 300 --strength 0.6" << endl;
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    vector<uint8_t> clean(bytes);
+    vector<uint8_t> frame(bytes);
+    mt19937 random(1);
+    normal_distribution<double> noise(0.0, grain);
+
+    TemporalDenoiser denoiser;
+    denoiser.setStrength(strength);
+    vector<double> times;
+    times.reserve(frames);
+    Region still;
+    Region moving;
+
+    for (int index = 0; index < frames; ++index) {
+        renderClean(clean, width, height, index);
+        for (size_t i = 0; i < bytes; i += 4) {
+            const int offset = static_cast<int>(lround(noise(random)));
+            for (int c = 0; c < 3; ++c) {
+                frame[i + c] = static_cast<uint8_t>(clamp(clean[i + c] + offset, 0, 255));
+            }
+            frame[i + 3] = 255;
+        }
+        const vector<uint8_t> noisy = frame;
+
+        const auto start = chrono::steady_clock::now();
+        denoiser.process(frame.data(), width, height, width * 4);
+        times.push_back(elapsedMs(start));
+
+        // Skip the frames the history needs to settle, and the square's edges
+        if (index < 10) {
+            continue;
+        }
+        const int squareX = (index * kSquareSpeed) % max(width - kSquareSize, 1);
+        const int squareY = (height - kSquareSize) / 2;
+        for (int y = 0; y < height; y += 2) {
+            for (int x = 0; x < width; x += 2) {
+                const size_t offset = (static_cast<size_t>(y) * width + x) * 4;
+                const double reference = luma(&clean[offset]);
+                const double before = luma(&noisy[offset]) - reference;
+                const double after = luma(&frame[offset]) - reference;
+                const int dx = x - squareX;
+                const int dy = y - squareY;
+                if (dx >= 4 && dx < kSquareSize - 4 && dy >= 4 && dy < kSquareSize - 4) {
+                    moving.add(before, after);
+                } else if (dx < -kSquareSpeed * 4 || dx >= kSquareSize + kSquareSpeed * 4
+                           || dy < -4 || dy >= kSquareSize + 4) {
+                    still.add(before, after);
+                }
+            }
+        }
+    }
+
+    // The first frame has no history and allocates; leave it out
+    vector<double> sorted(times.begin() + 1, times.end());
+    sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double ms : sorted) {
+        total += ms;
+    }
+    const double p95 = sorted[min(sorted.size() - 1, sorted.size() * 95 / 100)];
+
+    cout << fixed << setprecision(2);
+    cout << width << "x" << height << ", strength " << strength << ", grain sigma " << grain << ", "
+         << frames << " frames" << endl;
+    cout << "time per frame: first " << times.front() << " ms, then avg " << total / sorted.size()
+         << " / p95 " << p95 << " / max " << sorted.back() << " ms" << endl;
+    auto printRegion = [](const char *label, const Region &region) {
+        if (region.pixels == 0) {
+            return;
+        }
+        cout << label << ": luma noise RMS " << sqrt(region.noiseBefore / region.pixels) << " -> "
+             << sqrt(region.noiseAfter / region.pixels) << endl;
+    };
+    printRegion("still   ", still);
+    printRegion("moving  ", moving);
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "MotionEstimator.h"
+
+using namespace std;
+
+// Times MotionEstimator, the motion half of the preview's stabilization, on
+// synthetic frames: a textured scene seen through a camera that shakes by a
+// known sub-pixel amount each frame, with a subject crossing the picture on
+// its own. Reports the time per frame and how far the estimates land from
+// the true shake.
+
+namespace {
+
+const double kShakeAmplitude = 6.0;  // Pixels at 1080p, a monitor mount knocked by typing
+const int kSubjectSize = 360;
+
+// Smooth random texture: two octaves of bilinear value noise
+class Scene
+{
+public:
+    explicit Scene(unsigned seed)
+    {
+        mt19937 random(seed);
+        uniform_int_distribution<int> value(0, 255);
+        for (auto &cell : m_coarse) {
+            cell = static_cast<float>(value(random));
+        }
+        for (auto &cell : m_fine) {
+            cell = static_cast<float>(value(random));
+        }
+    }
+
+    float sample(double x, double y) const
+    {
+        return 0.6f * noise(m_coarse, x / 48.0, y / 48.0) + 0.4f * noise(m_fine, x / 9.0, y / 9.0);
+    }
+
+private:
+    static const int kGrid = 256;
+
+    static float noise(const float *grid, double x, double y)
+    {
+        const double fx = floor(x);
+        const double fy = floor(y);
+        const int x0 = static_cast<int>(fx) & (kGrid - 1);
+        const int y0 = static_cast<int>(fy) & (kGrid - 1);
+        const int x1 = (x0 + 1) & (kGrid - 1);
+        const int y1 = (y0 + 1) & (kGrid - 1);
+        const float tx = static_cast<float>(x - fx);
+        const float ty = static_cast<float>(y - fy);
+        const float top = grid[y0 * kGrid + x0] + (grid[y0 * kGrid + x1] - grid[y0 * kGrid + x0]) * tx;
+        const float bottom = grid[y1 * kGrid + x0] + (grid[y1 * kGrid + x1] - grid[y1 * kGrid + x0]) * tx;
+        return top + (bottom - top) * ty;
+    }
+
+    float m_coarse[kGrid * kGrid];
+    float m_fine[kGrid * kGrid];
+};
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+bool parseSize(const char *text, int &width, int &height)
+{
+    return sscanf(text, "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int width = 1920;
+    int height = 1080;
+    int frames = 120;
+    double grain = 4.0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc && parseSize(argv[i + 1], width, height)) {
+            ++i;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = max(atoi(argv[++i]), 3);
+        } else if (strcmp(argv[i], "--grain") == 0 && i + 1 < argc) {
+            grain = atof(argv[++i]);
+        } else {
+            cout << "Usage: " << argv[0] << " [--size WxH] [--frames N] [--grain sigma]" << endl;
+            cout << "Example: " << argv[0] << " --size 3840x2160 --frames 60" << endl;
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    static Scene background(1);
+    static Scene subject(2);
+    mt19937 random(3);
+    normal_distribution<double> noise(0.0, grain);
+    normal_distribution<double> shake(0.0, kShakeAmplitude * width / 1920.0);
+
+    vector<uint8_t> frame(static_cast<size_t>(width) * height * 4);
+    MotionEstimator estimator;
+    vector<double> times;
+    double squaredError = 0.0;
+    double squaredShake = 0.0;
+    int valid = 0;
+    double cameraX = 0.0;
+    double cameraY = 0.0;
+
+    for (int index = 0; index < frames; ++index) {
+        // The camera jumps about a fixed point; the subject walks left to right
+        const double previousX = cameraX;
+        const double previousY = cameraY;
+        cameraX = shake(random);
+        cameraY = shake(random);
+        const double subjectX = width * 0.1 + index * (width * 0.8 - kSubjectSize) / frames;
+        const double subjectY = height * 0.3;
+        for (int y = 0; y < height; ++y) {
+            uint8_t *row = frame.data() + static_cast<size_t>(y) * width * 4;
+            for (int x = 0; x < width; ++x) {
+                const double sceneX = x + cameraX;
+                const double sceneY = y + cameraY;
+                const bool onSubject = sceneX >= subjectX && sceneX < subjectX + kSubjectSize
+                                    && sceneY >= subjectY && sceneY < subjectY + kSubjectSize;
+                const float value = onSubject ? subject.sample(sceneX - subjectX, sceneY - subjectY)
+                                              : background.sample(sceneX, sceneY);
+                const uint8_t luma = static_cast<uint8_t>(clamp(lround(value + noise(random)), 0L, 255L));
+                row[4 * x] = luma;
+                row[4 * x + 1] = luma;
+                row[4 * x + 2] = luma;
+                row[4 * x + 3] = 255;
+            }
+        }
+
+        const auto start = chrono::steady_clock::now();
+        const MotionEstimator::Motion motion = estimator.estimate(frame.data(), width, height, width * 4);
+        times.push_back(elapsedMs(start));
+        if (index == 0) {
+            continue;
+        }
+
+        // The camera moving right moves the picture left
+        const double trueX = previousX - cameraX;
+        const double trueY = previousY - cameraY;
+        squaredShake += trueX * trueX + trueY * trueY;
+        if (motion.valid) {
+            ++valid;
+            squaredError += (motion.dx - trueX) * (motion.dx - trueX) + (motion.dy - trueY) * (motion.dy - trueY);
+        }
+    }
+
+    // The first frame only builds a pyramid; leave it out
+    vector<double> sorted(times.begin() + 1, times.end());
+    sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double ms : sorted) {
+        total += ms;
+    }
+    const double p95 = sorted[min(sorted.size() - 1, sorted.size() * 95 / 100)];
+
+    cout << fixed << setprecision(2);
+    cout << width << "x" << height << ", grain sigma " << grain << ", " << frames << " frames" << endl;
+    cout << "time per frame: first " << times.front() << " ms, then avg " << total / sorted.size()
+         << " / p95 " << p95 << " / max " << sorted.back() << " ms" << endl;
+    cout << "valid estimates: " << valid << " of " << frames - 1 << endl;
+    cout << "shake per frame RMS " << sqrt(squaredShake / (frames - 1)) << " px, estimate error RMS "
+         << (valid > 0 ? sqrt(squaredError / valid) : 0.0) << " px" << endl;
+    return 0;
+}
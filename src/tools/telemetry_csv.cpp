@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "GimbalTelemetry.h"
+
+using namespace std;
+
+// Converts a gimbal telemetry log (*.obtl) to CSV, one row per record,
+// ordered by time so samples and commands interleave for plotting.
+
+namespace {
+
+struct Row {
+    uint64_t timeUs;
+    string text;
+};
+
+template <typename T>
+bool readRecord(ifstream &in, T &record)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&record), sizeof(record)));
+}
+
+string formatTriple(const float values[3], bool valid)
+{
+    if (!valid) {
+        return ",,";
+    }
+    ostringstream out;
+    out << fixed << setprecision(3) << values[0] << "," << values[1] << "," << values[2];
+    return out.str();
+}
+
+string csvQuote(const char *text, size_t maxLength)
+{
+    string value(text, strnlen(text, maxLength));
+    string out = "\"";
+    for (char c : value) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argc > 3 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        cout << "Usage: " << argv[0] << " <log.obtl> [out.csv]" << endl;
+        cout << "Writes CSV to stdout when no output file is given." << endl;
+        return argc < 2 ? 1 : 0;
+    }
+
+    ifstream in(argv[1], ios::binary);
+    if (!in) {
+        cerr << "Cannot open " << argv[1] << endl;
+        return 1;
+    }
+
+    Telemetry::FileHeader header;
+    if (!readRecord(in, header) || memcmp(header.magic, Telemetry::kMagic, sizeof(header.magic)) != 0) {
+        cerr << argv[1] << " is not a gimbal telemetry log" << endl;
+        return 1;
+    }
+    if (header.version != Telemetry::kVersion) {
+        cerr << "Unsupported telemetry log version " << header.version << endl;
+        return 1;
+    }
+
+    vector<Row> rows;
+    size_t droppedSamples = 0;
+    size_t droppedCommands = 0;
+    bool truncated = false;
+
+    int type;
+    while ((type = in.get()) != EOF) {
+        if (type == Telemetry::RecordSample) {
+            Telemetry::Sample sample;
+            if (!readRecord(in, sample)) { truncated = true; break; }
+            bool attitude = sample.flags & Telemetry::AttitudeValid;
+            bool state = sample.flags & Telemetry::StateValid;
+            rows.push_back({sample.timeUs, "sample," + formatTriple(sample.attitude, attitude) + "," +
+                                               formatTriple(sample.euler, state) + "," +
+                                               formatTriple(sample.motor, state) + "," +
+                                               formatTriple(sample.velocity, state) + ",,"});
+        } else if (type == Telemetry::RecordCommand) {
+            Telemetry::Command command;
+            if (!readRecord(in, command)) { truncated = true; break; }
+            rows.push_back({command.timeUs, "command,,,,,,,,,,,,," +
+                                                csvQuote(command.name, sizeof(command.name)) + "," +
+                                                to_string(command.result)});
+        } else if (type == Telemetry::RecordDropped) {
+            Telemetry::Dropped dropped;
+            if (!readRecord(in, dropped)) { truncated = true; break; }
+            droppedSamples += dropped.samples;
+            droppedCommands += dropped.commands;
+        } else {
+            cerr << "Unknown record type " << type << ", stopping" << endl;
+            truncated = true;
+            break;
+        }
+    }
+
+    // The recorder writes samples and commands in batches; restore time order
+    stable_sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) { return a.timeUs < b.timeUs; });
+
+    ofstream file;
+    if (argc == 3) {
+        file.open(argv[2]);
+        if (!file) {
+            cerr << "Cannot write " << argv[2] << endl;
+            return 1;
+        }
+    }
+    ostream &out = argc == 3 ? file : cout;
+
+    out << "time_s,kind,attitude_roll,attitude_pitch,attitude_yaw,"
+           "euler_roll,euler_pitch,euler_yaw,motor_roll,motor_pitch,motor_yaw,"
+           "velocity_roll,velocity_pitch,velocity_yaw,command,result\n";
+    for (const auto &row : rows) {
+        out << fixed << setprecision(6) << row.timeUs / 1e6 << "," << row.text << "\n";
+    }
+
+    cerr << string(header.deviceSn, strnlen(header.deviceSn, sizeof(header.deviceSn)))
+         << ": " << rows.size() << " records at " << header.rateHz << " Hz";
+    if (droppedSamples || droppedCommands) {
+        cerr << ", " << droppedSamples << " samples and " << droppedCommands << " commands dropped";
+    }
+    if (truncated) {
+        cerr << " (log truncated)";
+    }
+    cerr << endl;
+    return 0;
+}